@@ -18,6 +18,7 @@
 
 #include "../ladr/top_input.h"
 #include "../ladr/interp.h"
+#include "evalmatrix.h"
 
 #define PROGRAM_NAME    "clausefilter"
 #include "../VERSION_DATE.h"
@@ -28,7 +29,9 @@ static char Help_string[] =
 "to stdout. The tests are true_in_all, true_in_some, false_in_all,\n"
 "false_in_some.\n"
 "For example,\n\n"
-"   clausefilter interps true_in_all < clauses.in > clauses.out\n\n";
+"   clausefilter interps true_in_all < clauses.in > clauses.out\n\n"
+"Argument \"threads <n>\" (read all of the formulas, then evaluate them\n"
+"with n threads) is accepted.\n";
 
 static Ordertype interp_compare(Interp a, Interp b)
 {
@@ -94,6 +97,76 @@ Interp find_interp(Topform c, Plist interps,
 
 enum {TRUE_IN_ALL, TRUE_IN_SOME, FALSE_IN_ALL, FALSE_IN_SOME};
 
+/*************
+ *
+ *   threaded_filter()
+ *
+ *   Read all of the formulas, evaluate them with eval_matrix(), and
+ *   print the ones that pass, in the order they were read.
+ *
+ *************/
+
+static
+void threaded_filter(Plist interps, int operation,
+		     LADR_BOOL ignore_nonevaluable, int num_threads,
+		     unsigned long *checked, unsigned long *passed)
+{
+  LADR_BOOL models = (operation == TRUE_IN_SOME || operation == FALSE_IN_ALL);
+  int num_interps = plist_count(interps);
+  int row_bytes = matrix_row_bytes(num_interps);
+  Interp *interp_array = malloc((num_interps + 1) * sizeof(Interp));
+  Plist clauses = NULL;
+  Plist p;
+  Topform *clause_array;
+  unsigned char *truth, *evaluable = NULL;
+  int num_clauses = 0;
+  int i, j;
+  Topform c = read_clause_or_formula(stdin, stderr);
+
+  while (c != NULL && !end_of_list_clause(c)) {
+    clauses = plist_prepend(clauses, c);
+    num_clauses++;
+    c = read_clause_or_formula(stdin, stderr);
+  }
+  clauses = reverse_plist(clauses);
+
+  for (p = interps, i = 0; p; p = p->next, i++)
+    interp_array[i] = p->v;
+  clause_array = malloc((num_clauses + 1) * sizeof(Topform));
+  for (p = clauses, i = 0; p; p = p->next, i++)
+    clause_array[i] = p->v;
+  truth = calloc((size_t) num_clauses * row_bytes + 1, 1);
+  if (ignore_nonevaluable)
+    evaluable = calloc((size_t) num_clauses * row_bytes + 1, 1);
+
+  eval_matrix(clause_array, num_clauses, interp_array, num_interps,
+	      num_threads, truth, evaluable);
+
+  for (i = 0; i < num_clauses; i++) {
+    unsigned char *row = truth + (size_t) i * row_bytes;
+    LADR_BOOL found = FALSE;
+    for (j = 0; j < num_interps && !found; j++) {
+      if (evaluable && !MATRIX_BIT(evaluable + (size_t) i * row_bytes, j))
+	;  /* skip this evaluation */
+      else if (MATRIX_BIT(row, j) == models)
+	found = TRUE;
+    }
+    (*checked)++;
+    if ((found && (operation==TRUE_IN_SOME || operation==FALSE_IN_SOME)) ||
+        (!found && (operation==TRUE_IN_ALL || operation==FALSE_IN_ALL))) {
+      (*passed)++;
+      fwrite_clause(stdout, clause_array[i], CL_FORM_BARE);
+    }
+    zap_topform(clause_array[i]);
+  }
+  zap_plist(clauses);
+  free(clause_array);
+  free(interp_array);
+  free(truth);
+  if (evaluable)
+    free(evaluable);
+}  /* threaded_filter */
+
 int main(int argc, char **argv)
 {
   FILE *interp_fp;
@@ -106,6 +179,7 @@ int main(int argc, char **argv)
   LADR_BOOL ignore_nonevaluable = string_member("ignore_nonevaluable", argv, argc);
   unsigned long int checked = 0;
   unsigned long int passed = 0;
+  int num_threads = 0;
   int i;
 
   if (string_member("help", argv, argc) ||
@@ -127,6 +201,13 @@ int main(int argc, char **argv)
   else
     fatal_error("clausefilter, need argument {true,false}_in_{all,some}");
 
+  i = which_string_member("threads", argv, argc);
+  if (i > 0) {
+    if (i+1 >= argc || !str_to_int(argv[i+1], &num_threads) ||
+	num_threads < 1)
+      fatal_error("clausefilter: \"threads\" needs a positive integer");
+  }
+
   init_standard_ladr();
   i = register_attribute("label",  STRING_ATTRIBUTE);  /* ignore these */
   i = register_attribute("answer", TERM_ATTRIBUTE);  /* ignore these */
@@ -155,7 +236,13 @@ int main(int argc, char **argv)
   
   /* Evaluate each formula/clause on stdin. */
 
-  c = read_clause_or_formula(stdin, stderr);
+  if (num_threads > 0) {
+    threaded_filter(interps, operation, ignore_nonevaluable, num_threads,
+		    &checked, &passed);
+    c = NULL;  /* all have been read */
+  }
+  else
+    c = read_clause_or_formula(stdin, stderr);
 
   while (c != NULL && !end_of_list_clause(c)) {
     
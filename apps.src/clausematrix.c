@@ -0,0 +1,170 @@
+/*  Copyright (C) 2006, 2007 William McCune
+
+    This file is part of the LADR Deduction Library.
+
+    The LADR Deduction Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU General Public License,
+    version 2.
+
+    The LADR Deduction Library is distributed in the hope that it will be
+    useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with the LADR Deduction Library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include "../ladr/top_input.h"
+#include "../ladr/interp.h"
+#include "evalmatrix.h"
+
+#define PROGRAM_NAME    "clausematrix"
+#include "../VERSION_DATE.h"
+
+static char Help_string[] =
+"\nThis program takes a file of interpretations (arg 1, text or binary)\n"
+"and a stream of clauses/formulas (stdin), and prints the truth matrix:\n"
+"a line for each clause, with a character for each interpretation,\n"
+"1 if the clause is true in the interpretation, 0 if it is false.\n\n"
+"For example,\n\n"
+"    clausematrix interps threads 4 < clauses.in\n\n"
+"Argument \"threads <n>\" is accepted.\n"
+"Argument \"hex\" (print each line in hex, 8 interpretations to a byte,\n"
+"    first interpretation in the low-order bit) is accepted.\n"
+"Argument \"ignore_nonevaluable\" (print - for pairs that cannot be\n"
+"    evaluated, instead of a fatal error) is accepted.\n";
+
+/*************
+ *
+ *   print_row()
+ *
+ *************/
+
+static
+void print_row(FILE *fp, unsigned char *row, unsigned char *evaluable,
+	       int num_interps, LADR_BOOL hex)
+{
+  int j;
+  if (hex) {
+    for (j = 0; j < matrix_row_bytes(num_interps); j++)
+      fprintf(fp, "%02x", row[j]);
+  }
+  else {
+    for (j = 0; j < num_interps; j++) {
+      if (evaluable && !MATRIX_BIT(evaluable, j))
+	fputc('-', fp);
+      else
+	fputc(MATRIX_BIT(row, j) ? '1' : '0', fp);
+    }
+  }
+  fputc('\n', fp);
+}  /* print_row */
+
+int main(int argc, char **argv)
+{
+  FILE *interp_fp;
+  Topform c;
+  Term t;
+  Plist interps = NULL;
+  Plist clauses = NULL;
+  Plist p;
+  Interp a;
+  Interp_bin bin;
+  Interp *interp_array;
+  Topform *clause_array;
+  unsigned char *truth;
+  unsigned char *evaluable = NULL;
+  int num_interps = 0;
+  int num_clauses = 0;
+  int num_threads = 1;
+  int row_bytes, num_groups, i, j, rc;
+  unsigned long num_true = 0;
+  unsigned long num_nonevaluable = 0;
+  LADR_BOOL commands = string_member("commands", argv, argc);
+  LADR_BOOL hex = string_member("hex", argv, argc);
+  LADR_BOOL ignore_nonevaluable = string_member("ignore_nonevaluable",
+						argv, argc);
+
+  if (string_member("help", argv, argc) ||
+      string_member("-help", argv, argc) ||
+      argc < 2) {
+    printf("\n%s, version %s, %s\n",PROGRAM_NAME,PROGRAM_VERSION,PROGRAM_DATE);
+    printf("%s", Help_string);
+    exit(1);
+  }
+
+  rc = which_string_member("threads", argv, argc);
+  if (rc > 0) {
+    if (rc+1 >= argc || !str_to_int(argv[rc+1], &num_threads) ||
+	num_threads < 1)
+      fatal_error("clausematrix: \"threads\" needs a positive integer");
+  }
+
+  interp_fp = fopen(argv[1], "r");
+  if (interp_fp == NULL)
+    fatal_error("interpretation file cannot be opened for reading");
+
+  init_standard_ladr();
+
+  i = register_attribute("label",  STRING_ATTRIBUTE);  /* ignore these */
+  i = register_attribute("answer", TERM_ATTRIBUTE);  /* ignore these */
+
+  bin = fread_interp_bin_header(interp_fp);
+  while ((a = fread_interp(interp_fp, bin, FALSE)) != NULL) {
+    interps = plist_prepend(interps, a);
+    num_interps++;
+  }
+  fclose(interp_fp);
+  interps = reverse_plist(interps);
+
+  if (commands) {
+    t = read_commands(stdin, stdout, FALSE, KILL_UNKNOWN);
+    if (!is_term(t, "clauses", 1) && !is_term(t, "formulas", 1))
+      fatal_error("formulas(...) not found");
+  }
+
+  c = read_clause_or_formula(stdin, stderr);
+  while (c != NULL && !end_of_list_clause(c)) {
+    clauses = plist_prepend(clauses, c);
+    num_clauses++;
+    c = read_clause_or_formula(stdin, stderr);
+  }
+  clauses = reverse_plist(clauses);
+
+  interp_array = malloc((num_interps + 1) * sizeof(Interp));
+  for (p = interps, i = 0; p; p = p->next, i++)
+    interp_array[i] = p->v;
+  clause_array = malloc((num_clauses + 1) * sizeof(Topform));
+  for (p = clauses, i = 0; p; p = p->next, i++)
+    clause_array[i] = p->v;
+
+  row_bytes = matrix_row_bytes(num_interps);
+  truth = calloc((size_t) num_clauses * row_bytes + 1, 1);
+  if (ignore_nonevaluable)
+    evaluable = calloc((size_t) num_clauses * row_bytes + 1, 1);
+
+  num_groups = eval_matrix(clause_array, num_clauses,
+			   interp_array, num_interps,
+			   num_threads, truth, evaluable);
+
+  for (i = 0; i < num_clauses; i++) {
+    unsigned char *row = truth + (size_t) i * row_bytes;
+    unsigned char *erow = evaluable ? evaluable + (size_t) i * row_bytes : NULL;
+    print_row(stdout, row, erow, num_interps, hex);
+    for (j = 0; j < num_interps; j++) {
+      if (MATRIX_BIT(row, j))
+	num_true++;
+      if (erow && !MATRIX_BIT(erow, j))
+	num_nonevaluable++;
+    }
+  }
+
+  printf("%% %s: clauses=%d, interps=%d, groups=%d, true=%lu, "
+	 "not_evaluable=%lu, %.2f seconds.\n",
+	 PROGRAM_NAME, num_clauses, num_interps, num_groups,
+	 num_true, num_nonevaluable, user_seconds());
+
+  exit(0);
+}  /* main */
@@ -18,16 +18,93 @@
 
 #include "../ladr/top_input.h"
 #include "../ladr/interp.h"
+#include "evalmatrix.h"
 
 #define PROGRAM_NAME    "clausetester"
 #include "../VERSION_DATE.h"
 
 static char Help_string[] =
-"\nThis program takes a file of interpretations (arg 1) and a stream of\n"
-"clauses (stdin).  For each clause, it tells interpretations in which\n"
-"the clause is true.\n\n"
+"\nThis program takes a file of interpretations (arg 1, text or binary)\n"
+"and a stream of clauses (stdin).  For each clause, it tells\n"
+"interpretations in which the clause is true.\n\n"
 "For example,\n\n"
-"    clausetester interps < clauses.in\n\n";
+"    clausetester interps < clauses.in\n\n"
+"Argument \"threads <n>\" (read all of the clauses, then evaluate them\n"
+"    with n threads) is accepted.\n";
+
+/*************
+ *
+ *   print_clause()
+ *
+ *************/
+
+static
+void print_clause(Topform c)
+{
+  Term t = topform_to_term(c);
+  fwrite_term(stdout, t);
+  zap_term(t);
+  printf(".  %%");
+}  /* print_clause */
+
+/*************
+ *
+ *   threaded_tester()
+ *
+ *   Read all of the clauses, evaluate them with eval_matrix(),
+ *   and print the same thing as the one-at-a-time loop in main().
+ *   Return the number of clauses.
+ *
+ *************/
+
+static
+int threaded_tester(Plist interps, int icount, int *counters, int num_threads)
+{
+  Plist clauses = NULL;
+  Plist p;
+  Interp *interp_array = malloc((icount + 1) * sizeof(Interp));
+  Topform *clause_array;
+  unsigned char *truth;
+  int row_bytes = matrix_row_bytes(icount);
+  int ccount = 0;
+  int i, j;
+  Topform c = read_clause_or_formula(stdin, stderr);
+
+  while (c != NULL && !end_of_list_clause(c)) {
+    clauses = plist_prepend(clauses, c);
+    ccount++;
+    c = read_clause_or_formula(stdin, stderr);
+  }
+  clauses = reverse_plist(clauses);
+
+  for (p = interps, i = 0; p; p = p->next, i++)
+    interp_array[i] = p->v;
+  clause_array = malloc((ccount + 1) * sizeof(Topform));
+  for (p = clauses, i = 0; p; p = p->next, i++)
+    clause_array[i] = p->v;
+  truth = calloc((size_t) ccount * row_bytes + 1, 1);
+
+  eval_matrix(clause_array, ccount, interp_array, icount, num_threads,
+	      truth, NULL);
+
+  for (i = 0; i < ccount; i++) {
+    unsigned char *row = truth + (size_t) i * row_bytes;
+    print_clause(clause_array[i]);
+    for (j = 0; j < icount; j++) {
+      if (MATRIX_BIT(row, j)) {
+	counters[j]++;
+	printf(" %2d", j+1);
+      }
+    }
+    printf("\n");
+    zap_topform(clause_array[i]);
+  }
+  zap_plist(clauses);
+  free(clause_array);
+  free(interp_array);
+  free(truth);
+  return ccount;
+}  /* threaded_tester */
 
 int main(int argc, char **argv)
 {
@@ -35,10 +112,12 @@ int main(int argc, char **argv)
   Topform c;
   Term t;
   Interp interp;
+  Interp_bin bin;
   Plist interps = NULL;
   int icount = 0;
   int ccount = 0;
-  int *counters, i;
+  int *counters, i, rc;
+  int num_threads = 0;
   LADR_BOOL commands = string_member("commands", argv, argc);
 
   if (string_member("help", argv, argc) ||
@@ -49,6 +128,13 @@ int main(int argc, char **argv)
     exit(1);
   }
 
+  rc = which_string_member("threads", argv, argc);
+  if (rc > 0) {
+    if (rc+1 >= argc || !str_to_int(argv[rc+1], &num_threads) ||
+	num_threads < 1)
+      fatal_error("clausetester: \"threads\" needs a positive integer");
+  }
+
   interp_fp = fopen(argv[1], "r");
   if (interp_fp == NULL)
     fatal_error("interpretation file cannot be opened for reading");
@@ -58,14 +144,11 @@ int main(int argc, char **argv)
   i = register_attribute("label",  STRING_ATTRIBUTE);  /* ignore these */
   i = register_attribute("answer", TERM_ATTRIBUTE);  /* ignore these */
 
-  t = read_term(interp_fp, stderr);  /* get first interpretation */
+  bin = fread_interp_bin_header(interp_fp);  /* NULL if text */
 
-  while (t != NULL) {
+  while ((interp = fread_interp(interp_fp, bin, FALSE)) != NULL) {
     icount++;
-    interp = compile_interp(t, FALSE);
     interps = plist_append(interps, interp);
-    zap_term(t);
-    t = read_term(interp_fp, stderr);
   }
   fclose(interp_fp);
 
@@ -79,30 +162,31 @@ int main(int argc, char **argv)
 
   /* Evaluate each clause on stdin. */
 
-  c = read_clause_or_formula(stdin, stderr);
+  if (num_threads > 0)
+    ccount = threaded_tester(interps, icount, counters, num_threads);
+  else {
+    c = read_clause_or_formula(stdin, stderr);
+
+    while (c != NULL && !end_of_list_clause(c)) {
 
-  while (c != NULL && !end_of_list_clause(c)) {
+      Plist p = interps;
+      ccount++;
+      print_clause(c);
 
-    Plist p = interps;
-    Term t = topform_to_term(c);
-    ccount++;
-    fwrite_term(stdout, t);
-    zap_term(t);
-    printf(".  %%");
-
-    i = 0;
-    while (p != NULL) {
-      if (eval_topform(c, p->v)) {  /* works also for non-clauses */
-	counters[i]++;
-	printf(" %2d", i+1);
+      i = 0;
+      while (p != NULL) {
+	if (eval_topform(c, p->v)) {  /* works also for non-clauses */
+	  counters[i]++;
+	  printf(" %2d", i+1);
+	}
+	i++;
+	p = p->next;
       }
-      i++;
-      p = p->next;
+      printf("\n");
+      fflush(stdout);
+      zap_topform(c);
+      c = read_clause_or_formula(stdin, stderr);
     }
-    printf("\n");
-    fflush(stdout);
-    zap_topform(c);
-    c = read_clause_or_formula(stdin, stderr);
   }
 
   for (i = 0; i < icount; i++)
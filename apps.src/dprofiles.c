@@ -26,13 +26,14 @@
 #include "../VERSION_DATE.h"
 
 static char Help_string[] =
-"\nThis program reads a stream of interpretations (from stdin)\n"
-"and shows the profiles."
+"\nThis program reads a stream of interpretations (from stdin,\n"
+"text or binary) and shows the profiles."
 "Argument \"discrim '<filename>'\" is accepted.\n";
 
 int main(int argc, char **argv)
 {
-  Term t;
+  Interp a;
+  Interp_bin bin;
   Plist discriminators = NULL;
   int rc;
 
@@ -59,20 +60,15 @@ int main(int argc, char **argv)
     }
   }
 
-  /* Input is a stream of interpretations. */
+  /* Input is a stream of interpretations, text or binary. */
 
-  t = read_term(stdin, stderr);
+  bin = fread_interp_bin_header(stdin);
 
-  while (t != NULL) {
-    Interp a, c;
-
-    a = compile_interp(t, FALSE);
-    c = normal3_interp(a, discriminators);
+  while ((a = fread_interp(stdin, bin, FALSE)) != NULL) {
+    Interp c = normal3_interp(a, discriminators);
     p_interp_profile(c, discriminators);
     zap_interp(a);
     zap_interp(c);
-    zap_term(t);
-    t = read_term(stdin, stderr);
   }
 
   exit(0);
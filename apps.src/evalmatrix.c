@@ -0,0 +1,227 @@
+/*  Copyright (C) 2006, 2007 William McCune
+
+    This file is part of the LADR Deduction Library.
+
+    The LADR Deduction Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU General Public License,
+    version 2.
+
+    The LADR Deduction Library is distributed in the hope that it will be
+    useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with the LADR Deduction Library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include "evalmatrix.h"
+#include "../provers.src/c11threads.h"
+
+/* Private definitions and types */
+
+struct group {
+  int n;           /* number of members */
+  int *members;    /* indexes into the interps array */
+};
+
+struct matrix {
+  Topform *clauses;
+  Interp *interps;
+  struct group *groups;
+  int num_groups;
+  unsigned char *truth;
+  int row_bytes;
+  char *pending;   /* [clause * num_groups + group]: left for eval_topform */
+};
+
+struct worker {
+  struct matrix *m;
+  int first;       /* this worker does rows first, first+stride, ... */
+  int stride;
+  int num_clauses;
+  thrd_t thread;
+};
+
+/*************
+ *
+ *   matrix_row_bytes()
+ *
+ *************/
+
+/* DOCUMENTATION
+The number of bytes in each row of the truth matrix.
+*/
+
+/* PUBLIC */
+int matrix_row_bytes(int num_interps)
+{
+  return (num_interps + 7) / 8;
+}  /* matrix_row_bytes */
+
+/*************
+ *
+ *   group_interps()
+ *
+ *   Partition the interps by domain size and signature.
+ *
+ *************/
+
+static
+struct group *group_interps(Interp *interps, int num_interps, int *num_groups)
+{
+  struct group *groups = malloc((num_interps + 1) * sizeof(struct group));
+  int i, g;
+
+  *num_groups = 0;
+  for (i = 0; i < num_interps; i++) {
+    for (g = 0; g < *num_groups; g++)
+      if (same_interp_signature(interps[groups[g].members[0]], interps[i]))
+	break;
+    if (g == *num_groups) {
+      groups[g].n = 0;
+      groups[g].members = malloc(num_interps * sizeof(int));
+      (*num_groups)++;
+    }
+    groups[g].members[groups[g].n++] = i;
+  }
+  return groups;
+}  /* group_interps */
+
+/*************
+ *
+ *   eval_row()
+ *
+ *************/
+
+static
+void eval_row(struct matrix *m, int i)
+{
+  Topform c = m->clauses[i];
+  unsigned char *row = m->truth + (size_t) i * m->row_bytes;
+  int g, k;
+
+  for (g = 0; g < m->num_groups; g++) {
+    struct group *gr = m->groups + g;
+    Eval_prog e = NULL;
+    if (!c->is_formula)
+      e = compile_eval_literals(c->literals, m->interps[gr->members[0]]);
+    if (e == NULL)
+      m->pending[(size_t) i * m->num_groups + g] = 1;
+    else {
+      for (k = 0; k < gr->n; k++) {
+	int j = gr->members[k];
+	if (run_eval_literals(e, m->interps[j]))
+	  row[j / 8] |= 1 << (j % 8);
+      }
+      zap_eval_prog(e);
+    }
+  }
+}  /* eval_row */
+
+/*************
+ *
+ *   worker_main()
+ *
+ *************/
+
+static
+int worker_main(void *arg)
+{
+  struct worker *w = arg;
+  int i;
+  for (i = w->first; i < w->num_clauses; i += w->stride)
+    eval_row(w->m, i);
+  return 0;
+}  /* worker_main */
+
+/*************
+ *
+ *   eval_matrix()
+ *
+ *************/
+
+/* DOCUMENTATION
+Evaluate each of the clauses (or formulas) in each of the interps,
+with the given number of threads, and fill in the truth matrix
+(num_clauses rows of matrix_row_bytes(num_interps) bytes, which
+must be zeroed by the caller).
+<P>
+If evaluable is not NULL, it is a matrix of the same shape, which
+is filled in to show which pairs are evaluable; pairs that are not
+evaluable are false in the truth matrix.  If evaluable is NULL,
+a pair that is not evaluable is a fatal error (as in eval_topform()).
+<P>
+The number of groups of interpretations is returned.
+*/
+
+/* PUBLIC */
+int eval_matrix(Topform *clauses, int num_clauses,
+		Interp *interps, int num_interps,
+		int num_threads,
+		unsigned char *truth, unsigned char *evaluable)
+{
+  struct matrix m;
+  int i, g, k;
+
+  m.clauses = clauses;
+  m.interps = interps;
+  m.groups = group_interps(interps, num_interps, &m.num_groups);
+  m.truth = truth;
+  m.row_bytes = matrix_row_bytes(num_interps);
+  m.pending = calloc((size_t) num_clauses * m.num_groups + 1, sizeof(char));
+
+  is_eq_symbol(0);  /* look up eq_sym before there are threads */
+
+  if (num_threads <= 1) {
+    for (i = 0; i < num_clauses; i++)
+      eval_row(&m, i);
+  }
+  else {
+    struct worker *workers = calloc(num_threads, sizeof(struct worker));
+    for (i = 0; i < num_threads; i++) {
+      workers[i].m = &m;
+      workers[i].first = i;
+      workers[i].stride = num_threads;
+      workers[i].num_clauses = num_clauses;
+      if (thrd_create(&(workers[i].thread), worker_main, workers + i) !=
+	  thrd_success)
+	fatal_error("eval_matrix: thread creation failed");
+    }
+    for (i = 0; i < num_threads; i++)
+      thrd_join(workers[i].thread, NULL);
+    free(workers);
+  }
+
+  /* Formulas and clauses that could not be compiled. */
+
+  if (evaluable) {
+    for (i = 0; i < num_clauses; i++) {
+      unsigned char *row = evaluable + (size_t) i * m.row_bytes;
+      for (k = 0; k < num_interps; k++)
+	row[k / 8] |= 1 << (k % 8);
+    }
+  }
+
+  for (i = 0; i < num_clauses; i++) {
+    for (g = 0; g < m.num_groups; g++) {
+      if (m.pending[(size_t) i * m.num_groups + g]) {
+	struct group *gr = m.groups + g;
+	for (k = 0; k < gr->n; k++) {
+	  int j = gr->members[k];
+	  if (evaluable && !evaluable_topform(clauses[i], interps[j]))
+	    evaluable[(size_t) i * m.row_bytes + j / 8] &= ~(1 << (j % 8));
+	  else if (eval_topform(clauses[i], interps[j]))
+	    truth[(size_t) i * m.row_bytes + j / 8] |= 1 << (j % 8);
+	}
+      }
+    }
+  }
+
+  for (g = 0; g < m.num_groups; g++)
+    free(m.groups[g].members);
+  free(m.groups);
+  free(m.pending);
+  return m.num_groups;
+}  /* eval_matrix */
@@ -0,0 +1,52 @@
+/*  Copyright (C) 2006, 2007 William McCune
+
+    This file is part of the LADR Deduction Library.
+
+    The LADR Deduction Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU General Public License,
+    version 2.
+
+    The LADR Deduction Library is distributed in the hope that it will be
+    useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with the LADR Deduction Library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifndef TP_EVALMATRIX_H
+#define TP_EVALMATRIX_H
+
+#include "../ladr/interp.h"
+
+/* INTRODUCTION
+Batch evaluation of a set of clauses/formulas in a set of
+interpretations.  The result is a truth matrix with a row of bits
+for each clause:  bit j of a row (bit j%8 of byte j/8) says whether
+the clause is true in interpretation j.
+<P>
+The interpretations are put into groups with the same domain size and
+signature, each clause is compiled once per group (see
+compile_eval_literals()), and the rows are divided among threads.
+Formulas, and clauses that cannot be compiled, are evaluated
+afterward (by the main thread) with eval_topform().
+*/
+
+/* Public definitions */
+
+#define MATRIX_BIT(row, j) (((row)[(j) / 8] >> ((j) % 8)) & 1)
+
+/* End of public definitions */
+
+/* Public function prototypes from evalmatrix.c */
+
+int matrix_row_bytes(int num_interps);
+
+int eval_matrix(Topform *clauses, int num_clauses,
+		Interp *interps, int num_interps,
+		int num_threads,
+		unsigned char *truth, unsigned char *evaluable);
+
+#endif  /* conditional compilation of whole file */
@@ -18,6 +18,7 @@
 
 #include "../ladr/top_input.h"
 #include "../ladr/interp.h"
+#include "evalmatrix.h"
 
 #define PROGRAM_NAME    "interpfilter"
 #include "../VERSION_DATE.h"
@@ -32,7 +33,9 @@ static char Help_string[] =
 "and commutativity (AC), we can remove AC models by using the\n"
 "some_false test.\n"
 "For example,\n\n"
-"    interpfilter clauses some_false < interps.in > interps.out\n\n";
+"    interpfilter clauses some_false < interps.in > interps.out\n\n"
+"Argument \"threads <n>\" (read all of the interpretations, then\n"
+"evaluate with n threads) is accepted.\n";
 
 /*************
  *
@@ -59,6 +62,69 @@ Topform find_clause(Plist topforms, Interp interp, LADR_BOOL requested_val)
 
 enum {ALL_TRUE, SOME_TRUE, ALL_FALSE, SOME_FALSE};
 
+/*************
+ *
+ *   threaded_filter()
+ *
+ *   Read all of the interpretations, evaluate the clauses in them
+ *   with eval_matrix(), and print the ones that pass, in the order
+ *   they were read.
+ *
+ *************/
+
+static
+void threaded_filter(Plist topforms, int operation, int num_threads,
+		     unsigned long *checked, unsigned long *passed)
+{
+  LADR_BOOL requested_val = (operation == SOME_TRUE || operation == ALL_FALSE);
+  Plist interps = NULL;
+  Plist p;
+  Interp *interp_array;
+  Topform *clause_array;
+  unsigned char *truth;
+  int num_interps = 0;
+  int num_clauses = plist_count(topforms);
+  int row_bytes, i, j;
+  Term t = read_term(stdin, stderr);
+
+  while (t != NULL) {
+    interps = plist_prepend(interps, compile_interp(t, FALSE));
+    num_interps++;
+    zap_term(t);
+    t = read_term(stdin, stderr);
+  }
+  interps = reverse_plist(interps);
+
+  interp_array = malloc((num_interps + 1) * sizeof(Interp));
+  for (p = interps, j = 0; p; p = p->next, j++)
+    interp_array[j] = p->v;
+  clause_array = malloc((num_clauses + 1) * sizeof(Topform));
+  for (p = topforms, i = 0; p; p = p->next, i++)
+    clause_array[i] = p->v;
+  row_bytes = matrix_row_bytes(num_interps);
+  truth = calloc((size_t) num_clauses * row_bytes + 1, 1);
+
+  eval_matrix(clause_array, num_clauses, interp_array, num_interps,
+	      num_threads, truth, NULL);
+
+  for (j = 0; j < num_interps; j++) {
+    LADR_BOOL found = FALSE;
+    for (i = 0; i < num_clauses && !found; i++)
+      found = (MATRIX_BIT(truth + (size_t) i * row_bytes, j) == requested_val);
+    (*checked)++;
+    if ((found  && (operation == SOME_TRUE || operation == SOME_FALSE)) ||
+	(!found && (operation == ALL_TRUE  || operation == ALL_FALSE ))) {
+      (*passed)++;
+      fprint_interp_standard(stdout, interp_array[j]);
+    }
+    zap_interp(interp_array[j]);
+  }
+  zap_plist(interps);
+  free(interp_array);
+  free(clause_array);
+  free(truth);
+}  /* threaded_filter */
+
 int main(int argc, char **argv)
 {
   FILE *clause_fp;
@@ -69,6 +135,7 @@ int main(int argc, char **argv)
   unsigned long int passed = 0;
   Plist topforms;
   int operation = -1;
+  int num_threads = 0;
   LADR_BOOL commands = string_member("commands", argv, argc);
 
   if (string_member("help", argv, argc) ||
@@ -90,6 +157,13 @@ int main(int argc, char **argv)
   else
     fatal_error("interpfilter: operation should be {all,some}_{true,false}");
 
+  i = which_string_member("threads", argv, argc);
+  if (i > 0) {
+    if (i+1 >= argc || !str_to_int(argv[i+1], &num_threads) ||
+	num_threads < 1)
+      fatal_error("interpfilter: \"threads\" needs a positive integer");
+  }
+
   clause_fp = fopen(argv[1], "r");
   if (clause_fp == NULL)
     fatal_error("interpfilter: clause file cannot be opened for reading");
@@ -109,7 +183,12 @@ int main(int argc, char **argv)
 
   /* Print each interpretation on stdin that satisfies the query. */
 
-  t = read_term(stdin, stderr);
+  if (num_threads > 0) {
+    threaded_filter(topforms, operation, num_threads, &checked, &passed);
+    t = NULL;  /* all have been read */
+  }
+  else
+    t = read_term(stdin, stderr);
   while (t != NULL) {
     Topform c;
     checked++;
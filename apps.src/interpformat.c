@@ -29,7 +29,8 @@
 static char Help_string[] =
 "\nThis program reads interpretations in standard format\n"
 "(from stdin or with -f <file>).  The input can be just interps\n"
-"(with or without list(interpretations)) or a Mace4 output file.\n"
+"(with or without list(interpretations)), a Mace4 output file, or\n"
+"a binary stream of interps (from interpformat binary or mace4 -W).\n"
 "It and takes a command-line argument saying how to print the interps:\n\n"
 "    standard    : one line per operation\n"
 "    standard2   : standard, with binary operations in a square (default)\n"
@@ -38,10 +39,11 @@ static char Help_string[] =
 "    raw         : similar to standard, but without punctuation\n"
 "    cooked      : as terms, e.g., f(0,1)=2\n"
 "    tex         : formatted for LaTeX\n"
-"    xml         : XML\n\n"
+"    xml         : XML\n"
+"    binary      : binary, read without parsing by LADR programs\n\n"
 "Also, argument \"output '<operations>'\" is accepted.\n\n";
 
-enum {STANDARD, STANDARD2, PORTABLE, TABULAR, RAW, COOKED, TEX, XML};
+enum {STANDARD, STANDARD2, PORTABLE, TABULAR, RAW, COOKED, TEX, XML, BINARY};
 
 /*************
  *
@@ -156,12 +158,41 @@ Term next_interp(FILE *fp, LADR_BOOL mace4_file)
   }
 }  /* next_interp */
 
+/*************
+ *
+ *   next_compiled_interp()
+ *
+ *************/
+
+static
+Interp next_compiled_interp(FILE *fp, Interp_bin bin, LADR_BOOL mace4_file,
+			    Plist output_strings)
+{
+  Interp a;
+  if (bin != NULL) {
+    a = fread_interp_bin(fp, bin);
+    if (a != NULL && output_strings != NULL)
+      remove_interp_others(a, output_strings);
+  }
+  else {
+    Term t = next_interp(fp, mace4_file);
+    if (t == NULL)
+      return NULL;
+    if (output_strings != NULL)
+      interp_remove_others(t, output_strings);
+    a = compile_interp(t, TRUE);
+    zap_term(t);
+  }
+  return a;
+}  /* next_compiled_interp */
+
 int main(int argc, char **argv)
 {
   LADR_BOOL mace4_file;  /* list of interps or mace4 output */
   LADR_BOOL wrap;        /* enclose output in list(interpretations). */
   int type, rc, count;
-  Term t;
+  Interp a;
+  Interp_bin bin_in, bin_out = NULL;
   String_buf heading, mace4_input;
   FILE *fin = stdin;
   char *filename = NULL;
@@ -189,6 +220,8 @@ int main(int argc, char **argv)
     type = TEX;
   else if (string_member("xml", argv, argc))
     type = XML;
+  else if (string_member("binary", argv, argc))
+    type = BINARY;
   else {
     type = STANDARD2;  /* default */
   }
@@ -220,21 +253,27 @@ int main(int argc, char **argv)
     }
   }
 
-  /* Input can be any of 3 types:
+  /* Input can be any of 4 types:
        1. stream of interps
        2. list of interps, surrounded by list(interpretations) .. end_of_list
        3. Mace4 output file, with "= MODEL =" ... "= end of model ="
+       4. binary stream of interps (see fread_interp_bin_header())
      See next_interp().
   */
 
-  rc = getc(fin);
-  mace4_file = (rc == '=');
-  if (!mace4_file)
-    ungetc(rc, fin);
-
   init_standard_ladr();
   simple_parse(TRUE);
 
+  bin_in = fread_interp_bin_header(fin);
+  if (bin_in != NULL)
+    mace4_file = FALSE;
+  else {
+    rc = getc(fin);
+    mace4_file = (rc == '=');
+    if (!mace4_file)
+      ungetc(rc, fin);
+  }
+
   if (mace4_file) {
     heading = read_next_section(fin);
     mace4_input = read_mace4_input(fin);
@@ -265,22 +304,23 @@ int main(int argc, char **argv)
     }
   }
 
-  if (wrap)
+  if (type == BINARY)
+    wrap = FALSE;
+  else if (wrap)
     printf("list(interpretations).\n");
 
-  t = next_interp(fin, mace4_file);
+  a = next_compiled_interp(fin, bin_in, mace4_file, output_strings);
   count = 0;
 
-  while (t != NULL) {
-    Interp a;
+  while (a != NULL) {
     count++;
 
-    if (output_strings != NULL)
-      interp_remove_others(t, output_strings);
-
-    a = compile_interp(t, TRUE);
-
-    if (type == STANDARD)
+    if (type == BINARY) {
+      if (bin_out == NULL)
+	bin_out = fwrite_interp_bin_header(stdout, a);
+      fwrite_interp_bin(stdout, bin_out, a);
+    }
+    else if (type == STANDARD)
       fprint_interp_standard(stdout, a);
     else if (type == STANDARD2)
       fprint_interp_standard2(stdout, a);
@@ -302,9 +342,8 @@ int main(int argc, char **argv)
       fprint_interp_standard2(stdout, a);
 
     zap_interp(a);
-    zap_term(t);
 
-    t = next_interp(fin, mace4_file);
+    a = next_compiled_interp(fin, bin_in, mace4_file, output_strings);
   }
 
   if (type == XML)
@@ -21,6 +21,7 @@
 
 #include "../ladr/top_input.h"
 #include "../ladr/interp.h"
+#include "../provers.src/c11threads.h"
 
 #define PROGRAM_NAME    "isofilter"
 #include "../VERSION_DATE.h"
@@ -33,11 +34,67 @@ static char Help_string[] =
 "        function(A, [1]),\n"
 "        function(e(_,_), [1,0,0,1]),\n"
 "        relation(P(_), [0,1])]).\n\n"
+"A binary stream of interpretations (from interpformat binary or\n"
+"mace4 -W) is also accepted; the output is in the standard form.\n\n"
 "Argument \"ignore_constants\" is accepted.\n"
 "Argument \"wrap\" is accepted.\n"
 "Argument \"check '<operations>'\" is accepted.\n"
 "Argument \"output '<operations>'\" is accepted.\n"
-"Argument \"discrim '<filename>'\" is accepted.\n";
+"Argument \"discrim '<filename>'\" is accepted.\n"
+"Argument \"canon\" is accepted.\n"
+"Argument \"threads <n>\" is accepted.\n";
+
+/* The kept interpretations are put into buckets by a hash of their
+   profiles (or, with the "canon" argument, of their canonical forms),
+   so that an interpretation is compared only with the members of
+   its own bucket. */
+
+struct bucket {
+  unsigned key;
+  int n;            /* number of members */
+  Plist members;    /* normal (or canonical) interps */
+};
+
+static Hashtab Buckets;
+static int Num_buckets = 0;
+static int Largest_bucket = 0;
+static int Interps_read = 0;
+static int Interps_kept = 0;
+
+static Interp_bin Bin = NULL;  /* the input is binary */
+static LADR_BOOL Ignore_constants = FALSE;
+static Plist Check_strings = NULL;
+static Plist Output_strings = NULL;
+
+/* With the "threads" argument, interpretations are read in batches.
+   While the worker threads compute the canonical labellings for one
+   batch, the main thread reads the next one; then the main thread
+   removes the isomorphic ones from the first batch and prints the
+   rest, in input order.  Only the main thread parses, prints, or
+   uses the LADR memory pools; the workers use canon_interp_perm(). */
+
+#define JOBS_PER_THREAD 256
+
+struct job {
+  Term t;       /* as read, for output (text input) */
+  Interp b;     /* as read, for output (binary input) */
+  Interp a;     /* for the isomorphism check */
+  int *perm;    /* canonical labelling, from a worker */
+};
+
+struct worker {
+  struct job *jobs;
+  int num_jobs;
+  int first;              /* this worker does first, first+stride, ... */
+  int stride;
+  long unsigned perms;
+  thrd_t thread;
+};
+
+static LADR_BOOL same_key(void *a, void *b)
+{
+  return ((struct bucket *) a)->key == ((struct bucket *) b)->key;
+}  /* same_key */
 
 static LADR_BOOL iso_member(Interp a, Plist interps)
 {
@@ -49,17 +106,199 @@ static LADR_BOOL iso_member(Interp a, Plist interps)
     return iso_member(a, interps->next);
 }  /* iso_member */
 
+static LADR_BOOL interp_member(Interp a, Plist interps)
+{
+  if (interps == NULL)
+    return FALSE;
+  else if (ident_interp(a, interps->v))
+    return TRUE;
+  else
+    return interp_member(a, interps->next);
+}  /* interp_member */
+
+/* Look for an interp isomorphic to c (identical, if canon) among the
+   kept ones.  If there is none, keep c. */
+
+static LADR_BOOL kept_before(Interp c, unsigned key, LADR_BOOL canon)
+{
+  struct bucket k, *bk;
+  k.key = key;
+  bk = hash_lookup(&k, key, Buckets, same_key);
+  if (bk != NULL && (canon ? interp_member(c, bk->members)
+		          : iso_member(c, bk->members)))
+    return TRUE;
+  if (bk == NULL) {
+    bk = malloc(sizeof(struct bucket));
+    bk->key = key;
+    bk->n = 0;
+    bk->members = NULL;
+    hash_insert(bk, bk->key, Buckets);
+    Num_buckets++;
+  }
+  bk->members = plist_prepend(bk->members, c);  /* keep the interp */
+  bk->n++;
+  Largest_bucket = IMAX(Largest_bucket, bk->n);
+  Interps_kept++;
+  return FALSE;
+}  /* kept_before */
+
+/* Read the next interp, and compile the part to be checked.  The
+   original is returned as a term *t (text input) or as an interp *b
+   (binary input), for print_interp(). */
+
+static LADR_BOOL read_interp(Interp *a, Term *t, Interp *b)
+{
+  *t = NULL;
+  *b = NULL;
+  if (Bin != NULL) {
+    *b = fread_interp_bin(stdin, Bin);
+    if (*b == NULL)
+      return FALSE;
+    if (Ignore_constants)
+      remove_interp_constants(*b);  /* constants not checked or output */
+    *a = copy_interp(*b);
+    if (Check_strings)
+      remove_interp_others(*a, Check_strings);
+    if (Output_strings)
+      remove_interp_others(*b, Output_strings);
+    return TRUE;
+  }
+
+  *t = read_term(stdin, stderr);
+  if (*t != NULL) {
+    Term twork;
+    if (Ignore_constants)
+      interp_remove_constants(*t);  /* constants not checked or output */
+
+    twork = copy_term(*t);
+
+    if (Check_strings)
+      interp_remove_others(twork, Check_strings);
+      
+    *a = compile_interp(twork, FALSE);
+    zap_term(twork);
+  }
+  return *t != NULL;
+}  /* read_interp */
+
+/* Print the original interp (the part to be output). */
+
+static void print_interp(Term t, Interp b)
+{
+  if (b != NULL)
+    fprint_interp_standard2(stdout, b);  /* already cut to the output */
+  else {
+    if (Output_strings)
+      interp_remove_others(t, Output_strings);
+
+    b = compile_interp(t, FALSE);
+    fprint_interp_standard2(stdout, b);
+    zap_interp(b);
+  }
+  fflush(stdout);
+}  /* print_interp */
+
+/* Free the original interp. */
+
+static void zap_original(Term t, Interp b)
+{
+  if (b != NULL)
+    zap_interp(b);
+  else
+    zap_term(t);
+}  /* zap_original */
+
+static void report_progress(void)
+{
+  if (Interps_read % 1000 == 0)
+    fprintf(stderr, "%s: %d interps read, %d kept\n",
+	    PROGRAM_NAME, Interps_read, Interps_kept);
+}  /* report_progress */
+
+static int read_batch(struct job *jobs, int max)
+{
+  int n = 0;
+  while (n < max && read_interp(&(jobs[n].a), &(jobs[n].t), &(jobs[n].b)))
+    n++;
+  return n;
+}  /* read_batch */
+
+static int worker_main(void *arg)
+{
+  struct worker *w = arg;
+  int i;
+  for (i = w->first; i < w->num_jobs; i += w->stride)
+    w->jobs[i].perm = canon_interp_perm(w->jobs[i].a, &(w->perms));
+  return 0;
+}  /* worker_main */
+
+/* Returns the number of permutations examined by the workers. */
+
+static long unsigned threaded_filter(int num_threads)
+{
+  int batch_size = num_threads * JOBS_PER_THREAD;
+  struct job *current = malloc(batch_size * sizeof(struct job));
+  struct job *next = malloc(batch_size * sizeof(struct job));
+  struct worker *workers = calloc(num_threads, sizeof(struct worker));
+  long unsigned perms = 0;
+  int n = read_batch(current, batch_size);
+
+  while (n > 0) {
+    int i, next_n;
+
+    for (i = 0; i < num_threads; i++) {
+      workers[i].jobs = current;
+      workers[i].num_jobs = n;
+      workers[i].first = i;
+      workers[i].stride = num_threads;
+      if (thrd_create(&(workers[i].thread), worker_main, workers + i) !=
+	  thrd_success)
+	fatal_error("isofilter: thread creation failed");
+    }
+
+    next_n = read_batch(next, batch_size);  /* while the workers work */
+
+    for (i = 0; i < num_threads; i++) {
+      thrd_join(workers[i].thread, NULL);
+      perms += workers[i].perms;
+      workers[i].perms = 0;
+    }
+
+    for (i = 0; i < n; i++) {
+      Interp c = permute_interp(current[i].a, current[i].perm);
+      Interps_read++;
+      if (kept_before(c, hash_interp(c), TRUE))
+	zap_interp(c);
+      else
+	print_interp(current[i].t, current[i].b);
+      free(current[i].perm);
+      zap_interp(current[i].a);
+      zap_original(current[i].t, current[i].b);
+      report_progress();
+    }
+
+    {
+      struct job *tmp = current;
+      current = next;
+      next = tmp;
+      n = next_n;
+    }
+  }
+  free(current);
+  free(next);
+  free(workers);
+  return perms;
+}  /* threaded_filter */
+
 int main(int argc, char **argv)
 {
   Term t;
-  Plist interps = NULL;
-  int interps_read = 0;
-  int interps_kept = 0;
-  LADR_BOOL ignore_constants = FALSE;
+  Interp a, b;
   LADR_BOOL wrap = FALSE;  /* surround output with list(interpretations) */
-  Plist check_strings = NULL;
-  Plist output_strings = NULL;
   Plist discriminators = NULL;
+  LADR_BOOL canon = FALSE;  /* compare canonical forms */
+  int num_threads = 1;
+  long unsigned worker_perms = 0;
   int rc, i;
 
   init_standard_ladr();
@@ -74,7 +313,7 @@ int main(int argc, char **argv)
 
   if (string_member("ignore_constants", argv, argc) ||
       string_member("-ignore_constants", argv, argc))
-    ignore_constants = TRUE;
+    Ignore_constants = TRUE;
 
   rc = which_string_member("check", argv, argc);
   if (rc == -1)
@@ -83,7 +322,7 @@ int main(int argc, char **argv)
     if (rc+1 >= argc)
       fatal_error("isofilter: missing \"check\" argument");
     else
-      check_strings = split_string(argv[rc+1]);
+      Check_strings = split_string(argv[rc+1]);
   }
 
   rc = which_string_member("output", argv, argc);
@@ -93,7 +332,7 @@ int main(int argc, char **argv)
     if (rc+1 >= argc)
       fatal_error("isofilter: missing \"output\" argument");
     else
-      output_strings = split_string(argv[rc+1]);
+      Output_strings = split_string(argv[rc+1]);
   }
 
   rc = which_string_member("discrim", argv, argc);
@@ -114,61 +353,68 @@ int main(int argc, char **argv)
       string_member("-wrap", argv, argc))
     wrap = TRUE;
 
-  /* Input is a stream of interpretations. */
+  if (string_member("canon", argv, argc) ||
+      string_member("-canon", argv, argc))
+    canon = TRUE;
 
-  if (wrap)
-    printf("list(interpretations).\n\n");
+  rc = which_string_member("threads", argv, argc);
+  if (rc == -1)
+    rc = which_string_member("-threads", argv, argc);
+  if (rc > 0) {
+    if (rc+1 >= argc || !str_to_int(argv[rc+1], &num_threads) ||
+	num_threads < 1)
+      fatal_error("isofilter: \"threads\" needs a positive integer");
+  }
 
-  t = read_term(stdin, stderr);
+  Buckets = hash_init(100003);
 
-  while (t != NULL) {
-    Interp a, c;
-    Term twork;
-    interps_read++;
+  /* Input is a stream of interpretations, text or binary. */
+
+  Bin = fread_interp_bin_header(stdin);
 
-    if (ignore_constants)
-      interp_remove_constants(t);  /* constants not checked or output */
+  if (wrap)
+    printf("list(interpretations).\n\n");
 
-    twork = copy_term(t);
+  if (num_threads > 1)
+    worker_perms = threaded_filter(num_threads);
+  else {
+    while (read_interp(&a, &t, &b)) {
+      Interp c;
+      unsigned key;
+      Interps_read++;
 
-    if (check_strings)
-      interp_remove_others(twork, check_strings);
-      
-    a = compile_interp(twork, FALSE);
-    c = normal3_interp(a, discriminators);
-    /* p_interp_profile(c, discriminators); */
-    if (iso_member(c, interps))
-      zap_interp(c);
-    else {
-      /* print the original interp */
+      c = normal3_interp(a, discriminators);
+      /* p_interp_profile(c, discriminators); */
+      if (canon) {
+	Interp d = canon_interp(c);
+	zap_interp(c);
+	c = d;
+	key = hash_interp(c);
+      }
+      else
+	key = hash_interp_profile(c);
 
-      Interp b;
-      if (output_strings)
-	interp_remove_others(t, output_strings);
-      
-      b = compile_interp(t, FALSE);
-      fprint_interp_standard2(stdout, b);
-      fflush(stdout);
-      zap_interp(b);
-      interps = plist_append(interps, c);  /* keep the normal interp */
-      interps_kept++;
-    }
-    zap_interp(a);
-    zap_term(t);
-    zap_term(twork);
-    t = read_term(stdin, stderr);
+      if (kept_before(c, key, canon))
+	zap_interp(c);
+      else
+	print_interp(t, b);  /* print the original interp */
+      zap_interp(a);
+      zap_original(t, b);
 
-    if (interps_read % 1000 == 0)
-      fprintf(stderr, "%s: %d interps read, %d kept\n",
-	      PROGRAM_NAME, interps_read, interps_kept);
+      report_progress();
+    }
   }
 
+  printf("%% %s: buckets=%d, largest_bucket=%d, mean_bucket=%.2f.\n",
+	 PROGRAM_NAME, Num_buckets, Largest_bucket,
+	 Num_buckets == 0 ? 0.0 : (double) Interps_kept / Num_buckets);
+
   printf("%% %s", PROGRAM_NAME);
   for(i = 1; i < argc; i++)
     printf(" %s", argv[i]);
 
-  printf(": input=%d, kept=%d, ", interps_read, interps_kept);
-  printf("checks=%lu, perms=%lu, ", iso_checks(), iso_perms());
+  printf(": input=%d, kept=%d, ", Interps_read, Interps_kept);
+  printf("checks=%lu, perms=%lu, ", iso_checks(), iso_perms() + worker_perms);
   printf("%.2f seconds.\n", user_seconds());
 
   if (wrap)
@@ -40,6 +40,27 @@ int Join_sym;  /* v */
 int M_sym;     /* m */
 int J_sym;     /* j */
 
+/* For lattice_identity(), the distinct subterms of an equation are
+   numbered (identical subterms get the same number), and the answers
+   to Whitman subproblems are kept in a table indexed by pairs of
+   subterm numbers, so that no subproblem is solved twice. */
+
+enum { LEAF, MEET, JOIN, OTHER };
+
+struct lnode {
+  int kind;
+  int key;          /* LEAF: symbol number, or -1-varnum for a variable */
+  int left, right;  /* MEET, JOIN: subterm numbers */
+};
+
+#define MAX_MEMO_NODES 4000  /* larger equations are not memoized */
+
+static struct lnode *Nodes;  /* the distinct subterms */
+static int Num_nodes;
+static int *Slots;           /* hash table of node numbers */
+static unsigned Slot_mask;
+static unsigned char *Memo;  /* [s*Num_nodes+t]: 0 unknown, 1 no, 2 yes */
+
 /*************
  *
  *   meet_term()
@@ -78,7 +99,8 @@ Whitman's algorithm (from the 1930s) is used, as described in
 Surveys and Monographs, Vol. 42 (1991).
 <P>
 Solutions to subproblems are not cached, so the behavior of
-this implementation can be exponential.
+this implementation can be exponential.  (lattice_identity() uses
+a version that caches them.)
 */
 
 LADR_BOOL lattice_leq(Term s, Term t)
@@ -116,6 +138,115 @@ LADR_BOOL lattice_leq(Term s, Term t)
 
 }  /* lattice_leq */
 
+/*************
+ *
+ *   intern_term()
+ *
+ *   Return the number of (the node for) subterm t.
+ *
+ *************/
+
+static
+int intern_term(Term t)
+{
+  struct lnode x;
+  unsigned h;
+
+  x.key = 0;
+  x.left = x.right = -1;
+  if (VARIABLE(t)) {
+    x.kind = LEAF;
+    x.key = -1 - VARNUM(t);
+  }
+  else if (CONSTANT(t)) {
+    x.kind = LEAF;
+    x.key = SYMNUM(t);
+  }
+  else if (meet_term(t) || join_term(t)) {
+    x.kind = meet_term(t) ? MEET : JOIN;
+    x.left = intern_term(ARG(t,0));
+    x.right = intern_term(ARG(t,1));
+  }
+  else {
+    x.kind = OTHER;  /* never <= anything by itself; not shared */
+    Nodes[Num_nodes] = x;
+    return Num_nodes++;
+  }
+
+  h = ((((unsigned) x.kind * 31 + (unsigned) x.key) * 31 +
+	(unsigned) x.left) * 31 + (unsigned) x.right) * 2654435761u;
+  for (h &= Slot_mask; Slots[h] != -1; h = (h + 1) & Slot_mask) {
+    struct lnode *y = Nodes + Slots[h];
+    if (y->kind == x.kind && y->key == x.key &&
+	y->left == x.left && y->right == x.right)
+      return Slots[h];
+  }
+  Nodes[Num_nodes] = x;
+  Slots[h] = Num_nodes;
+  return Num_nodes++;
+}  /* intern_term */
+
+static LADR_BOOL memo_leq(int s, int t);
+
+/*************
+ *
+ *   whitman_leq()
+ *
+ *   lattice_leq() on subterm numbers, with memo_leq() for the
+ *   subproblems.
+ *
+ *************/
+
+static
+LADR_BOOL whitman_leq(int s, int t)
+{
+  struct lnode *a = Nodes + s;
+  struct lnode *b = Nodes + t;
+
+  if (a->kind == LEAF && b->kind == LEAF)    /* (1) */
+    return s == t;
+
+  else if (a->kind == JOIN)                  /* (2) */
+    return (memo_leq(a->left, t) &&
+	    memo_leq(a->right, t));
+
+  else if (b->kind == MEET)                  /* (3) */
+    return (memo_leq(s, b->left) &&
+	    memo_leq(s, b->right));
+
+  else if (a->kind == LEAF && b->kind == JOIN)   /* (4) */
+    return (memo_leq(s, b->left) ||
+	    memo_leq(s, b->right));
+
+  else if (a->kind == MEET && b->kind == LEAF)   /* (5) */
+    return (memo_leq(a->left, t) ||
+	    memo_leq(a->right, t));
+
+  else if (a->kind == MEET && b->kind == JOIN)   /* (6) */
+    return (memo_leq(s, b->left) ||
+	    memo_leq(s, b->right) ||
+	    memo_leq(a->left, t) ||
+	    memo_leq(a->right, t));
+
+  else
+    return FALSE;
+}  /* whitman_leq */
+
+/*************
+ *
+ *   memo_leq()
+ *
+ *************/
+
+static
+LADR_BOOL memo_leq(int s, int t)
+{
+  unsigned char *r = Memo + (size_t) s * Num_nodes + t;
+  if (*r == 0)
+    *r = whitman_leq(s, t) ? 2 : 1;
+  return *r == 2;
+}  /* memo_leq */
+
 /*************
  *
  *   lattice_identity()
@@ -124,10 +255,35 @@ LADR_BOOL lattice_leq(Term s, Term t)
 
 int lattice_identity(Term atom)
 {
-  return (atom != NULL &&
-	  is_symbol(SYMNUM(atom), "=", 2) &&
-	  lattice_leq(ARG(atom,0), ARG(atom,1)) &&
-	  lattice_leq(ARG(atom,1), ARG(atom,0)));
+  int n, i, s, t;
+  LADR_BOOL ident;
+
+  if (atom == NULL || !is_symbol(SYMNUM(atom), "=", 2))
+    return FALSE;
+
+  n = symbol_count(atom);
+  if (n > MAX_MEMO_NODES)
+    return (lattice_leq(ARG(atom,0), ARG(atom,1)) &&
+	    lattice_leq(ARG(atom,1), ARG(atom,0)));
+
+  Nodes = malloc(n * sizeof(struct lnode));
+  for (Slot_mask = 1; Slot_mask < 2 * n; Slot_mask *= 2);
+  Slots = malloc(Slot_mask * sizeof(int));
+  for (i = 0; i < Slot_mask; i++)
+    Slots[i] = -1;
+  Slot_mask--;
+  Num_nodes = 0;
+
+  s = intern_term(ARG(atom,0));
+  t = intern_term(ARG(atom,1));
+
+  Memo = calloc((size_t) Num_nodes * Num_nodes, 1);
+  ident = memo_leq(s, t) && memo_leq(t, s);
+
+  free(Memo);
+  free(Slots);
+  free(Nodes);
+  return ident;
 }  /* lattice_identity */
 
 /*************
@@ -32,29 +32,26 @@ static char Help_string[] =
 "for each one, prints its upper-covers.  Each lattice is\n"
 "assumed to be in \"portable format\" as produced by mace4,\n"
 "and have a binary operation (meet) named \"^\", \"m\", or \"meet\"\n"
-"(it can have other operations as well).\n";
+"(it can have other operations as well).  A binary stream of\n"
+"interpretations (see interpformat) is also accepted.\n";
 
-/*************
- *
- *   adjacent()
- *
- *************/
+/* The order relation is kept as an n x n bit matrix:  row i has
+   a bit for each j with i < j, in words of WORD_BITS bits. */
 
-static LADR_BOOL adjacent(int n, int i, int j, LADR_BOOL *lt)
-{
-  int k;
-  for (k = 0; k < n; k++)
-    if (lt[I2(n,i,k)] && lt[I2(n,k,j)])
-      return FALSE;
-  return TRUE;
-}  /* adjacent */
+typedef unsigned long long Word;
+
+#define WORD_BITS 64
+#define ROW_WORDS(n)   (((n) + WORD_BITS - 1) / WORD_BITS)
+#define BIT(row, j)    (((row)[(j) / WORD_BITS] >> ((j) % WORD_BITS)) & 1)
+#define SET_BIT(row, j) ((row)[(j) / WORD_BITS] |= (Word) 1 << ((j) % WORD_BITS))
 
 static void upper_covers(Interp p, int lattice_number)
 {
   int n = interp_size(p);
-  LADR_BOOL *lt = malloc(n * n * sizeof(LADR_BOOL *));
-  LADR_BOOL *uc = malloc(n * n * sizeof(LADR_BOOL *));
-  int i, j;
+  int w = ROW_WORDS(n);
+  Word *lt = calloc((size_t) n * w, sizeof(Word));
+  Word *uc = malloc((size_t) n * w * sizeof(Word));
+  int i, j, k;
   int *a;
   a = interp_table(p, "^", 2);
   if (a == NULL) {
@@ -66,20 +63,29 @@ static void upper_covers(Interp p, int lattice_number)
     }
   }
 
-  /* Construct less-than relation; initialize upper-covers to less-than. */
-  for (i = 0; i < n; i++)
-    for (j = 0; j < n; j++) {
-      lt[I2(n,i,j)] = (a[I2(n,i,j)] == i && i != j);
-      uc[I2(n,i,j)] = lt[I2(n,i,j)];
-    }
+  /* Construct the less-than relation. */
 
-  /* Remove entries from uc if something is between the elements. */
-    
   for (i = 0; i < n; i++)
+    for (j = 0; j < n; j++)
+      if (a[I2(n,i,j)] == i && i != j)
+	SET_BIT(lt + (size_t) i * w, j);
+
+  /* Transitive reduction:  j covers i iff i < j and there is no k
+     with i < k < j, so remove from row i the rows of all k > i. */
+
+  for (i = 0; i < n; i++) {
+    Word *lti = lt + (size_t) i * w;
+    Word *uci = uc + (size_t) i * w;
+    for (k = 0; k < w; k++)
+      uci[k] = lti[k];
     for (j = 0; j < n; j++) {
-      if (lt[I2(n,i,j)] && !adjacent(n, i, j, lt))
-	uc[I2(n,i,j)] = FALSE;
+      if (BIT(lti, j)) {
+	Word *ltj = lt + (size_t) j * w;
+	for (k = 0; k < w; k++)
+	  uci[k] &= ~ltj[k];
+      }
     }
+  }
 
   /* Print upper-covers. */
 
@@ -89,7 +95,7 @@ static void upper_covers(Interp p, int lattice_number)
     LADR_BOOL started = FALSE;
     printf("(%d (", i);
     for (j = 0; j < n; j++) {
-      if (uc[I2(n,i,j)]) {
+      if (BIT(uc + (size_t) i * w, j)) {
 	printf("%s%d", started ? " " : "", j);
 	started = TRUE;
       }
@@ -101,11 +107,14 @@ static void upper_covers(Interp p, int lattice_number)
 
   free(lt);
   free(uc);
+  free(a);
 }  /* upper_covers */
 
 int main(int argc, char **argv)
 {
   Term t;
+  Interp a;
+  Interp_bin bin;
   int interps_read = 0;
 
   if (string_member("help", argv, argc) ||
@@ -120,19 +129,29 @@ int main(int argc, char **argv)
   /* Note that we do not read any commands. */
   /* terms(interpretations) and end_of_list are optional. */
 
-  t = read_term(stdin, stderr);
-  if (is_term(t, "terms", 1))
+  bin = fread_interp_bin_header(stdin);
+  if (bin != NULL) {
+    while ((a = fread_interp_bin(stdin, bin)) != NULL) {
+      interps_read++;
+      upper_covers(a, interps_read);
+      zap_interp(a);
+    }
+  }
+  else {
     t = read_term(stdin, stderr);
+    if (is_term(t, "terms", 1))
+      t = read_term(stdin, stderr);
 
-  while (t != NULL && !end_of_list_term(t)) {
-    Interp a = compile_interp(t, FALSE);
-    interps_read++;
+    while (t != NULL && !end_of_list_term(t)) {
+      a = compile_interp(t, FALSE);
+      interps_read++;
 
-    upper_covers(a, interps_read);
+      upper_covers(a, interps_read);
 
-    zap_interp(a);
-    zap_term(t);
-    t = read_term(stdin, stderr);
+      zap_interp(a);
+      zap_term(t);
+      t = read_term(stdin, stderr);
+    }
   }
 
   printf("%% upper-covers: translated=%d\n", interps_read);
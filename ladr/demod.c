@@ -150,7 +150,7 @@ Term demod(Term t, Mindex demods, int flag, Ilist *just_head,
   if (term_flag(t, flag) || VARIABLE(t))
     ;  /* leave it alone */
   else {
-    Discrim_pos dpos;
+    Mindex_pos mpos;
     Term found;
     Context c;  /* allocate after we demoulate the subterms */
     int i;
@@ -160,7 +160,8 @@ Term demod(Term t, Mindex demods, int flag, Ilist *just_head,
 
     c = get_context();
     Demod_attempts++;
-    found = discrim_bind_retrieve_first(t, demods->discrim_tree, c, &dpos);
+    found = mindex_retrieve_first(t, demods, GENERALIZATION, NULL, c,
+				  FALSE, &mpos);
 				  
     while (found != NULL) {
       Topform demodulator = found->container;
@@ -178,7 +179,7 @@ Term demod(Term t, Mindex demods, int flag, Ilist *just_head,
 	ok = term_greater(t, contractum, lex_order_vars);  /* LPO, RPO, KBO */
       
       if (ok) {
-	discrim_bind_cancel(dpos);
+	mindex_retrieve_cancel(mpos);
 	Demod_rewrites++;
 	zap_term(t);
 	*just_head = ilist_prepend(*just_head, demodulator->id);
@@ -188,7 +189,7 @@ Term demod(Term t, Mindex demods, int flag, Ilist *just_head,
       }
       else {
 	zap_term(contractum);
-	found = discrim_bind_retrieve_next(dpos);
+	found = mindex_retrieve_next(mpos);
       }
     }
     free_context(c);
@@ -30,6 +30,16 @@ static unsigned Discrim_gets, Discrim_frees;
 #define PTRS_DISCRIM_POS PTRS(sizeof(struct discrim_pos))
 static unsigned Discrim_pos_gets, Discrim_pos_frees;
 
+static unsigned Discrim_kids_mem;  /* memory (pointers) for child arrays */
+
+/* A node with this many rigid children becomes a table indexed by
+   symbol, if its largest symbol is less than DISCRIM_TABLE_SPARSE
+   times the number of children.  It goes back to a sorted array
+   when it shrinks to half as many. */
+
+#define DISCRIM_TABLE_KIDS   16
+#define DISCRIM_TABLE_SPARSE  4
+
 /*************
  *
  *   Discrim get_discrim()
@@ -59,6 +69,14 @@ Discrim get_discrim(void)
 /* PUBLIC */
 void free_discrim(Discrim p)
 {
+  if (p->kids_size > 0) {
+    Discrim_kids_mem -= p->kids_size;
+    free_mem(p->u.kids, p->kids_size);
+  }
+  if (p->vars_size > 0) {
+    Discrim_kids_mem -= p->vars_size;
+    free_mem(p->vars, p->vars_size);
+  }
   free_mem(p, PTRS_DISCRIM);
   Discrim_frees++;
 }  /* free_discrim */
@@ -127,6 +145,8 @@ void fprint_discrim_mem(FILE *fp, LADR_BOOL heading)
           n, Discrim_pos_gets, Discrim_pos_frees,
           Discrim_pos_gets - Discrim_pos_frees,
           ((Discrim_pos_gets - Discrim_pos_frees) * n) / 1024.);
+  fprintf(fp, "      discrim kids:                                  %9.1f K\n",
+	  Discrim_kids_mem * BYTES_POINTER / 1024.);
 
 }  /* fprint_discrim_mem */
 
@@ -151,6 +171,266 @@ void p_discrim_mem(void)
  *  end of memory management
  */
 
+/*************
+ *
+ *   discrim_rigid_kid()
+ *
+ *************/
+
+/* DOCUMENTATION
+Return the rigid child (rigid symbol, or AC count in wild trees) of
+node d with the given symbol, or NULL if there is none.
+*/
+
+/* PUBLIC */
+Discrim discrim_rigid_kid(Discrim d, int symbol)
+{
+  if (d->kids_table)
+    return (symbol >= 0 && symbol < d->kids_size ? d->u.kids[symbol] : NULL);
+  else {
+    int lo = 0;
+    int hi = d->num_kids;
+    while (lo < hi) {
+      int mid = lo + (hi - lo) / 2;
+      int s = d->u.kids[mid]->symbol;
+      if (s == symbol)
+	return d->u.kids[mid];
+      else if (s < symbol)
+	lo = mid + 1;
+      else
+	hi = mid;
+    }
+    return NULL;
+  }
+}  /* discrim_rigid_kid */
+
+/*************
+ *
+ *   discrim_next_kid()
+ *
+ *************/
+
+/* DOCUMENTATION
+This is for visiting the rigid children of node d in increasing order
+of symbol.  Start with *pos = 0; each call returns the next child
+(NULL when there are no more) and updates *pos.
+*/
+
+/* PUBLIC */
+Discrim discrim_next_kid(Discrim d, int *pos)
+{
+  if (d->kids_table) {
+    while (*pos < d->kids_size) {
+      Discrim k = d->u.kids[(*pos)++];
+      if (k != NULL)
+	return k;
+    }
+    return NULL;
+  }
+  else
+    return (*pos < d->num_kids ? d->u.kids[(*pos)++] : NULL);
+}  /* discrim_next_kid */
+
+/*************
+ *
+ *   discrim_var_kid()
+ *
+ *************/
+
+/* DOCUMENTATION
+Return the variable child of node d with the given variable number,
+or NULL if there is none.
+*/
+
+/* PUBLIC */
+Discrim discrim_var_kid(Discrim d, int varnum)
+{
+  int i;
+  for (i = 0; i < d->num_vars && d->vars[i]->symbol <= varnum; i++)
+    if (d->vars[i]->symbol == varnum)
+      return d->vars[i];
+  return NULL;
+}  /* discrim_var_kid */
+
+/*************
+ *
+ *   new_kids_array()
+ *
+ *************/
+
+static
+Discrim *new_kids_array(int n)
+{
+  Discrim_kids_mem += n;
+  return get_cmem(n);
+}  /* new_kids_array */
+
+/*************
+ *
+ *   free_kids_array()
+ *
+ *************/
+
+static
+void free_kids_array(Discrim *a, int n)
+{
+  if (a != NULL) {
+    Discrim_kids_mem -= n;
+    free_mem(a, n);
+  }
+}  /* free_kids_array */
+
+/*************
+ *
+ *   kids_to_table()
+ *
+ *   Change the kids of a node to (or resize) a table indexed by
+ *   symbol, big enough for symbols < size.
+ *
+ *************/
+
+static
+void kids_to_table(Discrim d, int size)
+{
+  Discrim *table = new_kids_array(size);
+  Discrim k;
+  int pos = 0;
+  while ((k = discrim_next_kid(d, &pos)) != NULL)
+    table[k->symbol] = k;
+  free_kids_array(d->u.kids, d->kids_size);
+  d->u.kids = table;
+  d->kids_size = size;
+  d->kids_table = TRUE;
+}  /* kids_to_table */
+
+/*************
+ *
+ *   kids_to_array()
+ *
+ *   Change the kids of a node from a table to a sorted array.
+ *
+ *************/
+
+static
+void kids_to_array(Discrim d)
+{
+  int size = (d->num_kids < 2 ? 2 : d->num_kids);
+  Discrim *a = new_kids_array(size);
+  Discrim k;
+  int pos = 0;
+  int i = 0;
+  while ((k = discrim_next_kid(d, &pos)) != NULL)
+    a[i++] = k;
+  free_kids_array(d->u.kids, d->kids_size);
+  d->u.kids = a;
+  d->kids_size = size;
+  d->kids_table = FALSE;
+}  /* kids_to_array */
+
+/*************
+ *
+ *   discrim_add_kid()
+ *
+ *************/
+
+/* DOCUMENTATION
+Create a child of node d with the given type and symbol, insert it
+in its place, and return it.  The caller must know that there is no
+such child already.  (AC counts go with the rigid children.)
+*/
+
+/* PUBLIC */
+Discrim discrim_add_kid(Discrim d, int type, int symbol)
+{
+  Discrim k = get_discrim();
+  int i;
+  k->type = type;
+  k->symbol = symbol;
+
+  if (type == DVARIABLE) {
+    if (d->num_vars == d->vars_size) {
+      int size = (d->vars_size == 0 ? 1 : 2 * d->vars_size);
+      Discrim *a = new_kids_array(size);
+      for (i = 0; i < d->num_vars; i++)
+	a[i] = d->vars[i];
+      free_kids_array(d->vars, d->vars_size);
+      d->vars = a;
+      d->vars_size = size;
+    }
+    for (i = d->num_vars; i > 0 && d->vars[i-1]->symbol > symbol; i--)
+      d->vars[i] = d->vars[i-1];
+    d->vars[i] = k;
+    d->num_vars++;
+  }
+  else if (d->kids_table) {
+    if (symbol >= d->kids_size)
+      kids_to_table(d, IMAX(symbol + 1, 2 * d->kids_size));
+    d->u.kids[symbol] = k;
+    d->num_kids++;
+  }
+  else {
+    if (d->num_kids == d->kids_size) {
+      int size = (d->kids_size == 0 ? 2 : 2 * d->kids_size);
+      Discrim *a = new_kids_array(size);
+      for (i = 0; i < d->num_kids; i++)
+	a[i] = d->u.kids[i];
+      free_kids_array(d->u.kids, d->kids_size);
+      d->u.kids = a;
+      d->kids_size = size;
+    }
+    for (i = d->num_kids; i > 0 && d->u.kids[i-1]->symbol > symbol; i--)
+      d->u.kids[i] = d->u.kids[i-1];
+    d->u.kids[i] = k;
+    d->num_kids++;
+
+    /* A wide node, with symbols that are not too sparse, becomes
+       a table. */
+    if (d->num_kids >= DISCRIM_TABLE_KIDS &&
+	d->u.kids[d->num_kids-1]->symbol < DISCRIM_TABLE_SPARSE * d->num_kids)
+      kids_to_table(d, d->u.kids[d->num_kids-1]->symbol + 1);
+  }
+  return k;
+}  /* discrim_add_kid */
+
+/*************
+ *
+ *   discrim_remove_kid()
+ *
+ *************/
+
+/* DOCUMENTATION
+Remove child k (variable or rigid) from node d.
+The child itself is not freed.
+*/
+
+/* PUBLIC */
+void discrim_remove_kid(Discrim d, Discrim k)
+{
+  int i;
+  if (DVAR(k)) {
+    for (i = 0; i < d->num_vars && d->vars[i] != k; i++);
+    if (i == d->num_vars)
+      fatal_error("discrim_remove_kid, variable child not found");
+    for (d->num_vars--; i < d->num_vars; i++)
+      d->vars[i] = d->vars[i+1];
+  }
+  else if (d->kids_table) {
+    if (k->symbol >= d->kids_size || d->u.kids[k->symbol] != k)
+      fatal_error("discrim_remove_kid, child not found");
+    d->u.kids[k->symbol] = NULL;
+    d->num_kids--;
+    if (d->num_kids < DISCRIM_TABLE_KIDS / 2)
+      kids_to_array(d);
+  }
+  else {
+    for (i = 0; i < d->num_kids && d->u.kids[i] != k; i++);
+    if (i == d->num_kids)
+      fatal_error("discrim_remove_kid, child not found");
+    for (d->num_kids--; i < d->num_kids; i++)
+      d->u.kids[i] = d->u.kids[i+1];
+  }
+}  /* discrim_remove_kid */
+
 /*************
  *
  *   discrim_init()
@@ -181,7 +461,7 @@ This routine frees an empty discrimination index (wild or tame).
 /* PUBLIC */
 void discrim_dealloc(Discrim d)
 {
-  if (d->u.kids) {
+  if (!DISCRIM_CHILDLESS(d)) {
     fatal_error("discrim_dealloc, nonempty index.");
   }
   else
@@ -201,20 +481,18 @@ void zap_discrim_tree(Discrim d, int n)
     zap_plist(d->u.data);
   }
   else {
-    int arity;
-    Discrim k, prev;
+    int arity, i;
+    Discrim k;
 
-    k = d->u.kids;
-    while (k != NULL) {
+    for (i = 0; i < d->num_vars; i++)
+      zap_discrim_tree(d->vars[i], n-1);
+    i = 0;
+    while ((k = discrim_next_kid(d, &i)) != NULL) {
       if (k->type == AC_ARG_TYPE || k->type == AC_NV_ARG_TYPE)
 	arity = 0;
-      else if (DVAR(k))
-	arity = 0;
       else
 	arity = sn_to_arity(k->symbol);
-      prev = k;
-      k = k->next;
-      zap_discrim_tree(prev, n+arity-1);
+      zap_discrim_tree(k, n+arity-1);
     }
   }
   free_discrim(d);
@@ -251,6 +529,56 @@ It can be used with either wild or tame trees.
 /* PUBLIC */
 LADR_BOOL discrim_empty(Discrim d)
 {
-  return (d == NULL ? TRUE : (d->u.kids == NULL ? TRUE : FALSE));
+  return (d == NULL ? TRUE : DISCRIM_CHILDLESS(d));
 }  /* discrim_empty */
 
+
+/*************
+ *
+ *   discrim_tree_size()
+ *
+ *************/
+
+static
+void discrim_tree_size(Discrim d, int n, int *nodes, int *mem)
+{
+  (*nodes)++;
+  *mem += PTRS_DISCRIM + d->kids_size + d->vars_size;
+  if (n == 0)
+    *mem += plist_count(d->u.data) * PTRS(sizeof(struct plist));
+  else {
+    int arity, i;
+    Discrim k;
+
+    for (i = 0; i < d->num_vars; i++)
+      discrim_tree_size(d->vars[i], n-1, nodes, mem);
+    i = 0;
+    while ((k = discrim_next_kid(d, &i)) != NULL) {
+      if (k->type == AC_ARG_TYPE || k->type == AC_NV_ARG_TYPE)
+	arity = 0;
+      else
+	arity = sn_to_arity(k->symbol);
+      discrim_tree_size(k, n+arity-1, nodes, mem);
+    }
+  }
+}  /* discrim_tree_size */
+
+/*************
+ *
+ *   discrim_size()
+ *
+ *************/
+
+/* DOCUMENTATION
+This routine finds the number of nodes in a discrimination index
+(wild or tame) and the memory (in pointers, as with get_mem())
+used by it, including the lists at the leaves.
+*/
+
+/* PUBLIC */
+void discrim_size(Discrim d, int *nodes, int *mem)
+{
+  *nodes = 0;
+  *mem = 0;
+  discrim_tree_size(d, 1, nodes, mem);
+}  /* discrim_size */
@@ -52,14 +52,29 @@ provides a uniform interface to these and other indexing methods.
 
 typedef struct discrim * Discrim;
 
+/* The children of a node are kept in two places.  Variable children
+   are in the array vars, in increasing order of variable number (wild
+   trees have at most one, the wildcard).  The other children (rigid
+   symbols, and the counts of AC arguments in wild trees) are in kids.
+   A narrow node keeps them in a sorted array; when a node gets wide,
+   kids becomes a table indexed directly by symbol, with NULL holes
+   (kids_table is set).  Use discrim_rigid_kid() and discrim_next_kid()
+   rather than looking at kids directly.
+*/
+
 struct discrim {       /* node in a discrimination tree */
-  Discrim   next;      /* sibling */
   union {
-    Discrim kids;      /* for internal nodes */
+    Discrim *kids;     /* for internal nodes: rigid children */
     Plist data;        /* for leaves */
   } u;
-  short symbol;        /* variable number or symbol number */
+  Discrim *vars;       /* variable children, by increasing symbol */
+  int symbol;          /* variable number or symbol number */
+  int num_kids;        /* number of rigid children */
+  int kids_size;       /* size of kids array (or table) */
+  short num_vars;      /* number of variable children */
+  short vars_size;     /* size of vars array */
   char type;           /* term type and for ac indexing type */
+  char kids_table;     /* kids is indexed by symbol */
 };
 
 typedef struct discrim_pos * Discrim_pos;
@@ -77,6 +92,10 @@ enum { DVARIABLE, DRIGID, AC_ARG_TYPE, AC_NV_ARG_TYPE };
 
 #define DVAR(d)  ((d)->type == DVARIABLE)
 
+/* Does a node have any children? */
+
+#define DISCRIM_CHILDLESS(d) ((d)->num_vars == 0 && (d)->num_kids == 0)
+
 /* End of public definitions */
 
 /* Public function prototypes from discrim.c */
@@ -93,6 +112,16 @@ void fprint_discrim_mem(FILE *fp, LADR_BOOL heading);
 
 void p_discrim_mem(void);
 
+Discrim discrim_rigid_kid(Discrim d, int symbol);
+
+Discrim discrim_next_kid(Discrim d, int *pos);
+
+Discrim discrim_var_kid(Discrim d, int varnum);
+
+Discrim discrim_add_kid(Discrim d, int type, int symbol);
+
+void discrim_remove_kid(Discrim d, Discrim k);
+
 Discrim discrim_init(void);
 
 void discrim_dealloc(Discrim d);
@@ -101,4 +130,6 @@ void destroy_discrim_tree(Discrim d);
 
 LADR_BOOL discrim_empty(Discrim d);
 
+void discrim_size(Discrim d, int *nodes, int *mem);
+
 #endif  /* conditional compilation of whole file */
@@ -29,7 +29,8 @@ typedef struct flat2 * Flat2;
 struct flat2 {  /* for building a stack of states for backtracking */
   Term     t;
   Flat2    prev, next, last;
-  Discrim  alternatives;
+  Discrim  alternatives;  /* node whose children are still to be tried */
+  int      alt_pos;       /* next variable child of alternatives to try */
   int      bound;
   int      varnum;
   int      place_holder;
@@ -40,6 +41,25 @@ struct flat2 {  /* for building a stack of states for backtracking */
 #define SUCCESS   3
 #define FAILURE   4
 
+/* For loading a tree all at once, the terms are sorted by their
+   symbols in preorder (variable n is -1-n), so that terms with
+   common prefixes are together.  This is all malloc'd, so that
+   sorting can be done by other threads.
+ */
+
+struct db_entry {
+  int      *key;
+  int      n;        /* length of key */
+  int      seq;      /* position in the input, to keep the order of leaves */
+  Term     t;
+};
+
+struct discrim_bulk {
+  struct db_entry *entries;
+  int      num_entries;
+  int      *keys;    /* the keys of the entries, end to end */
+};
+
 /*
  * memory management
  */
@@ -135,15 +155,13 @@ void p_discrimb_mem(void)
 void check_discrim_bind_tree(Discrim d, int n)
 {
   if (n > 0) {
-    int arity;
     Discrim d1;
-    for (d1 = d->u.kids; d1; d1 = d1->next) {
-      if (DVAR(d1))
-	arity = 0;
-      else
-	arity = sn_to_arity(d1->symbol);
-      check_discrim_bind_tree(d1, n+arity-1);
-    }
+    int i;
+    for (i = 0; i < d->num_vars; i++)
+      check_discrim_bind_tree(d->vars[i], n-1);
+    i = 0;
+    while ((d1 = discrim_next_kid(d, &i)) != NULL)
+      check_discrim_bind_tree(d1, n+sn_to_arity(d1->symbol)-1);
   }
 }  /* check_discrim_bind_tree */
 
@@ -177,11 +195,11 @@ void print_discrim_bind_tree(FILE *fp, Discrim d, int n, int depth)
   else {
     Discrim d1;
     fprintf(fp, "\n");
-    for (d1 = d->u.kids; d1 != NULL; d1 = d1->next) {
-      if (DVAR(d1))
-	arity = 0;
-      else
-	arity = sn_to_arity(d1->symbol);
+    for (i = 0; i < d->num_vars; i++)
+      print_discrim_bind_tree(fp, d->vars[i], n-1, depth+1);
+    i = 0;
+    while ((d1 = discrim_next_kid(d, &i)) != NULL) {
+      arity = sn_to_arity(d1->symbol);
       print_discrim_bind_tree(fp, d1, n+arity-1, depth+1);
     }
   }
@@ -231,65 +249,25 @@ void p_discrim_bind_index(Discrim d)
 static
 Discrim discrim_bind_insert_rec(Term t, Discrim d)
 {
-  Discrim d1, d2, prev;
-  int symbol, i;
+  Discrim d1;
+  int i;
 
   if (VARIABLE(t)) {
-    d1 = d->u.kids;
-    prev = NULL;
-    symbol = VARNUM(t);
-    while (d1 && DVAR(d1) && d1->symbol < symbol) {
-      prev = d1;
-      d1 = d1->next;
-    }
-    if (d1 == NULL || !DVAR(d1) || d1->symbol != symbol) {
-      d2 = get_discrim();
-      d2->type = DVARIABLE;
-      d2->symbol = VARNUM(t);
-      d2->next = d1;
-      if (prev == NULL)
-	d->u.kids = d2;
-      else
-	prev->next = d2;
-      return d2;
-    }
-    else  /* found node */
-      return d1;
+    d1 = discrim_var_kid(d, VARNUM(t));
+    if (d1 == NULL)
+      d1 = discrim_add_kid(d, DVARIABLE, VARNUM(t));
+    return d1;
   }
 
   else {  /* constant || complex */
-    d1 = d->u.kids;
-    prev = NULL;
     /* arities fixed: handle both NAME and COMPLEX */
-    symbol = SYMNUM(t);
-    while (d1 && DVAR(d1)) {  /* skip variables */
-      prev = d1;
-      d1 = d1->next;
-    }
-    while (d1 && d1->symbol < symbol) {
-      prev = d1;
-      d1 = d1->next;
-    }
-    if (d1 == NULL || d1->symbol != symbol) {
-      d2 = get_discrim();
-      d2->type = DRIGID;
-      d2->symbol = symbol;
-      d2->next = d1;
-      d1 = d2;
-    }
-    else
-      d2 = NULL;  /* new node not required at this level */
+    d1 = discrim_rigid_kid(d, SYMNUM(t));
+    if (d1 == NULL)
+      d1 = discrim_add_kid(d, DRIGID, SYMNUM(t));
 
     for (i = 0; i < ARITY(t); i++)
       d1 = discrim_bind_insert_rec(ARG(t,i), d1);
 
-    if (d2 != NULL) {  /* link in new subtree (possibly a leaf) */
-      if (prev == NULL)
-	d->u.kids = d2;
-      else
-	prev->next = d2;
-    }
-	    
     return d1;  /* d1 is leaf corresp. to end of input term */
   }
 }  /* discrim_bind_insert_rec */
@@ -339,7 +317,6 @@ Discrim discrim_bind_end(Term t, Discrim d, Plist *path_p)
 {
   Discrim d1;
   Plist dp;
-  int symbol, sym;
 
   /* add current node to the front of the path list. */
 
@@ -348,27 +325,14 @@ Discrim discrim_bind_end(Term t, Discrim d, Plist *path_p)
   dp->next = *path_p;
   *path_p = dp;
 
-  if (VARIABLE(t)) {
-    d1 = d->u.kids;
-    symbol = VARNUM(t);
-    while (d1 && DVAR(d1) && d1->symbol < symbol) 
-      d1 = d1->next;
-
-    if (d1 == NULL || !DVAR(d1) || d1->symbol != symbol)
-      return NULL;
-    else   /* found node */
-      return d1;
-  }
+  if (VARIABLE(t))
+    return discrim_var_kid(d, VARNUM(t));
 
   else {  /* constant || complex */
-    d1 = d->u.kids;
-    sym = SYMNUM(t);  /* arities fixed: handle both NAME and COMPLEX */
-    while (d1 && DVAR(d1))  /* skip variables */
-      d1 = d1->next;
-    while (d1 && d1->symbol < sym)
-      d1 = d1->next;
-
-    if (d1 == NULL || d1->symbol != sym)
+    /* arities fixed: handle both NAME and COMPLEX */
+    d1 = discrim_rigid_kid(d, SYMNUM(t));
+
+    if (d1 == NULL)
       return NULL;
     else {
       int i;
@@ -388,7 +352,7 @@ Discrim discrim_bind_end(Term t, Discrim d, Plist *path_p)
 static
 void discrim_bind_delete(Term t, Discrim root, void *object)
 {
-  Discrim end, d2, d3, parent;
+  Discrim end, parent;
   Plist tp1, tp2;
   Plist dp1, path;
 
@@ -421,22 +385,12 @@ void discrim_bind_delete(Term t, Discrim root, void *object)
 
   if (end->u.data == NULL) {
     /* free tree nodes from bottom up, using path to get parents */
-    end->u.kids = NULL;  /* probably not necessary */
     dp1 = path;
-    while (end->u.kids == NULL && end != root) {
+    while (DISCRIM_CHILDLESS(end) && end != root) {
       parent = (Discrim) dp1->v;
       dp1 = dp1->next;
-      d2 = parent->u.kids;
-      d3 = NULL;
-      while (d2 != end) {
-	d3 = d2;
-	d2 = d2->next;
-      }
-      if (d3 == NULL)
-	parent->u.kids = d2->next;
-      else
-	d3->next = d2->next;
-      free_discrim(d2);
+      discrim_remove_kid(parent, end);
+      free_discrim(end);
       end = parent;
     }
   }
@@ -477,6 +431,162 @@ void discrim_bind_update(Term t, Discrim root, void *object, Indexop op)
     discrim_bind_delete(t, root, object);
 }  /* discrim_bind_update */
 
+/*************
+ *
+ *   bulk_key()
+ *
+ *************/
+
+static
+int bulk_key(Term t, int *key, int n)
+{
+  if (VARIABLE(t))
+    key[n++] = -1 - VARNUM(t);
+  else {
+    int i;
+    key[n++] = SYMNUM(t);
+    for (i = 0; i < ARITY(t); i++)
+      n = bulk_key(ARG(t,i), key, n);
+  }
+  return n;
+}  /* bulk_key */
+
+/*************
+ *
+ *   compare_db_entries()
+ *
+ *************/
+
+static
+int compare_db_entries(const void *v1, const void *v2)
+{
+  const struct db_entry *e1 = v1;
+  const struct db_entry *e2 = v2;
+  int i;
+  for (i = 0; i < e1->n && i < e2->n; i++) {
+    if (e1->key[i] != e2->key[i])
+      return e1->key[i] < e2->key[i] ? -1 : 1;
+  }
+  if (e1->n != e2->n)
+    return e1->n < e2->n ? -1 : 1;
+  else
+    return e1->seq < e2->seq ? -1 : e1->seq > e2->seq;
+}  /* compare_db_entries */
+
+/*************
+ *
+ *   discrim_bind_bulk_sort()
+ *
+ *************/
+
+/* DOCUMENTATION
+This routine is the first step in loading n terms into an (empty)
+tame discrimination index all at once: it sorts the terms by
+their symbols in preorder.
+<P>
+It uses only malloc'd memory, and it does not change the terms,
+so calls for different indexes can run in parallel (in threads).
+The result goes to discrim_bind_bulk_build().
+*/
+
+/* PUBLIC */
+Discrim_bulk discrim_bind_bulk_sort(Term *terms, int n)
+{
+  Discrim_bulk b = malloc(sizeof(struct discrim_bulk));
+  int size = 0;
+  int i;
+
+  for (i = 0; i < n; i++)
+    size += symbol_count(terms[i]);
+  b->entries = malloc(IMAX(n, 1) * sizeof(struct db_entry));
+  b->keys = malloc(IMAX(size, 1) * sizeof(int));
+  b->num_entries = n;
+
+  size = 0;
+  for (i = 0; i < n; i++) {
+    struct db_entry *e = b->entries + i;
+    e->key = b->keys + size;
+    e->n = bulk_key(terms[i], e->key, 0);
+    e->seq = i;
+    e->t = terms[i];
+    size += e->n;
+  }
+  qsort(b->entries, n, sizeof(struct db_entry), compare_db_entries);
+  return b;
+}  /* discrim_bind_bulk_sort */
+
+/*************
+ *
+ *   discrim_bind_bulk_build()
+ *
+ *************/
+
+/* DOCUMENTATION
+This routine is the second step in loading terms into a tame
+discrimination index all at once (see discrim_bind_bulk_sort()).
+The tree must be empty.  It is built in one pass over the sorted
+terms, each term sharing the nodes of its prefix with the one before,
+and each leaf gets its list at once.  The objects are the terms.
+Discrim_bulk b is freed.
+<P>
+The answers to queries are the same, and come in the same order,
+as if the terms had been inserted with discrim_bind_update().
+*/
+
+/* PUBLIC */
+void discrim_bind_bulk_build(Discrim root, Discrim_bulk b)
+{
+  Discrim *nodes = NULL;  /* nodes[k] is the node for the first k symbols */
+  int nodes_size = 0;
+  int *prev = NULL;
+  int prev_n = 0;
+  int i = 0;
+
+  if (!discrim_empty(root))
+    fatal_error("discrim_bind_bulk_build, tree not empty.");
+
+  while (i < b->num_entries) {
+    struct db_entry *e = b->entries + i;
+    Plist *last;
+    int k = 0;
+    int j;
+
+    if (e->n + 1 > nodes_size) {
+      nodes_size = 2 * (e->n + 1);
+      nodes = realloc(nodes, nodes_size * sizeof(Discrim));
+      nodes[0] = root;
+    }
+
+    while (k < prev_n && k < e->n && prev[k] == e->key[k])
+      k++;
+    for (; k < e->n; k++) {
+      int s = e->key[k];
+      nodes[k+1] = (s < 0 ? discrim_add_kid(nodes[k], DVARIABLE, -1 - s) :
+		    discrim_add_kid(nodes[k], DRIGID, s));
+    }
+
+    last = &(nodes[e->n]->u.data);
+    for (j = i; j < b->num_entries && (j == i ||
+				       (b->entries[j].n == e->n &&
+					memcmp(b->entries[j].key, e->key,
+					       e->n * sizeof(int)) == 0)); j++) {
+      Plist p = get_plist();
+      p->v = b->entries[j].t;
+      p->next = NULL;
+      *last = p;
+      last = &(p->next);
+    }
+    prev = e->key;
+    prev_n = e->n;
+    i = j;
+  }
+
+  free(nodes);
+  free(b->entries);
+  free(b->keys);
+  free(b);
+}  /* discrim_bind_bulk_build */
+
 /*************
  *
  *  check_flat2
@@ -539,7 +649,9 @@ Plist discrim_bind_retrieve_leaf(Term t_in, Discrim root,
 {
   Flat2 f, f1, f2, f_save;
   Term t = NULL;
-  Discrim d = NULL;
+  Discrim n = NULL;  /* node whose children are being tried */
+  Discrim d = NULL;  /* the child that matches */
+  int k = 0;         /* next variable child of n to try */
   int symbol = 0;
   int match = 0;
   int bound = 0;
@@ -550,8 +662,9 @@ Plist discrim_bind_retrieve_leaf(Term t_in, Discrim root,
   f_save = NULL;
 
   if (t != NULL) {  /* if first call */
-    d = root->u.kids;
-    if (d != NULL) {
+    n = root;
+    k = 0;
+    if (!DISCRIM_CHILDLESS(n)) {
       f = get_flat2();
       f->t = t;
       f->last = f;
@@ -580,7 +693,8 @@ Plist discrim_bind_retrieve_leaf(Term t_in, Discrim root,
 	  subst->terms[f->varnum] = NULL;
 	  f->bound = 0;
 	}
-	d = f->alternatives;
+	n = f->alternatives;
+	k = f->alt_pos;
 	f->alternatives = NULL;
 	status = GO;
       }
@@ -590,7 +704,8 @@ Plist discrim_bind_retrieve_leaf(Term t_in, Discrim root,
 
     if (status == GO) {
       match = 0;
-      while (!match && d && DVAR(d)) {
+      while (!match && k < n->num_vars) {  /* variable children first */
+	d = n->vars[k++];
 	symbol = d->symbol;
 	if (subst->terms[symbol]) { /* if already bound */
 	  match = term_ident(subst->terms[symbol], f->t);
@@ -601,12 +716,13 @@ Plist discrim_bind_retrieve_leaf(Term t_in, Discrim root,
 	  subst->terms[symbol] = f->t;
 	  bound = 1;
 	}
-	if (!match)
-	  d = d->next;
       }
       if (match) {
-	/* push alternatives */
-	f->alternatives = d->next;
+	/* push alternatives: more variables, or the rigid child */
+	if (k < n->num_vars || (!VARIABLE(f->t) && n->num_kids > 0)) {
+	  f->alternatives = n;
+	  f->alt_pos = k;
+	}
 	f->bound = bound;
 	f->varnum = symbol;
 	f = f->last;
@@ -614,10 +730,8 @@ Plist discrim_bind_retrieve_leaf(Term t_in, Discrim root,
       else if (VARIABLE(f->t))
 	status = BACKTRACK;
       else {
-	symbol = SYMNUM(f->t);
-	while (d && d->symbol < symbol)
-	  d = d->next;
-	if (!d || d->symbol != symbol)
+	d = discrim_rigid_kid(n, SYMNUM(f->t));
+	if (d == NULL)
 	  status = BACKTRACK;
 	else if (f->place_holder) {
 	  int i;
@@ -649,7 +763,8 @@ Plist discrim_bind_retrieve_leaf(Term t_in, Discrim root,
       if (status == GO) {
 	if (f->next) {
 	  f = f->next;
-	  d = d->u.kids;
+	  n = d;
+	  k = 0;
 	}
 	else
 	  status = SUCCESS;
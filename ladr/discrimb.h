@@ -29,6 +29,8 @@ as soon as possible during retrieval.
 
 /* Public definitions */
 
+typedef struct discrim_bulk * Discrim_bulk;
+
 /* End of public definitions */
 
 /* Public function prototypes from discrimb.c */
@@ -45,6 +47,10 @@ void p_discrim_bind_index(Discrim d);
 
 void discrim_bind_update(Term t, Discrim root, void *object, Indexop op);
 
+Discrim_bulk discrim_bind_bulk_sort(Term *terms, int n);
+
+void discrim_bind_bulk_build(Discrim root, Discrim_bulk b);
+
 void *discrim_bind_retrieve_first(Term t, Discrim root,
 				  Context subst, Discrim_pos *ppos);
 
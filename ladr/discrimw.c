@@ -25,7 +25,8 @@ typedef struct flat * Flat;
 struct flat {  /* for building a stack of states for backtracking */
   Term    t;
   Flat    prev, next, last;
-  Discrim alternatives;
+  Discrim alternatives;    /* node whose children are still to be tried */
+  int     alt_pos;         /* where to resume in the children */
   int     bound;           /* (tame) */
   int     varnum;          /* (tame) */
   int     place_holder;
@@ -287,11 +288,12 @@ void print_discrim_wild_tree(FILE *fp, Discrim d, int n, int depth)
   else {
     Discrim d1;
     fprintf(fp, "\n");
-    for (d1 = d->u.kids; d1 != NULL; d1 = d1->next) {
+    for (i = 0; i < d->num_vars; i++)
+      print_discrim_wild_tree(fp, d->vars[i], n-1, depth+1);
+    i = 0;
+    while ((d1 = discrim_next_kid(d, &i)) != NULL) {
       if (d1->type == AC_ARG_TYPE || d1->type == AC_NV_ARG_TYPE)
 	arity = 0;
-      else if (DVAR(d1))
-	arity = 0;
       else
 	arity = sn_to_arity(d1->symbol);
       print_discrim_wild_tree(fp, d1, n+arity-1, depth+1);
@@ -341,41 +343,17 @@ static
 Discrim discrim_wild_insert_ac(Term t, Discrim d)
 {
   int num_args, num_nv_args;
-  Discrim d1, d2, dnew, prev;
+  Discrim d1, d2;
 
   num_args = num_ac_args(t, SYMNUM(t));
-
-  for (d1 = d->u.kids, prev = NULL;
-       d1 && d1->symbol < num_args;
-       prev = d1, d1 = d1->next);
-  if (d1 == NULL || d1->symbol != num_args) {
-    dnew = get_discrim();
-    dnew->type = AC_ARG_TYPE;
-    dnew->symbol = num_args;
-    dnew->next = d1;
-    if (prev != NULL)
-      prev->next = dnew;
-    else
-      d->u.kids = dnew;
-    d1 = dnew;
-  }
+  d1 = discrim_rigid_kid(d, num_args);
+  if (d1 == NULL)
+    d1 = discrim_add_kid(d, AC_ARG_TYPE, num_args);
 
   num_nv_args = num_ac_nv_args(t, SYMNUM(t));
-
-  for (d2 = d1->u.kids, prev = NULL;
-       d2 && d2->symbol < num_nv_args;
-       prev = d2, d2 = d2->next);
-  if (!d2 || d2->symbol != num_nv_args) {
-    dnew = get_discrim();
-    dnew->type = AC_NV_ARG_TYPE;
-    dnew->symbol = num_nv_args;
-    dnew->next = d2;
-    if (prev != NULL)
-      prev->next = dnew;
-    else
-      d1->u.kids = dnew;
-    d2 = dnew;
-  }
+  d2 = discrim_rigid_kid(d1, num_nv_args);
+  if (d2 == NULL)
+    d2 = discrim_add_kid(d1, AC_NV_ARG_TYPE, num_nv_args);
   return d2;
     
 }  /* discrim_wild_insert_ac */
@@ -389,45 +367,20 @@ Discrim discrim_wild_insert_ac(Term t, Discrim d)
 static
 Discrim discrim_wild_insert_rec(Term t, Discrim d)
 {
-  Discrim d1, prev, d2;
-  int sym;
+  Discrim d1;
 
   if (VARIABLE(t)) {
-    d1 = d->u.kids;
-    if (d1 == NULL || !DVAR(d1)) {
-      d2 = get_discrim();
-      d2->type = DVARIABLE;
-      d2->symbol = 0;    /* HERE */
-      d2->next = d1;
-      d->u.kids = d2;
-      return d2;
-    }
+    if (d->num_vars == 0)
+      return discrim_add_kid(d, DVARIABLE, 0);  /* all variables are 0 */
     else  /* found node */
-      return d1;
+      return d->vars[0];
   }
 
   else {  /* constant || complex */
-    d1 = d->u.kids;
-    prev = NULL;
     /* arities fixed: handle both NAME and COMPLEX */
-    sym = SYMNUM(t);
-    if (d1 && DVAR(d1)) {  /* skip variable */
-      prev = d1;
-      d1 = d1->next;
-    }
-    while (d1 && d1->symbol < sym) {
-      prev = d1;
-      d1 = d1->next;
-    }
-    if (d1 == NULL || d1->symbol != sym) {
-      d2 = get_discrim();
-      d2->type = DRIGID;
-      d2->symbol = sym;
-      d2->next = d1;
-      d1 = d2;
-    }
-    else
-      d2 = NULL;  /* new node not required at this level */
+    d1 = discrim_rigid_kid(d, SYMNUM(t));
+    if (d1 == NULL)
+      d1 = discrim_add_kid(d, DRIGID, SYMNUM(t));
 
     if (is_assoc_comm(SYMNUM(t))) {
       d1 = discrim_wild_insert_ac(t, d1);
@@ -438,13 +391,6 @@ Discrim discrim_wild_insert_rec(Term t, Discrim d)
 	d1 = discrim_wild_insert_rec(ARG(t,i), d1);
     }
 
-    if (d2 != NULL) {  /* link in new subtree (possibly a leaf) */
-      if (prev == NULL)
-	d->u.kids = d2;
-      else
-	prev->next = d2;
-    }
-	    
     return d1;  /* d1 is leaf corresp. to end of input term */
   }
 }  /* discrim_wild_insert_rec */
@@ -495,7 +441,6 @@ Discrim discrim_wild_end(Term t, Discrim d,
 {
   Discrim d1;
   Plist p;
-  int sym;
 
   /* add current node to the front of the path list. */
 
@@ -504,23 +449,13 @@ Discrim discrim_wild_end(Term t, Discrim d,
   p->next = *path_p;
   *path_p = p;
 
-  if (VARIABLE(t)) {
-    d1 = d->u.kids;
-    if (d1 && DVAR(d1))
-      return d1;
-    else
-      return NULL;
-  }
+  if (VARIABLE(t))
+    return (d->num_vars > 0 ? d->vars[0] : NULL);
 
   else {  /* constant || complex */
-    d1 = d->u.kids;
-    sym = SYMNUM(t);
-    if (d1 && DVAR(d1))  /* skip variables */
-      d1 = d1->next;
-    while (d1 && d1->symbol < sym)
-      d1 = d1->next;
-
-    if (d1 == NULL || d1->symbol != sym)
+    d1 = discrim_rigid_kid(d, SYMNUM(t));
+
+    if (d1 == NULL)
       return NULL;
     else if (is_assoc_comm(SYMNUM(t))) {
       int num_args, num_nv_args;
@@ -529,11 +464,11 @@ Discrim discrim_wild_end(Term t, Discrim d,
       num_args = num_ac_args(t, SYMNUM(t));
       num_nv_args = num_ac_nv_args(t, SYMNUM(t));
 		
-      for (d2 = d1->u.kids; d2 && d2->symbol != num_args; d2 = d2->next);
+      d2 = discrim_rigid_kid(d1, num_args);
       if (d2 == NULL)
 	return NULL;
       else {
-	for (d3 = d2->u.kids; d3 && d3->symbol != num_nv_args; d3 = d3->next);
+	d3 = discrim_rigid_kid(d2, num_nv_args);
 	if (d3 == NULL)
 	  return NULL;
 	else {
@@ -567,7 +502,7 @@ Discrim discrim_wild_end(Term t, Discrim d,
 static
 void discrim_wild_delete(Term t, Discrim root, void *object)
 {
-  Discrim end, i2, i3, parent;
+  Discrim end, parent;
   Plist tp1, tp2;
   Plist isp1, path;
 
@@ -600,22 +535,12 @@ void discrim_wild_delete(Term t, Discrim root, void *object)
 
   if (!end->u.data) {
     /* free tree nodes from bottom up, using path to get parents */
-    end->u.kids = NULL;  /* not really necessary */
     isp1 = path;
-    while (!end->u.kids && end != root) {
+    while (DISCRIM_CHILDLESS(end) && end != root) {
       parent = (Discrim) isp1->v;
       isp1 = isp1->next;
-      i2 = parent->u.kids;
-      i3 = NULL;
-      while (i2 != end) {
-	i3 = i2;
-	i2 = i2->next;
-      }
-      if (i3 == NULL)
-	parent->u.kids = i2->next;
-      else
-	i3->next = i2->next;
-      free_discrim(i2);
+      discrim_remove_kid(parent, end);
+      free_discrim(end);
       end = parent;
     }
   }
@@ -655,6 +580,23 @@ void discrim_wild_update(Term t, Discrim root, void *object, Indexop op)
     discrim_wild_delete(t, root, object);
 }  /* discrim_wild_update */
 
+/*************
+ *
+ *    kids_type()
+ *
+ *    The type of the rigid children of a node: AC_ARG_TYPE or
+ *    AC_NV_ARG_TYPE if they count AC arguments, DRIGID otherwise.
+ *
+ *************/
+
+static
+int kids_type(Discrim n)
+{
+  int pos = 0;
+  Discrim k = discrim_next_kid(n, &pos);
+  return (k == NULL ? DRIGID : k->type);
+}  /* kids_type */
+
 /*************
  *
  *    discrim_wild_retrieve_leaf(t_in, root, ppos)
@@ -667,15 +609,18 @@ Plist discrim_wild_retrieve_leaf(Term t_in, Discrim root, Flat *ppos)
   Flat f, f1, f2;
   Flat f_save = NULL;
   Term t;
-  Discrim d = NULL;
-  int symbol, status;
+  Discrim n = NULL;  /* node whose children are being tried */
+  Discrim d = NULL;  /* the child that matches */
+  int k = 0;         /* where to resume in the children of n */
+  int status;
 
   f = *ppos;  /* Don't forget to reset before return. */
   t = t_in;
 
   if (t != NULL) {  /* if first call */
-    d = root->u.kids;
-    if (d != NULL) {
+    n = root;
+    k = 0;
+    if (!DISCRIM_CHILDLESS(n)) {
       f = get_flat();
       f->t = t;
       f->last = f;
@@ -693,7 +638,11 @@ Plist discrim_wild_retrieve_leaf(Term t_in, Discrim root, Flat *ppos)
   while (status == GO || status == BACKTRACK) {
 
     /* Three things determine the state at this point.
-     * 1. d is the current node in the discrimination tree.
+     * 1. n is the current node in the discrimination tree, and k
+     *    says which of its children to try: for ordinary nodes,
+     *    0 means the variable (wildcard) child and then the rigid
+     *    one, and 1 means the rigid one only; for the children
+     *    that count AC arguments, k is a discrim_next_kid() position.
      * 2. f is the current node in the stack of flats.
      * 3. status is either GO or BACKTRACK.
      *
@@ -736,7 +685,8 @@ Plist discrim_wild_retrieve_leaf(Term t_in, Discrim root, Flat *ppos)
       }
 
 
-	d = f->alternatives;
+	n = f->alternatives;
+	k = f->alt_pos;
 	f->alternatives = NULL;
 	status = GO;
       }
@@ -752,35 +702,33 @@ Plist discrim_wild_retrieve_leaf(Term t_in, Discrim root, Flat *ppos)
     }  /* backtrack */
 
     if (status == GO) {
-#if 0
-      printf("go with (%x) %s\n", (unsigned) d,
-	     DVAR(d) ? "*" : sn_to_str(d->symbol));
-#endif
-      if (d && d->type == AC_ARG_TYPE) {
-	if (d->symbol <= f->num_ac_args)
-	  f->alternatives = d->next;
-	else
-	  status = BACKTRACK;
-      }
-      else if (d && d->type == AC_NV_ARG_TYPE) {
-	if (d->symbol <= f->num_ac_nv_args)
-	  f->alternatives = d->next;
+      int type = kids_type(n);
+      if (type == AC_ARG_TYPE || type == AC_NV_ARG_TYPE) {
+	/* The counts are in increasing order. */
+	int limit = (type == AC_ARG_TYPE ? f->num_ac_args : f->num_ac_nv_args);
+	d = discrim_next_kid(n, &k);
+	if (d != NULL && d->symbol <= limit) {
+	  f->alternatives = n;
+	  f->alt_pos = k;
+	}
 	else
 	  status = BACKTRACK;
       }
-      else if (d && DVAR(d)) {
+      else if (k == 0 && n->num_vars > 0) {
+	d = n->vars[0];
 	/* push alternatives */
-	f->alternatives = d->next;
+	if (!VARIABLE(f->t) && n->num_kids > 0) {
+	  f->alternatives = n;
+	  f->alt_pos = 1;
+	}
 	f = f->last;
       }
       else if (VARIABLE(f->t))
 	status = BACKTRACK;
       else {
-	symbol = SYMNUM(f->t);
-	while (d && d->symbol < symbol)
-	  d = d->next;
+	d = discrim_rigid_kid(n, SYMNUM(f->t));
 
-	if (!d || d->symbol != symbol)
+	if (d == NULL)
 	  status = BACKTRACK;
 	else {
 	  if (f->place_holder) {
@@ -843,7 +791,8 @@ Plist discrim_wild_retrieve_leaf(Term t_in, Discrim root, Flat *ppos)
 	    }  /* non-AC */
 	  }  /* if f->place_holder */
 	  if (f->commutative && f->flip == 0) {
-	    f->alternatives = d;
+	    f->alternatives = n;  /* the same rigid child, flipped */
+	    f->alt_pos = 1;
 	    f->flip = 1;
 	  }
 	}  /* rigid symbols match */
@@ -851,7 +800,8 @@ Plist discrim_wild_retrieve_leaf(Term t_in, Discrim root, Flat *ppos)
       if (status == GO) {
 	if (f->next) {
 	  f = f->next;
-	  d = d->u.kids;
+	  n = d;
+	  k = 0;
 	}
 	else
 	  status = SUCCESS;
@@ -101,13 +101,15 @@ Plist discrim_flat_retrieve_leaf(Flatterm fin, Discrim root,
 				 Context subst, Flatterm *ppos)
 {
   Flatterm f = NULL;
-  Discrim d = NULL;
+  Discrim n = NULL;  /* node whose children are being tried */
+  Discrim d = NULL;  /* the child that matches */
+  int k = 0;         /* next variable child of n to try */
   LADR_BOOL status = GO;
 
   if (root) {  /* first call */
-    d = root->u.kids;
+    n = root;
     f = fin;
-    if (d == NULL)
+    if (DISCRIM_CHILDLESS(n))
       return NULL;
     else
       status = GO;
@@ -128,17 +130,24 @@ Plist discrim_flat_retrieve_leaf(Flatterm fin, Discrim root,
 	return NULL;  /* fail */
       else {
 	MAYBE_UNBIND(f, subst);
-	d = f->alternative;
+	n = f->alternative;
+	k = f->alternative_pos;
 	f->alternative = NULL;
 	status = GO;
       }
     }  /* backtrack */
 
-    if (DVAR(d)) {
-      int varnum = d->symbol;
-      Flatterm b = (Flatterm) subst->terms[varnum];
+    if (k < n->num_vars) {  /* variable children first */
+      int varnum;
+      Flatterm b;
+      d = n->vars[k++];
+      varnum = d->symbol;
+      b = (Flatterm) subst->terms[varnum];
+      if (k < n->num_vars || (!VARIABLE(f) && n->num_kids > 0)) {
+	f->alternative = n;
+	f->alternative_pos = k;
+      }
       if (b) {
-	f->alternative = d->next;
 	if (flatterm_ident(f, b))
 	  f = f->end;  /* already bound to identical term */
 	else
@@ -147,20 +156,14 @@ Plist discrim_flat_retrieve_leaf(Flatterm fin, Discrim root,
       else {
 	subst->terms[varnum] = (Term) f;
 	f->varnum_bound_to = varnum;
-	f->alternative = d->next;
 	f = f->end;
       }
     }
     else if (VARIABLE(f))
       status = BACKTRACK;
     else {
-      int symnum = SYMNUM(f);
-      Discrim dd = NULL;
-      while (d && d->symbol < symnum) {
-	dd = d;
-	d = d->next;
-      }
-      if (!d || d->symbol != symnum)
+      d = discrim_rigid_kid(n, SYMNUM(f));
+      if (d == NULL)
 	status = BACKTRACK;
     }
     
@@ -171,7 +174,8 @@ Plist discrim_flat_retrieve_leaf(Flatterm fin, Discrim root,
       }
       else {
 	f = f->next;
-	d = d->u.kids;
+	n = d;
+	k = 0;
       }
     }  /* go */
   }  /* while */
@@ -266,6 +270,51 @@ void discrim_flat_cancel(Discrim_pos pos)
   free_discrim_pos(pos);
 }  /* discrim_flat_cancel */
 
+/*************
+ *
+ *   fdemod_retrieve_first(), fdemod_retrieve_next(), fdemod_cancel()
+ *
+ *   Demodulator retrieval, from a DISCRIM_BIND Mindex.
+ *   These bypass mindex_retrieve_first(), so they keep the statistics
+ *   of the Mindex; the answers match, so they are all counted.
+ *
+ *************/
+
+static
+Term fdemod_retrieve_first(Flatterm f, Mindex idx, Context subst,
+			   Discrim_pos *ppos)
+{
+  Term t;
+  if (idx->bulk_terms != NULL)
+    mindex_bulk_build(idx);
+  idx->stats.queries[GENERALIZATION]++;
+  if (mindex_query_depth_stats_on())
+    idx->stats.query_depth += flatterm_depth(f);
+  t = discrim_flat_retrieve_first(f, idx->discrim_tree, subst, ppos);
+  if (t != NULL) {
+    idx->stats.candidates++;
+    idx->stats.answers++;
+  }
+  return t;
+}  /* fdemod_retrieve_first */
+
+static
+Term fdemod_retrieve_next(Mindex idx, Discrim_pos pos)
+{
+  Term t = discrim_flat_retrieve_next(pos);
+  if (t != NULL) {
+    idx->stats.candidates++;
+    idx->stats.answers++;
+  }
+  return t;
+}  /* fdemod_retrieve_next */
+
+static
+void fdemod_cancel(Mindex idx, Discrim_pos pos)
+{
+  discrim_flat_cancel(pos);
+}  /* fdemod_cancel */
+
 /*************
  *
  *   fdemod()
@@ -273,7 +322,7 @@ void discrim_flat_cancel(Discrim_pos pos)
  *************/
 
 static
-Flatterm fdemod(Flatterm f, Discrim root, Context subst,
+Flatterm fdemod(Flatterm f, Mindex idx, Context subst,
 		int *step_limit,
 		int size_limit,
 		int *current_size,
@@ -296,7 +345,7 @@ Flatterm fdemod(Flatterm f, Discrim root, Context subst,
       int i;
       for (i = 0; i < ARITY(f); i++) {
 	Flatterm next = arg->end->next;
-	Flatterm a2 = fdemod(arg, root, subst, step_limit,
+	Flatterm a2 = fdemod(arg, idx, subst, step_limit,
 			     size_limit, current_size,
 			     sequence, just_head, lex_order_vars);
 	n += a2->size;
@@ -317,7 +366,7 @@ Flatterm fdemod(Flatterm f, Discrim root, Context subst,
     else {
       /* try to rewrite top */
       Discrim_pos dpos;
-      Term candidate = discrim_flat_retrieve_first(f, root, subst, &dpos);
+      Term candidate = fdemod_retrieve_first(f, idx, subst, &dpos);
       LADR_BOOL rewrite = FALSE;
 
       Fdemod_attempts++;
@@ -351,20 +400,20 @@ Flatterm fdemod(Flatterm f, Discrim root, Context subst,
 	  (*step_limit)--;
 
 	  Fdemod_rewrites++;
-	  discrim_flat_cancel(dpos);
+	  fdemod_cancel(idx, dpos);
 	  zap_flatterm(f);
 	  *just_head = i3list_prepend(*just_head,
 				      demodulator->id,
 				      *sequence,
 				      match_left ? 1 : 2);
 	  *sequence = sequence_save;
-	  f = fdemod(contractum, root, subst, step_limit,
+	  f = fdemod(contractum, idx, subst, step_limit,
 		     size_limit, current_size,
 		     sequence, just_head, lex_order_vars);
 	}
 	else {
 	  zap_flatterm(contractum);
-	  candidate = discrim_flat_retrieve_next(dpos);
+	  candidate = fdemod_retrieve_next(idx, dpos);
 	}
       }
     } /* end: try to rewrite top */
@@ -380,7 +429,9 @@ Flatterm fdemod(Flatterm f, Discrim root, Context subst,
  *************/
 
 /* DOCUMENTATION
-This routine demodulates a term.  ID numbers of demodulators
+This routine demodulates a term, with the demodulators in Mindex idx,
+which must be of type DISCRIM_BIND.
+ID numbers of demodulators
 are put on the front of just_head, so you'll probably want
 to reverse the list before putting it into the clause justification.
 <P>
@@ -388,7 +439,7 @@ This version uses flatterm retrieval.
 */
 
 /* PUBLIC */
-Term fdemodulate(Term t, Discrim root,
+Term fdemodulate(Term t, Mindex idx,
 		 int *step_limit, int *increase_limit, int *sequence,
 		 I3list *just_head, LADR_BOOL lex_order_vars)
 {
@@ -396,7 +447,7 @@ Term fdemodulate(Term t, Discrim root,
   Context subst = get_context();
   int current_size = f->size;
   int size_limit = (*increase_limit==INT_MAX) ? INT_MAX : current_size + *increase_limit;
-  Flatterm f2 = fdemod(f, root, subst, step_limit,
+  Flatterm f2 = fdemod(f, idx, subst, step_limit,
 		       size_limit, &current_size,
 		       sequence, just_head, lex_order_vars);
   free_context(subst);
@@ -455,7 +506,8 @@ int fdemod_rewrites()
  *************/
 
 /* DOCUMENTATION
-Demodulate Topform c, using demodulators in Mindex idx.
+Demodulate Topform c, using demodulators in Mindex idx
+(DISCRIM_BIND).
 If any rewriting occurs, the justification is appended to
 the clause's existing justification.
 <P>
@@ -480,7 +532,7 @@ void fdemod_clause(Topform c, Mindex idx,
      */
     int sequence = 0;
     for (lit = c->literals; lit != NULL; lit = lit->next)
-      lit->atom = fdemodulate(lit->atom, idx->discrim_tree,
+      lit->atom = fdemodulate(lit->atom, idx,
 			      step_limit, increase_limit,
 			      &sequence, &steps, lex_order_vars);
 			      
@@ -43,7 +43,7 @@ void *discrim_flat_retrieve_next(Discrim_pos pos);
 
 void discrim_flat_cancel(Discrim_pos pos);
 
-Term fdemodulate(Term t, Discrim root,
+Term fdemodulate(Term t, Mindex idx,
 		 int *step_limit, int *increase_limit, int *sequence,
 		 I3list *just_head, LADR_BOOL lex_order_vars);
 
@@ -316,6 +316,34 @@ int flatterm_symbol_count(Flatterm f)
   }
 }  /* flatterm_symbol_count */
 
+/*************
+ *
+ *   flatterm_depth()
+ *
+ *************/
+
+/* DOCUMENTATION
+Return the depth of a Flatterm.  Variables and constants have depth 0.
+*/
+
+/* PUBLIC */
+int flatterm_depth(Flatterm f)
+{
+  if (ARITY(f) == 0)
+    return 0;
+  else {
+    int max = 0;
+    int i;
+    Flatterm g = f->next;
+    for (i = 0; i < ARITY(f); i++) {
+      int d = flatterm_depth(g);
+      max = IMAX(max,d);
+      g = g->end->next;
+    }
+    return max+1;
+  }
+}  /* flatterm_depth */
+
 /*************
  *
  *   p_flatterm()
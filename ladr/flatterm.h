@@ -60,7 +60,8 @@ struct flatterm {
   /* The rest of the fields are for index retrieval and demodulation. */
   
   int size;                      /* symbol count */
-  struct discrim *alternative;   /* subtree to try next */
+  struct discrim *alternative;   /* node whose children to try next */
+  int alternative_pos;           /* next variable child to try */
   int varnum_bound_to;           /* -1 for not bound */
   LADR_BOOL reduced_flag;             /* fully demodulated */
 };
@@ -91,6 +92,8 @@ void print_flatterm(Flatterm f);
 
 int flatterm_symbol_count(Flatterm f);
 
+int flatterm_depth(Flatterm f);
+
 void p_flatterm(Flatterm f);
 
 LADR_BOOL flat_occurs_in(Flatterm t1, Flatterm t2);
@@ -29,7 +29,10 @@ static unsigned Next_calls_overflows = 0;
 typedef struct fpa_trie * Fpa_trie;
 
 struct fpa_trie {
-  Fpa_trie   parent, next, kids;
+  Fpa_trie   parent;
+  Fpa_trie   *kids;       /* children, in increasing order of label */
+  int        num_kids;
+  int        kids_size;   /* size of the kids array */
   int        label;
   Fpa_list   terms;
 #ifdef FPA_DEBUG
@@ -40,12 +43,40 @@ struct fpa_trie {
 struct fpa_index {
   Fpa_trie   root;
   int        depth;
+  int        *path;       /* buffer for paths, 2*depth+1 integers */
   Fpa_index  next;
 };
 
-struct fpa_state {
+/* For loading an index all at once, the (path, term) pairs are
+   sorted, so that each trie node and FPA list is built once.
+   This is all malloc'd, so that sorting can be done by other threads.
+ */
+
+struct fpa_entry {
+  int        *path;
+  int        start;       /* where the path is in paths */
+  int        n;           /* length of path */
+  Term       t;
+};
+
+struct fpa_bulk {
+  struct fpa_entry *entries;
+  int        num_entries;
+  int        *paths;      /* the paths of the entries, end to end */
+  int        paths_used;
+};
+
+/* A query is an AND/OR tree of nodes, with FPA lists at the leaves.
+   The nodes are taken from blocks that belong to the query (a bump
+   arena), and they are never freed individually; when the query
+   is finished or canceled, its blocks are given back all at once.
+ */
+
+typedef struct fpa_node * Fpa_node;
+
+struct fpa_node {
   int              type;
-  Fpa_state        left, right;
+  Fpa_node         left, right;
   Term             left_term, right_term;
   struct fposition fpos;
 #ifdef FPA_DEBUG
@@ -53,22 +84,36 @@ struct fpa_state {
 #endif
 };
 
-/* A path is a sequence of integers.  We have to do some operations
-   to the end of a path, and an Ilist is singly-linked; but we can
-   get away with just keeping a pointer to the end of the list.
- */
+#define FPA_BLOCK_NODES 32
+
+typedef struct fpa_block * Fpa_block;
+
+struct fpa_block {
+  struct fpa_node nodes[FPA_BLOCK_NODES];
+  int             used;
+  Fpa_block       next;
+};
+
+struct fpa_state {
+  Fpa_node   root;
+  Fpa_block  blocks;      /* the arena, most recent block first */
+};
+
+/* A path is a sequence of integers (symbol, argument position, symbol,
+   ..., symbol).  It is built in place in the index's path buffer. */
 
 struct path {
-  Ilist first;
-  Ilist last;
+  int *a;
+  int n;
 };
 
-enum { LEAF, UNION, INTERSECT };  /* types of fpa_state (node in FPA tree) */
+enum { LEAF, UNION, INTERSECT };  /* types of fpa_node (node in FPA tree) */
 
 /* for a mutual recursion */
 
-static Fpa_state build_query(Term t, Context c, Querytype type,
-			     struct path *p, int bound, Fpa_trie index);
+static Fpa_node build_query(Term t, Context c, Querytype type,
+			    struct path *p, int bound, Fpa_trie index,
+			    Fpa_state s);
 
 /*
  * memory management
@@ -80,9 +125,14 @@ static unsigned Fpa_trie_gets, Fpa_trie_frees;
 #define PTRS_FPA_STATE PTRS(sizeof(struct fpa_state))
 static unsigned Fpa_state_gets, Fpa_state_frees;
 
+#define PTRS_FPA_BLOCK PTRS(sizeof(struct fpa_block))
+static unsigned Fpa_block_gets, Fpa_block_frees;
+
 #define PTRS_FPA_INDEX PTRS(sizeof(struct fpa_index))
 static unsigned Fpa_index_gets, Fpa_index_frees;
 
+static unsigned Kids_mem;  /* keep track of memory (pointers) for kids */
+
 /*************
  *
  *   Fpa_trie get_fpa_trie()
@@ -107,6 +157,10 @@ Fpa_trie get_fpa_trie(void)
 static
 void free_fpa_trie(Fpa_trie p)
 {
+  if (p->kids != NULL) {
+    free_mem(p->kids, p->kids_size);
+    Kids_mem -= p->kids_size;
+  }
   free_mem(p, PTRS_FPA_TRIE);
   Fpa_trie_frees++;
 }  /* free_fpa_trie */
@@ -138,6 +192,35 @@ void free_fpa_state(Fpa_state p)
   Fpa_state_frees++;
 }  /* free_fpa_state */
 
+/*************
+ *
+ *   Fpa_block get_fpa_block()
+ *
+ *************/
+
+static
+Fpa_block get_fpa_block(void)
+{
+  Fpa_block p = get_mem(PTRS_FPA_BLOCK);
+  p->used = 0;
+  p->next = NULL;
+  Fpa_block_gets++;
+  return(p);
+}  /* get_fpa_block */
+
+/*************
+ *
+ *    free_fpa_block()
+ *
+ *************/
+
+static
+void free_fpa_block(Fpa_block p)
+{
+  free_mem(p, PTRS_FPA_BLOCK);
+  Fpa_block_frees++;
+}  /* free_fpa_block */
+
 /*************
  *
  *   Fpa_index get_fpa_index()
@@ -197,11 +280,19 @@ void fprint_fpa_mem(FILE *fp, LADR_BOOL heading)
           Fpa_state_gets - Fpa_state_frees,
           ((Fpa_state_gets - Fpa_state_frees) * n) / 1024.);
 
+  n = sizeof(struct fpa_block);
+  fprintf(fp, "fpa_block (%4d)    %11u%11u%11u%9.1f K\n",
+          n, Fpa_block_gets, Fpa_block_frees,
+          Fpa_block_gets - Fpa_block_frees,
+          ((Fpa_block_gets - Fpa_block_frees) * n) / 1024.);
+
   n = sizeof(struct fpa_index);
   fprintf(fp, "fpa_index (%4d)    %11u%11u%11u%9.1f K\n",
           n, Fpa_index_gets, Fpa_index_frees,
           Fpa_index_gets - Fpa_index_frees,
           ((Fpa_index_gets - Fpa_index_frees) * n) / 1024.);
+  fprintf(fp, "      fpa_trie kids:                                 %9.1f K\n",
+	  Kids_mem * BYTES_POINTER / 1024.);
 
 }  /* fprint_fpa_mem */
 
@@ -284,7 +375,6 @@ static
 void fprint_fpa_trie(FILE *fp, Fpa_trie p, int depth)
 {
   int i;
-  Fpa_trie q;
   for (i = 0; i < depth; i++)
     fprintf(fp, " - ");
   if (depth == 0)
@@ -306,8 +396,8 @@ void fprint_fpa_trie(FILE *fp, Fpa_trie p, int depth)
     fprint_path(fp, p->path);
 #endif  
   fprintf(fp, "\n");
-  for (q = p->kids; q != NULL; q = q->next)
-    fprint_fpa_trie(fp, q, depth+1);
+  for (i = 0; i < p->num_kids; i++)
+    fprint_fpa_trie(fp, p->kids[i], depth+1);
 }  /* fprint_fpa_trie */
 
 /*************
@@ -349,7 +439,66 @@ void p_fpa_index(Fpa_index idx)
 
 /*************
  *
- *    fpa_trie_member_insert (recursive) -- This routine takes a trie
+ *    kid_position -- Binary search for the child with a given label.
+ *    If it exists, *found is set to TRUE; in any case, the position
+ *    (where the child is or where it would be inserted) is returned.
+ *
+ *************/
+
+static
+int kid_position(Fpa_trie node, int val, LADR_BOOL *found)
+{
+  int lo = 0;
+  int hi = node->num_kids;
+  while (lo < hi) {
+    int mid = lo + (hi - lo) / 2;
+    int label = node->kids[mid]->label;
+    if (label == val) {
+      *found = TRUE;
+      return mid;
+    }
+    else if (label < val)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  *found = FALSE;
+  return lo;
+}  /* kid_position */
+
+/*************
+ *
+ *    insert_kid -- Insert a new child at a given position,
+ *    doubling the kids array if it is full.
+ *
+ *************/
+
+static
+void insert_kid(Fpa_trie node, int pos, Fpa_trie kid)
+{
+  int i;
+  if (node->num_kids == node->kids_size) {
+    int size = (node->kids_size == 0 ? 2 : 2 * node->kids_size);
+    Fpa_trie *kids = get_mem(size);
+    Kids_mem += size;
+    for (i = 0; i < node->num_kids; i++)
+      kids[i] = node->kids[i];
+    if (node->kids != NULL) {
+      free_mem(node->kids, node->kids_size);
+      Kids_mem -= node->kids_size;
+    }
+    node->kids = kids;
+    node->kids_size = size;
+  }
+  for (i = node->num_kids; i > pos; i--)
+    node->kids[i] = node->kids[i-1];
+  node->kids[pos] = kid;
+  node->num_kids++;
+}  /* insert_kid */
+
+/*************
+ *
+ *    fpa_trie_member_insert -- This routine takes a trie
  *    and a path, and looks for a node in the trie that corresponds
  *    to the path.  If such a node does not exist, it is created, and
  *    the trie is updated.
@@ -357,63 +506,48 @@ void p_fpa_index(Fpa_index idx)
  *************/
 
 static
-Fpa_trie fpa_trie_member_insert(Fpa_trie node, Ilist path)
+Fpa_trie fpa_trie_member_insert(Fpa_trie node, struct path *p)
 {
-  if (path == NULL)
-    return node;
-  else {
-    /* Find child node that matches first member of path;
-     * if it doesn't exist, create it. Children are in increasing order.
+  int k;
+  for (k = 0; k < p->n; k++) {
+    /* Find child node that matches member k of the path;
+     * if it doesn't exist, create it.
      */
-    int val = path->i;
-    Fpa_trie curr = node->kids;
-    Fpa_trie prev = NULL;
-    while (curr != NULL && curr->label < val) {
-      prev = curr;
-      curr = curr->next;
-    }
-    if (curr != NULL && curr->label == val)
-      return fpa_trie_member_insert(curr, path->next);
+    int val = p->a[k];
+    LADR_BOOL found;
+    int pos = kid_position(node, val, &found);
+    if (found)
+      node = node->kids[pos];
     else {
-      /* Get a new node and insert it before curr (which may be NULL). */
       Fpa_trie nw = get_fpa_trie();
       nw->parent = node;
       nw->label = val;
-      nw->next = curr;
-      if (prev == NULL)
-	node->kids = nw;
-      else
-	prev->next = nw;
-      return fpa_trie_member_insert(nw, path->next);
+      insert_kid(node, pos, nw);
+      node = nw;
     }
   }
+  return node;
 }  /* fpa_trie_member_insert */
 
 /*************
  *
- *    fpa_trie_member (recursive) -- This routine looks for a trie
+ *    fpa_trie_member -- This routine looks for a trie
  *    node that corresponds to a given path.
  *
  *************/
 
 static
-Fpa_trie fpa_trie_member(Fpa_trie node, Ilist path)
+Fpa_trie fpa_trie_member(Fpa_trie node, struct path *p)
 {
-  if (path == NULL)
-    return node;
-  else {
-    /* Find child node that matches first member of path;
-     * Children are in increasing order.
-     */
-    int val = path->i;
-    Fpa_trie curr = node->kids;
-    while (curr != NULL && curr->label < val)
-      curr = curr->next;
-    if (curr != NULL && curr->label == val)
-      return fpa_trie_member(curr, path->next);
-    else
+  int k;
+  for (k = 0; k < p->n; k++) {
+    LADR_BOOL found;
+    int pos = kid_position(node, p->a[k], &found);
+    if (!found)
       return NULL;
+    node = node->kids[pos];
   }
+  return node;
 }  /* fpa_trie_member */
 
 /*************
@@ -421,8 +555,9 @@ Fpa_trie fpa_trie_member(Fpa_trie node, Ilist path)
  *    fpa_trie_possible_delete (recursive) -- This routine checks if
  *    a trie node should be deleted.  If so, it is deleted, and a
  *    recursive call is made on the parent node.  The trie node should
- *    be deleted if (1) it is not the root, (2) there is no FPA list,
- *    and (3) it has no children.
+ *    be deleted if (1) it is not the root, (2) it has no FPA list or
+ *    an empty one, and (3) it has no children.  (Inner nodes have
+ *    no FPA lists, so they go when their last child goes.)
  *
  *************/
 
@@ -430,22 +565,41 @@ static
 void fpa_trie_possible_delete(Fpa_trie node)
 {
   if (node->parent &&
-      node->terms &&
-      fpalist_empty(node->terms) &&
-      node->kids == NULL) {
-    if (node->parent->kids == node)
-      node->parent->kids = node->next;
-    else {
-      Fpa_trie p = node->parent->kids;
-      while (p->next != node)
-	p = p->next;
-      p->next = node->next;
-    }
-    fpa_trie_possible_delete(node->parent);
+      (node->terms == NULL || fpalist_empty(node->terms)) &&
+      node->num_kids == 0) {
+    Fpa_trie parent = node->parent;
+    LADR_BOOL found;
+    int i = kid_position(parent, node->label, &found);
+    if (!found)
+      fatal_error("fpa_trie_possible_delete, node not found");
+    parent->num_kids--;
+    for ( ; i < parent->num_kids; i++)
+      parent->kids[i] = parent->kids[i+1];
+    fpa_trie_possible_delete(parent);
+    if (node->terms)
+      zap_fpalist(node->terms);
     free_fpa_trie(node);
   }
 }  /* fpa_trie_possible_delete */
 
+#ifdef FPA_DEBUG
+/*************
+ *
+ *    path_to_ilist -- for FPA_DEBUG
+ *
+ *************/
+
+static
+Ilist path_to_ilist(struct path *p)
+{
+  Ilist g = NULL;
+  int k;
+  for (k = p->n - 1; k >= 0; k--)
+    g = ilist_prepend(g, p->a[k]);
+  return g;
+}  /* path_to_ilist */
+#endif
+
 /*************
  *
  *    path_insert -- Given (term,path,index), insert a pointer
@@ -454,13 +608,13 @@ void fpa_trie_possible_delete(Fpa_trie node)
  *************/
 
 static
-void path_insert(Term t, Ilist path, Fpa_trie index)
+void path_insert(Term t, struct path *p, Fpa_trie index)
 {
-  Fpa_trie node = fpa_trie_member_insert(index, path);
+  Fpa_trie node = fpa_trie_member_insert(index, p);
 
 #ifdef FPA_DEBUG
   if (node->path == NULL)
-    node->path = copy_ilist(path);
+    node->path = path_to_ilist(p);
 #endif
 
   if (node->terms == NULL)
@@ -476,9 +630,9 @@ void path_insert(Term t, Ilist path, Fpa_trie index)
  *************/
 
 static
-void path_delete(Term t, Ilist path, Fpa_trie index)
+void path_delete(Term t, struct path *p, Fpa_trie index)
 {
-  Fpa_trie node = fpa_trie_member(index, path);
+  Fpa_trie node = fpa_trie_member(index, p);
 
   if (node == NULL) {
     fatal_error("path_delete, trie node not found.");
@@ -495,47 +649,6 @@ void path_delete(Term t, Ilist path, Fpa_trie index)
   fpa_trie_possible_delete(node);
 }  /* path_delete */
 
-/*************
- *
- *    path_push -- append an integer to a path.   "save" is used because
- *    we have a pointer to the last member, but the list is singly linked.
- *
- *************/
-
-static
-Ilist path_push(struct path *p, int i)
-{
-  Ilist nw = get_ilist();
-  Ilist save = p->last;
-
-  nw->i = i;
-  nw->next = NULL;
-  if (p->last == NULL)
-    p->first = nw;
-  else
-    p->last->next = nw;
-  p->last = nw;
-  return save;
-}  /* path_push */
-
-/*************
- *
- *    path_restore -- pop and throw away the last member of a path.
- *    We assume that "save" points to the next-to-last member.
- *
- *************/
-
-static
-void path_restore(struct path *p, Ilist save)
-{
-  free_ilist(p->last);
-  p->last = save;
-  if (save != NULL)
-    save->next = NULL;
-  else
-    p->first = NULL;
-}  /* path_restore */
-
 /*************
  *
  *  fpa_paths (recursive) -- This routine traverses a term, keeping a
@@ -548,31 +661,26 @@ static
 void fpa_paths(Term root, Term t, struct path *p, int bound,
 	       Indexop op, Fpa_trie index)
 {
-  Ilist save1;
+  p->a[p->n++] = (VARIABLE(t) ? 0 : SYMNUM(t));
 
-  if (VARIABLE(t))
-    save1 = path_push(p, 0);
-  else
-    save1 = path_push(p, SYMNUM(t));
   if (COMPLEX(t) && bound > 0 && !is_assoc_comm(SYMNUM(t))) {
     int i;
-    Ilist save2 = path_push(p, 0);
-
+    p->n++;
     for (i = 0; i < ARITY(t); i++) {
-      p->last->i = i+1;  /* Count arguments from 1. */
+      p->a[p->n-1] = i+1;  /* Count arguments from 1. */
       fpa_paths(root, ARG(t,i), p, bound-1, op, index);
     }
-    path_restore(p, save2);
+    p->n--;
   }
   else {
     /* printf("    ");  p_path(p->first); */
     
     if (op == INSERT)
-      path_insert(root, p->first, index);
+      path_insert(root, p, index);
     else
-      path_delete(root, p->first, index);
+      path_delete(root, p, index);
   }
-  path_restore(p, save1);
+  p->n--;
 }  /* fpa_paths */
 
 /*************
@@ -593,9 +701,30 @@ Fpa_index fpa_init_index(int depth)
   Fpa_index f = get_fpa_index();
   f->depth = depth;
   f->root = get_fpa_trie();
+  f->path = malloc((2 * (depth < 0 ? 0 : depth) + 1) * sizeof(int));
   return f;
 }  /* fpa_init_index */
 
+/*************
+ *
+ *   assign_fpa_id()
+ *
+ *************/
+
+/* DOCUMENTATION
+This routine gives Term t the next FPA_ID, if it does not have one.
+The IDs increase, and FPA lists are ordered by them, so answers
+come newest first.  Other indexes that keep FPA lists
+(for example, substitution trees) use the same IDs.
+*/
+
+/* PUBLIC */
+void assign_fpa_id(Term t)
+{
+  if (FPA_ID(t) == 0)
+    FPA_ID(t) = ++Fpa_id_count;
+}  /* assign_fpa_id */
+
 /*************
  *
  *    fpa_update -- Insert/delete a term into/from a FPA-PATH index.
@@ -619,15 +748,243 @@ void fpa_update(Term t, Fpa_index idx, Indexop op)
 
   if (FPA_ID(t) == 0) {
     if (op == INSERT)
-      FPA_ID(t) = ++Fpa_id_count;
+      assign_fpa_id(t);
     else
       fatal_error("fpa_update: FPA_ID=0.");
   }
 
-  p.first = p.last = NULL;
+  p.a = idx->path;
+  p.n = 0;
   fpa_paths(t, t, &p, idx->depth, op, idx->root);
 }  /* fpa_update */
 
+/*************
+ *
+ *   bulk_paths()
+ *
+ *   Like fpa_paths(), but the (path, term) pairs are added to the
+ *   entries of b.  The paths go into b->paths, which can move,
+ *   so the entries get pointers to them at the end.
+ *
+ *************/
+
+static
+void bulk_paths(Term root, Term t, struct path *p, int bound,
+		Fpa_bulk b, int *entries_size, int *paths_size)
+{
+  p->a[p->n++] = (VARIABLE(t) ? 0 : SYMNUM(t));
+
+  if (COMPLEX(t) && bound > 0 && !is_assoc_comm(SYMNUM(t))) {
+    int i;
+    p->n++;
+    for (i = 0; i < ARITY(t); i++) {
+      p->a[p->n-1] = i+1;  /* Count arguments from 1. */
+      bulk_paths(root, ARG(t,i), p, bound-1, b, entries_size, paths_size);
+    }
+    p->n--;
+  }
+  else {
+    struct fpa_entry *e;
+    if (b->num_entries == *entries_size) {
+      *entries_size *= 2;
+      b->entries = realloc(b->entries,
+			   *entries_size * sizeof(struct fpa_entry));
+    }
+    while (b->paths_used + p->n > *paths_size) {
+      *paths_size *= 2;
+      b->paths = realloc(b->paths, *paths_size * sizeof(int));
+    }
+    e = b->entries + b->num_entries++;
+    memcpy(b->paths + b->paths_used, p->a, p->n * sizeof(int));
+    e->start = b->paths_used;
+    e->n = p->n;
+    e->t = root;
+    b->paths_used += p->n;
+  }
+  p->n--;
+}  /* bulk_paths */
+
+/*************
+ *
+ *   compare_entries()
+ *
+ *   Paths in increasing order (a prefix comes first), then terms
+ *   in decreasing order, as in FPA lists.
+ *
+ *************/
+
+static
+int compare_entries(const void *v1, const void *v2)
+{
+  const struct fpa_entry *e1 = v1;
+  const struct fpa_entry *e2 = v2;
+  int i;
+  for (i = 0; i < e1->n && i < e2->n; i++) {
+    if (e1->path[i] != e2->path[i])
+      return e1->path[i] < e2->path[i] ? -1 : 1;
+  }
+  if (e1->n != e2->n)
+    return e1->n < e2->n ? -1 : 1;
+  else if (FGT(e1->t, e2->t))
+    return -1;
+  else if (FLT(e1->t, e2->t))
+    return 1;
+  else
+    return 0;
+}  /* compare_entries */
+
+/*************
+ *
+ *   fpa_bulk_sort()
+ *
+ *************/
+
+/* DOCUMENTATION
+This routine is the first step in loading n terms into an (empty)
+Fpa_index all at once: it finds and sorts the paths of the terms.
+The terms must already have FPA_IDs (see assign_fpa_id()).
+<P>
+It uses only malloc'd memory, and it changes neither the terms nor
+the index, so calls for different indexes can run in parallel
+(in threads).  The result goes to fpa_bulk_build().
+*/
+
+/* PUBLIC */
+Fpa_bulk fpa_bulk_sort(Term *terms, int n, Fpa_index idx)
+{
+  Fpa_bulk b = malloc(sizeof(struct fpa_bulk));
+  int depth = idx->depth;
+  int entries_size = IMAX(n, 1) * 4;
+  int paths_size = entries_size * 4;
+  int *a = malloc((2 * (depth < 0 ? 0 : depth) + 1) * sizeof(int));
+  int i;
+
+  b->entries = malloc(entries_size * sizeof(struct fpa_entry));
+  b->paths = malloc(paths_size * sizeof(int));
+  b->num_entries = 0;
+  b->paths_used = 0;
+
+  for (i = 0; i < n; i++) {
+    struct path p;
+    if (FPA_ID(terms[i]) == 0)
+      fatal_error("fpa_bulk_sort: FPA_ID=0.");
+    p.a = a;
+    p.n = 0;
+    bulk_paths(terms[i], terms[i], &p, depth, b, &entries_size, &paths_size);
+  }
+  free(a);
+
+  for (i = 0; i < b->num_entries; i++)
+    b->entries[i].path = b->paths + b->entries[i].start;
+  qsort(b->entries, b->num_entries, sizeof(struct fpa_entry),
+	compare_entries);
+  return b;
+}  /* fpa_bulk_sort */
+
+/*************
+ *
+ *   fpa_bulk_build()
+ *
+ *************/
+
+/* DOCUMENTATION
+This routine is the second step in loading terms into an
+Fpa_index all at once (see fpa_bulk_sort()).
+The index must be empty.  The trie is built in one pass over
+the sorted paths, each path sharing the nodes of its prefix
+with the one before, and each FPA list is built once,
+with the terms in order.  Fpa_bulk b is freed.
+<P>
+The index is the same as if the terms had been inserted with fpa_update().
+*/
+
+/* PUBLIC */
+void fpa_bulk_build(Fpa_index idx, Fpa_bulk b)
+{
+  Fpa_trie *nodes;  /* nodes[k] is the node for the first k labels */
+  Term *terms;
+  int *prev = NULL;
+  int prev_n = 0;
+  int i = 0;
+
+  if (!fpa_empty(idx))
+    fatal_error("fpa_bulk_build, index not empty.");
+
+  nodes = malloc((2 * (idx->depth < 0 ? 0 : idx->depth) + 2) *
+		 sizeof(Fpa_trie));
+  terms = malloc(IMAX(b->num_entries, 1) * sizeof(Term));
+  nodes[0] = idx->root;
+
+  while (i < b->num_entries) {
+    struct fpa_entry *e = b->entries + i;
+    int k = 0;
+    int m = 0;
+    int j;
+
+    while (k < prev_n && k < e->n && prev[k] == e->path[k])
+      k++;
+    for (; k < e->n; k++) {
+      Fpa_trie nw = get_fpa_trie();
+      nw->parent = nodes[k];
+      nw->label = e->path[k];
+      insert_kid(nodes[k], nodes[k]->num_kids, nw);
+      nodes[k+1] = nw;
+    }
+
+    for (j = i; j < b->num_entries && (j == i ||
+				       (b->entries[j].n == e->n &&
+					memcmp(b->entries[j].path, e->path,
+					       e->n * sizeof(int)) == 0)); j++) {
+      if (m > 0 && terms[m-1] == b->entries[j].t)
+	fatal_error("fpa_bulk_build, term already here.");
+      terms[m++] = b->entries[j].t;
+    }
+    nodes[e->n]->terms = fpalist_build(terms, m);
+#ifdef FPA_DEBUG
+    {
+      struct path p;
+      p.a = e->path;
+      p.n = e->n;
+      nodes[e->n]->path = path_to_ilist(&p);
+    }
+#endif
+    prev = e->path;
+    prev_n = e->n;
+    i = j;
+  }
+
+  free(nodes);
+  free(terms);
+  free(b->entries);
+  free(b->paths);
+  free(b);
+}  /* fpa_bulk_build */
+
+/*************
+ *
+ *   get_fpa_node() -- take a node from the query's arena
+ *
+ *************/
+
+static
+Fpa_node get_fpa_node(Fpa_state s, int type)
+{
+  Fpa_node q;
+  if (s->blocks == NULL || s->blocks->used == FPA_BLOCK_NODES) {
+    Fpa_block b = get_fpa_block();
+    b->next = s->blocks;
+    s->blocks = b;
+  }
+  q = s->blocks->nodes + s->blocks->used++;
+  q->type = type;
+  q->left = q->right = NULL;
+  q->left_term = q->right_term = NULL;
+#ifdef FPA_DEBUG
+  q->path = NULL;
+#endif
+  return q;
+}  /* get_fpa_node */
+
 /*************
  *
  *  query_leaf_full - for testing only
@@ -642,13 +999,12 @@ void fpa_update(Term t, Fpa_index idx, Indexop op)
 
 #ifdef FPA_DEBUG
 static
-Fpa_state query_leaf_full(Ilist path, Fpa_trie index)
+Fpa_node query_leaf_full(struct path *p, Fpa_trie index, Fpa_state s)
 {
-  Fpa_trie n = fpa_trie_member(index, path);
-  Fpa_state q = get_fpa_state();
-  q->type = LEAF;
-  q->terms = (n == NULL ? NULL : n->terms);
-  q->path = copy_ilist(path);
+  Fpa_trie n = fpa_trie_member(index, p);
+  Fpa_node q = get_fpa_node(s, LEAF);
+  q->fpos = (n == NULL ? (struct fposition) {NULL, 0} : first_fpos(n->terms));
+  q->path = path_to_ilist(p);
   return q;
 }  /* query_leaf_full */
 #endif
@@ -660,21 +1016,20 @@ Fpa_state query_leaf_full(Ilist path, Fpa_trie index)
  *************/
 
 static
-Fpa_state query_leaf(Ilist path, Fpa_trie index)
+Fpa_node query_leaf(struct path *p, Fpa_trie index, Fpa_state s)
 {
   Fpa_trie n;
 
-  /* return query_leaf_full(path, index); */
+  /* return query_leaf_full(p, index, s); */
 
-  n = fpa_trie_member(index, path);
+  n = fpa_trie_member(index, p);
   if (n == NULL)
     return NULL;
   else {
-    Fpa_state q = get_fpa_state();
-    q->type = LEAF;
+    Fpa_node q = get_fpa_node(s, LEAF);
     q->fpos = first_fpos(n->terms);
 #ifdef FPA_DEBUG
-    q->path = copy_ilist(path);
+    q->path = path_to_ilist(p);
 #endif
     return q;
   }
@@ -687,11 +1042,10 @@ Fpa_state query_leaf(Ilist path, Fpa_trie index)
  *************/
 
 static
-Fpa_state query_intersect(Fpa_state q1, Fpa_state q2)
+Fpa_node query_intersect(Fpa_node q1, Fpa_node q2, Fpa_state s)
 {
   /* Assume neither is NULL. */
-  Fpa_state q = get_fpa_state();
-  q->type = INTERSECT;
+  Fpa_node q = get_fpa_node(s, INTERSECT);
   q->left = q1;
   q->right = q2;
   return q;
@@ -704,15 +1058,14 @@ Fpa_state query_intersect(Fpa_state q1, Fpa_state q2)
  *************/
 
 static
-Fpa_state query_union(Fpa_state q1, Fpa_state q2)
+Fpa_node query_union(Fpa_node q1, Fpa_node q2, Fpa_state s)
 {
   if (q1 == NULL)
     return q2;
   else if (q2 == NULL)
     return q1;
   else {
-    Fpa_state q = get_fpa_state();
-    q->type = UNION;
+    Fpa_node q = get_fpa_node(s, UNION);
     q->left = q1;
     q->right = q2;
     return q;
@@ -726,7 +1079,7 @@ Fpa_state query_union(Fpa_state q1, Fpa_state q2)
  *************/
 
 static
-Fpa_state query_special(Fpa_trie n)
+Fpa_node query_special(Fpa_trie n, Fpa_state s)
 {
   /* There are 2 kinds of nodes: argument position (1,2,3,...) and
    * symbol (a,b,f,g,h); the two types alternate in a path.  The
@@ -736,9 +1089,8 @@ Fpa_state query_special(Fpa_trie n)
    * have a path corresponding to node n.
    */
 
-  if (n->kids == NULL) {
-    Fpa_state q = get_fpa_state();
-    q->type = LEAF;
+  if (n->num_kids == 0) {
+    Fpa_node q = get_fpa_node(s, LEAF);
     q->fpos = first_fpos(n->terms);
 #ifdef FPA_DEBUG
     q->path = copy_ilist(n->path);
@@ -746,16 +1098,14 @@ Fpa_state query_special(Fpa_trie n)
     return q;
   }
   else {
-    Fpa_state q1 = NULL;
-    Fpa_trie pos_child;
-    for (pos_child=n->kids; pos_child!=NULL; pos_child=pos_child->next) {
+    Fpa_node q1 = NULL;
+    int i, j;
+    for (i = 0; i < n->num_kids; i++) {
+      Fpa_trie pos_child = n->kids[i];
       if (pos_child->label == 1) {
-	Fpa_trie sym_child;
-	for (sym_child=pos_child->kids;
-	     sym_child!=NULL;
-	     sym_child=sym_child->next) {
-	  Fpa_state q2 = query_special(sym_child);
-	  q1 = query_union(q1, q2);
+	for (j = 0; j < pos_child->num_kids; j++) {
+	  Fpa_node q2 = query_special(pos_child->kids[j], s);
+	  q1 = query_union(q1, q2, s);
 	}
       }
     }
@@ -765,26 +1115,47 @@ Fpa_state query_special(Fpa_trie n)
 
 /*************
  *
- *  zap_fpa_state (recursive)
+ *  new_fpa_state()
  *
- *  This (recursive) routine frees an Fpa_state.
- *  It should NOT be called if you retrieve all answers to
- *  a query, because the query tree is freed as it is processsed
- *  by fpa_next_answer().  This routine should be called only if
- *  you decide not to get all of the answers.
+ *************/
+
+static
+Fpa_state new_fpa_state(void)
+{
+  Fpa_state s = get_fpa_state();
+  s->root = NULL;
+  s->blocks = get_fpa_block();
+  return s;
+}  /* new_fpa_state */
+
+/*************
+ *
+ *  zap_fpa_state()
+ *
+ *  This routine frees a query, that is, all of the blocks of its
+ *  arena.  It should NOT be called if you retrieve all answers to
+ *  a query, because the query is freed when the last answer has
+ *  been returned by fpa_next_answer().  This routine should be
+ *  called only if you decide not to get all of the answers.
  *
  *************/
 
 static
-void zap_fpa_state(Fpa_state q)
+void zap_fpa_state(Fpa_state s)
 {
-  if (q != NULL) {
-    zap_fpa_state(q->left);
-    zap_fpa_state(q->right);
+  if (s != NULL) {
+    Fpa_block b = s->blocks;
+    while (b != NULL) {
+      Fpa_block next = b->next;
 #ifdef FPA_DEBUG
-    zap_ilist(q->path);
+      int i;
+      for (i = 0; i < b->used; i++)
+	zap_ilist(b->nodes[i].path);
 #endif
-    free_fpa_state(q);
+      free_fpa_block(b);
+      b = next;
+    }
+    free_fpa_state(s);
   }
 }  /* zap_fpa_state */
 
@@ -795,44 +1166,36 @@ void zap_fpa_state(Fpa_state q)
  *************/
 
 static
-Fpa_state union_commuted(Fpa_state q, Term t, Context c,
-			 Querytype type,
-			 struct path *p, int bound, Fpa_trie index)
+Fpa_node union_commuted(Fpa_node q, Term t, Context c,
+			Querytype type,
+			struct path *p, int bound, Fpa_trie index,
+			Fpa_state s)
 {
-  Fpa_state q1;
+  Fpa_node q1;
   int empty, i;
-#if 0
-  printf("enter union_commuted with\n");
-  p_fpa_state(q);
-#endif
   q1 = NULL;
   empty = 0;
 
   for (i = 0; i < 2 && !empty; i++) {
-    p->last->i = (i == 0 ? 2 : 1);
+    p->a[p->n-1] = (i == 0 ? 2 : 1);
     /* Skip this arg if VARIABLE && (UNIFY || INSTANCE). */
     if (!VARIABLE(ARG(t,i)) || type==GENERALIZATION ||
 	type==LADR_VARIANT || type==IDENTICAL) {
-      Fpa_state q2 = build_query(ARG(t,i), c, type, p, bound-1, index);
+      Fpa_node q2 = build_query(ARG(t,i), c, type, p, bound-1, index, s);
       if (q2 == NULL) {
 	empty = 1;
-	zap_fpa_state(q1);
-	q1 = NULL;
+	q1 = NULL;  /* its nodes stay in the arena */
       }
       else if (q1 == NULL)
 	q1 = q2;
       else
-	q1 = query_intersect(q1, q2);
+	q1 = query_intersect(q1, q2, s);
     }
   }
   if (q1 != NULL)
-    q1 = query_union(q, q1);
+    q1 = query_union(q, q1, s);
   else
     q1 = q;
-#if 0
-  printf("exit union_commuted with\n");
-  p_fpa_state(q1);
-#endif    
   return(q1);
 }  /* union_commuted */
 
@@ -875,90 +1238,83 @@ LADR_BOOL all_args_vars_in_context(Term t, Context c)
  *************/
 
 static
-Fpa_state build_query(Term t, Context c, Querytype type,
-		      struct path *p, int bound, Fpa_trie index)
+Fpa_node build_query(Term t, Context c, Querytype type,
+		     struct path *p, int bound, Fpa_trie index,
+		     Fpa_state s)
 {
   if (VARIABLE(t)) {
     int i = VARNUM(t);
     if (c != NULL && c->terms[i] != NULL)
-      return build_query(c->terms[i], c->contexts[i], type, p, bound, index);
+      return build_query(c->terms[i], c->contexts[i], type, p, bound, index,
+			 s);
     else if (type == UNIFY || type == INSTANCE) {
       fatal_error("build_query, variable.");
       return NULL;  /* to quiet compiler */
     }
     else {
-      Ilist save = path_push(p, 0);
-      Fpa_state q = query_leaf(p->first, index);
-      path_restore(p, save);
+      Fpa_node q;
+      p->a[p->n++] = 0;
+      q = query_leaf(p, index, s);
+      p->n--;
       return q;
     }
   }
   else {  /* non-variable */
-    Fpa_state q1 = NULL;
-    Ilist save1 = path_push(p, SYMNUM(t));
+    Fpa_node q1 = NULL;
+    p->a[p->n++] = SYMNUM(t);
 
     if (CONSTANT(t) || bound <= 0 || is_assoc_comm(SYMNUM(t))) {
-      q1 = query_leaf(p->first, index);
+      q1 = query_leaf(p, index, s);
     }
     else if ((type == INSTANCE || type == UNIFY) &&
 	     all_args_vars_in_context(t, c)) {
-      Fpa_trie n = fpa_trie_member(index, p->first);
-      q1 = (n == NULL ? NULL : query_special(n));
+      Fpa_trie n = fpa_trie_member(index, p);
+      q1 = (n == NULL ? NULL : query_special(n, s));
     }
     else {
-      Ilist save2 = path_push(p, 0);
       int empty = 0;
       int i;
+      p->n++;
       for (i = 0; i < ARITY(t) && !empty; i++) {
-	p->last->i = i+1;
+	p->a[p->n-1] = i+1;
 	/* Skip this arg if VARIABLE && (UNIFY || INSTANCE). */
 	if (!var_in_context(ARG(t,i),c) || type==GENERALIZATION ||
 	    type==LADR_VARIANT || type==IDENTICAL) {
-	  Fpa_state q2 = build_query(ARG(t,i), c, type, p, bound-1, index);
+	  Fpa_node q2 = build_query(ARG(t,i), c, type, p, bound-1, index, s);
 					      
 	  if (q2 == NULL) {
 	    empty = 1;
-	    zap_fpa_state(q1);
-	    q1 = NULL;
+	    q1 = NULL;  /* its nodes stay in the arena */
 	  }
 	  else if (q1 == NULL)
 	    q1 = q2;
 	  else
-	    q1 = query_intersect(q1, q2);
+	    q1 = query_intersect(q1, q2, s);
 	}
       }
       if (is_commutative(SYMNUM(t)) && !term_ident(ARG(t,0), ARG(t,1)))
-	q1 = union_commuted(q1, t, c, type, p, bound, index);
-      path_restore(p, save2);
+	q1 = union_commuted(q1, t, c, type, p, bound, index, s);
+      p->n--;
     }
     if (type == UNIFY || type == GENERALIZATION) {
-      Fpa_state q2;
-      p->last->i = 0;
-      q2 = query_leaf(p->first, index);
-      q1 = query_union(q1, q2);
+      Fpa_node q2;
+      p->a[p->n-1] = 0;
+      q2 = query_leaf(p, index, s);
+      q1 = query_union(q1, q2, s);
     }
-    path_restore(p, save1);
+    p->n--;
     return q1;
   }
 }  /* build_query */
 
 /*************
  *
- *    fprint_fpa_state (recursive)
+ *    fprint_fpa_node (recursive)
  *
  *************/
 
-/* DOCUMENTATION
-This (recursive) routine prints (to FILE *fp) an Fpa_state tree.
-The depth parameter should be 0 on the top call.
-This is an AND/OR tree, with lists of terms (ordered by FPA_ID)
-at the leaves.  If FPA_DEBUG is not defined in fpa.h, the
-paths corresponding to the leaves are not printed, and the
-tree is hard to understand without the paths.
-*/
-
-/* PUBLIC */
-void fprint_fpa_state(FILE *fp, Fpa_state q, int depth)
+static
+void fprint_fpa_node(FILE *fp, Fpa_node q, int depth)
 {
   int i;
   for (i = 0; i < depth; i++)
@@ -987,9 +1343,31 @@ void fprint_fpa_state(FILE *fp, Fpa_state q, int depth)
   }
   fflush(fp);
   if (q->type == UNION || q->type == INTERSECT) {
-    fprint_fpa_state(fp, q->right, depth+1);
-    fprint_fpa_state(fp, q->left, depth+1);
+    fprint_fpa_node(fp, q->right, depth+1);
+    fprint_fpa_node(fp, q->left, depth+1);
   }
+}  /* fprint_fpa_node */
+
+/*************
+ *
+ *    fprint_fpa_state
+ *
+ *************/
+
+/* DOCUMENTATION
+This routine prints (to FILE *fp) an Fpa_state tree.
+The depth parameter should be 0 on the top call.
+This is an AND/OR tree, with lists of terms (ordered by FPA_ID)
+at the leaves.  If FPA_DEBUG is not defined in fpa.h, the
+paths corresponding to the leaves are not printed, and the
+tree is hard to understand without the paths.
+*/
+
+/* PUBLIC */
+void fprint_fpa_state(FILE *fp, Fpa_state q, int depth)
+{
+  if (q != NULL && q->root != NULL)
+    fprint_fpa_node(fp, q->root, depth);
 }  /* fprint_fpa_state */
 
 /*************
@@ -1025,7 +1403,8 @@ void p_fpa_query(Term t, Querytype query_type, Fpa_index idx)
   Fpa_state q;
   char *s;
   struct path p;
-  p.first = p.last = NULL;
+  p.a = idx->path;
+  p.n = 0;
 
   switch (query_type) {
   case UNIFY:          s = "UNIFY         "; break;
@@ -1038,7 +1417,8 @@ void p_fpa_query(Term t, Querytype query_type, Fpa_index idx)
   printf("\n%s with term %u: ", s, (unsigned) FPA_ID(t)); p_term(t);
   fflush(stdout);
 
-  q = build_query(t, NULL, query_type, &p, idx->depth, idx->root);
+  q = new_fpa_state();
+  q->root = build_query(t, NULL, query_type, &p, idx->depth, idx->root, q);
   p_fpa_state(q);
   zap_fpa_state(q);
   
@@ -1051,30 +1431,24 @@ void p_fpa_query(Term t, Querytype query_type, Fpa_index idx)
  *    Get the first or next term that satisfies a unification condition.
  *    (Unification conditions are provided by build_query.)
  *    `max' should be FPA_ID_MAX on top calls.  A return of NULL indicates
- *    that there are none or no more terms that satisfy (and the tree has
- *    been deallocated).  If you want to stop getting terms before a NULL
- *    is returned, then please deallocate the tree with zap_fpa_state(tree).
- *
- *    Warning: a return of NULL means that the tree has been deallocated.
+ *    that there are none or no more terms that satisfy, and the node
+ *    should not be visited again.  (The nodes belong to the query's
+ *    arena, so nothing is freed here.)
  *
  *************/
 
 static
-Term next_term(Fpa_state q, FPA_ID_TYPE max)
+Term next_term(Fpa_node q, FPA_ID_TYPE max)
 {
   BUMP_NEXT_CALLS;
   if (q == NULL)
     return NULL;
   else if (q->type == LEAF) {
-    Term t = FTERM(q->fpos);
-    while (t != NULL && FPA_ID(t) > max) {
-      q->fpos = next_fpos(q->fpos);
-      t = FTERM(q->fpos);
-    }
-    if (t == NULL) {
-      zap_fpa_state(q);
+    Term t;
+    q->fpos = fpos_skip(q->fpos, max);  /* gallop past terms > max */
+    t = FTERM(q->fpos);
+    if (t == NULL)
       return NULL;
-    }
     else {
       q->fpos = next_fpos(q->fpos);
       return t;
@@ -1095,14 +1469,8 @@ Term next_term(Fpa_state q, FPA_ID_TYPE max)
       else
 	t2 = next_term(q->right, FPA_ID(t1));
     }
-    if (t1 == NULL || t2 == NULL) {
-      if (t1 == NULL)
-	q->left = NULL;
-      if (t2 == NULL)
-	q->right = NULL;
-      zap_fpa_state(q);
+    if (t1 == NULL || t2 == NULL)
       return NULL; 
-    }
     else
       return t1;
   }
@@ -1139,14 +1507,8 @@ Term next_term(Fpa_state q, FPA_ID_TYPE max)
      * non-NULL (and different), save the smaller for the next
      * call, and return the larger.
      */
-    if (t1 == NULL) {
-      if (t2 == NULL) {
-	zap_fpa_state(q);
-	return NULL;
-      }
-      else
-	return t2;
-    }
+    if (t1 == NULL)
+      return t2;
     else if (t2 == NULL)
       return t1;
     else if (t1 == t2)
@@ -1173,13 +1535,16 @@ This routine extracts and returns the next answer term
 from an Fpa_state tree.  If there
 are no more answers, NULL is returned, and the tree is freed.
 If you wish to stop getting answers before NULL is returned,
-call zap_fpa_state(q) to free the Fpa_state tree.
+call fpa_cancel(q) to free the Fpa_state tree.
 */
 
 /* PUBLIC */
 Term fpa_next_answer(Fpa_state q)
 {
-  return next_term(q, FPA_ID_MAX);
+  Term t = (q == NULL ? NULL : next_term(q->root, FPA_ID_MAX));
+  if (t == NULL)
+    zap_fpa_state(q);
+  return t;
 }  /* fpa_next_answer */
 
 /*************
@@ -1193,7 +1558,7 @@ This routine extracts and returns the first answer term
 from an Fpa_state tree.  If there
 are no more answers, NULL is returned, and the tree is freed.
 If you wish to stop getting answers before NULL is returned,
-call zap_fpa_state(q) to free the Fpa_state tree.
+call fpa_cancel(q) to free the Fpa_state tree.
 <P>
 The query types are
 UNIFY, INSTANCE, GENERALIZATION, LADR_VARIANT, and IDENTICAL.
@@ -1207,11 +1572,18 @@ Term fpa_first_answer(Term t, Context c, Querytype query_type,
 		      Fpa_index idx, Fpa_state *ppos)
 {
   struct path p;
-  p.first = p.last = NULL;
-
-  *ppos = build_query(t, c, query_type, &p, idx->depth, idx->root);
-  
-  return fpa_next_answer(*ppos);
+  Fpa_state q = new_fpa_state();
+  p.a = idx->path;
+  p.n = 0;
+
+  q->root = build_query(t, c, query_type, &p, idx->depth, idx->root, q);
+  if (q->root == NULL) {
+    zap_fpa_state(q);
+    *ppos = NULL;
+    return NULL;
+  }
+  *ppos = q;
+  return fpa_next_answer(q);
 }  /* fpa_first_answer */
 
 /*************
@@ -1240,16 +1612,13 @@ void fpa_cancel(Fpa_state q)
 static
 void zap_fpa_trie(Fpa_trie n)
 {
-  Fpa_trie k, prev;
+  int i;
 
-  k = n->kids;
-  while (k != NULL) {
-    prev = k;
-    k = k->next;
-    zap_fpa_trie(prev);
-  }
+  for (i = 0; i < n->num_kids; i++)
+    zap_fpa_trie(n->kids[i]);
 
-  zap_fpalist(n->terms);
+  if (n->terms != NULL)
+    zap_fpalist(n->terms);
 
 #ifdef FPA_DEBUG
   zap_ilist(n->path);
@@ -1273,6 +1642,7 @@ frees all of the associated memory.
 void zap_fpa_index(Fpa_index idx)
 {
   zap_fpa_trie(idx->root);
+  free(idx->path);
   free_fpa_index(idx);
 }  /* zap_fpa_index */
 
@@ -1289,9 +1659,48 @@ This Boolean routine checks if an FPA/Path index is empty.
 /* PUBLIC */
 LADR_BOOL fpa_empty(Fpa_index idx)
 {
-  return (idx == NULL ? TRUE : idx->root->kids == NULL);
+  return (idx == NULL ? TRUE : idx->root->num_kids == 0);
 }  /* fpa_empty */
 
+/*************
+ *
+ *   fpa_trie_size()
+ *
+ *************/
+
+static
+void fpa_trie_size(Fpa_trie p, int *nodes, int *mem)
+{
+  int i;
+  (*nodes)++;
+  *mem += PTRS_FPA_TRIE + p->kids_size;
+  if (p->terms != NULL)
+    *mem += fpalist_mem(p->terms);
+  for (i = 0; i < p->num_kids; i++)
+    fpa_trie_size(p->kids[i], nodes, mem);
+}  /* fpa_trie_size */
+
+/*************
+ *
+ *   fpa_index_size()
+ *
+ *************/
+
+/* DOCUMENTATION
+This routine finds the number of nodes in the trie of an Fpa_index and
+the memory (in pointers, as with get_mem()) used by the index,
+including the FPA lists.
+*/
+
+/* PUBLIC */
+void fpa_index_size(Fpa_index idx, int *nodes, int *mem)
+{
+  *nodes = 0;
+  *mem = PTRS_FPA_INDEX + PTRS((2 * (idx->depth < 0 ? 0 : idx->depth) + 1) *
+			       sizeof(int));
+  fpa_trie_size(idx->root, nodes, mem);
+}  /* fpa_index_size */
+
 /*************
  *
  *   fpa_density()
@@ -1301,9 +1710,9 @@ LADR_BOOL fpa_empty(Fpa_index idx)
 static
 void fpa_density(Fpa_trie p)
 {
-  Fpa_trie q;
-  for (q = p->kids; q; q = q->next)
-    fpa_density(q);
+  int i;
+  for (i = 0; i < p->num_kids; i++)
+    fpa_density(p->kids[i]);
   if (p->terms != NULL) {
     printf("Fpa_list: chunks=%d, size=%d, terms=%d\n",
 	   p->terms->num_chunks,
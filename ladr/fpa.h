@@ -51,6 +51,7 @@ Commutative/symmetric (C) operations are handled.
 
 typedef struct fpa_index * Fpa_index;
 typedef struct fpa_state * Fpa_state;
+typedef struct fpa_bulk * Fpa_bulk;
 
 /* End of public definitions */
 
@@ -70,8 +71,14 @@ void p_fpa_index(Fpa_index idx);
 
 Fpa_index fpa_init_index(int depth);
 
+void assign_fpa_id(Term t);
+
 void fpa_update(Term t, Fpa_index idx, Indexop op);
 
+Fpa_bulk fpa_bulk_sort(Term *terms, int n, Fpa_index idx);
+
+void fpa_bulk_build(Fpa_index idx, Fpa_bulk b);
+
 void fprint_fpa_state(FILE *fp, Fpa_state q, int depth);
 
 void p_fpa_state(Fpa_state q);
@@ -89,6 +96,8 @@ void zap_fpa_index(Fpa_index idx);
 
 LADR_BOOL fpa_empty(Fpa_index idx);
 
+void fpa_index_size(Fpa_index idx, int *nodes, int *mem);
+
 void p_fpa_density(Fpa_index idx);
 
 unsigned mega_next_calls(void);
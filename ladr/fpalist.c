@@ -334,6 +334,47 @@ void fpalist_insert(Fpa_list p, Term t)
   }
 }  /* fpalist_insert */
 
+/*************
+ *
+ *   fpalist_build()
+ *
+ *************/
+
+/* DOCUMENTATION
+This routine makes an FPA list of n terms (n > 0), given in decreasing
+order, all at once.  It is like inserting the terms in increasing
+order, but the chunksize is the final one from the start, and
+the chunks are full, except perhaps the first.
+*/
+
+/* PUBLIC */
+Fpa_list fpalist_build(Term *terms, int n)
+{
+  Fpa_list p = get_fpa_list();
+  Fpa_chunk *next = &(p->chunks);
+  int size = F_INITIAL_SIZE;
+  int i = 0;
+
+  while (size < F_MAX_SIZE && (n + size - 1) / size >= size)
+    size *= 2;
+  p->chunksize = size;
+
+  while (i < n) {
+    /* The first chunk gets the remainder. */
+    int m = (i == 0 && n % size != 0 ? n % size : size);
+    Fpa_chunk f = get_fpa_chunk(size);
+    int j;
+    for (j = size - m; j < size; j++)
+      f->d[j] = terms[i++];
+    f->n = m;
+    p->num_chunks++;
+    *next = f;
+    next = &(f->next);
+  }
+  p->num_terms = n;
+  return p;
+}  /* fpalist_build */
+
 /*************
  *
  *   consolidate() - try to join f and f->next; not recursive
@@ -461,6 +502,67 @@ struct fposition next_fpos(struct fposition p)
   }
 }  /* next_fpos */
 
+/*************
+ *
+ *   fpos_skip()
+ *
+ *************/
+
+/* DOCUMENTATION
+Starting at position p, return the first position whose term has
+FPA_ID <= max (or the end position if there is none).  This is
+equivalent to calling next_fpos() until the term is small enough,
+but it skips whole chunks by looking at their last (smallest) terms,
+and inside a chunk it gallops (steps of 1, 2, 4, ...) and then does
+a binary search.  It is used when intersecting FPA lists, where
+one list frequently has to catch up with a much smaller ID.
+*/
+
+/* PUBLIC */
+struct fposition fpos_skip(struct fposition p, FPA_ID_TYPE max)
+{
+  Fpa_chunk f = p.f;
+  int lo, hi, step;
+
+  if (f == NULL || FPA_ID(f->d[p.i]) <= max)
+    return p;  /* the usual case */
+
+  /* Skip chunks whose smallest term is still too big. */
+
+  lo = p.i;
+  while (FPA_ID(f->d[f->size-1]) > max) {
+    f = f->next;
+    if (f == NULL)
+      return (struct fposition) {NULL, 0};
+    lo = f->size - f->n;
+  }
+
+  /* Now d[size-1] <= max; gallop from lo to bracket the answer. */
+
+  if (FPA_ID(f->d[lo]) <= max)
+    return (struct fposition) {f, lo};
+  step = 1;
+  hi = lo + 1;
+  while (hi < f->size - 1 && FPA_ID(f->d[hi]) > max) {
+    lo = hi;
+    step *= 2;
+    hi = lo + step;
+    if (hi > f->size - 1)
+      hi = f->size - 1;
+  }
+
+  /* Invariant: d[lo] > max and d[hi] <= max. */
+
+  while (hi - lo > 1) {
+    int mid = lo + (hi - lo) / 2;
+    if (FPA_ID(f->d[mid]) > max)
+      lo = mid;
+    else
+      hi = mid;
+  }
+  return (struct fposition) {f, hi};
+}  /* fpos_skip */
+
 /*************
  *
  *   zap_fpa_chunks()
@@ -510,6 +612,26 @@ LADR_BOOL fpalist_empty(Fpa_list p)
   return !p || p->chunks == NULL;
 }  /* fpalist_empty */
 
+/*************
+ *
+ *   fpalist_mem()
+ *
+ *************/
+
+/* DOCUMENTATION
+Return the memory (in pointers, as with get_mem()) used by an FPA list.
+*/
+
+/* PUBLIC */
+int fpalist_mem(Fpa_list p)
+{
+  int n = PTRS_FPA_LIST;
+  Fpa_chunk c;
+  for (c = p->chunks; c; c = c->next)
+    n += PTRS_FPA_CHUNK + c->size;
+  return n;
+}  /* fpalist_mem */
+
 /*************
  *
  *   p_fpa_list()
@@ -94,18 +94,24 @@ void p_fpalist_mem();
 
 void fpalist_insert(Fpa_list p, Term t);
 
+Fpa_list fpalist_build(Term *terms, int n);
+
 void fpalist_delete(Fpa_list p, Term t);
 
 struct fposition first_fpos(Fpa_list f);
 
 struct fposition next_fpos(struct fposition p);
 
+struct fposition fpos_skip(struct fposition p, FPA_ID_TYPE max);
+
 void zap_fpa_chunks(Fpa_chunk p);
 
 void zap_fpalist(Fpa_list p);
 
 LADR_BOOL fpalist_empty(Fpa_list p);
 
+int fpalist_mem(Fpa_list p);
+
 void p_fpa_list(Fpa_chunk c);
 
 #endif  /* conditional compilation of whole file */
@@ -119,8 +119,10 @@ void put_term_to_ibuf(Ibuffer ibuf, Term t)
  *
  *************/
 
+/* If symmap is not NULL, symbol a in the buffer is symmap[a]. */
+
 static
-Term get_term_from_ibuf(Ibuffer ibuf)
+Term get_term_from_ibuf(Ibuffer ibuf, int *symmap, int map_size)
 {
   int a = ibuf_xread(ibuf);
   if (a <= 0)
@@ -128,14 +130,17 @@ Term get_term_from_ibuf(Ibuffer ibuf)
   else {
     Term t;
     int i;
-    int arity = sn_to_arity(a);
+    int arity;
+    if (symmap != NULL)
+      a = (a < map_size ? symmap[a] : 0);
+    arity = sn_to_arity(a);
     if (arity == -1) {
       printf("bad symnum: %d\n", a);
       fatal_error("get_term_from_ibuf, symbol not in symbol table");
     }
     t = get_rigid_term_dangerously(a, arity);
     for (i = 0; i < ARITY(t); i++)
-      ARG(t,i) = get_term_from_ibuf(ibuf);
+      ARG(t,i) = get_term_from_ibuf(ibuf, symmap, map_size);
     return t;
   }
 }  /* get_term_from_ibuf */
@@ -310,6 +315,28 @@ void put_clause_to_ibuf(Ibuffer ibuf, Topform c)
 
 /* PUBLIC */
 Topform get_clause_from_ibuf(Ibuffer ibuf)
+{
+  return get_mapped_clause_from_ibuf(ibuf, NULL, 0);
+}  /* get_clause_from_ibuf */
+
+/*************
+ *
+ *   get_mapped_clause_from_ibuf()
+ *
+ *************/
+
+/* DOCUMENTATION
+This is like get_clause_from_ibuf(), except that the clause
+was put into the Ibuffer with a different symbol table (for example,
+by another process):  symbol n in the Ibuffer is symbol
+symmap[n] here (0 for none), for 0 < n < map_size.
+The flags on the atoms are not restored (they are left clear),
+because they belong to the other process (its termflag numbers
+and its term ordering).
+*/
+
+/* PUBLIC */
+Topform get_mapped_clause_from_ibuf(Ibuffer ibuf, int *symmap, int map_size)
 {
   /* id is_formula weight number-of-justs justs lits/atts [atomflags] */
 
@@ -318,7 +345,7 @@ Topform get_clause_from_ibuf(Ibuffer ibuf)
   int weight = ibuf_xread(ibuf);
   Just j = get_just_from_ibuf(ibuf);
 
-  Term t = get_term_from_ibuf(ibuf);
+  Term t = get_term_from_ibuf(ibuf, symmap, map_size);
   Topform c = term_to_topform(t, is_formula);
   zap_term(t);
 
@@ -329,11 +356,14 @@ Topform get_clause_from_ibuf(Ibuffer ibuf)
 
   if (!is_formula) {
     Literals l;
-    for (l = c->literals; l; l = l->next)
-      l->atom->private_flags = ibuf_xread(ibuf);
+    for (l = c->literals; l; l = l->next) {
+      int flags = ibuf_xread(ibuf);
+      if (symmap == NULL)
+	l->atom->private_flags = flags;
+    }
   }
   return c;
-}  /* get_clause_from_ibuf */
+}  /* get_mapped_clause_from_ibuf */
 
 /*************
  *
@@ -35,6 +35,8 @@ void put_clause_to_ibuf(Ibuffer ibuf, Topform c);
 
 Topform get_clause_from_ibuf(Ibuffer ibuf);
 
+Topform get_mapped_clause_from_ibuf(Ibuffer ibuf, int *symmap, int map_size);
+
 void check_ibuf_clause(Topform c);
 
 #endif  /* conditional compilation of whole file */
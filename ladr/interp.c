@@ -18,6 +18,11 @@
 
 #include "interp.h"
 #include "ioutil.h"
+#include "nonport.h"
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
 
 /* TO DO:
    1. Get rid of arity limits.
@@ -34,7 +39,8 @@ struct interp {
    * print symbol can be obtained from the symbol number.
    */
   int num_tables;      /* number of tables */
-  int **tables;
+  LADR_BOOL packed;    /* entries are unsigned chars (see PACKED_MAX_SIZE) */
+  void **tables;
   int *arities;        /* arity of tables[i] */
   int *types;          /* type of tables[i]: FUNCTION or RELATION */
 
@@ -60,6 +66,31 @@ struct interp {
 
 #define MAX_VARS_EVAL 100
 
+/* If the domain size is at most PACKED_MAX_SIZE, the tables are packed,
+   one unsigned char per entry, with PACKED_UNDEFINED for an undefined
+   entry (-1); otherwise an entry is an int.  A packed table has
+   PACKED_PAD extra bytes, so that a 4-byte read (an AVX2 gather) at
+   any entry stays inside the table. */
+
+#define PACKED_MAX_SIZE  255
+#define PACKED_UNDEFINED 255
+#define PACKED_PAD       3
+
+/* A binary stream of interpretations (see fwrite_interp_bin_header())
+   is a header with the signature, then a record for each interp. */
+
+#define BIN_MAGIC         "\211LADRint"
+#define BIN_MAGIC_LENGTH  8
+#define BIN_VERSION       1
+
+struct interp_bin {
+  int num_syms;
+  int *symnums;        /* symbols, in the order of the tables in a record */
+  int *arities;
+  int *types;
+  int max_symnum;
+};
+
 /* statistics */
 
 static long unsigned Iso_checks = 0;
@@ -147,22 +178,6 @@ void p_interp_mem()
  *  end of memory management
  */
 
-/*************
- *
- *   trivial_permutation()
- *
- *************/
-
-static
-int *trivial_permutation(int n)
-{
-  int *p = malloc(sizeof(int) * n);
-  int i;
-  for (i = 0; i < n; i++)
-    p[i] = i;
-  return p;
-}  /* trivial_permutation */
-
 /*************
  *
  *   int_power()
@@ -193,6 +208,70 @@ int int_power(int n, int exp)
   }
 }  /* int_power */
 
+/*************
+ *
+ *   new_table()
+ *
+ *   Allocate a table of n entries (packed or not, as p is).
+ *
+ *************/
+
+static
+void *new_table(Interp p, int n)
+{
+  if (p->packed)
+    return malloc(n + PACKED_PAD);
+  else
+    return malloc(n * sizeof(int));
+}  /* new_table */
+
+/*************
+ *
+ *   table_entry()
+ *
+ *************/
+
+static
+int table_entry(Interp p, void *table, int j)
+{
+  if (p->packed) {
+    int v = ((unsigned char *) table)[j];
+    return v == PACKED_UNDEFINED ? -1 : v;
+  }
+  else
+    return ((int *) table)[j];
+}  /* table_entry */
+
+/*************
+ *
+ *   set_table_entry()
+ *
+ *************/
+
+static
+void set_table_entry(Interp p, void *table, int j, int v)
+{
+  if (p->packed)
+    ((unsigned char *) table)[j] = (v == -1 ? PACKED_UNDEFINED : v);
+  else
+    ((int *) table)[j] = v;
+}  /* set_table_entry */
+
+/*************
+ *
+ *   table_bytes()
+ *
+ *   The number of bytes in the entries of the table for symbol f.
+ *
+ *************/
+
+static
+size_t table_bytes(Interp p, int f)
+{
+  size_t n = int_power(p->size, p->arities[f]);
+  return p->packed ? n : n * sizeof(int);
+}  /* table_bytes */
+
 /*************
  *
  *   compile_interp()
@@ -222,7 +301,7 @@ Interp compile_interp(Term t, LADR_BOOL allow_incomplete)
   int number_of_ops, domain_size, arity;
   int i, j, n, symnum, val, max, rc;
   LADR_BOOL function = FALSE;
-  int *table; 
+  void *table;
   Term comments = NULL;
   Term size = NULL;
   Term operations = NULL;
@@ -261,6 +340,7 @@ Interp compile_interp(Term t, LADR_BOOL allow_incomplete)
   p->t = copy_term(t);
   p->comments = copy_term(comments);
   p->size = domain_size;
+  p->packed = (domain_size <= PACKED_MAX_SIZE);
   p->num_tables = max + 100 + 1;  /* allow 100 extra in case of new symbols */
 
   p->occurrences = malloc(domain_size * sizeof(int));
@@ -272,7 +352,7 @@ Interp compile_interp(Term t, LADR_BOOL allow_incomplete)
     p->profile[i] = NULL;
   }
 
-  p->tables  = malloc(p->num_tables * sizeof(int *));
+  p->tables  = malloc(p->num_tables * sizeof(void *));
   p->types   = malloc(p->num_tables * sizeof(int));
   p->arities = malloc(p->num_tables * sizeof(int));
 
@@ -310,7 +390,7 @@ Interp compile_interp(Term t, LADR_BOOL allow_incomplete)
 
     p->types[symnum] = (function ? FUNCTION : RELATION);
     p->arities[symnum] = arity;
-    p->tables[symnum] = malloc(n * sizeof(int));
+    p->tables[symnum] = new_table(p, n);
     table = p->tables[symnum];
 
     for (j = 0; j < n; j++, lst = ARG(lst,1)) {
@@ -318,7 +398,7 @@ Interp compile_interp(Term t, LADR_BOOL allow_incomplete)
       rc = str_to_int(str, &val);
       if (!rc) {
 	if (allow_incomplete && str_ident(str, "-")) {
-	  table[j] = -1;
+	  set_table_entry(p, table, j, -1);
 	  p->incomplete = TRUE;
 	}
 	else
@@ -329,7 +409,7 @@ Interp compile_interp(Term t, LADR_BOOL allow_incomplete)
       else if (!function && (val < 0 || val > 1))
 	fatal_error("compile_interp, relation element out of range.");
       else {
-	table[j] = val;
+	set_table_entry(p, table, j, val);
 	if (function)
 	  p->occurrences[val]++;
       }
@@ -452,18 +532,18 @@ void fprint_interp_tex(FILE *fp, Interp p)
   fprintf(fp, "\\begin{table}[H]  \\centering %% size %d\n", p->size);
   
   for (i = 0; i < p->num_tables; i++) {  /* arity 0 */
-    int *table = p->tables[i];
+    void *table = p->tables[i];
     int arity = sn_to_arity(i);
     if (table != NULL && arity == 0) {
       if (first)
 	first = FALSE;
       else
 	fprintf(fp, " \\hspace{.5cm}\n");
-      fprintf(fp, "%s: %d", sn_to_str(i), table[0]);
+      fprintf(fp, "%s: %d", sn_to_str(i), table_entry(p, table, 0));
     }
   }
   for (i = 0; i < p->num_tables; i++) {  /* arity 1 */
-    int *table = p->tables[i];
+    void *table = p->tables[i];
     int arity = sn_to_arity(i);
     if (table != NULL && arity == 1) {
       int j;
@@ -479,12 +559,12 @@ void fprint_interp_tex(FILE *fp, Interp p)
       for (j = 0; j < n; j++)
 	fprintf(fp, "%d%s", j, j < n-1 ? " & " : "\\\\\n\\hline\n   & ");
       for (j = 0; j < n; j++)
-	fprintf(fp, "%d%s", table[j], j < n-1 ? " & " : "\n");
+	fprintf(fp, "%d%s", table_entry(p, table, j), j < n-1 ? " & " : "\n");
       fprintf(fp, "\\end{tabular}");
     }
   }
   for (i = 0; i < p->num_tables; i++) {  /* arity 2 */
-    int *table = p->tables[i];
+    void *table = p->tables[i];
     int arity = sn_to_arity(i);
     if (table != NULL && arity == 2) {
       int j, k;
@@ -504,7 +584,7 @@ void fprint_interp_tex(FILE *fp, Interp p)
 	for (k = 0; k < n; k++) {
 	  fprintf(fp,
 		  "%d%s",
-		  table[(n*j) + k], 
+		  table_entry(p, table, (n*j) + k), 
 		  k < n-1 ? " & " : (j < n-1 ? " \\\\\n" : "\n"));
 	}
       }
@@ -512,7 +592,7 @@ void fprint_interp_tex(FILE *fp, Interp p)
     }
   }
   for (i = 0; i < p->num_tables; i++) {  /* arity > 2 */
-    int *table = p->tables[i];
+    void *table = p->tables[i];
     int arity = sn_to_arity(i);
     if (table != NULL && arity > 2) {
       fprintf(fp, "\n\n%% table for arity %d %s %s not printed.\n\n",
@@ -576,19 +656,19 @@ void fprint_interp_xml(FILE *fp, Interp p)
   fprintf(fp, ">\n");
 
   for (i = 0; i < p->num_tables; i++) {  /* arity 0 */
-    int *table = p->tables[i];
+    void *table = p->tables[i];
     int arity = sn_to_arity(i);
     char *type = p->types[i] == FUNCTION ? "function" : "relation";
     if (table != NULL && arity == 0) {
       fprintf(fp, "\n    <op0 type=\"%s\">\n", type);
       fprintf(fp, "      <sym><![CDATA[%s]]></sym>\n", sn_to_str(i));
-      fprintf(fp, "      <v>%d</v>\n", table[0]);
+      fprintf(fp, "      <v>%d</v>\n", table_entry(p, table, 0));
       fprintf(fp, "    </op0>\n");
     }
   }
   
   for (i = 0; i < p->num_tables; i++) {  /* arity 1 */
-    int *table = p->tables[i];
+    void *table = p->tables[i];
     int arity = sn_to_arity(i); 
     char *type = p->types[i] == FUNCTION ? "function" : "relation";
     if (table != NULL && arity == 1) {
@@ -602,13 +682,13 @@ void fprint_interp_xml(FILE *fp, Interp p)
 
       fprintf(fp, "        <row> ");
       for (j = 0; j < n; j++)
-	fprintf(fp, "<v>%d</v>", table[j]);
+	fprintf(fp, "<v>%d</v>", table_entry(p, table, j));
       fprintf(fp, "</row>\n");
       fprintf(fp, "    </op1>\n");
     }
   }
   for (i = 0; i < p->num_tables; i++) {  /* arity 2 */
-    int *table = p->tables[i];
+    void *table = p->tables[i];
     int arity = sn_to_arity(i);
     char *type = p->types[i] == FUNCTION ? "function" : "relation";
     if (table != NULL && arity == 2) {
@@ -623,14 +703,14 @@ void fprint_interp_xml(FILE *fp, Interp p)
       for (j = 0; j < n; j++) {
 	fprintf(fp, "        <row><i>%d</i> ", j);
 	for (k = 0; k < n; k++)
-	  fprintf(fp, "<v>%d</v>", table[(n*j) + k]);
+	  fprintf(fp, "<v>%d</v>", table_entry(p, table, (n*j) + k));
 	fprintf(fp, "</row>\n");
       }
       fprintf(fp, "    </op2>\n");
     }
   }
   for (i = 0; i < p->num_tables; i++) {  /* arity > 2 */
-    int *table = p->tables[i];
+    void *table = p->tables[i];
     int arity = sn_to_arity(i);
     char *type = p->types[i] == FUNCTION ? "function" : "relation";
     if (table != NULL && arity > 2) {
@@ -645,7 +725,7 @@ void fprint_interp_xml(FILE *fp, Interp p)
 	fprintf(fp, "      <tupval> <tup>");
 	for (k = 0; k < arity; k++)
 	  fprintf(fp, "<i>%d</i>", a[k]);
-	fprintf(fp, "</tup>   <v>%d</v> </tupval>\n", table[j]);
+	fprintf(fp, "</tup>   <v>%d</v> </tupval>\n", table_entry(p, table, j));
       }
       free(a);
       fprintf(fp, "    </opn>\n");
@@ -680,7 +760,7 @@ void fprint_interp_standard(FILE *fp, Interp p)
     fprintf(fp, "[], [\n");
   
   for (i = 0; i < p->num_tables; i++) {
-    int *table = p->tables[i];
+    void *table = p->tables[i];
     if (table != NULL) {
       int j, n;
       int arity = sn_to_arity(i);
@@ -695,10 +775,10 @@ void fprint_interp_standard(FILE *fp, Interp p)
 
       for (j = 0, n = 1; j < arity; j++, n = n * p->size);
       for (j = 0; j < n; j++) {
-	if (table[j] == -1)
+	if (table_entry(p, table, j) == -1)
 	  fprintf(fp, "-%s"           , j == n-1 ? "])" : ",");
 	else
-	  fprintf(fp, "%d%s", table[j], j == n-1 ? "])" : ",");
+	  fprintf(fp, "%d%s", table_entry(p, table, j), j == n-1 ? "])" : ",");
       }
 
       /* ugly: decide if there are any more symbols */
@@ -738,7 +818,7 @@ void fprint_interp_standard2(FILE *fp, Interp p)
     fprintf(fp, "[], [\n");
   
   for (i = 0; i < p->num_tables; i++) {
-    int *table = p->tables[i];
+    void *table = p->tables[i];
     if (table != NULL) {
       int j, n;
       int arity = sn_to_arity(i);
@@ -755,12 +835,12 @@ void fprint_interp_standard2(FILE *fp, Interp p)
 
       for (j = 0, n = 1; j < arity; j++, n = n * p->size);
       for (j = 0; j < n; j++) {
-	if (table[j] == -1)
+	if (table_entry(p, table, j) == -1)
 	  fprintf(fp, w ? " -%s" : "-%s",
 		  j == n-1 ? "])" : ",");
 	else
 	  fprintf(fp, w ? "%2d%s" : "%d%s",
-		  table[j],
+		  table_entry(p, table, j),
 		  j == n-1 ? "])" : ",");
 	if (arity == 2 && (j+1) % p->size == 0 && j != n-1)
 	  fprintf(fp, "\n        ");
@@ -797,18 +877,18 @@ static void portable_indent(FILE *fp, int n)
  *************/
 
 static
-void portable_recurse(FILE *fp,
-		       int arity, int domain_size,
-		       int *table, int *idx_ptr, int depth)
+void portable_recurse(FILE *fp, Interp p, int arity,
+		       void *table, int *idx_ptr, int depth)
 {
+  int domain_size = p->size;
   if (arity == 0)
-    fprintf(fp, "%2d", table[(*idx_ptr)++]);
+    fprintf(fp, "%2d", table_entry(p, table, (*idx_ptr)++));
   else {
     int i;
     portable_indent(fp, depth);
     fprintf(fp, "[%s", arity > 1 ? "\n" : "");
     for (i = 0; i < domain_size; i++) {
-      portable_recurse(fp, arity-1, domain_size, table, idx_ptr, depth+1);
+      portable_recurse(fp, p, arity-1, table, idx_ptr, depth+1);
       if (i < domain_size-1)
 	fprintf(fp, ",");
       fprintf(fp, "%s", arity > 1 ? "\n" : "");
@@ -848,7 +928,7 @@ void fprint_interp_portable(FILE *fp, Interp p)
   fprintf(fp, "    [\n");
   
   for (i = 0; i < p->num_tables; i++) {
-    int *table = p->tables[i];
+    void *table = p->tables[i];
     if (table != NULL) {
       int j;
       int arity = sn_to_arity(i);
@@ -861,7 +941,7 @@ void fprint_interp_portable(FILE *fp, Interp p)
       if (arity == 0)
 	portable_indent(fp, 1);
 
-      portable_recurse(fp, arity, p->size, table, &idx, 1);
+      portable_recurse(fp, p, arity, table, &idx, 1);
 
       fprintf(fp, "\n      ]");
 
@@ -922,7 +1002,7 @@ void fprint_interp_cooked(FILE *fp, Interp p)
   fprintf(fp, "\n%% Interpretation of size %d\n", p->size);
 
   for (i = 0; i < p->num_tables; i++) {
-    int *table = p->tables[i];
+    void *table = p->tables[i];
     LADR_BOOL function = (p->types[i] == FUNCTION);
     if (table != NULL) {
       int j, n;
@@ -930,10 +1010,10 @@ void fprint_interp_cooked(FILE *fp, Interp p)
 
       fprintf(fp, "\n");
       if (arity == 0) {
-	if (table[0] == -1)
+	if (table_entry(p, table, 0) == -1)
 	  fprintf(fp, "%s = -.\n", sn_to_str(i));
 	else
-	  fprintf(fp, "%s = %d.\n", sn_to_str(i), table[0]);
+	  fprintf(fp, "%s = %d.\n", sn_to_str(i), table_entry(p, table, 0));
       }
       else {
 	int *a = malloc(arity * sizeof(int));
@@ -945,13 +1025,14 @@ void fprint_interp_cooked(FILE *fp, Interp p)
 	    fprintf(fp, "%s(", sn_to_str(i));
 	    for (k = 0; k < arity; k++)
 	      fprintf(fp, "%d%s", a[k], k == arity-1 ? "" : ",");
-	    if (table[j] == -1)
+	    if (table_entry(p, table, j) == -1)
 	      fprintf(fp, ") = -.\n");
 	    else
-	      fprintf(fp, ") = %d.\n", table[j]);
+	      fprintf(fp, ") = %d.\n", table_entry(p, table, j));
 	  }
 	  else {
-	    fprintf(fp, "%s %s(", table[j] ? " " : not_sym(), sn_to_str(i));
+	    fprintf(fp, "%s %s(",
+		    table_entry(p, table, j) ? " " : not_sym(), sn_to_str(i));
 	    for (k = 0; k < arity; k++)
 	      fprintf(fp, "%d%s", a[k], k == arity-1 ? "" : ",");
 	    fprintf(fp, ").\n");
@@ -993,7 +1074,7 @@ void fprint_interp_tabular(FILE *fp, Interp p)
   fprintf(fp, "\n%% Interpretation of size %d\n", p->size);
 
   for (f = 0; f < p->num_tables; f++) {
-    int *table = p->tables[f];
+    void *table = p->tables[f];
     if (table != NULL) {
       int n = p->size;
       int arity = sn_to_arity(f);
@@ -1001,7 +1082,7 @@ void fprint_interp_tabular(FILE *fp, Interp p)
       fprintf(fp, "\n %s : ", sn_to_str(f));
 
       if (arity == 0)
-	fprintf(fp, "%d\n", table[0]);
+	fprintf(fp, "%d\n", table_entry(p, table, 0));
 
       else if (arity == 1) {
 	fprintf(fp, "\n        ");
@@ -1012,10 +1093,10 @@ void fprint_interp_tabular(FILE *fp, Interp p)
 	  fprintf(fp, "--");
 	fprintf(fp, "\n        ");
 	for (i = 0; i < n; i++) {
-	  if (table[i] == -1)
+	  if (table_entry(p, table, i) == -1)
 	    fprintf(fp, " -");
 	  else
-	    fprintf(fp, "%2d", table[i]);
+	    fprintf(fp, "%2d", table_entry(p, table, i));
 	}
 	fprintf(fp, "\n");
       }
@@ -1029,10 +1110,10 @@ void fprint_interp_tabular(FILE *fp, Interp p)
 	for (i = 0; i < n; i++) {
 	  fprintf(fp, "\n    %2d |", i);
 	  for (j = 0; j < n; j++) {
-	    if (table[I2(n,i,j)] == -1)
+	    if (table_entry(p, table, I2(n,i,j)) == -1)
 	      fprintf(fp, " -");
 	    else
-	      fprintf(fp, "%2d", table[I2(n,i,j)]);
+	      fprintf(fp, "%2d", table_entry(p, table, I2(n,i,j)));
 	  }
 	}
 	fprintf(fp, "\n");
@@ -1041,10 +1122,10 @@ void fprint_interp_tabular(FILE *fp, Interp p)
 	int m = int_power(n, arity);
 	fprintf(fp, "[");
 	for (i = 0; i < m; i++) {
-	  if (table[i] == -1)
+	  if (table_entry(p, table, i) == -1)
 	    fprintf(fp, "-%s", i == m-1 ? "]\n" : ",");
 	  else
-	    fprintf(fp, "%d%s", table[i], i == m-1 ? "]\n" : ",");
+	    fprintf(fp, "%d%s", table_entry(p, table, i), i == m-1 ? "]\n" : ",");
 	}
       }
     }
@@ -1079,7 +1160,7 @@ void fprint_interp_raw(FILE *fp, Interp p)
   fprintf(fp, "\n%% Interpretation of size %d\n", p->size);
 
   for (f = 0; f < p->num_tables; f++) {
-    int *table = p->tables[f];
+    void *table = p->tables[f];
     if (table != NULL) {
       int n = p->size;
       int arity = sn_to_arity(f);
@@ -1090,10 +1171,10 @@ void fprint_interp_raw(FILE *fp, Interp p)
 	      sn_to_str(f), arity);
 
       for (i = 0; i < m; i++) {
-	if (table[i] == -1)
+	if (table_entry(p, table, i) == -1)
 	  fprintf(fp, "  -");
 	else
-	  fprintf(fp, " %2d", table[i]);
+	  fprintf(fp, " %2d", table_entry(p, table, i));
 	if (i % n == n-1)
 	  fprintf(fp, "\n");
       }
@@ -1103,6 +1184,386 @@ void fprint_interp_raw(FILE *fp, Interp p)
   }  /* for each function or relation */
 }  /* fprint_interp_raw */
 
+/*************
+ *
+ *   put_bin_int()
+ *
+ *   Binary files have 4-byte little-endian integers.
+ *
+ *************/
+
+static
+void put_bin_int(FILE *fp, int v)
+{
+  unsigned u = (unsigned) v;
+  putc(u & 0xff, fp);
+  putc((u >> 8) & 0xff, fp);
+  putc((u >> 16) & 0xff, fp);
+  putc((u >> 24) & 0xff, fp);
+}  /* put_bin_int */
+
+/*************
+ *
+ *   get_bin_int()
+ *
+ *   Return FALSE at end of file.
+ *
+ *************/
+
+static
+LADR_BOOL get_bin_int(FILE *fp, int *v)
+{
+  unsigned char b[4];
+  if (fread(b, 1, 4, fp) != 4)
+    return FALSE;
+  *v = (int) ((unsigned) b[0] | ((unsigned) b[1] << 8) |
+	      ((unsigned) b[2] << 16) | ((unsigned) b[3] << 24));
+  return TRUE;
+}  /* get_bin_int */
+
+/*************
+ *
+ *   comment_value()
+ *
+ *   Look for name=n in a list of comments; return n, or -1.
+ *
+ *************/
+
+static
+int comment_value(Term comments, char *name)
+{
+  Term t;
+  for (t = comments; t && cons_term(t); t = ARG(t,1)) {
+    Term c = ARG(t,0);
+    if (is_term(c, "=", 2) && is_term(ARG(c,0), name, 0))
+      return natural_constant_term(ARG(c,1));
+  }
+  return -1;
+}  /* comment_value */
+
+/*************
+ *
+ *   comment_term()
+ *
+ *   Build the comment name=n.
+ *
+ *************/
+
+static
+Term comment_term(char *name, int n)
+{
+  return build_binary_term(str_to_sn("=", 2),
+			   get_rigid_term(name, 0), nat_to_term(n));
+}  /* comment_term */
+
+/*************
+ *
+ *   fwrite_interp_bin_header()
+ *
+ *************/
+
+/* DOCUMENTATION
+This routine starts a binary stream of interpretations (to FILE *fp),
+by writing the header, which contains the signature of Interp p
+(the name, arity, and type of each of its symbols).  Every
+interpretation in the stream must have that signature (see
+fwrite_interp_bin()), and the returned Interp_bin, which records
+it, is passed to fwrite_interp_bin().
+<P>
+After the header, there is a record for each interpretation:
+the domain size, the model number and seconds (from the comments,
+-1 if absent), and then the tables, in the order of the header,
+each with size^arity entries:  one byte per entry (255 for undefined)
+if the domain size is at most 255, otherwise 4 bytes per entry
+(-1 for undefined).  All integers are 4 bytes, little-endian.
+*/
+
+/* PUBLIC */
+Interp_bin fwrite_interp_bin_header(FILE *fp, Interp p)
+{
+  Interp_bin b = malloc(sizeof(struct interp_bin));
+  int i;
+
+  set_binary_mode(fp);
+
+  b->num_syms = 0;
+  b->symnums = malloc(p->num_tables * sizeof(int));
+  for (i = 0; i < p->num_tables; i++)
+    if (p->tables[i] != NULL)
+      b->symnums[b->num_syms++] = i;
+
+  fwrite(BIN_MAGIC, 1, BIN_MAGIC_LENGTH, fp);
+  put_bin_int(fp, BIN_VERSION);
+  put_bin_int(fp, b->num_syms);
+
+  b->arities = malloc(b->num_syms * sizeof(int));
+  b->types = malloc(b->num_syms * sizeof(int));
+  b->max_symnum = 0;
+  for (i = 0; i < b->num_syms; i++) {
+    int sn = b->symnums[i];
+    char *name = sn_to_str(sn);
+    b->arities[i] = p->arities[sn];
+    b->types[i] = p->types[sn];
+    b->max_symnum = IMAX(b->max_symnum, sn);
+    put_bin_int(fp, b->types[i]);
+    put_bin_int(fp, b->arities[i]);
+    put_bin_int(fp, strlen(name));
+    fwrite(name, 1, strlen(name), fp);
+  }
+  return b;
+}  /* fwrite_interp_bin_header */
+
+/*************
+ *
+ *   fwrite_interp_bin()
+ *
+ *************/
+
+/* DOCUMENTATION
+This routine writes (to FILE *fp) Interp p, in binary form, as the
+next record of a stream started by fwrite_interp_bin_header().
+It is a fatal error if p's signature is not the one in the header.
+*/
+
+/* PUBLIC */
+void fwrite_interp_bin(FILE *fp, Interp_bin b, Interp p)
+{
+  int i, j, num_tables = 0;
+
+  for (i = 0; i < p->num_tables; i++)
+    if (p->tables[i] != NULL)
+      num_tables++;
+  if (num_tables != b->num_syms)
+    fatal_error("fwrite_interp_bin, interpretation does not match header");
+  for (i = 0; i < b->num_syms; i++) {
+    int sn = b->symnums[i];
+    if (sn >= p->num_tables || p->tables[sn] == NULL ||
+	p->types[sn] != b->types[i])
+      fatal_error("fwrite_interp_bin, interpretation does not match header");
+  }
+
+  put_bin_int(fp, p->size);
+  put_bin_int(fp, comment_value(p->comments, "number"));
+  put_bin_int(fp, comment_value(p->comments, "seconds"));
+
+  for (i = 0; i < b->num_syms; i++) {
+    int sn = b->symnums[i];
+    if (p->packed)
+      fwrite(p->tables[sn], 1, int_power(p->size, b->arities[i]), fp);
+    else {
+      int n = int_power(p->size, b->arities[i]);
+      for (j = 0; j < n; j++)
+	put_bin_int(fp, table_entry(p, p->tables[sn], j));
+    }
+  }
+}  /* fwrite_interp_bin */
+
+/*************
+ *
+ *   fread_interp_bin_header()
+ *
+ *************/
+
+/* DOCUMENTATION
+If FILE *fp is a binary stream of interpretations (see
+fwrite_interp_bin_header()), read its header and return an
+Interp_bin for fread_interp_bin().  Otherwise, return NULL, having
+read nothing from fp, so that the caller can read text instead.
+<P>
+The symbols in the header are entered into the symbol table.
+*/
+
+/* PUBLIC */
+Interp_bin fread_interp_bin_header(FILE *fp)
+{
+  char magic[BIN_MAGIC_LENGTH];
+  Interp_bin b;
+  int c, i, version;
+
+  set_binary_mode(fp);  /* harmless for text, where \r is white space */
+  c = getc(fp);
+  if (c != (unsigned char) BIN_MAGIC[0]) {
+    if (c != EOF)
+      ungetc(c, fp);
+    return NULL;
+  }
+
+  magic[0] = c;
+  if (fread(magic+1, 1, BIN_MAGIC_LENGTH-1, fp) != BIN_MAGIC_LENGTH-1 ||
+      memcmp(magic, BIN_MAGIC, BIN_MAGIC_LENGTH) != 0 ||
+      !get_bin_int(fp, &version))
+    fatal_error("fread_interp_bin_header, bad header");
+  if (version != BIN_VERSION)
+    fatal_error("fread_interp_bin_header, unknown version");
+
+  b = malloc(sizeof(struct interp_bin));
+  if (!get_bin_int(fp, &(b->num_syms)) || b->num_syms < 0)
+    fatal_error("fread_interp_bin_header, bad header");
+  b->symnums = malloc((b->num_syms + 1) * sizeof(int));
+  b->arities = malloc((b->num_syms + 1) * sizeof(int));
+  b->types = malloc((b->num_syms + 1) * sizeof(int));
+  b->max_symnum = 0;
+
+  for (i = 0; i < b->num_syms; i++) {
+    int length = 0;
+    char *name;
+    if (!get_bin_int(fp, &(b->types[i])) ||
+	!get_bin_int(fp, &(b->arities[i])) ||
+	!get_bin_int(fp, &length) ||
+	(b->types[i] != FUNCTION && b->types[i] != RELATION) ||
+	b->arities[i] < 0 || b->arities[i] > MAX_ARITY || length < 1)
+      fatal_error("fread_interp_bin_header, bad symbol");
+    name = malloc(length + 1);
+    if (fread(name, 1, length, fp) != (size_t) length)
+      fatal_error("fread_interp_bin_header, bad symbol");
+    name[length] = '\0';
+    b->symnums[i] = str_to_sn(name, b->arities[i]);
+    b->max_symnum = IMAX(b->max_symnum, b->symnums[i]);
+    free(name);
+  }
+  return b;
+}  /* fread_interp_bin_header */
+
+/*************
+ *
+ *   fread_interp_bin()
+ *
+ *************/
+
+/* DOCUMENTATION
+Read (from FILE *fp) the next interpretation of a binary stream,
+whose header has been read by fread_interp_bin_header().  NULL is
+returned at the end of the stream.  The interpretation has no term
+form, and its comments are just the number and the seconds.
+*/
+
+/* PUBLIC */
+Interp fread_interp_bin(FILE *fp, Interp_bin b)
+{
+  Interp p;
+  int domain_size, number, seconds, i, j;
+
+  if (!get_bin_int(fp, &domain_size))
+    return NULL;
+  if (!get_bin_int(fp, &number) || !get_bin_int(fp, &seconds))
+    fatal_error("fread_interp_bin, unexpected end of file");
+  if (domain_size < 1)
+    fatal_error("fread_interp_bin, domain size out of range.");
+
+  p = get_interp();
+  p->t = NULL;
+  p->comments = get_nil_term();
+  if (seconds >= 0)
+    p->comments = listterm_cons(comment_term("seconds", seconds),
+				p->comments);
+  if (number >= 0)
+    p->comments = listterm_cons(comment_term("number", number),
+				p->comments);
+  p->size = domain_size;
+  p->packed = (domain_size <= PACKED_MAX_SIZE);
+  p->num_tables = b->max_symnum + 100 + 1;  /* as in compile_interp() */
+
+  p->occurrences = malloc(domain_size * sizeof(int));
+  p->blocks = malloc(domain_size * sizeof(int));
+  p->profile = malloc(domain_size * sizeof(int *));
+  for (i = 0; i < domain_size; i++) {
+    p->occurrences[i] = 0;
+    p->blocks[i] = -1;
+    p->profile[i] = NULL;
+  }
+
+  p->tables  = malloc(p->num_tables * sizeof(void *));
+  p->types   = malloc(p->num_tables * sizeof(int));
+  p->arities = malloc(p->num_tables * sizeof(int));
+
+  for (i = 0; i < p->num_tables; i++) {
+    p->tables[i] = NULL;
+    p->types[i] = UNDEFINED;
+    p->arities[i] = -1;
+  }
+
+  for (i = 0; i < b->num_syms; i++) {
+    int sn = b->symnums[i];
+    int n = int_power(domain_size, b->arities[i]);
+    LADR_BOOL function = (b->types[i] == FUNCTION);
+    void *table = new_table(p, n);
+
+    p->types[sn] = b->types[i];
+    p->arities[sn] = b->arities[i];
+    p->tables[sn] = table;
+
+    if (p->packed) {
+      if (fread(table, 1, n, fp) != (size_t) n)
+	fatal_error("fread_interp_bin, unexpected end of file");
+    }
+    else {
+      for (j = 0; j < n; j++)
+	if (!get_bin_int(fp, ((int *) table) + j))
+	  fatal_error("fread_interp_bin, unexpected end of file");
+    }
+
+    for (j = 0; j < n; j++) {
+      int val = table_entry(p, table, j);
+      if (val == -1)
+	p->incomplete = TRUE;
+      else if (val < 0 || val >= (function ? domain_size : 2))
+	fatal_error("fread_interp_bin, element out of range.");
+      else if (function)
+	p->occurrences[val]++;
+    }
+  }
+  return p;
+}  /* fread_interp_bin */
+
+/*************
+ *
+ *   zap_interp_bin()
+ *
+ *************/
+
+/* DOCUMENTATION
+Free an Interp_bin (from fwrite_interp_bin_header() or
+fread_interp_bin_header()).
+*/
+
+/* PUBLIC */
+void zap_interp_bin(Interp_bin b)
+{
+  free(b->symnums);
+  free(b->arities);
+  free(b->types);
+  free(b);
+}  /* zap_interp_bin */
+
+/*************
+ *
+ *   fread_interp()
+ *
+ *************/
+
+/* DOCUMENTATION
+Read (from FILE *fp) and compile the next interpretation, in binary
+form if Interp_bin b is not NULL (see fread_interp_bin_header()),
+otherwise as a term (see compile_interp()).  NULL is returned at
+the end of the stream.
+*/
+
+/* PUBLIC */
+Interp fread_interp(FILE *fp, Interp_bin b, LADR_BOOL allow_incomplete)
+{
+  if (b != NULL)
+    return fread_interp_bin(fp, b);
+  else {
+    Term t = read_term(fp, stderr);
+    Interp p;
+    if (t == NULL)
+      return NULL;
+    p = compile_interp(t, allow_incomplete);
+    zap_term(t);
+    return p;
+  }
+}  /* fread_interp */
+
 /*************
  *
  *   eval_term_ground()
@@ -1134,7 +1595,7 @@ int eval_term_ground(Term t, Interp p, int *vals)
       return domain_element;
     }
     else {
-      int *table;
+      void *table;
       int i, j, mult;
 
       if (sn >= p->num_tables || p->tables[sn] == NULL) {
@@ -1151,7 +1612,7 @@ int eval_term_ground(Term t, Interp p, int *vals)
 	j += v * mult;
 	mult = mult * n;
       }
-      return table[j];
+      return table_entry(p, table, j);
     }
   }
 }  /* eval_term_ground */
@@ -1211,41 +1672,523 @@ LADR_BOOL all_recurse(Literals lits, Interp p, int *vals, int nextvar, int nvars
   }
 }  /* all_recurse */
 
+/*
+ * Compiled clause evaluation.
+ *
+ * For a particular interpretation, a clause is compiled into a flat
+ * program over an array of registers.  Registers 0..nvars-1 hold the
+ * values of the variables, and each domain element and each nonvariable
+ * subterm gets a register of its own.  A step computes one subterm
+ * with a single table lookup, the index being built from the argument
+ * registers and precomputed strides.
+ *
+ * The variables are assigned in nested loops (variable 0 outermost),
+ * and each step and each literal is put at the level of the greatest
+ * variable it contains, so a subterm is computed once for each
+ * assignment to the variables it depends on.  If a literal is true at
+ * some level, all of the instances below that point are true, and
+ * they are skipped.  The innermost variable is not looped over; its
+ * steps and literals are evaluated for all of its values at once
+ * (run_innermost()), with AVX2 gathers if the compiler targets AVX2.
+ */
+
+struct eval_step {
+  void *table;
+  int symnum;      /* for rebinding to another interpretation */
+  int arity;
+  int first_arg;   /* index into arg_regs and arg_strides */
+  int dest;        /* register */
+};
+
+struct eval_lit {
+  LADR_BOOL sign;
+  LADR_BOOL eq;
+  int a, b;        /* registers; b is used for equality only */
+};
+
+struct eval_prog {
+  int n;                    /* domain size */
+  LADR_BOOL packed;         /* tables as in the interpretation */
+  int nvars;
+  int *regs;
+  int num_regs, num_steps, num_args, num_lits;
+  struct eval_step *steps;
+  struct eval_lit *lits;
+  int *arg_regs;
+  int *arg_strides;
+  int *step_levels;         /* during compilation */
+  int *lit_levels;          /* during compilation */
+  /* The steps (literals) for level L (-1 <= L < nvars) are
+     step_start[L+1] .. step_start[L+2]-1 (lit_start, likewise). */
+  int *step_start;
+  int *lit_start;
+  int *instances;           /* instances[L+1] = n^(nvars-1-L) */
+  /* The innermost variable is evaluated for all of its values at
+     once, each register having a row of lanes. */
+  int width;                /* n rounded up to a multiple of LANE_BLOCK */
+  int *lanes;               /* [num_regs * width] */
+  LADR_BOOL *is_lane;       /* does the register vary across lanes? */
+  int *satisfied;           /* [width] */
+};
+
+#define LANE_BLOCK 8  /* 8 32-bit ints in an AVX2 register */
+#define MIN_LANES  4  /* smaller domains are done one value at a time */
+
+/* Table entry j, without the translation of PACKED_UNDEFINED;
+   compiled programs are not run on undefined entries. */
+
+#define STEP_ENTRY(packed, table, j) \
+  ((packed) ? ((unsigned char *) (table))[j] : ((int *) (table))[j])
+
 /*************
  *
- *   eval_literals()
+ *   zap_eval_prog()
  *
  *************/
 
 /* DOCUMENTATION
-This routine evaluates a clause in an interpretation.
-If all instances (over the domain of the interpretation) of the clause
-are true in the interpretaion, TRUE is returned.  If any instance
-is false, FALSE is returned.
-<P>
-Note that if the interpretation has d elements and the clause has
-v variables, it takes d^v evaluations to verify the clause.
-<P>
-All natural numbers are interpreted as domain values, and if any
-domain values are out of range, a fatal error occurs.
-<P>
-A fatal error occurs if any constant, function or predicate symbol
-in the clause (other than eq_sym(), which is always built in)
-is absent from the interpetation.
+Free a program made by compile_eval_literals().
 */
 
 /* PUBLIC */
-LADR_BOOL eval_literals(Literals lits, Interp p)
+void zap_eval_prog(Eval_prog e)
 {
-  int vals[MAX_VARS_EVAL];
-  int nvars, i;
-  LADR_BOOL rc;
+  free(e->regs);
+  free(e->steps);
+  free(e->lits);
+  free(e->arg_regs);
+  free(e->arg_strides);
+  free(e->step_levels);
+  free(e->lit_levels);
+  free(e->step_start);
+  free(e->lit_start);
+  free(e->instances);
+  free(e->lanes);
+  free(e->is_lane);
+  free(e->satisfied);
+  free(e);
+}  /* zap_eval_prog */
 
-  nvars = greatest_variable_in_clause(lits) + 1;
-  if (nvars > MAX_VARS_EVAL)
-    fatal_error("eval_literals: too many variables");
+/*************
+ *
+ *   compile_eval_term()
+ *
+ *   Return the register that will hold the value of the term, and
+ *   set *level to the greatest variable in the term (-1 if ground).
+ *   Return -1 if the term cannot be evaluated in the interpretation.
+ *
+ *************/
 
-  for (i = 0; i < nvars; i++)
+static
+int compile_eval_term(Term t, Interp p, Eval_prog e, int *level)
+{
+  int domain_element;
+
+  if (VARIABLE(t)) {
+    *level = VARNUM(t);
+    return VARNUM(t);
+  }
+  else if (CONSTANT(t) && term_to_int(t, &domain_element)) {
+    if (domain_element < 0 || domain_element >= p->size)
+      return -1;
+    *level = -1;
+    e->regs[e->num_regs] = domain_element;
+    return e->num_regs++;
+  }
+  else {
+    int sn = SYMNUM(t);
+    int i, mult, first_arg, max_level;
+    struct eval_step *s;
+
+    if (sn >= p->num_tables || p->tables[sn] == NULL)
+      return -1;
+
+    first_arg = e->num_args;
+    e->num_args += ARITY(t);
+    max_level = -1;
+    mult = 1;
+    for (i = ARITY(t)-1; i >= 0; i--) {
+      int arg_level;
+      int r = compile_eval_term(ARG(t,i), p, e, &arg_level);
+      if (r == -1)
+	return -1;
+      e->arg_regs[first_arg+i] = r;
+      e->arg_strides[first_arg+i] = mult;
+      mult = mult * p->size;
+      max_level = IMAX(max_level, arg_level);
+    }
+    s = e->steps + e->num_steps;
+    s->table = p->tables[sn];
+    s->symnum = sn;
+    s->arity = ARITY(t);
+    s->first_arg = first_arg;
+    s->dest = e->num_regs++;
+    e->step_levels[e->num_steps++] = max_level;
+    *level = max_level;
+    return s->dest;
+  }
+}  /* compile_eval_term */
+
+/*************
+ *
+ *   order_by_level()
+ *
+ *   Given the levels (-1 .. nvars-1) of n items, return the order
+ *   of a stable sort by level, and fill in start[0..nvars+1], where
+ *   start[L+1] is the position of the first item of level L.
+ *
+ *************/
+
+static
+int *order_by_level(int *levels, int n, int nvars, int *start)
+{
+  int *order = malloc((n + 1) * sizeof(int));
+  int *next = malloc((nvars + 1) * sizeof(int));
+  int i;
+
+  for (i = 0; i < nvars + 2; i++)
+    start[i] = 0;
+  for (i = 0; i < n; i++)
+    start[levels[i]+2]++;
+  for (i = 1; i < nvars + 2; i++)
+    start[i] += start[i-1];
+  for (i = 0; i < nvars + 1; i++)
+    next[i] = start[i];
+  for (i = 0; i < n; i++)
+    order[next[levels[i]+1]++] = i;
+  free(next);
+  return order;
+}  /* order_by_level */
+
+/*************
+ *
+ *   compile_eval_prog()
+ *
+ *   Return NULL if some term cannot be evaluated in the interpretation
+ *   (a symbol is missing or a domain element is out of range).
+ *
+ *************/
+
+static
+Eval_prog compile_eval_prog(Literals lits, Interp p, int nvars)
+{
+  Eval_prog e = calloc(1, sizeof(struct eval_prog));
+  int num_lits = number_of_literals(lits);
+  int max_syms = 0;
+  int i, *order;
+  Literals lit;
+  struct eval_step *steps;
+  struct eval_lit *elits;
+
+  for (lit = lits; lit; lit = lit->next)
+    max_syms += symbol_count(lit->atom);
+
+  e->n = p->size;
+  e->packed = p->packed;
+  e->nvars = nvars;
+  e->regs = malloc((nvars + max_syms + 1) * sizeof(int));
+  e->steps = malloc((max_syms + 1) * sizeof(struct eval_step));
+  e->step_levels = malloc((max_syms + 1) * sizeof(int));
+  e->arg_regs = malloc((max_syms + 1) * sizeof(int));
+  e->arg_strides = malloc((max_syms + 1) * sizeof(int));
+  e->lits = malloc((num_lits + 1) * sizeof(struct eval_lit));
+  e->lit_levels = malloc((num_lits + 1) * sizeof(int));
+  e->step_start = malloc((nvars + 2) * sizeof(int));
+  e->lit_start = malloc((nvars + 2) * sizeof(int));
+  e->instances = malloc((nvars + 1) * sizeof(int));
+  e->num_regs = nvars;
+
+  for (lit = lits; lit; lit = lit->next) {
+    struct eval_lit *l = e->lits + e->num_lits;
+    int level_a, level_b;
+    l->sign = lit->sign;
+    l->eq = is_eq_symbol(SYMNUM(lit->atom));
+    if (l->eq) {
+      l->a = compile_eval_term(ARG(lit->atom,0), p, e, &level_a);
+      l->b = compile_eval_term(ARG(lit->atom,1), p, e, &level_b);
+    }
+    else {
+      l->a = compile_eval_term(lit->atom, p, e, &level_a);
+      l->b = 0;
+      level_b = -1;
+    }
+    if (l->a == -1 || l->b == -1) {
+      zap_eval_prog(e);
+      return NULL;
+    }
+    e->lit_levels[e->num_lits++] = IMAX(level_a, level_b);
+  }
+
+  /* Put the steps and literals in level order.  The sort is stable,
+     and a step is never at a lower level than its arguments, so each
+     step still follows the steps for its arguments. */
+
+  order = order_by_level(e->step_levels, e->num_steps, nvars, e->step_start);
+  steps = malloc((e->num_steps + 1) * sizeof(struct eval_step));
+  for (i = 0; i < e->num_steps; i++)
+    steps[i] = e->steps[order[i]];
+  free(e->steps);
+  e->steps = steps;
+  free(order);
+
+  order = order_by_level(e->lit_levels, e->num_lits, nvars, e->lit_start);
+  elits = malloc((e->num_lits + 1) * sizeof(struct eval_lit));
+  for (i = 0; i < e->num_lits; i++)
+    elits[i] = e->lits[order[i]];
+  free(e->lits);
+  e->lits = elits;
+  free(order);
+
+  e->instances[nvars] = 1;
+  for (i = nvars - 1; i >= 0; i--)
+    e->instances[i] = e->instances[i+1] * e->n;
+
+  if (nvars > 0) {
+    int inner = nvars - 1;
+    e->width = (e->n + LANE_BLOCK - 1) / LANE_BLOCK * LANE_BLOCK;
+    /* calloc: padding lanes of the innermost variable hold 0, so every
+       lane of every step indexes its table in range */
+    e->lanes = calloc(e->num_regs * e->width, sizeof(int));
+    e->is_lane = calloc(e->num_regs, sizeof(LADR_BOOL));
+    e->satisfied = malloc(e->width * sizeof(int));
+    e->is_lane[inner] = TRUE;
+    for (i = 0; i < e->n; i++)
+      e->lanes[inner * e->width + i] = i;
+    for (i = e->step_start[inner+1]; i < e->step_start[inner+2]; i++)
+      e->is_lane[e->steps[i].dest] = TRUE;
+  }
+
+  return e;
+}  /* compile_eval_prog */
+
+/*************
+ *
+ *   run_innermost()
+ *
+ *   All variables but the last have been assigned.  Evaluate the
+ *   remaining steps and literals for every value of the last variable
+ *   at once, and return the number of true instances (with all_true,
+ *   0 if any instance is false).  With AVX2, each step is done with
+ *   gathers, 8 lanes at a time; otherwise it's a plain loop.
+ *
+ *************/
+
+static
+int run_innermost(Eval_prog e, LADR_BOOL all_true)
+{
+  int level = e->nvars - 1;
+  int w = e->width;
+  int n = e->n;
+  int *sat = e->satisfied;
+  int *lanes = e->lanes;
+  int *arg_regs = e->arg_regs;
+  int *arg_strides = e->arg_strides;
+  LADR_BOOL *is_lane = e->is_lane;
+  int i, k, lane, true_instances;
+
+  for (i = e->step_start[level+1]; i < e->step_start[level+2]; i++) {
+    struct eval_step *s = e->steps + i;
+    void *table = s->table;
+    LADR_BOOL packed = e->packed;
+    int *dest = lanes + s->dest * w;
+    int last_arg = s->first_arg + s->arity;
+    int base = 0;
+    for (k = s->first_arg; k < last_arg; k++) {
+      if (!is_lane[arg_regs[k]])
+	base += e->regs[arg_regs[k]] * arg_strides[k];
+    }
+#ifdef __AVX2__
+    for (lane = 0; lane < w; lane += LANE_BLOCK) {
+      __m256i j = _mm256_set1_epi32(base);
+      for (k = s->first_arg; k < last_arg; k++) {
+	if (is_lane[arg_regs[k]]) {
+	  __m256i v = _mm256_loadu_si256((__m256i *)
+					 (lanes + arg_regs[k] * w + lane));
+	  j = _mm256_add_epi32(j, _mm256_mullo_epi32(v,
+				  _mm256_set1_epi32(arg_strides[k])));
+	}
+      }
+      if (packed)
+	_mm256_storeu_si256((__m256i *) (dest + lane),
+			    _mm256_and_si256(_mm256_i32gather_epi32(table, j, 1),
+					     _mm256_set1_epi32(0xff)));
+      else
+	_mm256_storeu_si256((__m256i *) (dest + lane),
+			    _mm256_i32gather_epi32(table, j, 4));
+    }
+#else
+    {
+      /* Most steps have one or two arguments that vary. */
+      int *v1 = NULL, *v2 = NULL;
+      int s1 = 0, s2 = 0;
+      LADR_BOOL more = FALSE;
+      for (k = s->first_arg; k < last_arg; k++) {
+	if (!is_lane[arg_regs[k]])
+	  ;
+	else if (v1 == NULL) {
+	  v1 = lanes + arg_regs[k] * w;
+	  s1 = arg_strides[k];
+	}
+	else if (v2 == NULL) {
+	  v2 = lanes + arg_regs[k] * w;
+	  s2 = arg_strides[k];
+	}
+	else
+	  more = TRUE;
+      }
+      if (more) {
+	for (lane = 0; lane < n; lane++) {
+	  int j = base;
+	  for (k = s->first_arg; k < last_arg; k++) {
+	    if (is_lane[arg_regs[k]])
+	      j += lanes[arg_regs[k] * w + lane] * arg_strides[k];
+	  }
+	  dest[lane] = STEP_ENTRY(packed, table, j);
+	}
+      }
+      else if (v2 != NULL) {
+	for (lane = 0; lane < n; lane++)
+	  dest[lane] = STEP_ENTRY(packed, table,
+				  base + v1[lane] * s1 + v2[lane] * s2);
+      }
+      else {
+	for (lane = 0; lane < n; lane++)
+	  dest[lane] = STEP_ENTRY(packed, table, base + v1[lane] * s1);
+      }
+    }
+#endif
+  }
+
+  /* A literal at this level has at least one operand that varies. */
+
+  for (lane = 0; lane < n; lane++)
+    sat[lane] = 0;
+  for (i = e->lit_start[level+1]; i < e->lit_start[level+2]; i++) {
+    struct eval_lit *l = e->lits + i;
+    int sign = l->sign;
+    int *a, *b;
+    if (!l->eq) {
+      a = lanes + l->a * w;
+      for (lane = 0; lane < n; lane++)
+	sat[lane] |= ((a[lane] != 0) == sign);
+    }
+    else if (is_lane[l->a] && is_lane[l->b]) {
+      a = lanes + l->a * w;
+      b = lanes + l->b * w;
+      for (lane = 0; lane < n; lane++)
+	sat[lane] |= ((a[lane] == b[lane]) == sign);
+    }
+    else {
+      int c = e->regs[is_lane[l->a] ? l->b : l->a];
+      a = lanes + (is_lane[l->a] ? l->a : l->b) * w;
+      for (lane = 0; lane < n; lane++)
+	sat[lane] |= ((a[lane] == c) == sign);
+    }
+  }
+
+  true_instances = 0;
+  for (lane = 0; lane < n; lane++)
+    true_instances += sat[lane];
+  return (all_true && true_instances < n ? 0 : true_instances);
+}  /* run_innermost */
+
+/*************
+ *
+ *   run_eval_prog()
+ *
+ *   The variables before the given level have been assigned.  Compute
+ *   the steps for the level, then check the instances below.
+ *   Return the number of true instances below (with all_true,
+ *   return 0 as soon as a false instance is found).
+ *
+ *************/
+
+static
+int run_eval_prog(Eval_prog e, int level, LADR_BOOL all_true)
+{
+  int *r = e->regs;
+  int i, v, true_instances;
+
+  for (i = e->step_start[level+1]; i < e->step_start[level+2]; i++) {
+    struct eval_step *s = e->steps + i;
+    int j = 0;
+    int k;
+    for (k = s->first_arg; k < s->first_arg + s->arity; k++)
+      j += r[e->arg_regs[k]] * e->arg_strides[k];
+    r[s->dest] = STEP_ENTRY(e->packed, s->table, j);
+  }
+
+  for (i = e->lit_start[level+1]; i < e->lit_start[level+2]; i++) {
+    struct eval_lit *l = e->lits + i;
+    LADR_BOOL atom_val = (l->eq ? r[l->a] == r[l->b] : r[l->a]);
+    if (l->sign ? atom_val : !atom_val)
+      return e->instances[level+1];  /* all instances below are true */
+  }
+
+  if (level == e->nvars - 1)
+    return 0;  /* a false instance */
+  else if (level == e->nvars - 2 && e->n >= MIN_LANES)
+    return run_innermost(e, all_true);
+
+  true_instances = 0;
+  for (v = 0; v < e->n; v++) {
+    int t;
+    r[level+1] = v;
+    t = run_eval_prog(e, level+1, all_true);
+    if (all_true && t == 0)
+      return 0;
+    true_instances += t;
+  }
+  return true_instances;
+}  /* run_eval_prog */
+
+/*************
+ *
+ *   eval_literals()
+ *
+ *************/
+
+/* DOCUMENTATION
+This routine evaluates a clause in an interpretation.
+If all instances (over the domain of the interpretation) of the clause
+are true in the interpretaion, TRUE is returned.  If any instance
+is false, FALSE is returned.
+<P>
+Note that if the interpretation has d elements and the clause has
+v variables, it can take d^v evaluations to verify the clause.
+The clause is first compiled (for the interpretation) into a flat
+program of table lookups, with the variables assigned in nested
+loops; subterms are computed only when a variable they contain changes,
+and the instances under a true literal are skipped.
+<P>
+All natural numbers are interpreted as domain values, and if any
+domain values are out of range, a fatal error occurs.
+<P>
+A fatal error occurs if any constant, function or predicate symbol
+in the clause (other than eq_sym(), which is always built in)
+is absent from the interpetation.
+*/
+
+/* PUBLIC */
+LADR_BOOL eval_literals(Literals lits, Interp p)
+{
+  int vals[MAX_VARS_EVAL];
+  int nvars, i;
+  LADR_BOOL rc;
+  Eval_prog e;
+
+  nvars = greatest_variable_in_clause(lits) + 1;
+  if (nvars > MAX_VARS_EVAL)
+    fatal_error("eval_literals: too many variables");
+
+  e = compile_eval_prog(lits, p, nvars);
+  if (e) {
+    rc = run_eval_prog(e, -1, TRUE) != 0;
+    zap_eval_prog(e);
+    return rc;
+  }
+
+  for (i = 0; i < nvars; i++)
     vals[i] = -1;
 
   rc = all_recurse(lits, p, vals, 0, nvars);
@@ -1296,11 +2239,19 @@ int eval_literals_true_instances(Literals lits, Interp p)
 {
   int vals[MAX_VARS_EVAL];
   int nvars, i, true_instances;
+  Eval_prog e;
 
   nvars = greatest_variable_in_clause(lits) + 1;
   if (nvars > MAX_VARS_EVAL)
     fatal_error("eval_literals_true_instances: too many variables");
 
+  e = compile_eval_prog(lits, p, nvars);
+  if (e) {
+    true_instances = run_eval_prog(e, -1, FALSE);
+    zap_eval_prog(e);
+    return true_instances;
+  }
+
   for (i = 0; i < nvars; i++)
     vals[i] = -1;
 
@@ -1326,6 +2277,90 @@ int eval_literals_false_instances(Literals lits, Interp p)
   return int_power(p->size, nvars) - true_instances;
 }  /* eval_literals_false_instances */
 
+/*************
+ *
+ *   compile_eval_literals()
+ *
+ *************/
+
+/* DOCUMENTATION
+Compile a clause, for evaluation in an interpretation, into the
+program that eval_literals() uses.  The program can be run (with
+run_eval_literals()) in any interpretation that has the same domain
+size and signature (see same_interp_signature()) as the one it
+was compiled for.  NULL is returned if the clause has a symbol that
+is not in the interpretation, or a domain element out of range,
+or too many variables.
+<P>
+Compiling and running use only malloc/free, and the clause and
+interpretation are not changed, so different threads can work on
+different programs at the same time.  (eq_sym's symbol number is
+looked up the first time is_eq_symbol() is called, so call it once
+before starting the threads.)
+*/
+
+/* PUBLIC */
+Eval_prog compile_eval_literals(Literals lits, Interp p)
+{
+  int nvars = greatest_variable_in_clause(lits) + 1;
+  if (nvars > MAX_VARS_EVAL)
+    return NULL;
+  else
+    return compile_eval_prog(lits, p, nvars);
+}  /* compile_eval_literals */
+
+/*************
+ *
+ *   run_eval_literals()
+ *
+ *************/
+
+/* DOCUMENTATION
+Run a compiled clause in an interpretation (which must have the
+same domain size and signature as the one the clause was compiled
+for), and return TRUE iff all instances are true.
+*/
+
+/* PUBLIC */
+LADR_BOOL run_eval_literals(Eval_prog e, Interp p)
+{
+  int i;
+  if (p->size != e->n)
+    fatal_error("run_eval_literals: wrong domain size");
+  for (i = 0; i < e->num_steps; i++)
+    e->steps[i].table = p->tables[e->steps[i].symnum];
+  return run_eval_prog(e, -1, TRUE) != 0;
+}  /* run_eval_literals */
+
+/*************
+ *
+ *   same_interp_signature()
+ *
+ *************/
+
+/* DOCUMENTATION
+Do two interpretations have the same domain size and the same
+tables (same symbols, arities, and types)?
+*/
+
+/* PUBLIC */
+LADR_BOOL same_interp_signature(Interp a, Interp b)
+{
+  int i;
+  if (a->size != b->size)
+    return FALSE;
+  for (i = 0; i < IMAX(a->num_tables, b->num_tables); i++) {
+    LADR_BOOL in_a = i < a->num_tables && a->tables[i] != NULL;
+    LADR_BOOL in_b = i < b->num_tables && b->tables[i] != NULL;
+    if (in_a != in_b)
+      return FALSE;
+    else if (in_a && (a->arities[i] != b->arities[i] ||
+		      a->types[i] != b->types[i]))
+      return FALSE;
+  }
+  return TRUE;
+}  /* same_interp_signature */
+
 /*************
  *
  *   eval_fterm_ground()
@@ -1358,7 +2393,7 @@ int eval_fterm_ground(Term t, Interp p, int *vals)
       return domain_element;
     }
     else {
-      int *table;
+      void *table;
       int i, j, mult;
 
       if (sn >= p->num_tables || p->tables[sn] == NULL) {
@@ -1375,7 +2410,7 @@ int eval_fterm_ground(Term t, Interp p, int *vals)
 	j += v * mult;
 	mult = mult * n;
       }
-      return table[j];
+      return table_entry(p, table, j);
     }
   }
 }  /* eval_fterm_ground */
@@ -1598,6 +2633,71 @@ void interp_remove_others(Term t, Plist keepers)
   ARG(t,2) = interp_remove_others_recurse(ARG(t,2), keepers);
 }  /* interp_remove_others */
 
+/*************
+ *
+ *   remove_table()
+ *
+ *************/
+
+static
+void remove_table(Interp p, int f)
+{
+  int j, n = int_power(p->size, p->arities[f]);
+  if (p->types[f] == FUNCTION) {
+    for (j = 0; j < n; j++) {
+      int v = table_entry(p, p->tables[f], j);
+      if (v != -1)
+	p->occurrences[v]--;
+    }
+  }
+  free(p->tables[f]);
+  p->tables[f] = NULL;
+  p->types[f] = UNDEFINED;
+  p->arities[f] = -1;
+}  /* remove_table */
+
+/*************
+ *
+ *   remove_interp_constants()
+ *
+ *************/
+
+/* DOCUMENTATION
+In a compiled interpretation, remove all constants.
+(This is for interpretations without term forms, e.g., from
+fread_interp_bin(); the term form, if any, is not changed.)
+*/
+
+/* PUBLIC */
+void remove_interp_constants(Interp p)
+{
+  int f;
+  for (f = 0; f < p->num_tables; f++)
+    if (p->tables[f] != NULL && p->arities[f] == 0)
+      remove_table(p, f);
+}  /* remove_interp_constants */
+
+/*************
+ *
+ *   remove_interp_others()
+ *
+ *************/
+
+/* DOCUMENTATION
+In a compiled interpretation, remove all symbols not in keepers
+(a Plist of strings).  (As with remove_interp_constants(), the term
+form, if any, is not changed.)
+*/
+
+/* PUBLIC */
+void remove_interp_others(Interp p, Plist keepers)
+{
+  int f;
+  for (f = 0; f < p->num_tables; f++)
+    if (p->tables[f] != NULL && !string_member_plist(sn_to_str(f), keepers))
+      remove_table(p, f);
+}  /* remove_interp_others */
+
 /*************
  *
  *   copy_interp()
@@ -1618,6 +2718,7 @@ Interp copy_interp(Interp p)
   q->comments = copy_term(p->comments);
   q->size = p->size;
   q->incomplete = p->incomplete;
+  q->packed = p->packed;
   q->num_tables = p->num_tables;
 
   /* discriminators */
@@ -1644,9 +2745,13 @@ Interp copy_interp(Interp p)
   q->num_profile_components = p->num_profile_components;
   q->profile = malloc(sizeof(int *) * q->size);
   for (i = 0; i < q->size; i++) {
-    q->profile[i] = malloc(sizeof(int) * q->num_profile_components);
-    for (j = 0; j < q->num_profile_components; j++)
-      q->profile[i][j] = p->profile[i][j];
+    if (p->profile[i] == NULL)
+      q->profile[i] = NULL;  /* no profile yet (see create_profile()) */
+    else {
+      q->profile[i] = malloc(sizeof(int) * q->num_profile_components);
+      for (j = 0; j < q->num_profile_components; j++)
+	q->profile[i][j] = p->profile[i][j];
+    }
   }
 
   /* types, arities */
@@ -1660,27 +2765,78 @@ Interp copy_interp(Interp p)
 
   /* tables */
 
-  q->tables = malloc(q->num_tables * sizeof(int *));
+  q->tables = malloc(q->num_tables * sizeof(void *));
   for (i = 0; i < q->num_tables; i++)
     q->tables[i] = NULL;
 
   for (i = 0; i < q->num_tables; i++)
     if (p->tables[i] != NULL) {
-      int arity = p->arities[i];
-      int n = 1;
-      int *ptable, *qtable, j;
-      for (j = 0; j < arity; j++)
-	n = n * p->size;
-      q->tables[i] = malloc(n * sizeof(int));
-      ptable = p->tables[i];
-      qtable = q->tables[i];
-      for (j = 0; j < n; j++)
-	qtable[j] = ptable[j];
+      q->tables[i] = new_table(q, int_power(q->size, q->arities[i]));
+      memcpy(q->tables[i], p->tables[i], table_bytes(p, i));
     }
 
   return q;
 }  /* copy_interp */
 
+/*************
+ *
+ *   packed_maps()
+ *
+ *   Maps for permuting the entries of packed tables:  pmap is the
+ *   permutation (for functions), and imap is the identity (for
+ *   relations).  Both leave PACKED_UNDEFINED alone.
+ *
+ *************/
+
+static
+void packed_maps(int *p, int n, unsigned char *pmap, unsigned char *imap)
+{
+  int i;
+  for (i = 0; i < 256; i++) {
+    pmap[i] = (i < n ? p[i] : i);
+    imap[i] = i;
+  }
+}  /* packed_maps */
+
+/*************
+ *
+ *   permuted_row()
+ *
+ *   A table of arity 1, 2, or 3 is a sequence of rows of length n,
+ *   one for each tuple of all but the last argument.  Return the
+ *   row that row r goes to when the table is permuted by p.
+ *
+ *************/
+
+static
+int permuted_row(int r, int arity, int n, int *p)
+{
+  if (arity == 1)
+    return 0;
+  else if (arity == 2)
+    return p[r];
+  else
+    return p[r / n] * n + p[r % n];
+}  /* permuted_row */
+
+/*************
+ *
+ *   permute_row()
+ *
+ *   Permute a row of a packed table (the last argument by p,
+ *   and the entries by map).
+ *
+ *************/
+
+static
+void permute_row(unsigned char *dest, unsigned char *source,
+		 int n, int *p, unsigned char *map)
+{
+  int i;
+  for (i = 0; i < n; i++)
+    dest[p[i]] = map[source[i]];
+}  /* permute_row */
+
 /*************
  *
  *   permute_interp()
@@ -1698,9 +2854,28 @@ Interp permute_interp(Interp source, int *p)
 {
   Interp dest = copy_interp(source);
   int n = source->size;
+  unsigned char pmap[256], imap[256];
   int f;
+  if (source->packed)
+    packed_maps(p, n, pmap, imap);
   for (f = 0; f < source->num_tables; f++) {
-    if (source->tables[f] != NULL) {
+    if (source->tables[f] != NULL && source->packed) {
+      unsigned char *st = source->tables[f];
+      unsigned char *dt =   dest->tables[f];
+      int arity = source->arities[f];
+      unsigned char *map = (source->types[f] == FUNCTION ? pmap : imap);
+      if (arity == 0)
+	dt[0] = map[st[0]];
+      else if (arity <= 3) {
+	int r;
+	for (r = 0; r < int_power(n, arity-1); r++)
+	  permute_row(dt + n * permuted_row(r, arity, n, p), st + n * r,
+		      n, p, map);
+      }
+      else
+	fatal_error("permute_interp: arity > 3");
+    }
+    else if (source->tables[f] != NULL) {
       int *st = source->tables[f];
       int *dt =   dest->tables[f];
       int arity = source->arities[f];
@@ -1765,9 +2940,32 @@ are the same size and have the same symbols.
 LADR_BOOL ident_interp_perm(Interp a, Interp b, int *p)
 {
   int n = a->size;
+  unsigned char pmap[256], imap[256], row[PACKED_MAX_SIZE];
   int f;
+  if (a->packed)
+    packed_maps(p, n, pmap, imap);
   for (f = 0; f < a->num_tables; f++) {
-    if (a->tables[f] != NULL) {
+    if (a->tables[f] != NULL && a->packed) {
+      unsigned char *at =   a->tables[f];
+      unsigned char *bt =   b->tables[f];
+      int arity = a->arities[f];
+      unsigned char *map = (a->types[f] == FUNCTION ? pmap : imap);
+      if (arity == 0) {
+	if (bt[0] != map[at[0]])
+	  return FALSE;
+      }
+      else if (arity <= 3) {
+	int r;
+	for (r = 0; r < int_power(n, arity-1); r++) {
+	  permute_row(row, at + n * r, n, p, map);
+	  if (memcmp(row, bt + n * permuted_row(r, arity, n, p), n) != 0)
+	    return FALSE;
+	}
+      }
+      else
+	fatal_error("ident_interp_perm: arity > 3");
+    }
+    else if (a->tables[f] != NULL) {
       int *at =   a->tables[f];
       int *bt =   b->tables[f];
       int arity = a->arities[f];
@@ -1880,39 +3078,344 @@ Interp normal_interp(Interp a)
   return can;
 }  /* normal_interp */
 
+/*
+ * Partition refinement, for isomorphism checks and canonical forms.
+ *
+ * A partition of the domain is given by cells[x], the index of the
+ * cell containing element x.  The cells are ordered, and refinement
+ * splits cells in place, so the order of the cells (and everything
+ * else about a refined partition) depends only on the structure of
+ * the interpretation, not on the names of the elements.  When every
+ * cell is a singleton, cells[] is a permutation (old element to new
+ * element), as for permute_interp().
+ *
+ * Elements are distinguished by a signature: an order-independent sum
+ * over all table entries they take part in, of a hash of the symbol,
+ * the position, the cells of the arguments, and the cell of the value.
+ * (Hash collisions can only make the refinement weaker.)
+ */
+
+#define FNV_STEP(h,x) (((h) ^ (unsigned) (x)) * 16777619u)
+
+static
+void invert_perm(int *a, int *b, int n)
+{
+  int i;
+  for (i = 0; i < n; i++)
+    b[a[i]] = i;
+}  /* invert_perm */
+
+static
+void copy_perm(int *a, int *b, int n)
+{
+  int i;
+  for (i = 0; i < n; i++)
+    b[i] = a[i];
+}  /* copy_perm */
+
 /*************
  *
- *   iso_interp_recurse()
+ *   mix_hash()
  *
  *************/
 
 static
-LADR_BOOL iso_interp_recurse(int *p, int k, int n,
-			Interp a, Interp b, LADR_BOOL normal)
+unsigned mix_hash(unsigned h)
 {
-  int i;
-  if (k == n) {
-    /* We have a permutation. */
+  h ^= h >> 16;
+  h *= 0x85ebca6bu;
+  h ^= h >> 13;
+  h *= 0xc2b2ae35u;
+  h ^= h >> 16;
+  return h;
+}  /* mix_hash */
+
+/*************
+ *
+ *   element_signatures()
+ *
+ *************/
+
+static
+void element_signatures(Interp a, int *cells, unsigned *sig)
+{
+  int n = a->size;
+  int f, x;
+
+  for (x = 0; x < n; x++)
+    sig[x] = 0;
+
+  for (f = 0; f < a->num_tables; f++) {
+    if (a->tables[f] != NULL) {
+      void *t = a->tables[f];
+      int arity = a->arities[f];
+      LADR_BOOL function = (a->types[f] == FUNCTION);
+      int args[3] = {0, 0, 0};
+      int m = int_power(n, arity);
+      int i, k;
+      if (arity > 3)
+	fatal_error("element_signatures: arity > 3");
+      for (i = 0; i < m; i++) {
+	int v = table_entry(a, t, i);
+	unsigned d = FNV_STEP(2166136261u, f);
+	for (k = 0; k < arity; k++)
+	  d = FNV_STEP(d, cells[args[k]]);
+	d = FNV_STEP(d, !function ? v : (v < 0 ? -1 : cells[v]));
+	for (k = 0; k < arity; k++)
+	  sig[args[k]] += mix_hash(d + 0x9e3779b9u * (unsigned) (k+1));
+	if (function && v >= 0)
+	  sig[v] += mix_hash(d);
+	/* next tuple of arguments (odometer) */
+	for (k = arity-1; k >= 0 && ++args[k] == n; k--)
+	  args[k] = 0;
+      }
+    }
+  }
+}  /* element_signatures */
+
+/*************
+ *
+ *   refine_partition()
+ *
+ *   Split the cells by element signatures until nothing changes.
+ *   Return the number of cells; *trace gets a hash of the refinement,
+ *   which is the same for isomorphic interpretations and partitions.
+ *
+ *   The trace is built up a round at a time.  If rounds is not NULL,
+ *   it gets the number of rounds (in rounds[0]) and the trace after
+ *   each round.  If expect is not NULL, it holds the rounds of
+ *   another refinement, and as soon as this one is different, -1 is
+ *   returned (and the partition is left half refined).
+ *
+ *************/
+
+static
+int refine_partition(Interp a, int *cells, unsigned *trace,
+		     unsigned *rounds, unsigned *expect)
+{
+  int n = a->size;
+  int *order = malloc(n * sizeof(int));         /* remember to free this */
+  unsigned *sig = malloc(n * sizeof(unsigned));  /* remember to free this */
+  int *new_cells = malloc(n * sizeof(int));     /* remember to free this */
+  int num_cells = 0;
+  unsigned h = 2166136261u;
+  unsigned round = 0;
+  int i, j, x;
+
+  for (x = 0; x < n; x++)
+    num_cells = IMAX(num_cells, cells[x]+1);
+
+  while (num_cells < n) {
+    int new_num;
+    element_signatures(a, cells, sig);
+
+    /* Sort the elements by (cell, signature). */
+    for (i = 0; i < n; i++) {
+      int y = i;
+      for (j = i; j > 0 && (cells[order[j-1]] > cells[y] ||
+			    (cells[order[j-1]] == cells[y] &&
+			     sig[order[j-1]] > sig[y])); j--)
+	order[j] = order[j-1];
+      order[j] = y;
+    }
+
+    /* Renumber the cells. */
+    new_num = 0;
+    for (i = 0; i < n; i++) {
+      x = order[i];
+      if (i > 0 && (cells[x] != cells[order[i-1]] ||
+		    sig[x] != sig[order[i-1]]))
+	new_num++;
+      h = FNV_STEP(h, sig[x]);
+      new_cells[x] = new_num;
+    }
+    new_num++;
+    copy_perm(new_cells, cells, n);
+    h = FNV_STEP(h, new_num);
+    round++;
+    if (rounds)
+      rounds[round] = h;
+    if (expect && (round > expect[0] || h != expect[round])) {
+      num_cells = -1;  /* not like the other refinement */
+      break;
+    }
+    if (new_num == num_cells)
+      break;
+    num_cells = new_num;
+  }
+  if (rounds)
+    rounds[0] = round;
+  free(order);
+  free(sig);
+  free(new_cells);
+  *trace = h;
+  return num_cells;
+}  /* refine_partition */
+
+/*************
+ *
+ *   initial_partition()
+ *
+ *   For normal interps, start with the blocks; otherwise, one cell.
+ *
+ *************/
+
+static
+int *initial_partition(Interp a, LADR_BOOL normal)
+{
+  int n = a->size;
+  int *cells = malloc(n * sizeof(int));
+  int x, y;
+  for (x = 0; x < n; x++) {
+    cells[x] = 0;
+    if (normal) {
+      /* the number of distinct block values less than this one */
+      for (y = 0; y < n; y++) {
+	int z;
+	if (a->blocks[y] < a->blocks[x]) {
+	  for (z = 0; z < y && a->blocks[z] != a->blocks[y]; z++);
+	  if (z == y)
+	    cells[x]++;
+	}
+      }
+    }
+  }
+  return cells;
+}  /* initial_partition */
+
+/*************
+ *
+ *   target_cell()
+ *
+ *   The first cell with more than one element, or -1 if the
+ *   partition is discrete.
+ *
+ *************/
+
+static
+int target_cell(int *cells, int n, int num_cells)
+{
+  int *sizes, c, x;
+  if (num_cells == n)
+    return -1;
+  sizes = calloc(num_cells, sizeof(int));
+  for (x = 0; x < n; x++)
+    sizes[cells[x]]++;
+  for (c = 0; c < num_cells && sizes[c] == 1; c++);
+  free(sizes);
+  return c;
+}  /* target_cell */
+
+/*************
+ *
+ *   individualize()
+ *
+ *   Return a copy of the partition in which element v is split off,
+ *   ahead of the rest of its cell.
+ *
+ *************/
+
+static
+int *individualize(int *cells, int n, int v)
+{
+  int *new = malloc(n * sizeof(int));
+  int c = cells[v];
+  int x;
+  for (x = 0; x < n; x++)
+    new[x] = (cells[x] > c || (cells[x] == c && x != v) ?
+	      cells[x] + 1 : cells[x]);
+  return new;
+}  /* individualize */
+
+/*************
+ *
+ *   first_leaf()
+ *
+ *   Follow the first branch of the search tree for interp a down to a
+ *   discrete partition, recording the refinement traces on the way
+ *   (and the rounds of the refinement at level L in rounds + L*(n+1)).
+ *   Return the number of levels; the partition is left in cells.
+ *
+ *************/
+
+static
+int first_leaf(Interp a, int *cells, unsigned *traces, int *counts,
+	       unsigned *rounds)
+{
+  int n = a->size;
+  int level = 0;
+  while (TRUE) {
+    int c, v;
+    int *new;
+    counts[level] = refine_partition(a, cells, traces + level,
+				     rounds + level * (n+1), NULL);
+    c = target_cell(cells, n, counts[level]);
+    if (c == -1)
+      return level;
+    for (v = 0; cells[v] != c; v++);
+    new = individualize(cells, n, v);
+    copy_perm(new, cells, n);
+    free(new);
+    level++;
+  }
+}  /* first_leaf */
+
+/*************
+ *
+ *   iso_search()
+ *
+ *   Search the tree for interp b for a leaf that gives an
+ *   isomorphism from a (whose first leaf is pa).
+ *
+ *************/
+
+static
+LADR_BOOL iso_search(Interp a, int *pa, Interp b, int *cells, int level,
+		     unsigned *traces, int *counts, unsigned *rounds,
+		     int depth)
+{
+  int n = b->size;
+  unsigned trace;
+  int num_cells;
+
+  if (level > depth)
+    return FALSE;
+  /* Stop refining as soon as it differs from the refinement for a. */
+  num_cells = refine_partition(b, cells, &trace, NULL,
+			       rounds + level * (n+1));
+  if (num_cells != counts[level] || trace != traces[level])
+    return FALSE;  /* not like the path to the leaf for a */
+  else if (num_cells == n) {
+    /* We have a permutation:  a -> canonical order -> b. */
+    int *pb1 = malloc(n * sizeof(int));
+    int *sigma = malloc(n * sizeof(int));
+    LADR_BOOL ok;
+    int x;
     Iso_perms++;
-    return ident_interp_perm(a, b, p);
+    invert_perm(cells, pb1, n);
+    for (x = 0; x < n; x++)
+      sigma[x] = pb1[pa[x]];
+    ok = ident_interp_perm(a, b, sigma);
+    free(pb1);
+    free(sigma);
+    return ok;
   }
   else {
-    /* Continue building permutations. */
-    if (iso_interp_recurse(p, k+1, n, a, b, normal))
-      return TRUE;
-    for (i = k+1; i < n; i++) {
-      /* If normal, and if i and k are in the same block,
-	 don't swap them. */
-      if (!normal || a->blocks[i] == a->blocks[k]) {
-	ISWAP(p[k], p[i]);
-	if (iso_interp_recurse(p, k+1, n, a, b, normal))
+    int c = target_cell(cells, n, num_cells);
+    int v;
+    for (v = 0; v < n; v++) {
+      if (cells[v] == c) {
+	int *new = individualize(cells, n, v);
+	LADR_BOOL found = iso_search(a, pa, b, new, level+1,
+				     traces, counts, rounds, depth);
+	free(new);
+	if (found)
 	  return TRUE;
-	ISWAP(p[k], p[i]);
       }
     }
     return FALSE;
   }
-}  /* iso_interp_recurse */
+}  /* iso_search */
 
 /*************
  *
@@ -1931,7 +3434,6 @@ normal_interp(); this allows some optimization.
 LADR_BOOL isomorphic_interps(Interp a, Interp b, LADR_BOOL normal)
 {
   LADR_BOOL isomorphic;
-  int *perm;
 
   if (a->size != b->size)
     return FALSE;
@@ -1948,10 +3450,24 @@ LADR_BOOL isomorphic_interps(Interp a, Interp b, LADR_BOOL normal)
 
   Iso_checks++;
 
-  perm = trivial_permutation(a->size);  /* remember to free this */
+  /* Find one leaf of the refinement tree for a, then look
+     for a leaf for b with the same refinements along the way. */
 
-  isomorphic = iso_interp_recurse(perm, 0, a->size, a, b, normal);
-  free(perm);
+  {
+    int n = a->size;
+    int *pa = initial_partition(a, normal);  /* remember to free this */
+    int *pb = initial_partition(b, normal);  /* remember to free this */
+    unsigned *traces = malloc((n+1) * sizeof(unsigned));  /* free this */
+    int *counts = malloc((n+1) * sizeof(int));             /* free this */
+    unsigned *rounds = malloc((n+1) * (n+1) * sizeof(unsigned)); /* free */
+    int depth = first_leaf(a, pa, traces, counts, rounds);
+    isomorphic = iso_search(a, pa, b, pb, 0, traces, counts, rounds, depth);
+    free(pa);
+    free(pb);
+    free(traces);
+    free(counts);
+    free(rounds);
+  }
   return isomorphic;
 }  /* isomorphic_normal_interps */
 
@@ -1994,7 +3510,9 @@ Term interp_comments(Interp a)
  *************/
 
 /* DOCUMENTATION
-Given a symbol and arity, return the corresponding table.
+Given a symbol and arity, return a copy of the corresponding table
+(an array of ints, with -1 for undefined entries), or NULL if the
+symbol is not in the interpretation.  The caller should free the copy.
 */
 
 /* PUBLIC */
@@ -2002,8 +3520,16 @@ int *interp_table(Interp p, char *sym, int arity)
 {
   int f;
   for (f = 0; f < p->num_tables; f++)
-    if (is_symbol(f, sym, arity))
-      return p->tables[f];
+    if (p->tables[f] != NULL && is_symbol(f, sym, arity)) {
+      int *table;
+      int i, n;
+      for (i = 0, n = 1; i < arity; i++)
+	n = n * p->size;
+      table = malloc(n * sizeof(int));
+      for (i = 0; i < n; i++)
+	table[i] = table_entry(p, p->tables[f], i);
+      return table;
+    }
   return NULL;
 }  /* interp_table */
 
@@ -2183,8 +3709,10 @@ void update_interp_with_constant(Interp p, Term constant, int val)
   else if (p->tables[sn] != NULL)
     fatal_error("update_interp_with_constat, table not NULL");
   else {
-    p->tables[sn] = malloc(sizeof(int));
-    p->tables[sn][0] = val;
+    p->tables[sn] = new_table(p, 1);
+    p->types[sn] = FUNCTION;
+    p->arities[sn] = 0;
+    set_table_entry(p, p->tables[sn], 0, val);
   }
 }  /* update_interp_with_constant */
 
@@ -2222,15 +3750,20 @@ Ordertype compare_interp(Interp a, Interp b)
 {
   int f;
   for (f = 0; f < a->num_tables; f++) {
-    if (a->tables[f] != NULL) {
-      int *at =   a->tables[f];
-      int *bt =   b->tables[f];
+    if (a->tables[f] != NULL &&
+	/* packed tables are usually the same; if not, find where */
+	(!a->packed || memcmp(a->tables[f], b->tables[f],
+			      table_bytes(a, f)) != 0)) {
+      void *at =   a->tables[f];
+      void *bt =   b->tables[f];
       int n = int_power(a->size, a->arities[f]);
       int i;
       for (i = 0; i < n; i++) {
-	if (at[i] < bt[i])
+	int x = table_entry(a, at, i);
+	int y = table_entry(b, bt, i);
+	if (x < y)
 	  return LESS_THAN;
-	else if (at[i] > bt[i])
+	else if (x > y)
 	  return GREATER_THAN;
       }
     }
@@ -2256,6 +3789,37 @@ LADR_BOOL ident_interp(Interp a, Interp b)
   return compare_interp(a,b) == SAME_AS;
 }  /* ident_interp */
 
+/*************
+ *
+ *   hash_interp()
+ *
+ *************/
+
+/* DOCUMENTATION
+Return a hash value for an interpretation, computed from its tables.
+Identical interpretations get the same value, so this can be used
+with canonical forms (canon_interp()) to find isomorphic copies.
+*/
+
+/* PUBLIC */
+unsigned hash_interp(Interp a)
+{
+  unsigned h = 2166136261u;  /* FNV-1a */
+  int f;
+  h = (h ^ (unsigned) a->size) * 16777619u;
+  for (f = 0; f < a->num_tables; f++) {
+    if (a->tables[f] != NULL) {
+      void *at = a->tables[f];
+      int n = int_power(a->size, a->arities[f]);
+      int i;
+      h = (h ^ (unsigned) f) * 16777619u;
+      for (i = 0; i < n; i++)
+	h = (h ^ (unsigned) table_entry(a, at, i)) * 16777619u;
+    }
+  }
+  return h;
+}  /* hash_interp */
+
 static
 Ordertype compare_ints(int a, int b)
 {
@@ -2267,22 +3831,6 @@ Ordertype compare_ints(int a, int b)
     return SAME_AS;
 }  /* compare_ints */
 
-static
-void invert_perm(int *a, int *b, int n)
-{
-  int i;
-  for (i = 0; i < n; i++)
-    b[a[i]] = i;
-}  /* invert_perm */
-
-static
-void copy_perm(int *a, int *b, int n)
-{
-  int i;
-  for (i = 0; i < n; i++)
-    b[i] = a[i];
-}  /* copy_perm */
-
 /*************
  *
  *   compare_permed_interps()
@@ -2304,13 +3852,14 @@ Ordertype compare_permed_interps(int *x, int *y, int *xx, int *yy, Interp a)
   int f;
   for (f = 0; f < a->num_tables; f++) {
     if (a->tables[f] != NULL) {
-      int *t =   a->tables[f];
+      void *t =   a->tables[f];
       int arity = a->arities[f];
       LADR_BOOL function = (a->types[f] == FUNCTION);
       if (arity == 0) {
 	Ordertype result;
 	if (function)
-	  result = compare_ints(x[t[0]], y[t[0]]);
+	  result = compare_ints(x[table_entry(a, t, 0)],
+				y[table_entry(a, t, 0)]);
 	else
 	  result = SAME_AS;
 	if (result != SAME_AS)
@@ -2319,11 +3868,13 @@ Ordertype compare_permed_interps(int *x, int *y, int *xx, int *yy, Interp a)
       else if (arity == 1) {
 	int i;
 	for (i = 0; i < n; i++) {
+	  int u = table_entry(a, t, xx[i]);
+	  int v = table_entry(a, t, yy[i]);
 	  Ordertype result;
 	  if (function)
-	    result = compare_ints(x[t[xx[i]]], y[t[yy[i]]]);
+	    result = compare_ints(x[u], y[v]);
 	  else
-	    result = compare_ints(t[xx[i]], t[yy[i]]);
+	    result = compare_ints(u, v);
 	  if (result != SAME_AS)
 	    return result;
 	}
@@ -2332,13 +3883,13 @@ Ordertype compare_permed_interps(int *x, int *y, int *xx, int *yy, Interp a)
 	int i, j;
 	for (i = 0; i < n; i++)
 	  for (j = 0; j < n; j++) {
+	    int u = table_entry(a, t, I2(n,xx[i],xx[j]));
+	    int v = table_entry(a, t, I2(n,yy[i],yy[j]));
 	    Ordertype result;
 	    if (function)
-	      result = compare_ints(x[t[I2(n,xx[i],xx[j])]],
-				    y[t[I2(n,yy[i],yy[j])]]);
+	      result = compare_ints(x[u], y[v]);
 	    else
-	      result = compare_ints(t[I2(n,xx[i],xx[j])],
-				    t[I2(n,yy[i],yy[j])]);
+	      result = compare_ints(u, v);
 	    if (result != SAME_AS)
 	      return result;
 	  }
@@ -2348,13 +3899,13 @@ Ordertype compare_permed_interps(int *x, int *y, int *xx, int *yy, Interp a)
 	for (i = 0; i < n; i++)
 	  for (j = 0; j < n; j++)
 	    for (k = 0; k < n; k++) {
+	      int u = table_entry(a, t, I3(n,xx[i],xx[j],xx[k]));
+	      int v = table_entry(a, t, I3(n,yy[i],yy[j],yy[k]));
 	      Ordertype result;
 	      if (function)
-		result = compare_ints(x[t[I3(n,xx[i],xx[j],xx[k])]],
-				      y[t[I3(n,yy[i],yy[j],yy[k])]]);
+		result = compare_ints(x[u], y[v]);
 	      else
-		result = compare_ints(t[I3(n,xx[i],xx[j],xx[k])],
-				      t[I3(n,yy[i],yy[j],yy[k])]);
+		result = compare_ints(u, v);
 	      if (result != SAME_AS)
 		return result;
 	    }
@@ -2368,47 +3919,152 @@ Ordertype compare_permed_interps(int *x, int *y, int *xx, int *yy, Interp a)
 
 /*************
  *
- *   canon_recurse()
+ *   canon_search()
+ *
+ *   Search the refinement tree for the leaf that gives the least
+ *   permuted interpretation.  Two leaves that give the same one
+ *   differ by an automorphism; automorphisms that fix the elements
+ *   individualized so far are used to skip equivalent branches.
  *
  *************/
 
+#define MAX_AUTOS 64
+
+struct canon_state {
+  Interp a;
+  int *best;               /* best leaf so far (or NULL) */
+  int *best1;              /* inverse of best */
+  int *perm1;              /* work space */
+  int *autos[MAX_AUTOS];   /* automorphisms found */
+  int num_autos;
+  long unsigned leaves;    /* permutations examined */
+};
+
 static
-void canon_recurse(int k, int *perm, int *best, int *perm1, int *best1,
-		   Interp a)
-{
-  /* 
-     k: current position in working permutation
-     perm:  working permutation
-     best:  best permutation so far
-     perm1: inverse of perm
-     best1: inverse of best
-     a: base interp
-   */
-  int n = a->size;
-  if (k == n) {
+int orbit_root(int *parent, int x)
+{
+  while (parent[x] != x)
+    x = parent[x];
+  return x;
+}  /* orbit_root */
+
+static
+void canon_search(struct canon_state *s, int *cells, int *fixed, int nfixed)
+{
+  int n = s->a->size;
+  unsigned trace;
+  int num_cells = refine_partition(s->a, cells, &trace, NULL, NULL);
+
+  if (num_cells == n) {
     /* We have a permutation. */
-    Iso_perms++;
-    invert_perm(perm, perm1, a->size);
-    if (compare_permed_interps(perm, best, perm1, best1, a) == LESS_THAN) {
-      /* copy working permutation to best-so-far. */
-      copy_perm(perm, best, a->size);
-      copy_perm(perm1, best1, a->size);
+    s->leaves++;
+    invert_perm(cells, s->perm1, n);
+    if (s->best == NULL) {
+      s->best = malloc(n * sizeof(int));
+      s->best1 = malloc(n * sizeof(int));
+      copy_perm(cells, s->best, n);
+      copy_perm(s->perm1, s->best1, n);
+    }
+    else {
+      Ordertype r = compare_permed_interps(cells, s->best, s->perm1,
+					   s->best1, s->a);
+      if (r == LESS_THAN) {
+	copy_perm(cells, s->best, n);
+	copy_perm(s->perm1, s->best1, n);
+      }
+      else if (r == SAME_AS && s->num_autos < MAX_AUTOS) {
+	int *g = malloc(n * sizeof(int));
+	int x;
+	for (x = 0; x < n; x++)
+	  g[x] = s->best1[cells[x]];
+	s->autos[s->num_autos++] = g;
+      }
     }
   }
   else {
-    /* Continue building permutations. */
-    int i;
-    canon_recurse(k+1, perm, best, perm1, best1, a);
-    for (i = k+1; i < n; i++) {
-      /* If i and k are in different blocks, don't swap them. */
-      if (a->blocks[i] == a->blocks[k]) {
-	ISWAP(perm[k], perm[i]);
-	canon_recurse(k+1, perm, best, perm1, best1, a);
-	ISWAP(perm[k], perm[i]);
+    int c = target_cell(cells, n, num_cells);
+    int *parent = malloc(n * sizeof(int));  /* orbits of the children */
+    int *done = calloc(n, sizeof(int));     /* children searched */
+    int autos_used = -1;
+    int v;
+    for (v = 0; v < n; v++) {
+      if (cells[v] == c) {
+	int *new;
+	LADR_BOOL skip = FALSE;
+	if (autos_used != s->num_autos) {
+	  /* Orbits under the automorphisms that fix the path. */
+	  int i, x;
+	  for (x = 0; x < n; x++)
+	    parent[x] = x;
+	  for (i = 0; i < s->num_autos; i++) {
+	    int *g = s->autos[i];
+	    int k;
+	    for (k = 0; k < nfixed && g[fixed[k]] == fixed[k]; k++);
+	    if (k == nfixed) {
+	      for (x = 0; x < n; x++) {
+		int r1 = orbit_root(parent, x);
+		int r2 = orbit_root(parent, g[x]);
+		if (r1 != r2)
+		  parent[IMAX(r1,r2)] = IMIN(r1,r2);
+	      }
+	    }
+	  }
+	  autos_used = s->num_autos;
+	}
+	{
+	  int u;
+	  for (u = 0; u < v && !skip; u++)
+	    if (done[u] && orbit_root(parent, u) == orbit_root(parent, v))
+	      skip = TRUE;
+	}
+	if (!skip) {
+	  new = individualize(cells, n, v);
+	  fixed[nfixed] = v;
+	  canon_search(s, new, fixed, nfixed+1);
+	  free(new);
+	  done[v] = 1;
+	}
       }
     }
+    free(parent);
+    free(done);
   }
-}  /* canon_recurse */
+}  /* canon_search */
+
+/*************
+ *
+ *   canon_labelling()
+ *
+ *   Search from the given partition (which is freed), and return
+ *   the best leaf.  Only malloc() and free() are used.
+ *
+ *************/
+
+static
+int *canon_labelling(Interp a, int *cells, long unsigned *leaves)
+{
+  struct canon_state s;
+  int *fixed = malloc(a->size * sizeof(int));  /* remember to free this */
+  int i;
+
+  s.a = a;
+  s.best = NULL;
+  s.best1 = NULL;
+  s.perm1 = malloc(a->size * sizeof(int));
+  s.num_autos = 0;
+  s.leaves = 0;
+
+  canon_search(&s, cells, fixed, 0);
+
+  free(cells);
+  free(fixed);
+  free(s.best1);
+  free(s.perm1);
+  for (i = 0; i < s.num_autos; i++)
+    free(s.autos[i]);
+  *leaves += s.leaves;
+  return s.best;
+}  /* canon_labelling */
 
 /*************
  *
@@ -2420,33 +4076,45 @@ void canon_recurse(int k, int *perm, int *best, int *perm1, int *best1,
 Return the (unique) canonical form of the interp.
 The input interp (which is not changed) is assumed
 to be in normal form.
+<P>
+The canonical form is found by partition refinement: the elements
+are split into classes by the table entries they take part in,
+then individualized one at a time (with refinement after each),
+and the least of the resulting permuted interps is taken.
+Automorphisms found along the way are used to prune the search.
 */
 
 /* PUBLIC */
 Interp canon_interp(Interp a)
 {
-  Interp canon;
-
-  int *perm  = trivial_permutation(a->size);  /* remember to free this */
-  int *best  = trivial_permutation(a->size);  /* remember to free this */
-  int *perm1 = trivial_permutation(a->size);  /* remember to free this */
-  int *best1 = trivial_permutation(a->size);  /* remember to free this */
-
-  invert_perm(best, best1, a->size);  /* let best1 be the inverse of best */
-  /* perm gets inverted when needed */
-
-  canon_recurse(0, perm, best, perm1, best1, a);
-
-  canon = permute_interp(a, best);  /* makes new copy */
-
-  free(perm);
+  int *best = canon_labelling(a, initial_partition(a, TRUE), &Iso_perms);
+  Interp canon = permute_interp(a, best);  /* makes new copy */
   free(best);
-  free(perm1);
-  free(best1);
-
   return canon;
 }  /* canon_interp */
 
+/*************
+ *
+ *   canon_interp_perm()
+ *
+ *************/
+
+/* DOCUMENTATION
+Return a canonical labelling of an interp: a permutation p such
+that permute_interp(a,p) is the same for all interps isomorphic
+to a.  Unlike canon_interp(), the interp need not be in normal form,
+nothing is allocated from the LADR memory pools, and no global
+statistics are updated, so different interps can be given to
+different threads at the same time.  The number of permutations
+examined is added to *perms.  The caller should free the result.
+*/
+
+/* PUBLIC */
+int *canon_interp_perm(Interp a, long unsigned *perms)
+{
+  return canon_labelling(a, initial_partition(a, FALSE), perms);
+}  /* canon_interp_perm */
+
 /*************
  *
  *   assign_discriminator_counts()
@@ -2702,6 +4370,65 @@ LADR_BOOL same_profiles(Interp a, Interp b)
   return TRUE;
 }  /* same_profiles */
 
+/*************
+ *
+ *   hash_interp_profile()
+ *
+ *************/
+
+/* DOCUMENTATION
+Return a hash value computed from the profile of a normal
+interpretation (see normal3_interp()), along with some counts
+for the binary operations (commuting pairs, associative triples,
+and elements that are left or right identities for some element).
+All of these are invariant under isomorphism, and normal3_interp()
+sorts the profile, so isomorphic interpretations get the same value.
+This can be used to avoid isomorphism checks between interpretations
+that cannot be isomorphic.
+*/
+
+/* PUBLIC */
+unsigned hash_interp_profile(Interp a)
+{
+  unsigned h = 2166136261u;  /* FNV-1a, as in hash_interp() */
+  int n = a->size;
+  int i, j, k, f;
+  h = (h ^ (unsigned) n) * 16777619u;
+  for (i = 0; i < n; i++)
+    for (j = 0; j < a->num_profile_components; j++)
+      h = (h ^ (unsigned) a->profile[i][j]) * 16777619u;
+  for (i = 0; i < a->num_discriminators; i++)
+    h = (h ^ (unsigned) a->discriminator_counts[i]) * 16777619u;
+
+  for (f = 0; f < a->num_tables; f++) {
+    void *t = a->tables[f];
+    if (t != NULL && a->arities[f] == 2 && a->types[f] == FUNCTION) {
+      int commuting = 0, associative = 0, left = 0, right = 0;
+      for (i = 0; i < n; i++) {
+	for (j = 0; j < n; j++) {
+	  int ij = table_entry(a, t, I2(n,i,j));
+	  if (ij == table_entry(a, t, I2(n,j,i)))
+	    commuting++;
+	  if (ij == j)
+	    left++;
+	  if (ij == i)
+	    right++;
+	  for (k = 0; k < n; k++)
+	    if (table_entry(a, t, I2(n,ij,k)) ==
+		table_entry(a, t, I2(n,i,table_entry(a, t, I2(n,j,k)))))
+	      associative++;
+	}
+      }
+      h = (h ^ (unsigned) f) * 16777619u;
+      h = (h ^ (unsigned) commuting) * 16777619u;
+      h = (h ^ (unsigned) associative) * 16777619u;
+      h = (h ^ (unsigned) left) * 16777619u;
+      h = (h ^ (unsigned) right) * 16777619u;
+    }
+  }
+  return h;
+}  /* hash_interp_profile */
+
 /*************
  *
  *   perms_required()
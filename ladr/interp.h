@@ -29,6 +29,10 @@
 
 typedef struct interp *Interp;
 
+typedef struct eval_prog * Eval_prog;  /* a compiled clause */
+
+typedef struct interp_bin * Interp_bin;  /* a binary stream's signature */
+
 enum { SEMANTICS_NOT_EVALUATED,
        SEMANTICS_NOT_EVALUABLE,
        SEMANTICS_TRUE,
@@ -69,14 +73,34 @@ void fprint_interp_tabular(FILE *fp, Interp p);
 
 void fprint_interp_raw(FILE *fp, Interp p);
 
+Interp_bin fwrite_interp_bin_header(FILE *fp, Interp p);
+
+void fwrite_interp_bin(FILE *fp, Interp_bin b, Interp p);
+
+Interp_bin fread_interp_bin_header(FILE *fp);
+
+Interp fread_interp_bin(FILE *fp, Interp_bin b);
+
+void zap_interp_bin(Interp_bin b);
+
+Interp fread_interp(FILE *fp, Interp_bin b, LADR_BOOL allow_incomplete);
+
 int eval_term_ground(Term t, Interp p, int *vals);
 
+void zap_eval_prog(Eval_prog e);
+
 LADR_BOOL eval_literals(Literals lits, Interp p);
 
 int eval_literals_true_instances(Literals lits, Interp p);
 
 int eval_literals_false_instances(Literals lits, Interp p);
 
+Eval_prog compile_eval_literals(Literals lits, Interp p);
+
+LADR_BOOL run_eval_literals(Eval_prog e, Interp p);
+
+LADR_BOOL same_interp_signature(Interp a, Interp b);
+
 LADR_BOOL eval_formula(Formula f, Interp p);
 
 Term interp_remove_constants_recurse(Term ops);
@@ -87,6 +111,10 @@ Term interp_remove_others_recurse(Term ops, Plist keepers);
 
 void interp_remove_others(Term t, Plist keepers);
 
+void remove_interp_constants(Interp p);
+
+void remove_interp_others(Interp p, Plist keepers);
+
 Interp copy_interp(Interp p);
 
 Interp permute_interp(Interp source, int *p);
@@ -125,8 +153,12 @@ Ordertype compare_interp(Interp a, Interp b);
 
 LADR_BOOL ident_interp(Interp a, Interp b);
 
+unsigned hash_interp(Interp a);
+
 Interp canon_interp(Interp a);
 
+int *canon_interp_perm(Interp a, long unsigned *perms);
+
 void assign_discriminator_counts(Interp a, Plist discriminators);
 
 LADR_BOOL same_discriminator_counts(Interp a, Interp b);
@@ -143,6 +175,8 @@ Interp normal3_interp(Interp a, Plist discriminators);
 
 LADR_BOOL same_profiles(Interp a, Interp b);
 
+unsigned hash_interp_profile(Interp a);
+
 long unsigned perms_required(Interp a);
 
 long unsigned factorial(int n);
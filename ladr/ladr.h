@@ -27,6 +27,7 @@
 #include "clausify.h"
 #include "ac_redun.h"
 #include "int_code.h"
+#include "snapshot.h"
 #include "di_tree.h"
 #include "definitions.h"
 #include "dollar.h"
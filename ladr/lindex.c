@@ -231,3 +231,26 @@ LADR_BOOL lindex_backtrack(Lindex idx)
   return (idx->pos->unif_type == BACKTRACK_UNIF ||
 	  idx->neg->unif_type == BACKTRACK_UNIF);
 }  /* lindex_backtrack */
+
+/*************
+ *
+ *   fprint_lindex_stats()
+ *
+ *************/
+
+/* DOCUMENTATION
+This routine prints (to FILE *fp) the statistics (see
+fprint_mindex_stats()) of the positive and negative Mindexes of
+an Lindex.  The string name identifies the Lindex.
+*/
+
+/* PUBLIC */
+void fprint_lindex_stats(FILE *fp, char *name, Lindex ldx)
+{
+  char *s = malloc(strlen(name) + 5);
+  sprintf(s, "%s_pos", name);
+  fprint_mindex_stats(fp, s, ldx->pos);
+  sprintf(s, "%s_neg", name);
+  fprint_mindex_stats(fp, s, ldx->neg);
+  free(s);
+}  /* fprint_lindex_stats */
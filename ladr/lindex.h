@@ -74,4 +74,6 @@ LADR_BOOL lindex_empty(Lindex idx);
 
 LADR_BOOL lindex_backtrack(Lindex idx);
 
+void fprint_lindex_stats(FILE *fp, char *name, Lindex ldx);
+
 #endif  /* conditional compilation of whole file */
@@ -43,9 +43,21 @@ struct mindex_pos {
   /* DISCRIM_BIND */
   Discrim_pos  discrim_position;
 
+  /* SUBST_TREE */
+  Substree_pos subst_position;
+
   Mindex_pos next;  /* for avail list */
 };
 
+/* bulk loading */
+
+static LADR_BOOL Bulk_loading = FALSE;  /* hold inserts */
+static Plist Bulk_indexes = NULL;       /* Mindexes holding inserts */
+
+/* statistics */
+
+static LADR_BOOL Query_depth_stats = FALSE;   /* total the query depths */
+
 /*
  * memory management
  */
@@ -176,13 +188,13 @@ void p_mindex_mem()
 This routine allocates and returns an (empty) Mindex, which is
 used to retrieve unifiable terms.
 <UL>
-<LI><TT>index_type: {LINEAR, FPA, DISCRIM_WILD, DISCRIM_BIND}</TT>
+<LI><TT>index_type: {LINEAR, FPA, DISCRIM_WILD, DISCRIM_BIND, SUBST_TREE}</TT>
 <LI><TT>unif_type: {ORDINARY_UNIF, BACKTRACK_UNIF}</TT>
 <LI><TT>fpa_depth: </TT>depth of FPA indexing
     (ignored for other index types).
 </UL>
-<I>Types of retrieval</I>.  LINEAR and FPA indexes support all types
-of retrieval (FPA is slow for GENERALIZATION).
+<I>Types of retrieval</I>.  LINEAR, FPA, and SUBST_TREE indexes support
+all types of retrieval (FPA is slow for GENERALIZATION).
 DISCRIM_WILD and DISCRIM_BIND indexes support GENERALIZATION retrieval only.
 See mindex_retrieve_first().
 <P>
@@ -213,6 +225,7 @@ Mindex mindex_init(Mindextype mtype, Uniftype utype, int fpa_depth)
   case FPA:          mdx->fpa = fpa_init_index(fpa_depth); break;
   case DISCRIM_WILD: mdx->discrim_tree = discrim_init(); break;
   case DISCRIM_BIND: mdx->discrim_tree = discrim_init(); break;
+  case SUBST_TREE:   mdx->subst_tree = substree_init(); break;
   default:           free_mindex(mdx); mdx = NULL;
   }
 
@@ -233,6 +246,9 @@ terms.  It must exist (be non-NULL).
 /* PUBLIC */
 LADR_BOOL mindex_empty(Mindex mdx)
 {
+  if (mdx->bulk_terms != NULL)
+    return FALSE;
+
   switch (mdx->index_type) {
   case FPA:
     return fpa_empty(mdx->fpa);
@@ -244,6 +260,9 @@ LADR_BOOL mindex_empty(Mindex mdx)
   case DISCRIM_BIND:
     return discrim_empty(mdx->discrim_tree);
     break;
+  case SUBST_TREE:
+    return substree_empty(mdx->subst_tree);
+    break;
   }
   return FALSE;
 }  /* mindex_empty */
@@ -275,6 +294,9 @@ void mindex_free(Mindex mdx)
     case DISCRIM_BIND:
       discrim_dealloc(mdx->discrim_tree);
       break;
+    case SUBST_TREE:
+      substree_dealloc(mdx->subst_tree);
+      break;
     }
     free_mindex(mdx);
   }
@@ -294,6 +316,12 @@ to the Mindex after calling this routine.
 /* PUBLIC */
 void mindex_destroy(Mindex mdx)
 {
+  if (mdx->bulk_terms != NULL) {
+    if (plist_member(Bulk_indexes, mdx))
+      Bulk_indexes = plist_remove(Bulk_indexes, mdx);
+    mindex_bulk_build(mdx);
+  }
+
   if (!mindex_empty(mdx)) {
     fprintf(stdout, "\nWARNING: destroying nonempty mindex.\n\n");
     fprintf(stderr, "\nWARNING: destroying nonempty mindex.\n\n");
@@ -310,6 +338,9 @@ void mindex_destroy(Mindex mdx)
   case DISCRIM_BIND:
     destroy_discrim_tree(mdx->discrim_tree);
     break;
+  case SUBST_TREE:
+    destroy_substree(mdx->subst_tree);
+    break;
   }
   free_mindex(mdx);
 }  /* mindex_destroy */
@@ -392,11 +423,31 @@ a Term t into/from an Mindex mdx.
 <P>
 It is your responsibility to remember that t is in the index,
 because we don't currently have a routine "mindex_member()".
+<P>
+Between mindex_bulk_begin() and mindex_bulk_end(), insertions
+into empty FPA and DISCRIM_BIND indexes are held, to be done
+all at once.
 */
 
 /* PUBLIC */
 void mindex_update(Mindex mdx, Term t, Indexop op)
 {
+  if (Bulk_loading && op == INSERT &&
+      (mdx->index_type == FPA || mdx->index_type == DISCRIM_BIND) &&
+      mdx->fpa_bulk == NULL && mdx->discrim_bulk == NULL &&
+      (mdx->bulk_terms != NULL || mindex_empty(mdx))) {
+    if (mdx->bulk_terms == NULL)
+      Bulk_indexes = plist_append(Bulk_indexes, mdx);
+    if (mdx->index_type == FPA)
+      assign_fpa_id(t);  /* now, so that the IDs are in order */
+    mdx->bulk_terms = plist_prepend(mdx->bulk_terms, t);
+    mdx->num_bulk++;
+    return;
+  }
+
+  if (mdx->bulk_terms != NULL)
+    mindex_bulk_build(mdx);
+
   if (mdx->index_type == FPA)
     fpa_update(t, mdx->fpa, op);
   else if (mdx->index_type == LINEAR)
@@ -405,11 +456,126 @@ void mindex_update(Mindex mdx, Term t, Indexop op)
     discrim_wild_update(t, mdx->discrim_tree, t, op);
   else if (mdx->index_type == DISCRIM_BIND)
     discrim_bind_update(t, mdx->discrim_tree, t, op);
+  else if (mdx->index_type == SUBST_TREE)
+    substree_update(t, mdx->subst_tree, op);
   else {
     fatal_error("ERROR, mindex_update: bad mindex type.");
   }
 }  /* mindex_update */
 
+/*************
+ *
+ *   mindex_bulk_begin()
+ *
+ *************/
+
+/* DOCUMENTATION
+This routine starts bulk loading: until mindex_bulk_end(),
+terms inserted (with mindex_update()) into empty FPA and DISCRIM_BIND
+indexes are held, and each of those indexes is built all at once,
+which is much faster than inserting the terms one by one when there
+are many of them.  The indexes are the same either way, so queries
+get the same answers, in the same order.
+<P>
+An index is built when it is next used (updated, queried, printed,
+or destroyed), so holding is safe, but it is meant for loading
+(for example, initial clauses), with no queries.
+The other types (LINEAR, DISCRIM_WILD, and SUBST_TREE)
+are not held; their terms are inserted one by one, as usual.
+*/
+
+/* PUBLIC */
+void mindex_bulk_begin(void)
+{
+  Bulk_loading = TRUE;
+}  /* mindex_bulk_begin */
+
+/*************
+ *
+ *   mindex_bulk_end()
+ *
+ *************/
+
+/* DOCUMENTATION
+This routine stops bulk loading (see mindex_bulk_begin()), and it
+returns a Plist of the indexes that are holding terms.  The caller
+should free the list, after calling mindex_bulk_build() on
+each of them (otherwise, they are built when they are next used).
+If there are several, mindex_bulk_sort() can be called on them
+first, in parallel.
+*/
+
+/* PUBLIC */
+Plist mindex_bulk_end(void)
+{
+  Plist p = Bulk_indexes;
+  Bulk_loading = FALSE;
+  Bulk_indexes = NULL;
+  return p;
+}  /* mindex_bulk_end */
+
+/*************
+ *
+ *   mindex_bulk_sort()
+ *
+ *************/
+
+/* DOCUMENTATION
+This routine does the first step of building an index that
+is holding terms (see mindex_bulk_begin()):  it sorts the terms
+for building.  It uses only malloc'd memory, so it can be
+called for several indexes in parallel (in threads),
+while nothing else is going on.
+*/
+
+/* PUBLIC */
+void mindex_bulk_sort(Mindex mdx)
+{
+  if (mdx->bulk_terms != NULL &&
+      mdx->fpa_bulk == NULL && mdx->discrim_bulk == NULL) {
+    Term *terms = malloc(mdx->num_bulk * sizeof(Term));
+    int i = mdx->num_bulk;
+    Plist p;
+    for (p = mdx->bulk_terms; p; p = p->next)
+      terms[--i] = p->v;  /* back to the order of insertion */
+    if (mdx->index_type == FPA)
+      mdx->fpa_bulk = fpa_bulk_sort(terms, mdx->num_bulk, mdx->fpa);
+    else
+      mdx->discrim_bulk = discrim_bind_bulk_sort(terms, mdx->num_bulk);
+    free(terms);
+  }
+}  /* mindex_bulk_sort */
+
+/*************
+ *
+ *   mindex_bulk_build()
+ *
+ *************/
+
+/* DOCUMENTATION
+This routine builds an index that is holding terms
+(see mindex_bulk_begin()), calling mindex_bulk_sort() if
+that has not been done.  If the index is not holding terms,
+nothing happens.
+*/
+
+/* PUBLIC */
+void mindex_bulk_build(Mindex mdx)
+{
+  if (mdx->bulk_terms != NULL) {
+    mindex_bulk_sort(mdx);
+    if (mdx->index_type == FPA)
+      fpa_bulk_build(mdx->fpa, mdx->fpa_bulk);
+    else
+      discrim_bind_bulk_build(mdx->discrim_tree, mdx->discrim_bulk);
+    mdx->fpa_bulk = NULL;
+    mdx->discrim_bulk = NULL;
+    zap_plist(mdx->bulk_terms);
+    mdx->bulk_terms = NULL;
+    mdx->num_bulk = 0;
+  }
+}  /* mindex_bulk_build */
+
 /*************
  *
  *    mindex_retrieve_first
@@ -469,6 +635,13 @@ Term mindex_retrieve_first(Term t, Mindex mdx, Querytype qtype,
 {
   Mindex_pos pos;
 
+  if (mdx->bulk_terms != NULL)
+    mindex_bulk_build(mdx);
+
+  mdx->stats.queries[qtype]++;
+  if (Query_depth_stats)
+    mdx->stats.query_depth += term_depth(t);
+
   if ((mdx->index_type == DISCRIM_WILD || mdx->index_type == DISCRIM_BIND) &&
       qtype != GENERALIZATION)
     return NULL;
@@ -492,6 +665,8 @@ Term mindex_retrieve_first(Term t, Mindex mdx, Querytype qtype,
       pos->discrim_position = NULL;
     else if (mdx->index_type == DISCRIM_BIND)
       pos->discrim_position = NULL;
+    else if (mdx->index_type == SUBST_TREE)
+      pos->subst_position = NULL;
     else if (mdx->index_type == LINEAR)
       pos->linear_position = mdx->linear_first;
 
@@ -541,6 +716,19 @@ Term next_candidate(Mindex_pos pos)
       tf = discrim_bind_retrieve_next(pos->discrim_position);
   }
 
+  else if (pos->index->index_type == SUBST_TREE) {
+    if (pos->subst_position == NULL)
+      tf = substree_retrieve_first(pos->query_term,
+				   pos->query_subst,
+				   pos->query_type,
+				   pos->index->subst_tree,
+				   &(pos->subst_position));
+    else
+      tf = substree_retrieve_next(pos->subst_position);
+    if (tf == NULL)
+      pos->subst_position = NULL;
+  }
+
   else if (pos->index->index_type == LINEAR) {
     if (pos->linear_position == NULL)
       tf = NULL;
@@ -552,6 +740,8 @@ Term next_candidate(Mindex_pos pos)
 
   else
     tf = NULL;
+  if (tf != NULL)
+    pos->index->stats.candidates++;
   return tf;
 }  /* next_candidate */
 
@@ -587,6 +777,8 @@ Term retrieve_next_backtrack(Mindex_pos pos)
 	pos->btu_position = unify_bt_first(tq, cq, tf, cf);
 	if (pos->btu_position == NULL)
 	  tf = next_candidate(pos);
+	else
+	  pos->index->stats.answers++;
       }
     }
   }  /* UNIFY */
@@ -606,6 +798,8 @@ Term retrieve_next_backtrack(Mindex_pos pos)
 	  pos->btm_position = match_bt_first(tf, cf, tq, pos->partial_match);
 	if (pos->btm_position == NULL)
 	  tf = next_candidate(pos);
+	else
+	  pos->index->stats.answers++;
       }
     }
   }  /* INSTANCE || GENERALIZATION */
@@ -689,6 +883,7 @@ Term mindex_retrieve_next(Mindex_pos pos)
 #if 0
       printf("          MATE, %d: ", tf->INDEX_ID); p_term(tf);
 #endif	
+      pos->index->stats.answers++;
       return tf;
     }
     else {
@@ -751,6 +946,10 @@ void mindex_retrieve_cancel(Mindex_pos pos)
     discrim_wild_cancel(pos->discrim_position);
   else if (pos->index->index_type == DISCRIM_BIND)
     discrim_bind_cancel(pos->discrim_position);
+  else if (pos->index->index_type == SUBST_TREE) {
+    if (pos->subst_position != NULL)
+      substree_cancel(pos->subst_position);
+  }
 
   free_mindex_pos(pos);
 }  /* mindex_retrieve_cancel */
@@ -786,6 +985,9 @@ This routine prints (to FILE *fp) Mindex mdx.
 /* PUBLIC */
 void fprint_mindex(FILE *fp, Mindex mdx)
 {
+  if (mdx->bulk_terms != NULL)
+    mindex_bulk_build(mdx);
+
   switch (mdx->index_type) {
   case LINEAR:
     fprintf(fp, "\nThis is an Mindex of type LINEAR.\n");
@@ -803,5 +1005,144 @@ void fprint_mindex(FILE *fp, Mindex mdx)
     fprintf(fp, "\nThis is an Mindex of type DISCRIM_BIND.\n");
     fprint_discrim_bind_index(fp, mdx->discrim_tree);
     break;
+  case SUBST_TREE:
+    fprintf(fp, "\nThis is an Mindex of type SUBST_TREE.\n");
+    fprint_substree(fp, mdx->subst_tree);
+    break;
   }
 }  /* fprint_mindex */
+
+/*************
+ *
+ *   mindex_type_string()
+ *
+ *************/
+
+static
+char *mindex_type_string(Mindextype mtype)
+{
+  switch (mtype) {
+  case LINEAR:       return "LINEAR";
+  case FPA:          return "FPA";
+  case DISCRIM_WILD: return "DISCRIM_WILD";
+  case DISCRIM_BIND: return "DISCRIM_BIND";
+  case SUBST_TREE:   return "SUBST_TREE";
+  default:           return "???";
+  }
+}  /* mindex_type_string */
+
+/*************
+ *
+ *   mindex_size()
+ *
+ *************/
+
+/* DOCUMENTATION
+This routine finds the number of nodes in an Mindex (for LINEAR,
+the number of terms) and the memory (in pointers, as with get_mem())
+used by it.  The indexed terms are not counted.
+*/
+
+/* PUBLIC */
+void mindex_size(Mindex mdx, int *nodes, int *mem)
+{
+  if (mdx->bulk_terms != NULL)
+    mindex_bulk_build(mdx);
+
+  switch (mdx->index_type) {
+  case LINEAR:
+    *nodes = plist_count(mdx->linear_first);
+    *mem = *nodes * PTRS(sizeof(struct plist));
+    break;
+  case FPA:
+    fpa_index_size(mdx->fpa, nodes, mem);
+    break;
+  case DISCRIM_WILD:
+  case DISCRIM_BIND:
+    discrim_size(mdx->discrim_tree, nodes, mem);
+    break;
+  case SUBST_TREE:
+    substree_size(mdx->subst_tree, nodes, mem);
+    break;
+  default:
+    *nodes = *mem = 0;
+  }
+  *mem += PTRS_MINDEX;
+}  /* mindex_size */
+
+/*************
+ *
+ *   mindex_query_depth_stats()
+ *
+ *************/
+
+/* DOCUMENTATION
+This routine turns on (or off) the totaling of the depths of the
+query terms, for all Mindexes, which costs a walk of each query.
+(This is the depth of the queries, not the depth that retrieval
+reaches in the index.)  The other statistics are always kept.
+*/
+
+/* PUBLIC */
+void mindex_query_depth_stats(LADR_BOOL on)
+{
+  Query_depth_stats = on;
+}  /* mindex_query_depth_stats */
+
+/*************
+ *
+ *   mindex_query_depth_stats_on()
+ *
+ *************/
+
+/* DOCUMENTATION
+Is the totaling of query depths on (see mindex_query_depth_stats())?
+*/
+
+/* PUBLIC */
+LADR_BOOL mindex_query_depth_stats_on(void)
+{
+  return Query_depth_stats;
+}  /* mindex_query_depth_stats_on */
+
+/*************
+ *
+ *   fprint_mindex_stats()
+ *
+ *************/
+
+/* DOCUMENTATION
+This routine prints (to FILE *fp) a line of statistics for Mindex mdx:
+the number of queries (and of each type: unify, instance,
+generalization, variant, identical), the candidates the index
+gave and the answers among them (that is, those that unify or
+match, and the precision answers/candidates), the average depth
+of the query terms (query_depth, if mindex_query_depth_stats() is on),
+and the size of the index.
+The string name identifies the index.
+*/
+
+/* PUBLIC */
+void fprint_mindex_stats(FILE *fp, char *name, Mindex mdx)
+{
+  struct mindex_stats *s = &(mdx->stats);
+  unsigned long queries = 0;
+  int i, nodes, mem;
+
+  for (i = 0; i <= IDENTICAL; i++)
+    queries += s->queries[i];
+  mindex_size(mdx, &nodes, &mem);
+
+  fprintf(fp, "%s (%s): queries=%lu (%lu/%lu/%lu/%lu/%lu), "
+	  "candidates=%lu, answers=%lu (%.2f), ",
+	  name, mindex_type_string(mdx->index_type),
+	  queries,
+	  s->queries[UNIFY], s->queries[INSTANCE], s->queries[GENERALIZATION],
+	  s->queries[LADR_VARIANT], s->queries[IDENTICAL],
+	  s->candidates, s->answers,
+	  s->candidates == 0 ? 1.0 : (double) s->answers / s->candidates);
+  if (Query_depth_stats)
+    fprintf(fp, "query_depth=%.2f, ",
+	    queries == 0 ? 0.0 : (double) s->query_depth / queries);
+  fprintf(fp, "nodes=%d, %.1f K.\n", nodes, mem * BYTES_POINTER / 1024.);
+}  /* fprint_mindex_stats */
@@ -22,6 +22,7 @@
 #include "fpa.h"
 #include "discrimb.h"
 #include "discrimw.h"
+#include "substree.h"
 #include "btu.h"
 #include "btm.h"
 
@@ -64,6 +65,12 @@ Supports <TT>GENERALIZATION</TT> retrieval only.
 <LI><TT>DISCRIM_BIND :</TT> Discrimination indexing, where matching
 occurs during indexing. This supports C symbols, <I>but not AC symbols</I>.
 Supports <TT>GENERALIZATION</TT> retrieval only.
+<LI><TT>SUBST_TREE   :</TT> Substitution trees (see substree.h), in which
+the indexed terms share the nodes for their common generalizations.
+This supports all types of retrieval, and
+<TT>INSTANCE</TT> retrieval is a perfect filter (without AC or C symbols).
+Like FPA, it supports AC symbols (as constants) and C symbols
+(by not looking at their arguments).
 </UL>
 */
 
@@ -74,7 +81,8 @@ Supports <TT>GENERALIZATION</TT> retrieval only.
 typedef enum { LINEAR,
 	       FPA,
 	       DISCRIM_WILD,
-	       DISCRIM_BIND
+	       DISCRIM_BIND,
+	       SUBST_TREE
              } Mindextype;
 
 /* types of unification */
@@ -86,9 +94,23 @@ typedef enum { ORDINARY_UNIF,
 typedef struct mindex * Mindex;
 typedef struct mindex_pos * Mindex_pos;
 
+struct mindex_stats {     /* retrieval statistics */
+  unsigned long queries[IDENTICAL+1];  /* by Querytype */
+  unsigned long candidates;   /* terms from the index */
+  unsigned long answers;      /* candidates that unify or match */
+  unsigned long query_depth;  /* total depth of the query terms (optional) */
+};
+
 struct mindex {
   Mindextype index_type;
   Uniftype   unif_type;
+  struct mindex_stats stats;
+
+  /* bulk loading (see mindex_bulk_begin()) */
+  Plist        bulk_terms;    /* held inserts, latest first */
+  int          num_bulk;
+  Fpa_bulk     fpa_bulk;      /* sorted, for FPA */
+  Discrim_bulk discrim_bulk;  /* sorted, for DISCRIM_BIND */
 
   /* FPA */
   Fpa_index  fpa;
@@ -100,6 +122,9 @@ struct mindex {
   /* DISCRIM_WILD and DISCRIM_BIND */
   Discrim   discrim_tree;
 
+  /* SUBST_TREE */
+  Substree  subst_tree;
+
   Mindex     next;  /* for avail list */
 };
 
@@ -121,6 +146,14 @@ void mindex_destroy(Mindex mdx);
 
 void mindex_update(Mindex mdx, Term t, Indexop op);
 
+void mindex_bulk_begin(void);
+
+Plist mindex_bulk_end(void);
+
+void mindex_bulk_sort(Mindex mdx);
+
+void mindex_bulk_build(Mindex mdx);
+
 Term mindex_retrieve_first(Term t, Mindex mdx, Querytype qtype,
 			   Context query_subst, Context found_subst,
 			   LADR_BOOL partial_match,
@@ -132,4 +165,12 @@ void mindex_retrieve_cancel(Mindex_pos pos);
 
 void fprint_mindex(FILE *fp, Mindex mdx);
 
+void mindex_size(Mindex mdx, int *nodes, int *mem);
+
+void mindex_query_depth_stats(LADR_BOOL on);
+
+LADR_BOOL mindex_query_depth_stats_on(void);
+
+void fprint_mindex_stats(FILE *fp, char *name, Mindex mdx);
+
 #endif  /* conditional compilation of whole file */
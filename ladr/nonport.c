@@ -23,6 +23,8 @@
 
 #ifdef _WIN32
 /* This means that we don't have some UNIXy things */
+#  include <io.h>
+#  include <fcntl.h>
 #else
 #  include <pwd.h>
 #  include <unistd.h>
@@ -108,3 +110,22 @@ int get_bits(void)
 {
   return sizeof(long) == 8 && sizeof(void *) == 8 ? 64 : 32;
 }  /* get_bits */
+
+/*************
+ *
+ *   set_binary_mode()
+ *
+ *************/
+
+/* DOCUMENTATION
+Make a stream (e.g., stdin or stdout) binary, that is, without
+newline translation.  This matters only on Windows.
+*/
+
+/* PUBLIC */
+void set_binary_mode(FILE *fp)
+{
+#ifdef _WIN32
+  _setmode(_fileno(fp), _O_BINARY);
+#endif
+}  /* set_binary_mode */
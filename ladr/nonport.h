@@ -19,6 +19,8 @@
 #ifndef TP_NONPORT_H
 #define TP_NONPORT_H
 
+#include <stdio.h>
+
 /* #define PRIMITIVE_ENVIRONMENT */
 
 /* INTRODUCTION
@@ -45,4 +47,6 @@ int my_process_id(void);
 
 int get_bits(void);
 
+void set_binary_mode(FILE *fp);
+
 #endif  /* conditional compilation of whole file */
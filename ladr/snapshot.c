@@ -0,0 +1,356 @@
+/*  Copyright (C) 2006, 2007 William McCune
+
+    This file is part of the LADR Deduction Library.
+
+    The LADR Deduction Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU General Public License,
+    version 2.
+
+    The LADR Deduction Library is distributed in the hope that it will be
+    useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with the LADR Deduction Library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include "snapshot.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+#  include <io.h>
+#else
+#  include <unistd.h>
+#  include <sys/mman.h>
+#endif
+
+/* Private definitions and types */
+
+enum { SNAP_CLAUSE, SNAP_SHARED };  /* list entries */
+
+/*************
+ *
+ *   put_string_to_ibuf()
+ *
+ *************/
+
+static
+void put_string_to_ibuf(Ibuffer ibuf, char *s)
+{
+  int n = strlen(s);
+  int i;
+  ibuf_write(ibuf, n);
+  for (i = 0; i < n; i++)
+    ibuf_write(ibuf, s[i]);
+}  /* put_string_to_ibuf */
+
+/*************
+ *
+ *   get_string_from_ibuf()
+ *
+ *************/
+
+static
+char *get_string_from_ibuf(Ibuffer ibuf)
+{
+  int n = ibuf_xread(ibuf);
+  char *s = malloc(n + 1);
+  int i;
+  for (i = 0; i < n; i++)
+    s[i] = ibuf_xread(ibuf);
+  s[n] = '\0';
+  return s;
+}  /* get_string_from_ibuf */
+
+/*************
+ *
+ *   put_symbols_to_ibuf()
+ *
+ *************/
+
+static
+void put_symbols_to_ibuf(Ibuffer ibuf)
+{
+  int max = greatest_symnum();
+  int n = 0;
+  int sn;
+
+  for (sn = 1; sn <= max; sn++)
+    if (sn_to_arity(sn) != -1)
+      n++;
+  ibuf_write(ibuf, n);
+
+  for (sn = 1; sn <= max; sn++) {
+    int arity = sn_to_arity(sn);
+    if (arity != -1) {
+      char *name = sn_to_str(sn);
+      int prec = 0;
+      Parsetype type = NOTHING_SPECIAL;
+      if (arity == 2)
+	binary_parse_type(name, &prec, &type);
+      else if (arity == 1)
+	unary_parse_type(name, &prec, &type);
+      ibuf_write(ibuf, sn);
+      ibuf_write(ibuf, arity);
+      ibuf_write(ibuf, get_symbol_type(sn));
+      ibuf_write(ibuf, type);
+      ibuf_write(ibuf, prec);
+      ibuf_write(ibuf, (is_assoc_comm(sn) ? ASSOC_COMMUTE :
+			is_commutative(sn) ? COMMUTE : EMPTY_THEORY));
+      ibuf_write(ibuf, is_skolem(sn));
+      put_string_to_ibuf(ibuf, name);
+    }
+  }
+}  /* put_symbols_to_ibuf */
+
+/*************
+ *
+ *   get_symbols_from_ibuf()
+ *
+ *************/
+
+/* Put the symbols into the symbol table, and return the map
+   from the numbers in the file to the numbers here. */
+
+static
+int *get_symbols_from_ibuf(Ibuffer ibuf, int *map_size)
+{
+  int n = ibuf_xread(ibuf);
+  int size = 1;
+  int *map = calloc(size, sizeof(int));
+  int i;
+
+  for (i = 0; i < n; i++) {
+    int old_sn     = ibuf_xread(ibuf);
+    int arity      = ibuf_xread(ibuf);
+    int type       = ibuf_xread(ibuf);
+    int parse_type = ibuf_xread(ibuf);
+    int prec       = ibuf_xread(ibuf);
+    int theory     = ibuf_xread(ibuf);
+    int skolem     = ibuf_xread(ibuf);
+    char *name     = get_string_from_ibuf(ibuf);
+    int sn = str_to_sn(name, arity);
+
+    if (old_sn >= size) {
+      int new_size = IMAX(old_sn + 1, 2 * size);
+      map = realloc(map, new_size * sizeof(int));
+      memset(map + size, 0, (new_size - size) * sizeof(int));
+      size = new_size;
+    }
+    map[old_sn] = sn;
+
+    if (type != UNSPECIFIED_SYMBOL && get_symbol_type(sn) == UNSPECIFIED_SYMBOL)
+      set_symbol_type(sn, type);
+    if (parse_type != NOTHING_SPECIAL) {
+      int prec2;
+      Parsetype type2;
+      LADR_BOOL special = (arity == 2 ? binary_parse_type(name, &prec2, &type2) :
+			   unary_parse_type(name, &prec2, &type2));
+      if (!special || prec2 != prec || type2 != parse_type)
+	set_parse_type(name, prec, parse_type);
+    }
+    if (theory == ASSOC_COMMUTE && !is_assoc_comm(sn))
+      set_assoc_comm(name, TRUE);
+    else if (theory == COMMUTE && !is_commutative(sn))
+      set_commutative(name, TRUE);
+    if (skolem && !is_skolem(sn))
+      set_skolem(sn);
+    free(name);
+  }
+  *map_size = size;
+  return map;
+}  /* get_symbols_from_ibuf */
+
+/*************
+ *
+ *   shared_clause()
+ *
+ *************/
+
+/* Is c in one of the first n lists? */
+
+static
+LADR_BOOL shared_clause(Topform c, Clist *lists, int n)
+{
+  Clist_pos p;
+  for (p = c->containers; p; p = p->nocc) {
+    int i;
+    for (i = 0; i < n; i++)
+      if (p->list == lists[i])
+	return TRUE;
+  }
+  return FALSE;
+}  /* shared_clause */
+
+/*************
+ *
+ *   write_snapshot()
+ *
+ *************/
+
+/* DOCUMENTATION
+This routine writes a snapshot (see the introduction) of the
+n Clists to a file.  Clauses that are in more than one of the lists
+must have IDs.
+*/
+
+/* PUBLIC */
+void write_snapshot(char *filename, Clist *lists, int n)
+{
+  Ibuffer ibuf = ibuf_init();
+  FILE *fp;
+  int max_id = 0;
+  int i;
+
+  ibuf_write(ibuf, SNAPSHOT_MAGIC);
+  ibuf_write(ibuf, SNAPSHOT_VERSION);
+  put_symbols_to_ibuf(ibuf);
+
+  for (i = 0; i < n; i++) {
+    Clist_pos p;
+    for (p = lists[i]->first; p; p = p->next)
+      max_id = IMAX(max_id, p->c->id);
+  }
+  ibuf_write(ibuf, max_id);
+
+  ibuf_write(ibuf, n);
+  for (i = 0; i < n; i++) {
+    Clist_pos p;
+    put_string_to_ibuf(ibuf, lists[i]->name);
+    ibuf_write(ibuf, lists[i]->length);
+    for (p = lists[i]->first; p; p = p->next) {
+      if (shared_clause(p->c, lists, i)) {
+	if (p->c->id == 0)
+	  fatal_error("write_snapshot, shared clause without ID");
+	ibuf_write(ibuf, SNAP_SHARED);
+	ibuf_write(ibuf, p->c->id);
+      }
+      else {
+	ibuf_write(ibuf, SNAP_CLAUSE);
+	put_clause_to_ibuf(ibuf, p->c);
+      }
+    }
+  }
+
+  fp = fopen(filename, "wb");
+  if (fp == NULL) {
+    perror(filename);
+    fatal_error("write_snapshot, cannot open file");
+  }
+  if (fwrite(ibuf_buffer(ibuf), sizeof(int), ibuf_length(ibuf), fp) !=
+      ibuf_length(ibuf) || fclose(fp) != 0) {
+    perror(filename);
+    fatal_error("write_snapshot, write error");
+  }
+  ibuf_free(ibuf);
+}  /* write_snapshot */
+
+/*************
+ *
+ *   read_snapshot()
+ *
+ *************/
+
+/* DOCUMENTATION
+This routine reads a snapshot (see the introduction) that has
+n lists, and it sets lists[i] to a Plist of the clauses
+of the i-th list, in order.  A clause that was in more than one list
+is in more than one Plist.  The file is mapped into memory
+(except on Windows, where it is read).
+*/
+
+/* PUBLIC */
+void read_snapshot(char *filename, Plist *lists, int n)
+{
+  struct ibuffer buf;
+  Ibuffer ibuf = &buf;
+  Topform *by_id;
+  struct stat st;
+  int *symmap;
+  int map_size, max_id, i;
+#ifdef _WIN32
+  int fd = open(filename, O_RDONLY | _O_BINARY);  /* no newline translation */
+#else
+  int fd = open(filename, O_RDONLY);
+#endif
+
+  if (fd == -1 || fstat(fd, &st) != 0) {
+    perror(filename);
+    fatal_error("read_snapshot, cannot open file");
+  }
+
+#ifdef _WIN32
+  Ibuffer copy = fd_read_to_ibuf(fd);
+  buf = *copy;
+#else
+  buf.buf = mmap(NULL, IMAX(st.st_size, 1), PROT_READ, MAP_PRIVATE, fd, 0);
+  if (buf.buf == MAP_FAILED) {
+    perror(filename);
+    fatal_error("read_snapshot, cannot map file");
+  }
+  buf.size = buf.write_position = st.st_size / sizeof(int);
+#endif
+  buf.read_position = 0;
+  close(fd);
+
+  if (ibuf_read(ibuf) != SNAPSHOT_MAGIC)
+    fatal_error("read_snapshot, not a snapshot (or different byte order)");
+  if (ibuf_read(ibuf) != SNAPSHOT_VERSION)
+    fatal_error("read_snapshot, wrong snapshot version");
+
+  symmap = get_symbols_from_ibuf(ibuf, &map_size);
+  max_id = ibuf_xread(ibuf);
+  by_id = calloc(max_id + 1, sizeof(Topform));
+
+  if (ibuf_xread(ibuf) != n)
+    fatal_error("read_snapshot, wrong number of lists");
+
+  for (i = 0; i < n; i++) {
+    char *name = get_string_from_ibuf(ibuf);
+    int length = ibuf_xread(ibuf);
+    Plist clauses = NULL;
+    int j;
+    for (j = 0; j < length; j++) {
+      Topform c;
+      if (ibuf_xread(ibuf) == SNAP_SHARED) {
+	int id = ibuf_xread(ibuf);
+	c = (id > 0 && id <= max_id ? by_id[id] : NULL);
+	if (c == NULL)
+	  fatal_error("read_snapshot, shared clause not found");
+      }
+      else {
+	c = get_mapped_clause_from_ibuf(ibuf, symmap, map_size);
+	if (c->id > 0 && c->id <= max_id)
+	  by_id[c->id] = c;
+      }
+      clauses = plist_prepend(clauses, c);
+    }
+    lists[i] = reverse_plist(clauses);
+    free(name);
+  }
+
+  /* The clauses are input to the new job. */
+
+  for (i = 0; i < n; i++) {
+    Plist p;
+    for (p = lists[i]; p; p = p->next) {
+      Topform c = p->v;
+      if (c->id != 0 || !has_input_just(c)) {
+	c->id = 0;
+	zap_just(c->justification);
+	c->justification = input_just();
+      }
+    }
+  }
+
+  free(by_id);
+  free(symmap);
+#ifdef _WIN32
+  ibuf_free(copy);
+#else
+  munmap(buf.buf, IMAX(st.st_size, 1));
+#endif
+}  /* read_snapshot */
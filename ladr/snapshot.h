@@ -0,0 +1,62 @@
+/*  Copyright (C) 2006, 2007 William McCune
+
+    This file is part of the LADR Deduction Library.
+
+    The LADR Deduction Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU General Public License,
+    version 2.
+
+    The LADR Deduction Library is distributed in the hope that it will be
+    useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with the LADR Deduction Library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifndef TP_SNAPSHOT_H
+#define TP_SNAPSHOT_H
+
+#include "int_code.h"
+#include "clist.h"
+
+/* INTRODUCTION
+A snapshot is a binary file with some lists of clauses, so that
+a later job (for example, with the same large theory and a
+different goal) can load them instead of reading and processing
+the input again.
+<P>
+The file is a sequence of integers (see ibuffer.h):
+a header (SNAPSHOT_MAGIC, SNAPSHOT_VERSION), the symbol table
+(name, arity, and the properties that are declared in the input:
+function/relation, parse type, AC/C, Skolem), then the lists,
+each a name and its clauses (see int_code.h).  A clause that is
+in more than one list is written once and referred to by its ID.
+The integers are in the byte order of the machine that wrote
+the file, and a file with a different byte order or version
+is rejected.
+<P>
+When a snapshot is read, its symbols are put into the symbol table
+(the numbers can be different, so the terms are translated),
+and the clauses get input justifications and no IDs:
+they are the new job's input.
+Indexes are not in the file; they are built from the clauses
+(see mindex_bulk_begin()).
+*/
+
+/* Public definitions */
+
+#define SNAPSHOT_MAGIC    0x4c414452  /* "LADR" */
+#define SNAPSHOT_VERSION  1
+
+/* End of public definitions */
+
+/* Public function prototypes from snapshot.c */
+
+void write_snapshot(char *filename, Clist *lists, int n);
+
+void read_snapshot(char *filename, Plist *lists, int n);
+
+#endif  /* conditional compilation of whole file */
@@ -0,0 +1,1513 @@
+/*  Copyright (C) 2006, 2007 William McCune
+
+    This file is part of the LADR Deduction Library.
+
+    The LADR Deduction Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU General Public License,
+    version 2.
+
+    The LADR Deduction Library is distributed in the hope that it will be
+    useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with the LADR Deduction Library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include "substree.h"
+
+/* Private definitions and types */
+
+/* Indicator variables are numbered from MAX_VARS; the root indicator
+   stands for the whole term.  Those numbered MAX_VNUM or more are not
+   shared (see get_variable_term()), so the tree frees them itself. */
+
+#define ST_ROOT    MAX_VARS
+#define IND(t)     (VARIABLE(t) && VARNUM(t) >= MAX_VARS)
+
+/* Are two tree terms the same subterm of the answers? */
+
+enum { ST_DIFFERENT, ST_SAME, ST_MAYBE };
+
+/* A substitution (indicator variables to subterms of the term
+   being inserted or deleted), in no particular order.  It binds
+   the indicator variables that are open (not yet bound) at a node. */
+
+struct st_subst {
+  int  *inds;
+  Term *terms;
+  int  n;
+};
+
+struct st_choice {     /* choice point for retrieval */
+  St_node node;        /* node whose children are being tried */
+  int     k;           /* next child */
+  int     top;         /* size of the alignment trail at the node */
+  int     qtop;        /* size of the query variable trail at the node */
+};
+
+struct substree_pos {  /* to save position in set of answers */
+  Querytype type;
+  struct fposition *leaves;  /* heap of positions in the leaves found */
+  int       num_leaves;
+  int       leaves_size;
+  struct st_choice *stack;
+  int       sp;        /* number of choice points */
+  int       stack_size;
+  int       *inds;     /* trail: indicator variables ... */
+  Term      *terms;    /* ... the query subterms they are aligned with ... */
+  Context   *contexts; /* ... and the contexts of those */
+  int       top;       /* size of the trail */
+  int       trail_size;
+  int       *qvars;    /* INSTANCE: query variables ... */
+  Term      *qterms;   /* ... and the tree terms they are bound to, */
+  Term      *qterms2;  /* or (qvars -1) pairs that must be identical */
+  int       qtop;
+  int       qtrail_size;
+  Substree_pos next;   /* for avail list */
+};
+
+/*
+ * memory management
+ */
+
+#define PTRS_ST_NODE PTRS(sizeof(struct st_node))
+static unsigned St_node_gets, St_node_frees;
+
+#define PTRS_SUBSTREE PTRS(sizeof(struct substree))
+static unsigned Substree_gets, Substree_frees;
+
+#define PTRS_SUBSTREE_POS PTRS(sizeof(struct substree_pos))
+static unsigned Substree_pos_gets, Substree_pos_frees;
+
+static unsigned St_arrays_mem;  /* memory (pointers) for bindings, kids */
+
+/* Positions are kept on an avail list of our own, so that the
+   stack, trail, and heap are allocated only once. */
+
+static Substree_pos Pos_avail = NULL;
+
+#define ST_STACK_INIT 64
+
+/*************
+ *
+ *   get_st_node()
+ *
+ *************/
+
+static
+St_node get_st_node(void)
+{
+  St_node p = get_cmem(PTRS_ST_NODE);
+  St_node_gets++;
+  return(p);
+}  /* get_st_node */
+
+/*************
+ *
+ *   st_zap_term()
+ *
+ *   Like zap_term(), but it also frees unshared indicator variables.
+ *
+ *************/
+
+static
+void st_zap_term(Term t)
+{
+  if (VARIABLE(t)) {
+    if (VARNUM(t) >= MAX_VNUM)
+      free(t);
+  }
+  else {
+    int i;
+    for (i = 0; i < ARITY(t); i++)
+      st_zap_term(ARG(t,i));
+    free_term(t);
+  }
+}  /* st_zap_term */
+
+/*************
+ *
+ *   set_binds()
+ *
+ *   Give node d (which has no bindings) the n bindings, which it
+ *   takes (the terms are not copied).
+ *
+ *************/
+
+static
+void set_binds(St_node d, int *inds, Term *terms, int n)
+{
+  int i;
+  if (n > 0) {
+    d->inds = get_mem(PTRS(n * sizeof(int)));
+    d->terms = get_mem(n);
+    St_arrays_mem += PTRS(n * sizeof(int)) + n;
+  }
+  for (i = 0; i < n; i++) {
+    d->inds[i] = inds[i];
+    d->terms[i] = terms[i];
+  }
+  d->num_binds = n;
+}  /* set_binds */
+
+/*************
+ *
+ *   free_binds()
+ *
+ *************/
+
+static
+void free_binds(St_node d)
+{
+  int i;
+  int n = d->num_binds;
+  for (i = 0; i < n; i++)
+    st_zap_term(d->terms[i]);
+  if (n > 0) {
+    St_arrays_mem -= PTRS(n * sizeof(int)) + n;
+    free_mem(d->inds, PTRS(n * sizeof(int)));
+    free_mem(d->terms, n);
+  }
+  d->inds = NULL;
+  d->terms = NULL;
+  d->num_binds = 0;
+}  /* free_binds */
+
+/*************
+ *
+ *    free_st_node()
+ *
+ *************/
+
+static
+void free_st_node(St_node p)
+{
+  free_binds(p);
+  if (p->kids_size > 0) {
+    St_arrays_mem -= p->kids_size;
+    free_mem(p->kids, p->kids_size);
+  }
+  free_mem(p, PTRS_ST_NODE);
+  St_node_frees++;
+}  /* free_st_node */
+
+/*************
+ *
+ *   get_substree()
+ *
+ *************/
+
+static
+Substree get_substree(void)
+{
+  Substree p = get_cmem(PTRS_SUBSTREE);
+  Substree_gets++;
+  return(p);
+}  /* get_substree */
+
+/*************
+ *
+ *    free_substree()
+ *
+ *************/
+
+static
+void free_substree(Substree p)
+{
+  if (p->free_size > 0)
+    free(p->free_inds);
+  free_mem(p, PTRS_SUBSTREE);
+  Substree_frees++;
+}  /* free_substree */
+
+/*************
+ *
+ *   get_substree_pos()
+ *
+ *************/
+
+static
+Substree_pos get_substree_pos(void)
+{
+  Substree_pos p;
+  if (Pos_avail != NULL) {
+    p = Pos_avail;
+    Pos_avail = p->next;
+  }
+  else {
+    p = get_mem(PTRS_SUBSTREE_POS);  /* not initialized */
+    p->stack_size = ST_STACK_INIT;
+    p->stack = malloc(p->stack_size * sizeof(struct st_choice));
+    p->trail_size = ST_STACK_INIT;
+    p->inds = malloc(p->trail_size * sizeof(int));
+    p->terms = malloc(p->trail_size * sizeof(Term));
+    p->contexts = malloc(p->trail_size * sizeof(Context));
+    p->qtrail_size = ST_STACK_INIT;
+    p->qvars = malloc(p->qtrail_size * sizeof(int));
+    p->qterms = malloc(p->qtrail_size * sizeof(Term));
+    p->qterms2 = malloc(p->qtrail_size * sizeof(Term));
+    p->leaves_size = ST_STACK_INIT;
+    p->leaves = malloc(p->leaves_size * sizeof(struct fposition));
+  }
+  Substree_pos_gets++;
+  return(p);
+}  /* get_substree_pos */
+
+/*************
+ *
+ *    free_substree_pos()
+ *
+ *************/
+
+static
+void free_substree_pos(Substree_pos p)
+{
+  p->next = Pos_avail;
+  Pos_avail = p;
+  Substree_pos_frees++;
+}  /* free_substree_pos */
+
+/*************
+ *
+ *   fprint_substree_mem()
+ *
+ *************/
+
+/* DOCUMENTATION
+This routine prints (to FILE *fp) memory usage statistics for data types
+associated with the substree package.
+The Boolean argument heading tells whether to print a heading on the table.
+*/
+
+/* PUBLIC */
+void fprint_substree_mem(FILE *fp, LADR_BOOL heading)
+{
+  int n;
+  if (heading)
+    fprintf(fp, "  type (bytes each)        gets      frees     in use      bytes\n");
+
+  n = sizeof(struct st_node);
+  fprintf(fp, "st_node (%4d)      %11u%11u%11u%9.1f K\n",
+          n, St_node_gets, St_node_frees,
+          St_node_gets - St_node_frees,
+          ((St_node_gets - St_node_frees) * n) / 1024.);
+
+  n = sizeof(struct substree);
+  fprintf(fp, "substree (%4d)     %11u%11u%11u%9.1f K\n",
+          n, Substree_gets, Substree_frees,
+          Substree_gets - Substree_frees,
+          ((Substree_gets - Substree_frees) * n) / 1024.);
+
+  n = sizeof(struct substree_pos);
+  fprintf(fp, "substree_pos (%4d) %11u%11u%11u%9.1f K\n",
+          n, Substree_pos_gets, Substree_pos_frees,
+          Substree_pos_gets - Substree_pos_frees,
+          ((Substree_pos_gets - Substree_pos_frees) * n) / 1024.);
+  fprintf(fp, "      substree arrays:                               %9.1f K\n",
+	  St_arrays_mem * BYTES_POINTER / 1024.);
+
+}  /* fprint_substree_mem */
+
+/*************
+ *
+ *   p_substree_mem()
+ *
+ *************/
+
+/* DOCUMENTATION
+This routine prints (to stdout) memory usage statistics for data types
+associated with the substree package.
+*/
+
+/* PUBLIC */
+void p_substree_mem(void)
+{
+  fprint_substree_mem(stdout, TRUE);
+}  /* p_substree_mem */
+
+/*
+ *  end of memory management
+ */
+
+/*************
+ *
+ *   new_ind()
+ *
+ *************/
+
+static
+int new_ind(Substree idx)
+{
+  if (idx->num_free > 0)
+    return idx->free_inds[--idx->num_free];
+  else
+    return idx->next_ind++;
+}  /* new_ind */
+
+/*************
+ *
+ *   release_ind()
+ *
+ *   Indicator variable v no longer occurs in the tree.
+ *
+ *************/
+
+static
+void release_ind(Substree idx, int v)
+{
+  if (idx->num_free == idx->free_size) {
+    idx->free_size = (idx->free_size == 0 ? 64 : 2 * idx->free_size);
+    idx->free_inds = realloc(idx->free_inds, idx->free_size * sizeof(int));
+  }
+  idx->free_inds[idx->num_free++] = v;
+}  /* release_ind */
+
+/*************
+ *
+ *   insert_kid()
+ *
+ *   Append node k to the children of d.
+ *
+ *************/
+
+static
+void insert_kid(St_node d, St_node k)
+{
+  if (d->num_kids == d->kids_size) {
+    int size = (d->kids_size == 0 ? 2 : 2 * d->kids_size);
+    St_node *a = get_mem(size);
+    int j;
+    St_arrays_mem += size;
+    for (j = 0; j < d->num_kids; j++)
+      a[j] = d->kids[j];
+    if (d->kids_size > 0) {
+      St_arrays_mem -= d->kids_size;
+      free_mem(d->kids, d->kids_size);
+    }
+    d->kids = a;
+    d->kids_size = size;
+  }
+  d->kids[d->num_kids++] = k;
+}  /* insert_kid */
+
+/*************
+ *
+ *   remove_kid()
+ *
+ *************/
+
+static
+void remove_kid(St_node d, int i)
+{
+  for (d->num_kids--; i < d->num_kids; i++)
+    d->kids[i] = d->kids[i+1];
+}  /* remove_kid */
+
+/*************
+ *
+ *   substree_init()
+ *
+ *************/
+
+/* DOCUMENTATION
+This routine allocates and returns an empty substitution tree.
+*/
+
+/* PUBLIC */
+Substree substree_init(void)
+{
+  Substree idx = get_substree();
+  idx->root = get_st_node();
+  idx->next_ind = ST_ROOT + 1;
+  return idx;
+}  /* substree_init */
+
+/*************
+ *
+ *   substree_empty()
+ *
+ *************/
+
+/* DOCUMENTATION
+Does a substitution tree have no terms?
+*/
+
+/* PUBLIC */
+LADR_BOOL substree_empty(Substree idx)
+{
+  return idx->root->num_kids == 0;
+}  /* substree_empty */
+
+/*************
+ *
+ *   substree_dealloc()
+ *
+ *************/
+
+/* DOCUMENTATION
+This routine frees an empty substitution tree.
+*/
+
+/* PUBLIC */
+void substree_dealloc(Substree idx)
+{
+  if (!substree_empty(idx))
+    fatal_error("substree_dealloc, nonempty substitution tree.");
+  free_st_node(idx->root);
+  free_substree(idx);
+}  /* substree_dealloc */
+
+/*************
+ *
+ *   zap_st_node()
+ *
+ *************/
+
+static
+void zap_st_node(St_node d)
+{
+  int i;
+  for (i = 0; i < d->num_kids; i++)
+    zap_st_node(d->kids[i]);
+  if (d->data != NULL)
+    zap_fpalist(d->data);
+  free_st_node(d);
+}  /* zap_st_node */
+
+/*************
+ *
+ *   destroy_substree()
+ *
+ *************/
+
+/* DOCUMENTATION
+This routine frees all the memory associated with a substitution tree
+(but not the indexed terms).
+*/
+
+/* PUBLIC */
+void destroy_substree(Substree idx)
+{
+  zap_st_node(idx->root);
+  free_substree(idx);
+}  /* destroy_substree */
+
+/*************
+ *
+ *   st_term_mem()
+ *
+ *   Memory (pointers) for a bound term.  Ordinary variables are
+ *   shared, and unshared indicator variables are counted as terms.
+ *
+ *************/
+
+static
+int st_term_mem(Term t)
+{
+  if (VARIABLE(t))
+    return VARNUM(t) >= MAX_VNUM ? PTRS(sizeof(struct term)) : 0;
+  else {
+    int i;
+    int n = PTRS(sizeof(struct term)) + ARITY(t);
+    for (i = 0; i < ARITY(t); i++)
+      n += st_term_mem(ARG(t,i));
+    return n;
+  }
+}  /* st_term_mem */
+
+/*************
+ *
+ *   st_node_size()
+ *
+ *************/
+
+static
+void st_node_size(St_node d, int *nodes, int *mem)
+{
+  int i;
+  (*nodes)++;
+  *mem += PTRS_ST_NODE + d->kids_size;
+  if (d->num_binds > 0)
+    *mem += PTRS(d->num_binds * sizeof(int)) + d->num_binds;
+  for (i = 0; i < d->num_binds; i++)
+    *mem += st_term_mem(d->terms[i]);
+  if (d->data != NULL)
+    *mem += fpalist_mem(d->data);
+  for (i = 0; i < d->num_kids; i++)
+    st_node_size(d->kids[i], nodes, mem);
+}  /* st_node_size */
+
+/*************
+ *
+ *   substree_size()
+ *
+ *************/
+
+/* DOCUMENTATION
+This routine finds the number of nodes in a substitution tree and
+the memory (in pointers, as with get_mem()) used by it, including
+the FPA lists at the leaves.
+*/
+
+/* PUBLIC */
+void substree_size(Substree idx, int *nodes, int *mem)
+{
+  *nodes = 0;
+  *mem = PTRS_SUBSTREE + PTRS(idx->free_size * sizeof(int));
+  st_node_size(idx->root, nodes, mem);
+}  /* substree_size */
+
+/*************
+ *
+ *   normal_copy()
+ *
+ *   Copy t, renaming the variables 0, 1, ... by first occurrence.
+ *
+ *************/
+
+static
+Term normal_copy(Term t, int *map, int *n)
+{
+  if (VARIABLE(t)) {
+    if (VARNUM(t) >= MAX_VARS)
+      fatal_error("substree, variable too big");
+    if (map[VARNUM(t)] == -1)
+      map[VARNUM(t)] = (*n)++;
+    return get_variable_term(map[VARNUM(t)]);
+  }
+  else {
+    int i;
+    Term t2 = get_rigid_term_like(t);
+    for (i = 0; i < ARITY(t); i++)
+      ARG(t2,i) = normal_copy(ARG(t,i), map, n);
+    return t2;
+  }
+}  /* normal_copy */
+
+/*************
+ *
+ *   init_subst()
+ *
+ *   The substitution {root := normal copy of t}, with room for
+ *   the open indicator variables, which are at disjoint positions of t.
+ *
+ *************/
+
+static
+void init_subst(struct st_subst *s, Term t)
+{
+  int map[MAX_VARS];
+  int i, n = 0;
+  int size = symbol_count(t);
+  for (i = 0; i < MAX_VARS; i++)
+    map[i] = -1;
+  s->inds = malloc(size * sizeof(int));
+  s->terms = malloc(size * sizeof(Term));
+  s->inds[0] = ST_ROOT;
+  s->terms[0] = normal_copy(t, map, &n);
+  s->n = 1;
+}  /* init_subst */
+
+/*************
+ *
+ *   subst_lookup()
+ *
+ *************/
+
+static
+int subst_lookup(struct st_subst *s, int v)
+{
+  int i;
+  for (i = 0; i < s->n; i++)
+    if (s->inds[i] == v)
+      return i;
+  fatal_error("substree, indicator variable is not open");
+  return -1;  /* to quiet compiler */
+}  /* subst_lookup */
+
+/*************
+ *
+ *   subst_remove()
+ *
+ *************/
+
+static
+void subst_remove(struct st_subst *s, int i)
+{
+  s->n--;
+  s->inds[i] = s->inds[s->n];
+  s->terms[i] = s->terms[s->n];
+}  /* subst_remove */
+
+/*************
+ *
+ *   subst_add()
+ *
+ *************/
+
+static
+void subst_add(struct st_subst *s, int v, Term t)
+{
+  s->inds[s->n] = v;
+  s->terms[s->n] = t;
+  s->n++;
+}  /* subst_add */
+
+/*************
+ *
+ *   generalizes()
+ *
+ *   Is s (from the tree) more general than t (from the term
+ *   being inserted), with only indicator variables as variables?
+ *
+ *************/
+
+static
+LADR_BOOL generalizes(Term s, Term t)
+{
+  if (IND(s))
+    return TRUE;
+  else if (VARIABLE(s))
+    return VARIABLE(t) && VARNUM(s) == VARNUM(t);
+  else if (VARIABLE(t) || SYMNUM(s) != SYMNUM(t))
+    return FALSE;
+  else {
+    int i;
+    for (i = 0; i < ARITY(s); i++)
+      if (!generalizes(ARG(s,i), ARG(t,i)))
+	return FALSE;
+    return TRUE;
+  }
+}  /* generalizes */
+
+/*************
+ *
+ *   node_generalizes()
+ *
+ *************/
+
+static
+LADR_BOOL node_generalizes(St_node d, struct st_subst *s)
+{
+  int i;
+  for (i = 0; i < d->num_binds; i++)
+    if (!generalizes(d->terms[i], s->terms[subst_lookup(s, d->inds[i])]))
+      return FALSE;
+  return TRUE;
+}  /* node_generalizes */
+
+/*************
+ *
+ *   bind_inds()
+ *
+ *   s generalizes t; add the bindings of the indicator variables of s.
+ *
+ *************/
+
+static
+void bind_inds(Term s, Term t, struct st_subst *sub)
+{
+  if (IND(s))
+    subst_add(sub, VARNUM(s), t);
+  else {
+    int i;
+    for (i = 0; i < ARITY(s); i++)
+      bind_inds(ARG(s,i), ARG(t,i), sub);
+  }
+}  /* bind_inds */
+
+/*************
+ *
+ *   descend()
+ *
+ *   Node d generalizes substitution s; make s the substitution
+ *   for the indicator variables that are open below d.
+ *
+ *************/
+
+static
+void descend(St_node d, struct st_subst *s)
+{
+  int i;
+  for (i = 0; i < d->num_binds; i++) {
+    int j = subst_lookup(s, d->inds[i]);
+    Term t = s->terms[j];
+    subst_remove(s, j);
+    bind_inds(d->terms[i], t, s);
+  }
+}  /* descend */
+
+/*************
+ *
+ *   top_compatible()
+ *
+ *************/
+
+static
+LADR_BOOL top_compatible(Term s, Term t)
+{
+  if (VARIABLE(s) || VARIABLE(t))
+    return VARIABLE(s) && VARIABLE(t) && VARNUM(s) == VARNUM(t);
+  else
+    return SYMNUM(s) == SYMNUM(t);
+}  /* top_compatible */
+
+/*************
+ *
+ *   node_shares()
+ *
+ *   Does node d have a binding with something in common with s?
+ *
+ *************/
+
+static
+LADR_BOOL node_shares(St_node d, struct st_subst *s)
+{
+  int i;
+  for (i = 0; i < d->num_binds; i++)
+    if (top_compatible(d->terms[i], s->terms[subst_lookup(s, d->inds[i])]))
+      return TRUE;
+  return FALSE;
+}  /* node_shares */
+
+/*************
+ *
+ *   generalize()
+ *
+ *   Build the most specific common generalization of s (from the tree)
+ *   and t (from the term being inserted).  Where they differ, there
+ *   is a new indicator variable, bound to (a copy of) the piece of s
+ *   in sub_s, and to the piece of t in sub_t.  Where s has an indicator
+ *   variable, it stays, and it is bound to the piece of t in sub_t.
+ *
+ *************/
+
+static
+Term generalize(Substree idx, Term s, Term t,
+		struct st_subst *sub_s, struct st_subst *sub_t)
+{
+  if (IND(s)) {
+    subst_add(sub_t, VARNUM(s), t);
+    return get_variable_term(VARNUM(s));
+  }
+  else if (!top_compatible(s, t)) {
+    int v = new_ind(idx);
+    subst_add(sub_s, v, copy_term(s));
+    subst_add(sub_t, v, t);
+    return get_variable_term(v);
+  }
+  else if (VARIABLE(s))
+    return get_variable_term(VARNUM(s));
+  else {
+    int i;
+    Term g = get_rigid_term_like(s);
+    for (i = 0; i < ARITY(s); i++)
+      ARG(g,i) = generalize(idx, ARG(s,i), ARG(t,i), sub_s, sub_t);
+    return g;
+  }
+}  /* generalize */
+
+/*************
+ *
+ *   new_leaf()
+ *
+ *************/
+
+static
+St_node new_leaf(struct st_subst *s, Term t)
+{
+  St_node d = get_st_node();
+  int i;
+  for (i = 0; i < s->n; i++)
+    s->terms[i] = copy_term(s->terms[i]);
+  set_binds(d, s->inds, s->terms, s->n);
+  d->data = get_fpa_list();
+  fpalist_insert(d->data, t);
+  return d;
+}  /* new_leaf */
+
+/*************
+ *
+ *   split_node()
+ *
+ *   Child i of d has something in common with substitution s, but
+ *   it does not generalize s.  Put a node with the common part in
+ *   its place, with children for the rest of it and the rest of s
+ *   (a new leaf for term t).
+ *
+ *************/
+
+static
+void split_node(Substree idx, St_node d, int i, struct st_subst *s,
+		Term t)
+{
+  St_node k = d->kids[i];
+  St_node m = get_st_node();
+  int n = 0;
+  int j;
+  struct st_subst common, rest;
+
+  for (j = 0; j < k->num_binds; j++)
+    n += symbol_count(k->terms[j]);
+  common.inds = malloc(k->num_binds * sizeof(int));
+  common.terms = malloc(k->num_binds * sizeof(Term));
+  common.n = 0;
+  rest.inds = malloc(n * sizeof(int));
+  rest.terms = malloc(n * sizeof(Term));
+  rest.n = 0;
+
+  for (j = 0; j < k->num_binds; j++) {
+    int v = k->inds[j];
+    int p = subst_lookup(s, v);
+    Term u = s->terms[p];
+    if (top_compatible(k->terms[j], u)) {
+      subst_remove(s, p);
+      subst_add(&common, v, generalize(idx, k->terms[j], u, &rest, s));
+    }
+    else
+      subst_add(&rest, v, copy_term(k->terms[j]));
+  }
+
+  set_binds(m, common.inds, common.terms, common.n);
+  free_binds(k);
+  set_binds(k, rest.inds, rest.terms, rest.n);
+  free(common.inds);
+  free(common.terms);
+  free(rest.inds);
+  free(rest.terms);
+
+  insert_kid(m, k);
+  insert_kid(m, new_leaf(s, t));
+  d->kids[i] = m;
+}  /* split_node */
+
+/*************
+ *
+ *   substree_insert()
+ *
+ *************/
+
+static
+void substree_insert(Term t, Substree idx)
+{
+  struct st_subst s;
+  Term t2;
+  St_node d = idx->root;
+  LADR_BOOL done = FALSE;
+
+  init_subst(&s, t);
+  t2 = s.terms[0];
+
+  while (!done) {
+    int i;
+    for (i = 0; i < d->num_kids && !node_generalizes(d->kids[i], &s); i++);
+    if (i < d->num_kids) {
+      d = d->kids[i];
+      descend(d, &s);
+      if (d->num_kids == 0) {
+	fpalist_insert(d->data, t);
+	done = TRUE;
+      }
+    }
+    else {
+      for (i = 0; i < d->num_kids && !node_shares(d->kids[i], &s); i++);
+      if (i < d->num_kids)
+	split_node(idx, d, i, &s, t);
+      else
+	insert_kid(d, new_leaf(&s, t));
+      done = TRUE;
+    }
+  }
+  zap_term(t2);
+  free(s.inds);
+  free(s.terms);
+}  /* substree_insert */
+
+/*************
+ *
+ *   substitute()
+ *
+ *   Copy s, replacing the indicator variables bound in node k
+ *   (and marking those bindings as used).
+ *
+ *************/
+
+static
+Term substitute(Term s, St_node k, LADR_BOOL *used)
+{
+  if (IND(s)) {
+    int i;
+    for (i = 0; i < k->num_binds; i++) {
+      if (k->inds[i] == VARNUM(s)) {
+	used[i] = TRUE;
+	return copy_term(k->terms[i]);
+      }
+    }
+    return get_variable_term(VARNUM(s));
+  }
+  else if (VARIABLE(s))
+    return get_variable_term(VARNUM(s));
+  else {
+    int i;
+    Term t = get_rigid_term_like(s);
+    for (i = 0; i < ARITY(s); i++)
+      ARG(t,i) = substitute(ARG(s,i), k, used);
+    return t;
+  }
+}  /* substitute */
+
+/*************
+ *
+ *   merge_node()
+ *
+ *   Node d has one child; compose its bindings into d.
+ *
+ *************/
+
+static
+void merge_node(Substree idx, St_node d)
+{
+  St_node k = d->kids[0];
+  int size = d->num_binds + k->num_binds;
+  int *inds = malloc(size * sizeof(int));
+  Term *terms = malloc(size * sizeof(Term));
+  LADR_BOOL *used = calloc(k->num_binds, sizeof(LADR_BOOL));
+  int i, n = 0;
+
+  for (i = 0; i < d->num_binds; i++) {
+    inds[n] = d->inds[i];
+    terms[n++] = substitute(d->terms[i], k, used);
+  }
+  for (i = 0; i < k->num_binds; i++) {
+    if (used[i])
+      release_ind(idx, k->inds[i]);
+    else {
+      inds[n] = k->inds[i];
+      terms[n++] = copy_term(k->terms[i]);
+    }
+  }
+  free_binds(d);
+  set_binds(d, inds, terms, n);
+  free(inds);
+  free(terms);
+  free(used);
+
+  St_arrays_mem -= d->kids_size;
+  free_mem(d->kids, d->kids_size);
+  d->kids = k->kids;
+  d->num_kids = k->num_kids;
+  d->kids_size = k->kids_size;
+  d->data = k->data;
+
+  k->kids_size = 0;  /* the array now belongs to d */
+  free_st_node(k);
+}  /* merge_node */
+
+/*************
+ *
+ *   substree_delete()
+ *
+ *   Look for term t in the leaves below d that generalize s
+ *   (they might not be on the path it was inserted on).
+ *
+ *************/
+
+static
+LADR_BOOL substree_delete(Substree idx, St_node d, struct st_subst *s,
+			  int size, Term t)
+{
+  int i;
+
+  if (d->num_kids == 0 && d != idx->root) {
+    if (FTERM(fpos_skip(first_fpos(d->data), FPA_ID(t))) != t)
+      return FALSE;
+    fpalist_delete(d->data, t);
+    return TRUE;
+  }
+
+  for (i = 0; i < d->num_kids; i++) {
+    St_node k = d->kids[i];
+    if (node_generalizes(k, s)) {
+      LADR_BOOL found;
+      struct st_subst s2;
+      s2.inds = malloc(size * sizeof(int));
+      s2.terms = malloc(size * sizeof(Term));
+      s2.n = s->n;
+      memcpy(s2.inds, s->inds, s->n * sizeof(int));
+      memcpy(s2.terms, s->terms, s->n * sizeof(Term));
+      descend(k, &s2);
+      found = substree_delete(idx, k, &s2, size, t);
+      free(s2.inds);
+      free(s2.terms);
+      if (found) {
+	if (k->num_kids == 0 && fpalist_empty(k->data)) {
+	  remove_kid(d, i);
+	  zap_fpalist(k->data);
+	  free_st_node(k);
+	  if (d != idx->root && d->num_kids == 1)
+	    merge_node(idx, d);
+	}
+	return TRUE;
+      }
+    }
+  }
+  return FALSE;
+}  /* substree_delete */
+
+/*************
+ *
+ *   substree_update()
+ *
+ *************/
+
+/* DOCUMENTATION
+Insert (op==INSERT) or delete (op==DELETE) Term t into/from a
+substitution tree.  The tree has copies of the parts of t; the term
+itself goes into a leaf, and it gets an FPA_ID if it does not have one.
+*/
+
+/* PUBLIC */
+void substree_update(Term t, Substree idx, Indexop op)
+{
+  if (op == INSERT) {
+    assign_fpa_id(t);
+    substree_insert(t, idx);
+  }
+  else {
+    struct st_subst s;
+    Term t2;
+    init_subst(&s, t);
+    t2 = s.terms[0];
+    if (!substree_delete(idx, idx->root, &s, symbol_count(t), t)) {
+      fprint_term(stderr, t);
+      fprintf(stderr, "\n");
+      fatal_error("substree_update, term not found");
+    }
+    zap_term(t2);
+    free(s.inds);
+    free(s.terms);
+  }
+}  /* substree_update */
+
+/*************
+ *
+ *   push_alignment()
+ *
+ *************/
+
+static
+void push_alignment(Substree_pos pos, int v, Term t, Context c)
+{
+  if (pos->top == pos->trail_size) {
+    pos->trail_size *= 2;
+    pos->inds = realloc(pos->inds, pos->trail_size * sizeof(int));
+    pos->terms = realloc(pos->terms, pos->trail_size * sizeof(Term));
+    pos->contexts = realloc(pos->contexts, pos->trail_size * sizeof(Context));
+  }
+  pos->inds[pos->top] = v;
+  pos->terms[pos->top] = t;
+  pos->contexts[pos->top] = c;
+  pos->top++;
+}  /* push_alignment */
+
+/*************
+ *
+ *   push_choice()
+ *
+ *************/
+
+static
+void push_choice(Substree_pos pos, St_node d)
+{
+  if (pos->sp == pos->stack_size) {
+    pos->stack_size *= 2;
+    pos->stack = realloc(pos->stack,
+			 pos->stack_size * sizeof(struct st_choice));
+  }
+  pos->stack[pos->sp].node = d;
+  pos->stack[pos->sp].k = 0;
+  pos->stack[pos->sp].top = pos->top;
+  pos->stack[pos->sp].qtop = pos->qtop;
+  pos->sp++;
+}  /* push_choice */
+
+/*************
+ *
+ *   path_binding()
+ *
+ *   What the tree binds indicator variable v to on the path being
+ *   tried (the current kid of each choice point), or NULL.
+ *
+ *************/
+
+static
+Term path_binding(Substree_pos pos, int v)
+{
+  int i, j;
+  for (i = pos->sp - 1; i >= 0; i--) {
+    struct st_choice *ch = pos->stack + i;
+    St_node k = ch->node->kids[ch->k - 1];
+    for (j = 0; j < k->num_binds; j++)
+      if (k->inds[j] == v)
+	return k->terms[j];
+  }
+  return NULL;
+}  /* path_binding */
+
+/*************
+ *
+ *   same_answer()
+ *
+ *   Are tree terms s and t the same subterm of the answers?
+ *   ST_MAYBE if that depends on indicator variables not yet bound
+ *   (or on the arguments of AC or C symbols, which are not checked).
+ *
+ *************/
+
+static
+int same_answer(Term s, Term t, Substree_pos pos)
+{
+  Term b;
+  while (IND(s) && (b = path_binding(pos, VARNUM(s))) != NULL)
+    s = b;
+  while (IND(t) && (b = path_binding(pos, VARNUM(t))) != NULL)
+    t = b;
+  if (IND(s) || IND(t))
+    return (s == t ? ST_SAME : ST_MAYBE);
+  else if (VARIABLE(s) || VARIABLE(t))
+    return (VARIABLE(s) && VARIABLE(t) && VARNUM(s) == VARNUM(t) ?
+	    ST_SAME : ST_DIFFERENT);
+  else if (SYMNUM(s) != SYMNUM(t))
+    return ST_DIFFERENT;
+  else if (is_commutative(SYMNUM(s)) || is_assoc_comm(SYMNUM(s)))
+    return ST_MAYBE;
+  else {
+    int result = ST_SAME;
+    int i;
+    for (i = 0; i < ARITY(s) && result != ST_DIFFERENT; i++) {
+      int r = same_answer(ARG(s,i), ARG(t,i), pos);
+      if (r != ST_SAME)
+	result = r;
+    }
+    return result;
+  }
+}  /* same_answer */
+
+/*************
+ *
+ *   bind_query_var()
+ *
+ *   For INSTANCE: query variable v goes with tree term s.  If v already
+ *   goes with another term, they have to be the same subterm of the
+ *   answers, and if that is not known yet, the pair is checked again
+ *   at each node further down.
+ *
+ *************/
+
+static
+LADR_BOOL bind_query_var(Substree_pos pos, int v, Term s)
+{
+  Term first = NULL;
+  int i;
+  for (i = 0; i < pos->qtop && pos->qvars[i] != v; i++);
+  if (i < pos->qtop) {
+    int r = same_answer(pos->qterms[i], s, pos);
+    if (r == ST_DIFFERENT)
+      return FALSE;
+    else if (r == ST_SAME)
+      return TRUE;
+    first = pos->qterms[i];  /* ST_MAYBE */
+  }
+  if (pos->qtop == pos->qtrail_size) {
+    pos->qtrail_size *= 2;
+    pos->qvars = realloc(pos->qvars, pos->qtrail_size * sizeof(int));
+    pos->qterms = realloc(pos->qterms, pos->qtrail_size * sizeof(Term));
+    pos->qterms2 = realloc(pos->qterms2, pos->qtrail_size * sizeof(Term));
+  }
+  pos->qvars[pos->qtop] = (first == NULL ? v : -1);
+  pos->qterms[pos->qtop] = (first == NULL ? s : first);
+  pos->qterms2[pos->qtop] = s;
+  pos->qtop++;
+  return TRUE;
+}  /* bind_query_var */
+
+/*************
+ *
+ *   compatible()
+ *
+ *   Can s (from the tree) be an answer for query subterm t (in
+ *   context c)?  The indicator variables of s are aligned with
+ *   the corresponding query subterms.
+ *
+ *************/
+
+static
+LADR_BOOL compatible(Term s, Term t, Context c, Substree_pos pos)
+{
+  if (IND(s)) {
+    push_alignment(pos, VARNUM(s), t, c);
+    return TRUE;
+  }
+  while (VARIABLE(t) && c != NULL && c->terms[VARNUM(t)] != NULL) {
+    int i = VARNUM(t);
+    t = c->terms[i];
+    c = c->contexts[i];
+  }
+  if (pos->type == INSTANCE && VARIABLE(t) && c == pos->contexts[0])
+    return bind_query_var(pos, VARNUM(t), s);
+  else if (VARIABLE(s))
+    return (pos->type == UNIFY || pos->type == GENERALIZATION ||
+	    VARIABLE(t));
+  else if (VARIABLE(t))
+    return pos->type == UNIFY || pos->type == INSTANCE;
+  else if (SYMNUM(s) != SYMNUM(t))
+    return FALSE;
+  else if (is_commutative(SYMNUM(s)) || is_assoc_comm(SYMNUM(s)))
+    return TRUE;
+  else {
+    int i;
+    for (i = 0; i < ARITY(s); i++)
+      if (!compatible(ARG(s,i), ARG(t,i), c, pos))
+	return FALSE;
+    return TRUE;
+  }
+}  /* compatible */
+
+/*************
+ *
+ *   node_compatible()
+ *
+ *   An indicator variable that is not on the trail is in a part of
+ *   the answer that is not constrained by the query.
+ *
+ *************/
+
+static
+LADR_BOOL node_compatible(St_node d, Substree_pos pos)
+{
+  int i, j;
+  for (i = 0; i < d->num_binds; i++) {
+    for (j = pos->top - 1; j >= 0 && pos->inds[j] != d->inds[i]; j--);
+    if (j >= 0 &&
+	!compatible(d->terms[i], pos->terms[j], pos->contexts[j], pos))
+      return FALSE;
+  }
+  for (i = 0; i < pos->qtop; i++) {
+    if (pos->qvars[i] == -1 &&
+	same_answer(pos->qterms[i], pos->qterms2[i], pos) == ST_DIFFERENT)
+      return FALSE;
+  }
+  return TRUE;
+}  /* node_compatible */
+
+/*************
+ *
+ *   find_leaves()
+ *
+ *   Put a position for each leaf with candidates into the heap
+ *   (not yet in heap order).
+ *
+ *************/
+
+static
+void find_leaves(Substree_pos pos)
+{
+  while (pos->sp > 0) {
+    struct st_choice *ch = pos->stack + (pos->sp - 1);
+    if (ch->k == ch->node->num_kids)
+      pos->sp--;
+    else {
+      St_node k = ch->node->kids[ch->k++];
+      pos->top = ch->top;
+      pos->qtop = ch->qtop;
+      if (node_compatible(k, pos)) {
+	if (k->num_kids > 0)
+	  push_choice(pos, k);
+	else {
+	  if (pos->num_leaves == pos->leaves_size) {
+	    pos->leaves_size *= 2;
+	    pos->leaves = realloc(pos->leaves,
+				  pos->leaves_size * sizeof(struct fposition));
+	  }
+	  pos->leaves[pos->num_leaves++] = first_fpos(k->data);
+	}
+      }
+    }
+  }
+}  /* find_leaves */
+
+/*************
+ *
+ *   sift_down()
+ *
+ *   The heap has the largest FPA_ID at the top.
+ *
+ *************/
+
+static
+void sift_down(struct fposition *a, int n, int i)
+{
+  struct fposition x = a[i];
+  FPA_ID_TYPE id = FPA_ID(FTERM(x));
+  while (2*i+1 < n) {
+    int j = 2*i+1;
+    if (j+1 < n && FPA_ID(FTERM(a[j+1])) > FPA_ID(FTERM(a[j])))
+      j++;
+    if (FPA_ID(FTERM(a[j])) <= id)
+      break;
+    a[i] = a[j];
+    i = j;
+  }
+  a[i] = x;
+}  /* sift_down */
+
+/*************
+ *
+ *   substree_retrieve_first()
+ *
+ *************/
+
+/* DOCUMENTATION
+Retrieve the first term that might be an answer to a query
+(UNIFY, INSTANCE, GENERALIZATION, LADR_VARIANT, or IDENTICAL)
+with Term t, or NULL if there are none.
+If Context c is not NULL, then the instance of the term (in the
+context) is used for the query.
+The answers are candidates only, except for INSTANCE
+(see the introduction).
+They come in the same order as from FPA (by decreasing FPA_ID):
+the leaves are found first, and their FPA lists are merged.
+If there is an answer, *ppos is set to a position for getting
+more answers with substree_retrieve_next(), or for giving up
+with substree_cancel().
+*/
+
+/* PUBLIC */
+Term substree_retrieve_first(Term t, Context c, Querytype type,
+			     Substree idx, Substree_pos *ppos)
+{
+  Substree_pos pos = get_substree_pos();
+  int i;
+  pos->type = type;
+  pos->num_leaves = 0;
+  pos->sp = 0;
+  pos->top = 0;
+  pos->qtop = 0;
+  push_alignment(pos, ST_ROOT, t, c);
+  push_choice(pos, idx->root);
+  find_leaves(pos);
+  for (i = pos->num_leaves / 2 - 1; i >= 0; i--)
+    sift_down(pos->leaves, pos->num_leaves, i);
+  *ppos = pos;
+  return substree_retrieve_next(pos);
+}  /* substree_retrieve_first */
+
+/*************
+ *
+ *   substree_retrieve_next()
+ *
+ *************/
+
+/* DOCUMENTATION
+Retrieve the next answer (see substree_retrieve_first()).
+If there are no more, the position is freed, and NULL is returned.
+*/
+
+/* PUBLIC */
+Term substree_retrieve_next(Substree_pos pos)
+{
+  struct fposition *a = pos->leaves;
+  Term t;
+  if (pos->num_leaves == 0) {
+    free_substree_pos(pos);
+    return NULL;
+  }
+  t = FTERM(a[0]);
+  a[0] = next_fpos(a[0]);
+  if (FTERM(a[0]) == NULL)
+    a[0] = a[--pos->num_leaves];
+  if (pos->num_leaves > 1)
+    sift_down(a, pos->num_leaves, 0);
+  return t;
+}  /* substree_retrieve_next */
+
+/*************
+ *
+ *   substree_cancel()
+ *
+ *************/
+
+/* DOCUMENTATION
+Give up on a retrieval before getting all of the answers.
+*/
+
+/* PUBLIC */
+void substree_cancel(Substree_pos pos)
+{
+  free_substree_pos(pos);
+}  /* substree_cancel */
+
+/*************
+ *
+ *   print_st_node()
+ *
+ *************/
+
+static
+void print_st_node(FILE *fp, St_node d, int depth)
+{
+  int i;
+
+  for (i = 0; i < depth; i++)
+    fprintf(fp, " -");
+
+  if (depth == 0)
+    fprintf(fp, "root");
+  for (i = 0; i < d->num_binds; i++) {
+    fprintf(fp, " v%d:=", d->inds[i]);
+    fprint_term(fp, d->terms[i]);
+  }
+
+  if (d->num_kids == 0 && depth > 0)
+    fprintf(fp, ": leaf has %d terms.\n", d->data->num_terms);
+  else {
+    fprintf(fp, "\n");
+    for (i = 0; i < d->num_kids; i++)
+      print_st_node(fp, d->kids[i], depth+1);
+  }
+}  /* print_st_node */
+
+/*************
+ *
+ *   fprint_substree()
+ *
+ *************/
+
+/* DOCUMENTATION
+This routine prints (to FILE *fp) a substitution tree.
+*/
+
+/* PUBLIC */
+void fprint_substree(FILE *fp, Substree idx)
+{
+  print_st_node(fp, idx->root, 0);
+}  /* fprint_substree */
+
+/*************
+ *
+ *   p_substree()
+ *
+ *************/
+
+/* DOCUMENTATION
+This routine prints (to stdout) a substitution tree.
+*/
+
+/* PUBLIC */
+void p_substree(Substree idx)
+{
+  fprint_substree(stdout, idx);
+}  /* p_substree */
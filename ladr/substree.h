@@ -0,0 +1,113 @@
+/*  Copyright (C) 2006, 2007 William McCune
+
+    This file is part of the LADR Deduction Library.
+
+    The LADR Deduction Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU General Public License,
+    version 2.
+
+    The LADR Deduction Library is distributed in the hope that it will be
+    useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with the LADR Deduction Library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifndef TP_SUBSTREE_H
+#define TP_SUBSTREE_H
+
+#include "fpa.h"
+
+/* INTRODUCTION
+A substitution tree is an index for all types of retrieval
+(UNIFY, INSTANCE, GENERALIZATION, LADR_VARIANT, and IDENTICAL).
+Each node binds some <I>indicator variables</I> to terms, which
+can contain other indicator variables, to be bound further down.
+The root indicator variable stands for the whole term,
+so the composition of the bindings on a path from the root to a leaf
+is an indexed term.  Terms that have a common generalization
+share the nodes for it.
+<P>
+A leaf has an FPA list (see fpalist.h) of the indexed terms
+that are variants of each other, so the terms get FPA_IDs,
+and the answers come newest first, as with FPA.
+<P>
+The variables of the indexed terms are renamed (in the tree, not the
+terms themselves) by first occurrence, so variants end up in the same leaf.
+Indicator variables are numbered from MAX_VARS.
+<P>
+Retrieval is a filter: it checks symbols (and, for INSTANCE, LADR_VARIANT,
+and IDENTICAL, where variables are), but not that the variables
+are bound consistently, so the answers are candidates,
+to be checked with unification or matching (as with FPA).
+The arguments of AC and C symbols are not checked.
+<P>
+INSTANCE retrieval (for example, for back demodulation and
+back subsumption) is a perfect filter, except for the arguments of
+AC and C symbols:  a query variable goes with the part of the tree
+where it first occurs, and at a later occurrence, the two parts
+have to be the same subterm of the answers.  If that depends on
+indicator variables that are bound further down, it is checked
+again at each node, so paths are cut off as soon as they disagree.
+The index is updated incrementally with substree_update().
+*/
+
+/* Public definitions */
+
+typedef struct st_node * St_node;
+typedef struct substree * Substree;
+typedef struct substree_pos * Substree_pos;
+
+struct st_node {       /* node in a substitution tree */
+  int       *inds;       /* indicator variables bound here ... */
+  Term      *terms;      /* ... and what they are bound to */
+  int       num_binds;
+  St_node   *kids;
+  int       num_kids;
+  int       kids_size;   /* size of kids array */
+  Fpa_list  data;        /* for leaves: the indexed terms */
+};
+
+struct substree {      /* a substitution tree index */
+  St_node   root;        /* binds nothing */
+  int       *free_inds;  /* indicator variables to be reused */
+  int       num_free;
+  int       free_size;
+  int       next_ind;    /* next new indicator variable */
+};
+
+/* End of public definitions */
+
+/* Public function prototypes from substree.c */
+
+void fprint_substree_mem(FILE *fp, LADR_BOOL heading);
+
+void p_substree_mem(void);
+
+Substree substree_init(void);
+
+LADR_BOOL substree_empty(Substree idx);
+
+void substree_dealloc(Substree idx);
+
+void destroy_substree(Substree idx);
+
+void substree_size(Substree idx, int *nodes, int *mem);
+
+void substree_update(Term t, Substree idx, Indexop op);
+
+Term substree_retrieve_first(Term t, Context c, Querytype type,
+			     Substree idx, Substree_pos *ppos);
+
+Term substree_retrieve_next(Substree_pos pos);
+
+void substree_cancel(Substree_pos pos);
+
+void fprint_substree(FILE *fp, Substree idx);
+
+void p_substree(Substree idx);
+
+#endif  /* conditional compilation of whole file */
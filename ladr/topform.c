@@ -615,6 +615,26 @@ Topform copy_clause_with_flag(Topform c, int flag)
   return c2;
 }  /* copy_clause_with_flag */
 
+/*************
+ *
+ *   clear_atom_flags()
+ *
+ *************/
+
+/* DOCUMENTATION
+This routine clears all of the termflags on the atoms of a clause
+(for example, the marks for maximal, selected, and oriented literals),
+so that they can be set again, say, for a different term ordering.
+*/
+
+/* PUBLIC */
+void clear_atom_flags(Topform c)
+{
+  Literals lit;
+  for (lit = c->literals; lit; lit = lit->next)
+    lit->atom->private_flags = 0;
+}  /* clear_atom_flags */
+
 /*************
  *
  *   inherit_attributes()
@@ -126,6 +126,8 @@ Topform copy_clause_with_flags(Topform c);
 
 Topform copy_clause_with_flag(Topform c, int flag);
 
+void clear_atom_flags(Topform c);
+
 void inherit_attributes(Topform par1, Context s1,
 			Topform par2, Context s2,
 			Topform child);
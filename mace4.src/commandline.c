@@ -118,12 +118,19 @@ void usage_message(FILE *fp, Mace_options opt)
   "  -R n : flag integer_ring (%s).\n"
   "  -q n : flag iterate_primes (%s).\n"
   "  -S n : flag skolems_last (%s).\n"
+  "  -A n : flag nonisomorphic (%s).\n"
+  "  -B n : flag sat_search (%s).\n"
+  "  -C n : flag learn_nogoods (%s).\n"
+  "  -D n : parm max_learned_megs (%d).\n"
   "\n"
   "Special Flags (not corresponding to set/clear/assign commands)\n"
   "\n"
   "  -c   : Ignore unrecognized set/clear/assign commands in the input\n"
   "         file.  This is useful for running MACE4 on an input file\n"
   "         designed for another program such as a theorem prover.\n"
+  "\n"
+  "  -W file : Also write the models to file, in the binary form read\n"
+  "         by isofilter, interpformat, and other LADR programs.\n"
   "\n"
 
 	  , PROGRAM_NAME, PROGRAM_VERSION, PROGRAM_DATE,
@@ -149,7 +156,11 @@ void usage_message(FILE *fp, Mace_options opt)
 	  flag(opt->trace) ? "set" : "clear",
 	  flag(opt->integer_ring) ? "set" : "clear",
 	  flag(opt->iterate_primes) ? "set" : "clear",
-	  flag(opt->skolems_last) ? "set" : "clear"
+	  flag(opt->skolems_last) ? "set" : "clear",
+	  flag(opt->nonisomorphic) ? "set" : "clear",
+	  flag(opt->sat_search) ? "set" : "clear",
+	  flag(opt->learn_nogoods) ? "set" : "clear",
+	  parm(opt->max_learned_megs)
 	  );
 }  /* usage_message */
 
@@ -170,7 +181,7 @@ void process_command_line_args(int argc, char **argv,
   */
   
   while ((c = getopt(argc, argv,
-	     "n:N:m:t:s:b:O:M:p:P:v:L:G:H:I:J:K:T:R:i:q:Q:S:cf:g")) != EOF) {
+	     "n:N:m:t:s:b:O:M:p:P:v:L:G:H:I:J:K:T:R:i:q:Q:S:A:B:C:D:W:cf:g")) != EOF) {
     switch (c) {
     case 'n':
       command_line_parm(opt->domain_size, optarg);
@@ -247,6 +258,27 @@ void process_command_line_args(int argc, char **argv,
     case 'S':
       command_line_flag(opt->skolems_last, optarg);
       break;
+    case 'A':
+      command_line_flag(opt->nonisomorphic, optarg);
+      break;
+    case 'B':
+      command_line_flag(opt->sat_search, optarg);
+      break;
+    case 'C':
+      command_line_flag(opt->learn_nogoods, optarg);
+      break;
+    case 'D':
+      command_line_parm(opt->max_learned_megs, optarg);
+      break;
+    case 'W':  /* also write the models, in binary, to a file */
+      {
+	FILE *fp = fopen(optarg, "wb");
+	if (fp == NULL)
+	  fatal_error("the -W file cannot be opened for writing");
+	set_binary_models_file(fp);
+	printf("\n%% From the command line: binary models to %s.\n", optarg);
+      }
+      break;
     case 'c':  /* prover compatability mode */
     case 'f':  /* input files */
     case 'g':  /* tptp syntax */
@@ -190,6 +190,28 @@ void restore_from_stack(Estack stack)
   }
 }  /* restore_from_stack */
 
+/*************
+ *
+ *   estack_cat()
+ *
+ *   Put stack s1 on top of stack s2, so that restoring the result
+ *   undoes s1 and then s2.
+ *
+ *************/
+
+Estack estack_cat(Estack s1, Estack s2)
+{
+  if (s1 == NULL)
+    return s2;
+  else {
+    Estack s = s1;
+    while (s->next != NULL)
+      s = s->next;
+    s->next = s2;
+    return s1;
+  }
+}  /* estack_cat */
+
 /*************
  *
  *   zap_estack()
@@ -69,6 +69,8 @@ Estack update_and_push(void **p, void *nw, Estack stack);
 
 void restore_from_stack(Estack stack);
 
+Estack estack_cat(Estack s1, Estack s2);
+
 void zap_estack(Estack s);
 
 #endif  /* conditional compilation of whole file */
@@ -24,6 +24,8 @@ extern Plist Ground_clauses;
 extern struct mace_stats Mstats;
 
 extern struct cell *Cells;
+extern Symbol_data *Sn_to_mace_sn;
+extern Mace_options Opt;
 
 extern int Eq_sn;
 extern int Or_sn;
@@ -64,6 +66,7 @@ Mclause get_mclause(int numlits)
   p->subsumed = FALSE;
   p->u.active = -1;
   p->next = NULL;
+  p->origin = NULL;
 
   Mclause_gets++;
   Mclause_use += (PTRS_MCLAUSE + numlits) * BYTES_POINTER;
@@ -148,6 +151,8 @@ void zap_mclause(Mclause c)
   int i;
   for (i = 0; i < c->numlits; i++)
     zap_mterm(LIT(c,i));
+  if (c->origin != NULL)
+    free(c->origin);
   free_mclause(c);
 }  /* zap_mclause */
 
@@ -505,6 +510,34 @@ Term subst_domain_elements_term(Term t, int *vals)
   }
 }  /* subst_domain_elements_term */
 
+/*************
+ *
+ *   keep_ground_clause()
+ *
+ *   Index the eterms of a new ground clause, set the parent pointers,
+ *   and give it to unit propagation.
+ *
+ *************/
+
+static
+void keep_ground_clause(Mclause m, Mstate state)
+{
+  int i;
+  for (i = 0; i < m->numlits; i++) {
+    eterm_index_term(LIT(m,i));
+    set_parent_pointers(LIT(m,i));
+    LIT(m,i)->container = m;
+  }
+  process_initial_clause(m, state);
+  if (!state->ok) {
+    fprintf(stdout, "\nNOTE: unsatisfiability detected on input.\n");
+    fprintf(stderr, "\nNOTE: unsatisfiability detected on input.\n");
+    return;
+  }
+  Ground_clauses = plist_prepend(Ground_clauses, m);
+  Mstats.ground_clauses_kept++;
+}  /* keep_ground_clause */
+
 /*************
  *
  *   instances_recurse()
@@ -532,23 +565,8 @@ void instances_recurse(Topform c, int *vals, int *domains,
       state->ok = FALSE;
       return;
     }
-    else if (!TRUE_TERM(t)) {
-      int i;
-      Mclause m = term_to_mclause(t);
-      for (i = 0; i < m->numlits; i++) {
-	eterm_index_term(LIT(m,i));
-	set_parent_pointers(LIT(m,i));
-	LIT(m,i)->container = m;
-      }
-      process_initial_clause(m, state);
-      if (!state->ok) {
-	fprintf(stdout, "\nNOTE: unsatisfiability detected on input.\n");
-	fprintf(stderr, "\nNOTE: unsatisfiability detected on input.\n");
-	return;
-      }
-      Ground_clauses = plist_prepend(Ground_clauses, m);
-      Mstats.ground_clauses_kept++;
-    }
+    else if (!TRUE_TERM(t))
+      keep_ground_clause(term_to_mclause(t), state);
   }
   else if (domains[nextvar] == -1) {
     /* in case the current variable does not appear in the clause */
@@ -567,6 +585,341 @@ void instances_recurse(Topform c, int *vals, int *domains,
   }
 }  /* instances_recurse */
 
+/*
+ * Instantiation templates.
+ *
+ * Instead of copying the clause and substituting domain elements for
+ * every instance, each clause is compiled (once for each domain size)
+ * into a template: the atom of each literal becomes a small postfix
+ * program whose leaves are variable slots or domain elements and whose
+ * inner nodes carry the base of the symbol's cells.  An instance is
+ * first evaluated against the current partial model by filling in the
+ * slots, which allocates nothing.  Terms are built only for the
+ * instances that are kept, and then only for the literals that are
+ * not false.  The result is the same as simp_tv() on the instance.
+ */
+
+enum { TI_VAR, TI_ELEM, TI_APPLY, TI_TRUE, TI_FALSE };  /* instructions */
+
+enum { TV_FALSE, TV_TRUE, TV_OPEN };  /* values of instantiated literals */
+
+struct tinstr {
+  int op;     /* TI_VAR, TI_ELEM, TI_APPLY, TI_TRUE, TI_FALSE */
+  int arg;    /* variable, domain element, or symnum */
+  int arity;  /* TI_APPLY */
+  int base;   /* TI_APPLY: base for the cell IDs of the symbol */
+};
+
+struct tlit {
+  LADR_BOOL sign;
+  LADR_BOOL eq;          /* the atom is an equality */
+  int n;                 /* number of instructions */
+  struct tinstr *code;   /* postfix; code[n-1] is the atom */
+};
+
+typedef struct mtemplate * Mtemplate;
+
+struct mtemplate {
+  int numlits;
+  int nvars;
+  struct tlit *lits;
+  int *tv;       /* value of each literal for the current instance */
+  int *vstk;     /* work stacks, big enough for any literal */
+  int *istk;
+  Term *tstk;
+};
+
+/* With learn_nogoods, each ground clause remembers its template
+   and instance, so that conflict analysis can find the cells that
+   made its literals false (see explain_mclause()). */
+
+struct morigin {
+  Mtemplate m;
+  int vals[1];  /* m->nvars of them */
+};
+
+static Plist Kept_templates;  /* templates that have origins pointing to them */
+
+/*************
+ *
+ *   compile_tatom()  -  recursive
+ *
+ *************/
+
+static
+int compile_tatom(Term t, struct tinstr *code, int n)
+{
+  int i;
+  if (VARIABLE(t)) {
+    code[n].op = TI_VAR;
+    code[n].arg = VARNUM(t);
+  }
+  else if ((i = natural_constant_term(t)) >= 0) {
+    code[n].op = TI_ELEM;  /* arithmetic is off, so i < Domain_size */
+    code[n].arg = i;
+  }
+  else {
+    for (i = 0; i < ARITY(t); i++)
+      n = compile_tatom(ARG(t,i), code, n);
+    code[n].op = TI_APPLY;
+    code[n].arg = SYMNUM(t);
+    code[n].arity = ARITY(t);
+    code[n].base = Sn_to_mace_sn[SYMNUM(t)]->base;
+  }
+  return n+1;
+}  /* compile_tatom */
+
+/*************
+ *
+ *   compile_template()
+ *
+ *************/
+
+static
+Mtemplate compile_template(Topform c)
+{
+  Mtemplate m = malloc(sizeof(struct mtemplate));
+  Literals lit;
+  int i, max = 1;
+
+  m->numlits = number_of_literals(c->literals);
+  m->lits = malloc(IMAX(m->numlits,1) * sizeof(struct tlit));
+  m->tv = malloc(IMAX(m->numlits,1) * sizeof(int));
+
+  for (lit = c->literals, i = 0; lit != NULL; lit = lit->next, i++) {
+    struct tlit *l = m->lits + i;
+    Term a = lit->atom;
+    l->sign = lit->sign;
+    l->eq = !VARIABLE(a) && SYMNUM(a) == Eq_sn;
+    l->code = malloc(symbol_count(a) * sizeof(struct tinstr));
+    if (true_term(a) || false_term(a)) {
+      l->code[0].op = (true_term(a) ? TI_TRUE : TI_FALSE);
+      l->n = 1;
+    }
+    else
+      l->n = compile_tatom(a, l->code, 0);
+    max = IMAX(max, l->n);
+  }
+  m->vstk = malloc(max * sizeof(int));
+  m->istk = malloc(max * sizeof(int));
+  m->tstk = malloc(max * sizeof(Term));
+  return m;
+}  /* compile_template */
+
+/*************
+ *
+ *   zap_template()
+ *
+ *************/
+
+static
+void zap_template(Mtemplate m)
+{
+  int i;
+  for (i = 0; i < m->numlits; i++)
+    free(m->lits[i].code);
+  free(m->lits);
+  free(m->tv);
+  free(m->vstk);
+  free(m->istk);
+  free(m->tstk);
+  free(m);
+}  /* zap_template */
+
+/*************
+ *
+ *   eval_tlit()
+ *
+ *   Evaluate an instance of a literal w.r.t. the current assignments.
+ *   The values on the stack are domain elements, or -1 if the subterm
+ *   does not simplify to a domain element; the IDs are cell IDs, or -1
+ *   if the subterm is not an eterm.
+ *
+ *************/
+
+static
+int eval_tlit(struct tlit *l, int *vals, int *vstk, int *istk)
+{
+  int i, sp = 0, v;
+
+  if (l->code[0].op == TI_TRUE || l->code[0].op == TI_FALSE)
+    v = (l->code[0].op == TI_TRUE);
+  else {
+    for (i = 0; i < l->n; i++) {
+      struct tinstr *p = l->code + i;
+      if (p->op == TI_VAR || p->op == TI_ELEM) {
+	vstk[sp] = (p->op == TI_VAR ? vals[p->arg] : p->arg);
+	istk[sp++] = -1;
+      }
+      else {
+	int j, x, id = 0;
+	sp -= p->arity;
+	for (j = 0; j < p->arity && id >= 0; j++)
+	  id = (vstk[sp+j] < 0 ? -1 : id * Domain_size + vstk[sp+j]);
+	if (id >= 0) {
+	  id += p->base;
+	  x = (Cells[id].value ? VARNUM(Cells[id].value) : -1);
+	}
+	else
+	  x = -1;
+	if (x < 0 && l->eq && i == l->n-1) {
+	  /* f(4,3)=2; check if 2 has been crossed off of f(4,3) list. */
+	  if (vstk[sp+1] >= 0 && istk[sp] >= 0) {
+	    if (Cells[istk[sp]].possible[vstk[sp+1]] == NULL)
+	      x = 0;
+	  }
+	  else if (vstk[sp] >= 0 && istk[sp+1] >= 0) {
+	    if (Cells[istk[sp+1]].possible[vstk[sp]] == NULL)
+	      x = 0;
+	  }
+	}
+	vstk[sp] = x;
+	istk[sp++] = id;
+      }
+    }
+    v = vstk[0];
+  }
+  if (v < 0)
+    return TV_OPEN;
+  else
+    return (l->sign ? v : !v) ? TV_TRUE : TV_FALSE;
+}  /* eval_tlit */
+
+/*************
+ *
+ *   ident_tlits()
+ *
+ *   Are two instantiated literals identical (before simplification)?
+ *
+ *************/
+
+static
+LADR_BOOL ident_tlits(struct tlit *a, struct tlit *b, int *vals)
+{
+  int i;
+  if (a->sign != b->sign || a->n != b->n)
+    return FALSE;
+  for (i = 0; i < a->n; i++) {
+    struct tinstr *p = a->code + i;
+    struct tinstr *q = b->code + i;
+    if (p->op == TI_APPLY || q->op == TI_APPLY) {
+      if (p->op != q->op || p->arg != q->arg)
+	return FALSE;
+    }
+    else if (p->op == TI_TRUE || p->op == TI_FALSE || q->op == TI_TRUE ||
+	     q->op == TI_FALSE) {
+      if (p->op != q->op)
+	return FALSE;
+    }
+    else {
+      int x = (p->op == TI_VAR ? vals[p->arg] : p->arg);
+      int y = (q->op == TI_VAR ? vals[q->arg] : q->arg);
+      if (x != y)
+	return FALSE;
+    }
+  }
+  return TRUE;
+}  /* ident_tlits */
+
+/*************
+ *
+ *   build_tatom()
+ *
+ *   Build the simplified atom of an instantiated literal.
+ *
+ *************/
+
+static
+Term build_tatom(struct tlit *l, int *vals, Term *tstk)
+{
+  int i, sp = 0;
+  for (i = 0; i < l->n; i++) {
+    struct tinstr *p = l->code + i;
+    if (p->op == TI_VAR)
+      tstk[sp++] = Domain[vals[p->arg]];
+    else if (p->op == TI_ELEM)
+      tstk[sp++] = Domain[p->arg];
+    else {
+      int j, id = 0;
+      Term t;
+      sp -= p->arity;
+      for (j = 0; j < p->arity && id >= 0; j++)
+	id = (VARIABLE(tstk[sp+j]) ? id * Domain_size + VARNUM(tstk[sp+j]) : -1);
+      if (id >= 0 && Cells[id + p->base].value != NULL)
+	t = Cells[id + p->base].value;
+      else {
+	t = get_rigid_term_dangerously(p->arg, p->arity);
+	for (j = 0; j < p->arity; j++)
+	  ARG(t,j) = tstk[sp+j];
+      }
+      tstk[sp++] = t;
+    }
+  }
+  return tstk[0];
+}  /* build_tatom */
+
+/*************
+ *
+ *   template_instance()
+ *
+ *************/
+
+static
+void template_instance(Mtemplate m, int *vals, Mstate state)
+{
+  int i, j, n = 0;
+  Mclause c;
+
+  Mstats.ground_clauses_seen++;
+
+  for (i = 0; i < m->numlits; i++) {
+    m->tv[i] = eval_tlit(m->lits + i, vals, m->vstk, m->istk);
+    if (m->tv[i] == TV_TRUE)
+      return;
+  }
+
+  /* Remove duplicates, keeping the last occurrence (as merge() does). */
+
+  for (i = 0; i < m->numlits; i++) {
+    if (m->tv[i] == TV_OPEN) {
+      for (j = i+1; j < m->numlits; j++) {
+	if (m->tv[j] == TV_OPEN && ident_tlits(m->lits+i, m->lits+j, vals)) {
+	  m->tv[i] = TV_FALSE;
+	  break;
+	}
+      }
+      if (m->tv[i] == TV_OPEN)
+	n++;
+    }
+  }
+
+  if (n == 0) {
+    fprintf(stdout, "\nNOTE: unsatisfiability detected on input.\n");
+    fprintf(stderr, "\nNOTE: unsatisfiability detected on input.\n");
+    state->ok = FALSE;
+    return;
+  }
+
+  c = get_mclause(n);
+  c->u.active = n;
+  for (i = 0, j = 0; i < m->numlits; i++) {
+    if (m->tv[i] == TV_OPEN) {
+      Term atom = build_tatom(m->lits + i, vals, m->tstk);
+      if (!m->lits[i].sign)
+	term_flag_set(atom, Negation_flag);
+      term_flag_set(atom, Relation_flag);
+      LIT(c,j++) = atom;
+    }
+  }
+  if (flag(Opt->learn_nogoods)) {
+    c->origin = malloc(sizeof(struct morigin) + m->nvars * sizeof(int));
+    c->origin->m = m;
+    for (i = 0; i < m->nvars; i++)
+      c->origin->vals[i] = vals[i];
+  }
+  keep_ground_clause(c, state);
+}  /* template_instance */
+
 /*************
  *
  *   generate_ground_clauses()
@@ -581,8 +934,96 @@ void generate_ground_clauses(Topform c, Mstate state)
 
   biggest_var = greatest_variable_in_clause(c->literals);
 
-  for (i = 0; i <= biggest_var; i++)
-    domains[i] = Domain_size;
-	
-  instances_recurse(c, vals, domains, 0, biggest_var+1, state);
+  if (flag(Opt->arithmetic) || c->is_formula) {
+    for (i = 0; i <= biggest_var; i++)
+      domains[i] = Domain_size;
+    instances_recurse(c, vals, domains, 0, biggest_var+1, state);
+  }
+  else {
+    /* Step through the instances like an odometer. */
+    Mtemplate m = compile_template(c);
+    m->nvars = biggest_var+1;
+    for (i = 0; i <= biggest_var; i++)
+      vals[i] = 0;
+    do {
+      template_instance(m, vals, state);
+      for (i = biggest_var; i >= 0 && ++vals[i] == Domain_size; i--)
+	vals[i] = 0;
+    } while (state->ok && i >= 0);
+    if (flag(Opt->learn_nogoods))
+      Kept_templates = plist_prepend(Kept_templates, m);
+    else
+      zap_template(m);
+  }
 }  /* generate_ground_clauses */
+
+/*************
+ *
+ *   zap_ground_templates()
+ *
+ *   Free the templates kept for explain_mclause().  Call this
+ *   after the ground clauses have been freed.
+ *
+ *************/
+
+void zap_ground_templates(void)
+{
+  Plist p;
+  for (p = Kept_templates; p != NULL; p = p->next)
+    zap_template(p->v);
+  zap_plist(Kept_templates);
+  Kept_templates = NULL;
+}  /* zap_ground_templates */
+
+/*************
+ *
+ *   explain_mclause()
+ *
+ *   Evaluate the literals of the instance that produced a ground
+ *   clause, and call f(id) for each cell whose value is used.
+ *   If the clause is false or unit, those cells are why.  Cell x
+ *   (the one the unit is about, or -1) is treated as unassigned.
+ *   Return FALSE if the clause has no origin (formulas).
+ *
+ *************/
+
+LADR_BOOL explain_mclause(Mclause c, int x, void (*f)(int))
+{
+  Mtemplate m;
+  int i, k;
+
+  if (c->origin == NULL)
+    return FALSE;
+
+  m = c->origin->m;
+  for (k = 0; k < m->numlits; k++) {
+    struct tlit *l = m->lits + k;
+    int *vals = c->origin->vals;
+    int *vstk = m->vstk;
+    int sp = 0;
+    if (l->code[0].op == TI_TRUE || l->code[0].op == TI_FALSE)
+      continue;
+    for (i = 0; i < l->n; i++) {
+      struct tinstr *p = l->code + i;
+      if (p->op == TI_VAR)
+	vstk[sp++] = vals[p->arg];
+      else if (p->op == TI_ELEM)
+	vstk[sp++] = p->arg;
+      else {
+	int j, id = 0;
+	sp -= p->arity;
+	for (j = 0; j < p->arity && id >= 0; j++)
+	  id = (vstk[sp+j] < 0 ? -1 : id * Domain_size + vstk[sp+j]);
+	if (id >= 0)
+	  id += p->base;
+	if (id >= 0 && id != x && Cells[id].value != NULL) {
+	  (*f)(id);
+	  vstk[sp++] = VARNUM(Cells[id].value);
+	}
+	else
+	  vstk[sp++] = -1;
+      }
+    }
+  }
+  return TRUE;
+}  /* explain_mclause */
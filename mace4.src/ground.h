@@ -25,6 +25,7 @@
 /* Public definitions */
 
 typedef struct mclause * Mclause;
+typedef struct morigin * Morigin;
 
 struct mclause {
   Term *lits;
@@ -38,6 +39,7 @@ struct mclause {
     long int active;
     void *for_padding_only;
   } u;
+  Morigin origin;  /* clause and instance, if learn_nogoods is set */
 };
 
 #define MAX_MACE_VARS      50
@@ -65,5 +67,7 @@ int lit_position(Mclause parent, Term child);
 Mclause containing_mclause(Term t);
 Term containing_mliteral(Term t);
 void generate_ground_clauses(Topform c, Mstate state);
+void zap_ground_templates(void);
+LADR_BOOL explain_mclause(Mclause c, int x, void (*f)(int));
 
 #endif  /* conditional compilation of whole file */
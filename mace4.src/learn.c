@@ -0,0 +1,847 @@
+/*  Copyright (C) 2006, 2007 William McCune
+
+    This file is part of the LADR Deduction Library.
+
+    The LADR Deduction Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU General Public License,
+    version 2.
+
+    The LADR Deduction Library is distributed in the hope that it will be
+    useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with the LADR Deduction Library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include "msearch.h"
+
+/* External variables defined in msearch.c. */
+
+extern Mace_options Opt;
+extern struct cell *Cells;
+extern int Number_of_cells;
+extern int Domain_size;
+extern Term *Domain;
+extern struct mace_stats Mstats;
+
+#define FACT_ID(f)    ((f) / 2 / FACT_STRIDE)
+#define FACT_VAL(f)   (((f) / 2) % FACT_STRIDE)
+#define FACT_ELIM(f)  ((f) % 2)
+
+enum { FV_OPEN, FV_TRUE, FV_FALSE };  /* fact_value() */
+
+struct nogood {
+  int n;
+  float activity;
+  int facts[1];  /* n of them; facts[0] and facts[1] are watched */
+};
+
+struct frec {              /* why a fact holds */
+  int level;
+  unsigned long stamp;     /* order in which facts were made */
+  struct mreason r;
+};
+
+struct wlist {             /* nogoods watching a fact */
+  int n, size;
+  Nogood *v;
+};
+
+struct ivec {
+  int n, size;
+  int *v;
+};
+
+static LADR_BOOL Learning;      /* set for the current domain size */
+static LADR_BOOL Analyze;       /* analyze conflicts (search, not lookahead) */
+static int Level;               /* current decision level */
+static unsigned long Stamp;
+
+static struct frec *Assign_recs;  /* one for each cell */
+static struct frec *Elim_recs;    /* one for each (cell,value) */
+static struct wlist *Watches;     /* one for each fact */
+static char *Seen;                /* one for each fact */
+static int *Decisions;            /* the decision at each level */
+
+static Nogood *Nogoods;           /* the learned nogoods */
+static int Num_nogoods, Nogoods_size;
+static size_t Bytes;              /* for nogoods and watches */
+static float Activity_inc;
+
+static Nogood Pending;            /* from the most recent conflict */
+static int Pending_level;         /* where Pending becomes unit */
+
+static struct ivec Current;       /* analysis: facts at conflict level */
+static struct ivec Lower;         /* analysis: facts at lower levels */
+static struct ivec Touched;       /* analysis: facts marked Seen */
+static int Conflict_level;
+static unsigned long Explain_stamp; /* analysis: cells valued before this */
+
+/*************
+ *
+ *   ivec_push()
+ *
+ *************/
+
+static
+void ivec_push(struct ivec *a, int x)
+{
+  if (a->n == a->size) {
+    a->size = (a->size == 0 ? 64 : 2 * a->size);
+    a->v = realloc(a->v, a->size * sizeof(int));
+  }
+  a->v[a->n++] = x;
+}  /* ivec_push */
+
+/*************
+ *
+ *   num_facts()
+ *
+ *************/
+
+static
+int num_facts(void)
+{
+  return Number_of_cells * FACT_STRIDE * 2;
+}  /* num_facts */
+
+/*************
+ *
+ *   init_learning()
+ *
+ *   Call this for each domain size, after the cells have been set up
+ *   and before the ground clauses are generated.
+ *
+ *************/
+
+/* DOCUMENTATION
+*/
+
+/* PUBLIC */
+void init_learning(void)
+{
+  Learning = (flag(Opt->learn_nogoods) &&
+	      !flag(Opt->arithmetic) && !flag(Opt->sat_search));
+  if (!Learning)
+    return;
+  Analyze = FALSE;
+  Level = 0;
+  Stamp = 0;
+  Assign_recs = calloc(Number_of_cells, sizeof(struct frec));
+  Elim_recs = calloc(Number_of_cells * FACT_STRIDE, sizeof(struct frec));
+  Watches = calloc(num_facts(), sizeof(struct wlist));
+  Seen = calloc(num_facts(), sizeof(char));
+  Decisions = calloc(Number_of_cells + 2, sizeof(int));
+  Nogoods = NULL;
+  Num_nogoods = Nogoods_size = 0;
+  Bytes = 0;
+  Activity_inc = 1.0;
+  Pending = NULL;
+}  /* init_learning */
+
+/*************
+ *
+ *   free_learning()
+ *
+ *************/
+
+/* DOCUMENTATION
+*/
+
+/* PUBLIC */
+void free_learning(void)
+{
+  int i, n;
+  if (!Learning)
+    return;
+  n = num_facts();
+  for (i = 0; i < n; i++)
+    free(Watches[i].v);
+  for (i = 0; i < Num_nogoods; i++)
+    free(Nogoods[i]);
+  free(Nogoods);
+  free(Pending);
+  free(Watches);
+  free(Seen);
+  free(Decisions);
+  free(Assign_recs);
+  free(Elim_recs);
+  free(Current.v);
+  free(Lower.v);
+  free(Touched.v);
+  Current.v = Lower.v = Touched.v = NULL;
+  Current.n = Lower.n = Touched.n = 0;
+  Current.size = Lower.size = Touched.size = 0;
+  Learning = FALSE;
+}  /* free_learning */
+
+/*************
+ *
+ *   learning()
+ *
+ *************/
+
+/* DOCUMENTATION
+Is nogood learning on for the current domain size?
+*/
+
+/* PUBLIC */
+LADR_BOOL learning(void)
+{
+  return Learning;
+}  /* learning */
+
+/*************
+ *
+ *   learn_level()
+ *
+ *   Set the decision level for the facts that follow, and analyze
+ *   contradictions from now on.  A level of -1 means that the
+ *   propagation that follows is lookahead, so contradictions are
+ *   not analyzed.
+ *
+ *************/
+
+/* DOCUMENTATION
+*/
+
+/* PUBLIC */
+void learn_level(int level)
+{
+  if (level < 0)
+    Analyze = FALSE;
+  else {
+    Level = level;
+    Analyze = TRUE;
+  }
+}  /* learn_level */
+
+/*************
+ *
+ *   record()
+ *
+ *************/
+
+static
+struct frec *record(int f)
+{
+  if (FACT_ELIM(f))
+    return Elim_recs + f / 2;
+  else
+    return Assign_recs + FACT_ID(f);
+}  /* record */
+
+/*************
+ *
+ *   learn_record()
+ *
+ *************/
+
+/* DOCUMENTATION
+Record the reason for a new assignment or elimination.
+*/
+
+/* PUBLIC */
+void learn_record(int id, int v, LADR_BOOL elim, Mreason r)
+{
+  if (Learning) {
+    struct frec *p = record(FACT(id, v, elim));
+    p->level = Level;
+    p->stamp = ++Stamp;
+    p->r = *r;
+    if (r->type == R_DECISION)
+      Decisions[Level] = FACT(id, v, FALSE);
+  }
+}  /* learn_record */
+
+/*************
+ *
+ *   fact_value()
+ *
+ *************/
+
+static
+int fact_value(int f)
+{
+  int id = FACT_ID(f);
+  int v = FACT_VAL(f);
+  Term value = Cells[id].value;
+  if (!FACT_ELIM(f)) {
+    if (value != NULL)
+      return (value == Domain[v] ? FV_TRUE : FV_FALSE);
+    else
+      return (Cells[id].possible[v] == NULL ? FV_FALSE : FV_OPEN);
+  }
+  else {
+    if (Cells[id].possible[v] == NULL)
+      return FV_TRUE;
+    else if (value != NULL)
+      return (value == Domain[v] ? FV_FALSE : FV_TRUE);
+    else
+      return FV_OPEN;
+  }
+}  /* fact_value */
+
+/*************
+ *
+ *   cause()
+ *
+ *   The recorded fact that makes fact f true.  An elimination
+ *   f(1,2)!=3 can hold because f(1,2) has another value.
+ *
+ *************/
+
+static
+int cause(int f)
+{
+  int id = FACT_ID(f);
+  int v = FACT_VAL(f);
+  if (FACT_ELIM(f) && Cells[id].possible[v] != NULL)
+    return FACT(id, VARNUM(Cells[id].value), FALSE);
+  else
+    return f;
+}  /* cause */
+
+/*************
+ *
+ *   p_fact()
+ *
+ *************/
+
+static
+void p_fact(int f)
+{
+  fwrite_term(stdout, Cells[FACT_ID(f)].eterm);
+  printf("%s%d", FACT_ELIM(f) ? "!=" : "=", FACT_VAL(f));
+}  /* p_fact */
+
+/*************
+ *
+ *   add_fact()
+ *
+ *   Add a true fact to the conflict being analyzed.
+ *
+ *************/
+
+static
+void add_fact(int f)
+{
+  struct frec *p;
+  if (fact_value(f) != FV_TRUE)
+    fatal_error("add_fact, fact in explanation is not true");
+  f = cause(f);
+  p = record(f);
+  if (p->level == 0 || Seen[f])
+    return;
+  Seen[f] = 1;
+  ivec_push(&Touched, f);
+  if (p->level >= Conflict_level)
+    ivec_push(&Current, f);
+  else
+    ivec_push(&Lower, f);
+}  /* add_fact */
+
+/*************
+ *
+ *   add_cell()
+ *
+ *   A cell used by a ground clause.  Cells that got their values
+ *   after the fact being explained played no part in it.
+ *
+ *************/
+
+static
+void add_cell(int id)
+{
+  if (Assign_recs[id].stamp < Explain_stamp)
+    add_fact(FACT(id, VARNUM(Cells[id].value), FALSE));
+}  /* add_cell */
+
+/*************
+ *
+ *   add_decisions()
+ *
+ *   When we cannot do better: the decisions up to a level.
+ *
+ *************/
+
+static
+void add_decisions(int level)
+{
+  int i;
+  for (i = 1; i <= level; i++)
+    add_fact(Decisions[i]);
+}  /* add_decisions */
+
+/*************
+ *
+ *   bump_nogood()
+ *
+ *************/
+
+static
+void bump_nogood(Nogood ng)
+{
+  ng->activity += Activity_inc;
+  if (ng->activity > 1e20) {
+    int i;
+    for (i = 0; i < Num_nogoods; i++)
+      Nogoods[i]->activity *= 1e-20;
+    Activity_inc *= 1e-20;
+  }
+}  /* bump_nogood */
+
+/*************
+ *
+ *   explain()
+ *
+ *   Add the facts from which fact f (or, if f is -1,
+ *   the contradiction) was derived.
+ *
+ *************/
+
+static
+void explain(Mreason r, int f)
+{
+  int level = (f == -1 ? Level : record(f)->level);
+  int i;
+  Explain_stamp = (f == -1 ? ULONG_MAX : record(f)->stamp);
+  switch (r->type) {
+  case R_DECISION:
+    break;
+  case R_NEGPROP:
+    add_fact(r->fact);
+    /* fall through */
+  case R_CLAUSE:
+    if (!explain_mclause(r->p, r->x, add_cell))
+      add_decisions(level);
+    break;
+  case R_ELIMS:
+    for (i = 0; i < id_to_domain_size(r->x); i++)
+      if (i != FACT_VAL(f))
+	add_fact(FACT(r->x, i, TRUE));
+    break;
+  case R_NOGOOD:
+    {
+      Nogood ng = r->p;
+      bump_nogood(ng);
+      for (i = 0; i < ng->n; i++)
+	if (ng->facts[i] != r->x)
+	  add_fact(ng->facts[i]);
+    }
+    break;
+  }
+}  /* explain */
+
+/*************
+ *
+ *   analyze()
+ *
+ *   Trace the reasons back from a contradiction to the first unique
+ *   implication point at the highest level involved, and leave the
+ *   resulting nogood in Pending.
+ *
+ *************/
+
+static
+void analyze(Mreason r, int fact)
+{
+  int i, j, max_level, uip;
+  Nogood ng;
+
+  /* Collect the contradiction, then split it by level. */
+
+  Conflict_level = INT_MAX;
+  explain(r, -1);
+  if (fact != -1)
+    add_fact(fact);
+
+  for (i = 0, max_level = 0; i < Lower.n; i++)
+    max_level = IMAX(max_level, record(Lower.v[i])->level);
+
+  if (max_level > 0) {
+    for (i = 0, j = 0; i < Lower.n; i++) {
+      if (record(Lower.v[i])->level == max_level)
+	ivec_push(&Current, Lower.v[i]);
+      else
+	Lower.v[j++] = Lower.v[i];
+    }
+    Lower.n = j;
+    Conflict_level = max_level;
+
+    /* Resolve away the facts at the conflict level, latest first. */
+
+    while (TRUE) {
+      int best = 0;
+      for (i = 1; i < Current.n; i++)
+	if (record(Current.v[i])->stamp > record(Current.v[best])->stamp)
+	  best = i;
+      uip = Current.v[best];
+      Current.v[best] = Current.v[--Current.n];
+      if (Current.n == 0)
+	break;
+      if (record(uip)->r.type == R_DECISION)
+	fatal_error("analyze, decision is not the last fact at its level");
+      explain(&(record(uip)->r), uip);
+    }
+
+    /* The nogood: the UIP, then the facts from the lower levels,
+       with one at the highest of those levels in the second place. */
+
+    ng = malloc(sizeof(struct nogood) + Lower.n * sizeof(int));
+    ng->n = Lower.n + 1;
+    ng->activity = Activity_inc;
+    ng->facts[0] = uip;
+    Pending_level = 0;
+    for (i = 0; i < Lower.n; i++) {
+      int level = record(Lower.v[i])->level;
+      ng->facts[i+1] = Lower.v[i];
+      if (level > Pending_level) {
+	Pending_level = level;
+	ng->facts[i+1] = ng->facts[1];
+	ng->facts[1] = Lower.v[i];
+      }
+    }
+    Pending = ng;
+    Activity_inc *= 1.05;
+    if (Activity_inc > 1e20) {
+      for (i = 0; i < Num_nogoods; i++)
+	Nogoods[i]->activity *= 1e-20;
+      ng->activity *= 1e-20;
+      Activity_inc *= 1e-20;
+    }
+    Mstats.nogoods++;
+    Mstats.nogood_facts += ng->n;
+
+    if (flag(Opt->trace)) {
+      printf("\t\t\t\t\tNOGOOD:");
+      for (i = 0; i < ng->n; i++) {
+	printf(" ");
+	p_fact(ng->facts[i]);
+      }
+      printf(" (level %d)\n", Pending_level);
+    }
+  }
+
+  for (i = 0; i < Touched.n; i++)
+    Seen[Touched.v[i]] = 0;
+  Current.n = Lower.n = Touched.n = 0;
+}  /* analyze */
+
+/*************
+ *
+ *   learn_conflict()
+ *
+ *************/
+
+/* DOCUMENTATION
+Propagation has found a contradiction: the reason r,
+along with the (true) fact, if it is not -1.
+*/
+
+/* PUBLIC */
+void learn_conflict(Mreason r, int fact)
+{
+  if (Learning && Analyze && Pending == NULL && Level > 0)
+    analyze(r, fact);
+}  /* learn_conflict */
+
+/*************
+ *
+ *   watch()
+ *
+ *************/
+
+static
+void watch(int f, Nogood ng)
+{
+  struct wlist *w = Watches + f;
+  if (w->n == w->size) {
+    int size = (w->size == 0 ? 4 : 2 * w->size);
+    w->v = realloc(w->v, size * sizeof(Nogood));
+    Bytes += (size - w->size) * sizeof(Nogood);
+    w->size = size;
+  }
+  w->v[w->n++] = ng;
+}  /* watch */
+
+/*************
+ *
+ *   negation()
+ *
+ *   The fact to make true when fact f must not hold.  Relation
+ *   cells have no eliminations: P(1)!=1 is P(1)=0.
+ *
+ *************/
+
+static
+int negation(int f)
+{
+  int id = FACT_ID(f);
+  int v = FACT_VAL(f);
+  if (FACT_ELIM(f))
+    return FACT(id, v, FALSE);
+  else if (Cells[id].symbol->type == RELATION)
+    return FACT(id, 1 - v, FALSE);
+  else
+    return FACT(id, v, TRUE);
+}  /* negation */
+
+/*************
+ *
+ *   visit()
+ *
+ *   Fact f has just become true.  Check the nogoods watching it.
+ *
+ *************/
+
+static
+void visit(int f, Mstate state)
+{
+  struct wlist *w = Watches + f;
+  int i, j;
+  for (i = 0, j = 0; i < w->n; i++) {
+    Nogood ng = w->v[i];
+    int k, first;
+    if (!state->ok) {
+      w->v[j++] = ng;  /* just keep the rest */
+      continue;
+    }
+    if (ng->n == 1) {
+      struct mreason r = {R_NOGOOD, NULL, -1, -1};
+      w->v[j++] = ng;
+      r.p = ng;
+      learn_conflict(&r, -1);
+      state->ok = FALSE;
+      continue;
+    }
+    if (ng->facts[0] == f) {
+      ng->facts[0] = ng->facts[1];
+      ng->facts[1] = f;
+    }
+    first = fact_value(ng->facts[0]);
+    if (first == FV_FALSE) {
+      w->v[j++] = ng;  /* the nogood cannot be violated */
+      continue;
+    }
+    for (k = 2; k < ng->n && fact_value(ng->facts[k]) == FV_TRUE; k++);
+    if (k < ng->n) {
+      /* move the watch */
+      ng->facts[1] = ng->facts[k];
+      ng->facts[k] = f;
+      watch(ng->facts[1], ng);
+      continue;
+    }
+    w->v[j++] = ng;
+    if (first == FV_TRUE) {
+      struct mreason r = {R_NOGOOD, NULL, -1, -1};
+      r.p = ng;
+      learn_conflict(&r, -1);
+      state->ok = FALSE;
+    }
+    else {
+      /* All other facts hold, so the first one must not. */
+      int g = negation(ng->facts[0]);
+      struct mreason r = {R_NOGOOD, NULL, -1, -1};
+      r.p = ng;
+      r.x = ng->facts[0];
+      Mstats.nogood_propagations++;
+      if (FACT_ELIM(g))
+	new_elimination(FACT_ID(g), Domain[FACT_VAL(g)], &r, state);
+      else
+	new_assignment(FACT_ID(g), Domain[FACT_VAL(g)], &r, state);
+    }
+  }
+  w->n = j;
+}  /* visit */
+
+/*************
+ *
+ *   propagate_nogoods()
+ *
+ *************/
+
+/* DOCUMENTATION
+Propagate an ASSIGNMENT or ELIMINATION job through the learned nogoods.
+If a contradiction is found, set state->ok to FALSE.
+*/
+
+/* PUBLIC */
+void propagate_nogoods(int type, int id, Term beta, Mstate state)
+{
+  if (type == ELIMINATION)
+    visit(FACT(id, VARNUM(beta), TRUE), state);
+  else {
+    /* f(1,2)=3 makes f(1,2)!=v true for the other values v. */
+    int w = VARNUM(Cells[id].value);
+    int n = id_to_domain_size(id);
+    int v;
+    visit(FACT(id, w, FALSE), state);
+    for (v = 0; v < n && state->ok; v++)
+      if (v != w && Cells[id].possible[v] != NULL)
+	visit(FACT(id, v, TRUE), state);
+  }
+}  /* propagate_nogoods */
+
+/*************
+ *
+ *   learn_pending()
+ *
+ *************/
+
+/* DOCUMENTATION
+Is there a new nogood (from the most recent contradiction)?  If so,
+set *level to the decision level at which it becomes unit.
+*/
+
+/* PUBLIC */
+LADR_BOOL learn_pending(int *level)
+{
+  if (Pending == NULL)
+    return FALSE;
+  else {
+    *level = Pending_level;
+    return TRUE;
+  }
+}  /* learn_pending */
+
+/*************
+ *
+ *   locked()
+ *
+ *   Is a nogood the reason for a fact that holds?
+ *
+ *************/
+
+static
+LADR_BOOL locked(Nogood ng)
+{
+  int i;
+  for (i = 0; i < ng->n; i++) {
+    int g = ng->facts[i] ^ 1;  /* the negation of the fact */
+    int id = FACT_ID(g);
+    int v = FACT_VAL(g);
+    LADR_BOOL recorded = (FACT_ELIM(g) ? Cells[id].possible[v] == NULL
+			  : Cells[id].value == Domain[v]);
+    if (recorded && record(g)->r.type == R_NOGOOD && record(g)->r.p == ng)
+      return TRUE;
+  }
+  return FALSE;
+}  /* locked */
+
+/*************
+ *
+ *   compare_activity()
+ *
+ *************/
+
+static
+int compare_activity(const void *a, const void *b)
+{
+  float x = (*((Nogood *) a))->activity;
+  float y = (*((Nogood *) b))->activity;
+  return (x < y ? -1 : (x > y ? 1 : 0));
+}  /* compare_activity */
+
+/*************
+ *
+ *   reduce_nogoods()
+ *
+ *   Delete the less active half of the nogoods that are not reasons
+ *   for current facts, and take them out of the watch lists.
+ *
+ *************/
+
+static
+void reduce_nogoods(void)
+{
+  int i, j, n = num_facts();
+  int target = Num_nogoods / 2;
+  int deleted = 0;
+
+  qsort(Nogoods, Num_nogoods, sizeof(Nogood), compare_activity);
+  for (i = 0; i < Num_nogoods && deleted < target; i++) {
+    if (!locked(Nogoods[i])) {
+      Nogoods[i]->n = -Nogoods[i]->n;  /* mark for deletion */
+      deleted++;
+    }
+  }
+
+  for (i = 0; i < n; i++) {
+    struct wlist *w = Watches + i;
+    int k;
+    for (j = 0, k = 0; j < w->n; j++)
+      if (w->v[j]->n > 0)
+	w->v[k++] = w->v[j];
+    w->n = k;
+  }
+
+  for (i = 0, j = 0; i < Num_nogoods; i++) {
+    Nogood ng = Nogoods[i];
+    if (ng->n > 0)
+      Nogoods[j++] = ng;
+    else {
+      Bytes -= sizeof(struct nogood) + (-ng->n - 1) * sizeof(int);
+      free(ng);
+    }
+  }
+  Num_nogoods = j;
+  Mstats.nogoods_deleted += deleted;
+}  /* reduce_nogoods */
+
+/*************
+ *
+ *   learn_assert()
+ *
+ *************/
+
+/* DOCUMENTATION
+Add the pending nogood at the given decision level (after the search
+has backed up to that level).  If it is unit, make its consequence and
+propagate, setting *stk to the events to undo.  Return LEARN_ASSERTED,
+LEARN_CONFLICT (there may be another nogood pending), LEARN_FALSE
+(the state at this level is contradictory), or LEARN_NOTHING.
+*/
+
+/* PUBLIC */
+int learn_assert(int level, Estack *stk)
+{
+  Nogood ng = Pending;
+  int i, g, first;
+  struct mreason r = {R_NOGOOD, NULL, -1, -1};
+
+  Pending = NULL;
+  *stk = NULL;
+  learn_level(level);
+
+  if (Bytes / (1024*1024) >= parm(Opt->max_learned_megs))
+    reduce_nogoods();
+
+  if (Num_nogoods == Nogoods_size) {
+    Nogoods_size = (Nogoods_size == 0 ? 1024 : 2 * Nogoods_size);
+    Nogoods = realloc(Nogoods, Nogoods_size * sizeof(Nogood));
+  }
+  Nogoods[Num_nogoods++] = ng;
+  Bytes += sizeof(struct nogood) + (ng->n - 1) * sizeof(int);
+  watch(ng->facts[0], ng);
+  if (ng->n > 1)
+    watch(ng->facts[1], ng);
+
+  first = fact_value(ng->facts[0]);
+  for (i = 1; i < ng->n; i++)
+    if (fact_value(ng->facts[i]) != FV_TRUE)
+      return LEARN_NOTHING;
+  if (first == FV_TRUE)
+    return LEARN_FALSE;
+  else if (first == FV_FALSE)
+    return LEARN_NOTHING;
+
+  r.p = ng;
+  r.x = ng->facts[0];
+  g = negation(r.x);
+  *stk = propagate_fact(FACT_ID(g), Domain[FACT_VAL(g)], FACT_ELIM(g), &r);
+  return (*stk == NULL ? LEARN_CONFLICT : LEARN_ASSERTED);
+}  /* learn_assert */
@@ -0,0 +1,69 @@
+/*  Copyright (C) 2006, 2007 William McCune
+
+    This file is part of the LADR Deduction Library.
+
+    The LADR Deduction Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU General Public License,
+    version 2.
+
+    The LADR Deduction Library is distributed in the hope that it will be
+    useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with the LADR Deduction Library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifndef MACE4_LEARN_H
+#define MACE4_LEARN_H
+
+/* INTRODUCTION
+Nogood learning for the native search (flag learn_nogoods).
+Each assignment and elimination made by propagation is recorded
+with its decision level and its reason (see struct mreason in
+propagate.h).  When propagation finds a contradiction, the reasons
+are traced back to the first unique implication point, giving a
+set of facts that cannot all hold (a nogood).  The search then
+backjumps to the level at which the nogood becomes unit, and
+the nogood takes part in propagation from then on (it is watched
+on two of its facts, so nothing has to be undone on backtracking).
+Parm max_learned_megs limits the memory for the nogoods; when it
+is reached, the less active half of them are deleted.
+<P>
+A fact is an assignment f(1,2)=3 or an elimination f(1,2)!=3,
+coded as an integer by FACT().
+*/
+
+/* Public definitions */
+
+typedef struct nogood * Nogood;
+
+#define FACT_STRIDE     (Domain_size < 2 ? 2 : Domain_size)
+#define FACT(id,v,elim) ((((id) * FACT_STRIDE) + (v)) * 2 + ((elim) ? 1 : 0))
+
+/* learn_assert() results */
+
+enum {
+  LEARN_ASSERTED,  /* the nogood was unit; its consequence has been made */
+  LEARN_CONFLICT,  /* ... and that gave another contradiction */
+  LEARN_FALSE,     /* the nogood is false at this level */
+  LEARN_NOTHING    /* the nogood is not unit at this level */
+};
+
+/* End of public definitions */
+
+/* Public function prototypes from learn.c */
+
+void init_learning(void);
+void free_learning(void);
+LADR_BOOL learning(void);
+void learn_level(int level);
+void learn_record(int id, int v, LADR_BOOL elim, Mreason r);
+void learn_conflict(Mreason r, int fact);
+void propagate_nogoods(int type, int id, Term beta, Mstate state);
+LADR_BOOL learn_pending(int *level);
+int learn_assert(int level, Estack *stk);
+
+#endif  /* conditional compilation of whole file */
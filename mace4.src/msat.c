@@ -0,0 +1,1757 @@
+/*  Copyright (C) 2006, 2007 William McCune
+
+    This file is part of the LADR Deduction Library.
+
+    The LADR Deduction Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU General Public License,
+    version 2.
+
+    The LADR Deduction Library is distributed in the hope that it will be
+    useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with the LADR Deduction Library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include "msearch.h"
+
+/* External variables defined in msearch.c. */
+
+extern Mace_options Opt;
+
+extern Symbol_data Symbols;
+extern Symbol_data *Sn_to_mace_sn;
+
+extern int Number_of_cells;
+extern struct cell *Cells;
+
+extern int Domain_size;
+extern Term *Domain;
+
+extern Plist Ground_clauses;
+
+extern int Relation_flag;  /* term flag */
+extern int Negation_flag;  /* term flag */
+
+extern int Eq_sn;
+
+extern struct mace_stats Mstats;
+
+/* Literals are 2*var (positive) and 2*var+1 (negative). */
+
+#define POS_LIT(v)   (2 * (v))
+#define NEG_LIT(l)   ((l) ^ 1)
+#define LIT_VAR(l)   ((l) >> 1)
+
+enum { V_FALSE = 0, V_TRUE = 1, V_UNDEF = 2 };
+
+/* Results of encoding a literal of a ground clause. */
+
+enum { SL_FALSE, SL_TRUE, SL_LIT, SL_OPEN };
+
+/* Ground clauses with at most this many nested terms are expanded
+   instead of getting definitions for the nested terms. */
+
+#define MAX_EXPAND 2
+
+typedef struct sclause * Sclause;
+
+struct sclause {
+  int size;
+  LADR_BOOL learnt;
+  LADR_BOOL deleted;
+  float activity;
+  int lits[];      /* for a reason clause, lits[0] is the implied literal */
+};
+
+struct watch {
+  Sclause c;
+  int blocker;     /* some other literal of c; if true, skip c */
+};
+
+struct wlist {
+  struct watch *w;
+  int n, size;
+};
+
+struct msat {
+  LADR_BOOL ok;           /* FALSE if a conflict at level 0 was found */
+  int nvars;
+
+  /* per variable */
+  signed char *value;
+  signed char *phase;     /* saved polarity */
+  int *level;
+  Sclause *reason;
+  double *activity;
+  char *seen;
+
+  /* per literal */
+  struct wlist *watches;  /* watches[l]: clauses watching l (visit if l false) */
+
+  int *trail;
+  int trail_n;
+  int qhead;
+  int *trail_lim;
+  int decision_level;
+
+  int *heap;              /* VSIDS order: binary max-heap of variables */
+  int heap_n;
+  int *heap_pos;          /* -1 if not in heap */
+
+  Sclause *clauses;
+  int num_clauses, clauses_size;
+  Sclause *learnts;
+  int num_learnts, learnts_size;
+
+  double var_inc;
+  double cla_inc;
+  double max_learnts;
+  int restart_index;
+  int conflicts_to_restart;
+
+  int *buf;               /* for learned clauses */
+  int *toclear;
+  int var_size;           /* allocated size of the per-variable arrays */
+
+  /* Mace4 encoding */
+  int *cell_var;          /* first variable for each cell, -1 if assigned */
+
+  int *cbuf;              /* clause under construction */
+  int cbuf_n, cbuf_size;
+  LADR_BOOL cbuf_true;
+
+  /* Nested terms and non-cell atoms, identified by the symbol and
+     the nodes of the arguments (see term_node()). */
+  int num_aux, aux_size;
+  int *aux_sn;
+  int *aux_kids;          /* index into kids */
+  int *aux_var;
+  int *aux_next;          /* hash chain */
+  int *aux_hash;
+  int aux_hash_size;      /* a power of 2 */
+  int *kids;
+  int kids_n, kids_size;
+
+  /* Terms eliminated by expansion (see expand_mclause()). */
+  int elim_id[MAX_EXPAND];
+  int elim_val[MAX_EXPAND];
+  int num_elim;
+};
+
+/*************
+ *
+ *   lit_value()
+ *
+ *************/
+
+static
+int lit_value(Msat s, int lit)
+{
+  int v = s->value[LIT_VAR(lit)];
+  return (v == V_UNDEF ? V_UNDEF : v ^ (lit & 1));
+}  /* lit_value */
+
+/*************
+ *
+ *   heap_*()
+ *
+ *   The unassigned variables, ordered by activity.
+ *
+ *************/
+
+static
+void heap_up(Msat s, int i)
+{
+  int x = s->heap[i];
+  while (i > 0) {
+    int p = (i - 1) / 2;
+    if (s->activity[s->heap[p]] >= s->activity[x])
+      break;
+    s->heap[i] = s->heap[p];
+    s->heap_pos[s->heap[i]] = i;
+    i = p;
+  }
+  s->heap[i] = x;
+  s->heap_pos[x] = i;
+}  /* heap_up */
+
+static
+void heap_down(Msat s, int i)
+{
+  int x = s->heap[i];
+  for (;;) {
+    int c = 2 * i + 1;
+    if (c >= s->heap_n)
+      break;
+    if (c + 1 < s->heap_n &&
+	s->activity[s->heap[c+1]] > s->activity[s->heap[c]])
+      c++;
+    if (s->activity[s->heap[c]] <= s->activity[x])
+      break;
+    s->heap[i] = s->heap[c];
+    s->heap_pos[s->heap[i]] = i;
+    i = c;
+  }
+  s->heap[i] = x;
+  s->heap_pos[x] = i;
+}  /* heap_down */
+
+static
+void heap_insert(Msat s, int v)
+{
+  if (s->heap_pos[v] == -1) {
+    s->heap[s->heap_n] = v;
+    s->heap_pos[v] = s->heap_n++;
+    heap_up(s, s->heap_n - 1);
+  }
+}  /* heap_insert */
+
+static
+int heap_remove_max(Msat s)
+{
+  int v = s->heap[0];
+  s->heap_pos[v] = -1;
+  s->heap_n--;
+  if (s->heap_n > 0) {
+    s->heap[0] = s->heap[s->heap_n];
+    s->heap_pos[s->heap[0]] = 0;
+    heap_down(s, 0);
+  }
+  return v;
+}  /* heap_remove_max */
+
+/*************
+ *
+ *   bump_var(), bump_clause()
+ *
+ *************/
+
+static
+void bump_var(Msat s, int v)
+{
+  if ((s->activity[v] += s->var_inc) > 1e100) {
+    int i;
+    for (i = 0; i < s->nvars; i++)
+      s->activity[i] *= 1e-100;
+    s->var_inc *= 1e-100;
+  }
+  if (s->heap_pos[v] != -1)
+    heap_up(s, s->heap_pos[v]);
+}  /* bump_var */
+
+static
+void bump_clause(Msat s, Sclause c)
+{
+  if ((c->activity += s->cla_inc) > 1e20) {
+    int i;
+    for (i = 0; i < s->num_learnts; i++)
+      s->learnts[i]->activity *= 1e-20;
+    s->cla_inc *= 1e-20;
+  }
+}  /* bump_clause */
+
+/*************
+ *
+ *   watch_push()
+ *
+ *************/
+
+static
+void watch_push(Msat s, int lit, Sclause c, int blocker)
+{
+  struct wlist *ws = &(s->watches[lit]);
+  if (ws->n == ws->size) {
+    ws->size = (ws->size == 0 ? 4 : 2 * ws->size);
+    ws->w = realloc(ws->w, ws->size * sizeof(struct watch));
+  }
+  ws->w[ws->n].c = c;
+  ws->w[ws->n].blocker = blocker;
+  ws->n++;
+}  /* watch_push */
+
+/*************
+ *
+ *   enqueue()
+ *
+ *************/
+
+static
+void enqueue(Msat s, int lit, Sclause reason)
+{
+  int v = LIT_VAR(lit);
+  s->value[v] = (lit & 1) ? V_FALSE : V_TRUE;
+  s->level[v] = s->decision_level;
+  s->reason[v] = reason;
+  s->trail[s->trail_n++] = lit;
+}  /* enqueue */
+
+/*************
+ *
+ *   new_vars()
+ *
+ *   Add n variables, and return the first.
+ *
+ *************/
+
+static
+int new_vars(Msat s, int n)
+{
+  int first = s->nvars;
+  int i;
+
+  if (s->nvars + n > s->var_size) {
+    int size = MAX(2 * s->var_size, s->nvars + n);
+    s->value     = realloc(s->value, size * sizeof(signed char));
+    s->phase     = realloc(s->phase, size * sizeof(signed char));
+    s->level     = realloc(s->level, size * sizeof(int));
+    s->reason    = realloc(s->reason, size * sizeof(Sclause));
+    s->activity  = realloc(s->activity, size * sizeof(double));
+    s->seen      = realloc(s->seen, size * sizeof(char));
+    s->watches   = realloc(s->watches, 2 * size * sizeof(struct wlist));
+    s->trail     = realloc(s->trail, size * sizeof(int));
+    s->trail_lim = realloc(s->trail_lim, (size + 1) * sizeof(int));
+    s->heap      = realloc(s->heap, size * sizeof(int));
+    s->heap_pos  = realloc(s->heap_pos, size * sizeof(int));
+    s->buf       = realloc(s->buf, (size + 1) * sizeof(int));
+    s->toclear   = realloc(s->toclear, (size + 1) * sizeof(int));
+    s->var_size = size;
+  }
+
+  for (i = first; i < first + n; i++) {
+    s->value[i] = V_UNDEF;
+    s->phase[i] = V_FALSE;
+    s->level[i] = 0;
+    s->reason[i] = NULL;
+    s->activity[i] = 0;
+    s->seen[i] = 0;
+    s->heap_pos[i] = -1;
+    memset(&(s->watches[2*i]), 0, 2 * sizeof(struct wlist));
+    s->nvars++;
+    heap_insert(s, i);
+  }
+  Mstats.sat_vars = s->nvars;
+  return first;
+}  /* new_vars */
+
+/*************
+ *
+ *   cancel_until()
+ *
+ *************/
+
+static
+void cancel_until(Msat s, int level)
+{
+  if (s->decision_level > level) {
+    int i;
+    for (i = s->trail_n - 1; i >= s->trail_lim[level]; i--) {
+      int v = LIT_VAR(s->trail[i]);
+      s->phase[v] = s->value[v];
+      s->value[v] = V_UNDEF;
+      s->reason[v] = NULL;
+      heap_insert(s, v);
+    }
+    s->trail_n = s->qhead = s->trail_lim[level];
+    s->decision_level = level;
+  }
+}  /* cancel_until */
+
+/*************
+ *
+ *   propagate()
+ *
+ *   Unit propagation with two watched literals.  Return a
+ *   conflicting clause, or NULL.
+ *
+ *************/
+
+static
+Sclause propagate(Msat s)
+{
+  Sclause confl = NULL;
+
+  while (confl == NULL && s->qhead < s->trail_n) {
+    int fl = NEG_LIT(s->trail[s->qhead++]);  /* the literal that became false */
+    struct wlist *ws = &(s->watches[fl]);
+    int i = 0, j = 0;
+
+    Mstats.sat_propagations++;
+
+    while (i < ws->n) {
+      Sclause c = ws->w[i].c;
+      int first, k;
+
+      if (lit_value(s, ws->w[i].blocker) == V_TRUE) {
+	ws->w[j++] = ws->w[i++];
+	continue;
+      }
+      i++;
+
+      /* Make sure the false literal is lits[1]. */
+      if (c->lits[0] == fl) {
+	c->lits[0] = c->lits[1];
+	c->lits[1] = fl;
+      }
+      first = c->lits[0];
+      if (lit_value(s, first) == V_TRUE) {
+	ws->w[j].c = c;
+	ws->w[j++].blocker = first;
+	continue;
+      }
+
+      /* Look for a new literal to watch. */
+      for (k = 2; k < c->size; k++) {
+	if (lit_value(s, c->lits[k]) != V_FALSE) {
+	  c->lits[1] = c->lits[k];
+	  c->lits[k] = fl;
+	  watch_push(s, c->lits[1], c, first);
+	  break;
+	}
+      }
+      if (k < c->size)
+	continue;
+
+      /* The clause is unit or false. */
+      ws->w[j].c = c;
+      ws->w[j++].blocker = first;
+      if (lit_value(s, first) == V_FALSE) {
+	confl = c;
+	s->qhead = s->trail_n;
+	while (i < ws->n)
+	  ws->w[j++] = ws->w[i++];
+      }
+      else
+	enqueue(s, first, c);
+    }
+    ws->n = j;
+  }
+  return confl;
+}  /* propagate */
+
+/*************
+ *
+ *   new_sclause()
+ *
+ *************/
+
+static
+Sclause new_sclause(Msat s, int *lits, int n, LADR_BOOL learnt)
+{
+  Sclause c = malloc(sizeof(struct sclause) + n * sizeof(int));
+  int i;
+  c->size = n;
+  c->learnt = learnt;
+  c->deleted = FALSE;
+  c->activity = 0;
+  for (i = 0; i < n; i++)
+    c->lits[i] = lits[i];
+  watch_push(s, c->lits[0], c, c->lits[1]);
+  watch_push(s, c->lits[1], c, c->lits[0]);
+
+  if (learnt) {
+    if (s->num_learnts == s->learnts_size) {
+      s->learnts_size = (s->learnts_size == 0 ? 1024 : 2 * s->learnts_size);
+      s->learnts = realloc(s->learnts, s->learnts_size * sizeof(Sclause));
+    }
+    s->learnts[s->num_learnts++] = c;
+  }
+  else {
+    if (s->num_clauses == s->clauses_size) {
+      s->clauses_size = (s->clauses_size == 0 ? 1024 : 2 * s->clauses_size);
+      s->clauses = realloc(s->clauses, s->clauses_size * sizeof(Sclause));
+    }
+    s->clauses[s->num_clauses++] = c;
+    Mstats.sat_clauses++;
+  }
+  return c;
+}  /* new_sclause */
+
+/*************
+ *
+ *   compare_lits()
+ *
+ *************/
+
+static
+int compare_lits(const void *a, const void *b)
+{
+  return *((const int *) a) - *((const int *) b);
+}  /* compare_lits */
+
+/*************
+ *
+ *   add_clause()
+ *
+ *   Add an input clause at decision level 0.  The array is
+ *   sorted in place.  Duplicate and false literals are removed,
+ *   and tautologies and satisfied clauses are ignored.
+ *
+ *************/
+
+static
+void add_clause(Msat s, int *lits, int n)
+{
+  int i, j;
+
+  if (!s->ok)
+    return;
+
+  qsort(lits, n, sizeof(int), compare_lits);
+  for (i = j = 0; i < n; i++) {
+    int val = lit_value(s, lits[i]);
+    if (val == V_TRUE || (i > 0 && lits[i] == NEG_LIT(lits[i-1])))
+      return;  /* satisfied or tautology */
+    else if (val == V_UNDEF && (j == 0 || lits[i] != lits[j-1]))
+      lits[j++] = lits[i];
+  }
+
+  if (j == 0)
+    s->ok = FALSE;
+  else if (j == 1) {
+    enqueue(s, lits[0], NULL);
+    if (propagate(s) != NULL)
+      s->ok = FALSE;
+  }
+  else
+    new_sclause(s, lits, j, FALSE);
+}  /* add_clause */
+
+/*************
+ *
+ *   redundant_lit()
+ *
+ *   A literal of a learned clause is redundant if all the other
+ *   literals of its reason are already in the clause (or at level 0).
+ *
+ *************/
+
+static
+LADR_BOOL redundant_lit(Msat s, int lit)
+{
+  Sclause r = s->reason[LIT_VAR(lit)];
+  int i;
+  if (r == NULL)
+    return FALSE;
+  for (i = 1; i < r->size; i++) {
+    int v = LIT_VAR(r->lits[i]);
+    if (!s->seen[v] && s->level[v] > 0)
+      return FALSE;
+  }
+  return TRUE;
+}  /* redundant_lit */
+
+/*************
+ *
+ *   analyze()
+ *
+ *   First-UIP conflict analysis.  The learned clause is left in
+ *   s->buf (the asserting literal first, a literal of the
+ *   backjump level second); its length is returned, and the
+ *   backjump level is returned in *btlevel.
+ *
+ *************/
+
+static
+int analyze(Msat s, Sclause confl, int *btlevel)
+{
+  int pathc = 0;
+  int p = -1;
+  int index = s->trail_n - 1;
+  int n = 1;  /* buf[0] is reserved for the asserting literal */
+  int i, j, nclear;
+
+  do {
+    if (confl->learnt)
+      bump_clause(s, confl);
+    for (i = (p == -1 ? 0 : 1); i < confl->size; i++) {
+      int q = confl->lits[i];
+      int v = LIT_VAR(q);
+      if (!s->seen[v] && s->level[v] > 0) {
+	bump_var(s, v);
+	s->seen[v] = 1;
+	if (s->level[v] >= s->decision_level)
+	  pathc++;
+	else
+	  s->buf[n++] = q;
+      }
+    }
+    /* Next literal of the trail to look at. */
+    while (!s->seen[LIT_VAR(s->trail[index--])]);
+    p = s->trail[index+1];
+    confl = s->reason[LIT_VAR(p)];
+    s->seen[LIT_VAR(p)] = 0;
+    pathc--;
+  } while (pathc > 0);
+  s->buf[0] = NEG_LIT(p);
+
+  /* Remove redundant literals. */
+
+  nclear = n;
+  for (i = 0; i < n; i++)
+    s->toclear[i] = s->buf[i];
+  for (i = j = 1; i < n; i++)
+    if (!redundant_lit(s, s->buf[i]))
+      s->buf[j++] = s->buf[i];
+  n = j;
+
+  /* Find the backjump level, and put that literal second. */
+
+  if (n == 1)
+    *btlevel = 0;
+  else {
+    int max = 1;
+    for (i = 2; i < n; i++)
+      if (s->level[LIT_VAR(s->buf[i])] > s->level[LIT_VAR(s->buf[max])])
+	max = i;
+    p = s->buf[max];
+    s->buf[max] = s->buf[1];
+    s->buf[1] = p;
+    *btlevel = s->level[LIT_VAR(p)];
+  }
+
+  for (i = 0; i < nclear; i++)
+    s->seen[LIT_VAR(s->toclear[i])] = 0;
+  return n;
+}  /* analyze */
+
+/*************
+ *
+ *   compare_activity()
+ *
+ *************/
+
+static
+int compare_activity(const void *a, const void *b)
+{
+  Sclause c = *((Sclause *) a);
+  Sclause d = *((Sclause *) b);
+  return (c->activity < d->activity ? -1 : c->activity > d->activity ? 1 : 0);
+}  /* compare_activity */
+
+/*************
+ *
+ *   reduce_learnts()
+ *
+ *   Delete about half of the learned clauses, the least active first.
+ *   Binary clauses and clauses that are reasons are kept.
+ *
+ *************/
+
+static
+void reduce_learnts(Msat s)
+{
+  int i, j, l;
+
+  qsort(s->learnts, s->num_learnts, sizeof(Sclause), compare_activity);
+  for (i = 0; i < s->num_learnts / 2; i++) {
+    Sclause c = s->learnts[i];
+    int v = LIT_VAR(c->lits[0]);
+    if (c->size > 2 && !(s->reason[v] == c && lit_value(s, c->lits[0]) == V_TRUE))
+      c->deleted = TRUE;
+  }
+
+  for (l = 0; l < 2 * s->nvars; l++) {
+    struct wlist *ws = &(s->watches[l]);
+    for (i = j = 0; i < ws->n; i++)
+      if (!ws->w[i].c->deleted)
+	ws->w[j++] = ws->w[i];
+    ws->n = j;
+  }
+
+  for (i = j = 0; i < s->num_learnts; i++) {
+    if (s->learnts[i]->deleted)
+      free(s->learnts[i]);
+    else
+      s->learnts[j++] = s->learnts[i];
+  }
+  s->num_learnts = j;
+}  /* reduce_learnts */
+
+/*************
+ *
+ *   luby()
+ *
+ *   The Luby sequence 1,1,2,1,1,2,4,1,1,2,1,1,2,4,8,...
+ *
+ *************/
+
+static
+int luby(int x)
+{
+  int size, seq;
+  for (size = 1, seq = 0; size < x + 1; seq++, size = 2 * size + 1);
+  while (size - 1 != x) {
+    size = (size - 1) >> 1;
+    seq--;
+    x = x % size;
+  }
+  return 1 << seq;
+}  /* luby */
+
+/*************
+ *
+ *   msat_solve()
+ *
+ *   Search for a satisfying assignment.  Return MSAT_SAT (the
+ *   assignment can be read with msat_cell_value()), MSAT_UNSAT,
+ *   or MSAT_UNKNOWN if max_conflicts conflicts occurred first;
+ *   in that case, the search can be resumed by calling again.
+ *
+ *************/
+
+/* DOCUMENTATION
+*/
+
+/* PUBLIC */
+int msat_solve(Msat s, int max_conflicts)
+{
+  int conflicts = 0;
+
+  if (!s->ok)
+    return MSAT_UNSAT;
+
+  for (;;) {
+    Sclause confl = propagate(s);
+    if (confl != NULL) {
+      int n, btlevel;
+      Mstats.sat_conflicts++;
+      conflicts++;
+      s->conflicts_to_restart--;
+      if (s->decision_level == 0) {
+	s->ok = FALSE;
+	return MSAT_UNSAT;
+      }
+      n = analyze(s, confl, &btlevel);
+      cancel_until(s, btlevel);
+      if (n == 1)
+	enqueue(s, s->buf[0], NULL);
+      else {
+	Sclause c = new_sclause(s, s->buf, n, TRUE);
+	bump_clause(s, c);
+	enqueue(s, s->buf[0], c);
+      }
+      s->var_inc *= (1 / 0.95);
+      s->cla_inc *= (1 / 0.999);
+    }
+    else {
+      int next;
+      if (s->conflicts_to_restart <= 0) {
+	cancel_until(s, 0);
+	Mstats.sat_restarts++;
+	s->conflicts_to_restart = 100 * luby(++s->restart_index);
+      }
+      if (conflicts >= max_conflicts)
+	return MSAT_UNKNOWN;
+      if (s->num_learnts - s->trail_n >= s->max_learnts) {
+	reduce_learnts(s);
+	s->max_learnts *= 1.1;
+      }
+
+      next = -1;
+      while (next == -1 && s->heap_n > 0) {
+	int v = heap_remove_max(s);
+	if (s->value[v] == V_UNDEF)
+	  next = v;
+      }
+      if (next == -1)
+	return MSAT_SAT;  /* all variables are assigned */
+
+      Mstats.sat_decisions++;
+      s->trail_lim[s->decision_level++] = s->trail_n;
+      enqueue(s, s->phase[next] == V_TRUE ? POS_LIT(next) : NEG_LIT(POS_LIT(next)),
+	      NULL);
+    }
+  }
+}  /* msat_solve */
+
+/*************
+ *
+ *   cell_lit()
+ *
+ *   The literal for cell ID having value v (for relation cells,
+ *   v is 0 or 1).  Assigned cells and crossed-off values give
+ *   SL_TRUE or SL_FALSE.
+ *
+ *************/
+
+static
+int cell_lit(Msat s, int id, int v, int *plit)
+{
+  if (Cells[id].value != NULL)
+    return (VARNUM(Cells[id].value) == v ? SL_TRUE : SL_FALSE);
+  else if (Cells[id].possible[v] == NULL)
+    return SL_FALSE;
+  else if (Cells[id].symbol->type == RELATION) {
+    *plit = (v == 1 ? POS_LIT(s->cell_var[id]) : NEG_LIT(POS_LIT(s->cell_var[id])));
+    return SL_LIT;
+  }
+  else {
+    *plit = POS_LIT(s->cell_var[id] + v);
+    return SL_LIT;
+  }
+}  /* cell_lit */
+
+/*************
+ *
+ *   cbuf_start(), cbuf_add(), cbuf_end()
+ *
+ *   Build an input clause.  The literals are given as the results
+ *   of cell_lit() and node_lit(), so that TRUE literals satisfy the
+ *   clause and FALSE literals are dropped.
+ *
+ *************/
+
+static
+void cbuf_start(Msat s)
+{
+  s->cbuf_n = 0;
+  s->cbuf_true = FALSE;
+}  /* cbuf_start */
+
+static
+void cbuf_add(Msat s, int r, int lit, LADR_BOOL negate)
+{
+  if (negate && r != SL_LIT)
+    r = (r == SL_TRUE ? SL_FALSE : SL_TRUE);
+  if (r == SL_TRUE)
+    s->cbuf_true = TRUE;
+  else if (r == SL_LIT) {
+    if (s->cbuf_n == s->cbuf_size) {
+      s->cbuf_size = 2 * s->cbuf_size;
+      s->cbuf = realloc(s->cbuf, s->cbuf_size * sizeof(int));
+    }
+    s->cbuf[s->cbuf_n++] = (negate ? NEG_LIT(lit) : lit);
+  }
+}  /* cbuf_add */
+
+static
+void cbuf_end(Msat s)
+{
+  if (!s->cbuf_true)
+    add_clause(s, s->cbuf, s->cbuf_n);
+}  /* cbuf_end */
+
+/*************
+ *
+ *   node_lit()
+ *
+ *   Term nodes:  0 .. Domain_size-1 are the domain elements, the
+ *   next Number_of_cells nodes are the cells, and the rest are the
+ *   nested terms (aux), each with Domain_size variables of its own.
+ *   Get the literal for node having value v.
+ *
+ *************/
+
+static
+int node_lit(Msat s, int node, int v, int *plit)
+{
+  if (node < Domain_size)
+    return (node == v ? SL_TRUE : SL_FALSE);
+  else if (node < Domain_size + Number_of_cells)
+    return cell_lit(s, node - Domain_size, v, plit);
+  else {
+    *plit = POS_LIT(s->aux_var[node - Domain_size - Number_of_cells] + v);
+    return SL_LIT;
+  }
+}  /* node_lit */
+
+/*************
+ *
+ *   aux_lookup()
+ *
+ *   Find (or insert) the aux entry for sn(kids).  *pnew is set
+ *   if it is inserted; the caller then sets aux_var.
+ *
+ *************/
+
+static
+unsigned aux_hash(int sn, int n, int *kids)
+{
+  unsigned h = sn;
+  int i;
+  for (i = 0; i < n; i++)
+    h = h * 31 + kids[i];
+  return h;
+}  /* aux_hash */
+
+static
+int aux_lookup(Msat s, int sn, int n, int *kids, LADR_BOOL *pnew)
+{
+  unsigned h = aux_hash(sn, n, kids) & (s->aux_hash_size - 1);
+  int k, i;
+
+  for (k = s->aux_hash[h]; k != -1; k = s->aux_next[k]) {
+    if (s->aux_sn[k] == sn) {
+      int *p = s->kids + s->aux_kids[k];
+      for (i = 0; i < n && p[i] == kids[i]; i++);
+      if (i == n) {
+	*pnew = FALSE;
+	return k;
+      }
+    }
+  }
+
+  if (s->num_aux == s->aux_size) {
+    s->aux_size *= 2;
+    s->aux_sn   = realloc(s->aux_sn, s->aux_size * sizeof(int));
+    s->aux_kids = realloc(s->aux_kids, s->aux_size * sizeof(int));
+    s->aux_var  = realloc(s->aux_var, s->aux_size * sizeof(int));
+    s->aux_next = realloc(s->aux_next, s->aux_size * sizeof(int));
+  }
+  while (s->kids_n + n > s->kids_size) {
+    s->kids_size *= 2;
+    s->kids = realloc(s->kids, s->kids_size * sizeof(int));
+  }
+
+  k = s->num_aux++;
+  s->aux_sn[k] = sn;
+  s->aux_kids[k] = s->kids_n;
+  for (i = 0; i < n; i++)
+    s->kids[s->kids_n++] = kids[i];
+  s->aux_var[k] = -1;
+  s->aux_next[k] = s->aux_hash[h];
+  s->aux_hash[h] = k;
+
+  if (s->num_aux > 2 * s->aux_hash_size) {
+    /* rehash */
+    int j;
+    s->aux_hash_size *= 2;
+    s->aux_hash = realloc(s->aux_hash, s->aux_hash_size * sizeof(int));
+    for (j = 0; j < s->aux_hash_size; j++)
+      s->aux_hash[j] = -1;
+    for (j = 0; j < s->num_aux; j++) {
+      Symbol_data sym = Sn_to_mace_sn[s->aux_sn[j]];
+      int arity = (s->aux_sn[j] == Eq_sn ? 2 : sym->arity);
+      unsigned g = aux_hash(s->aux_sn[j], arity, s->kids + s->aux_kids[j]) &
+	(s->aux_hash_size - 1);
+      s->aux_next[j] = s->aux_hash[g];
+      s->aux_hash[g] = j;
+    }
+  }
+  *pnew = TRUE;
+  return k;
+}  /* aux_lookup */
+
+/*************
+ *
+ *   next_args()
+ *
+ *   Step an odometer over the possible values of the argument
+ *   nodes.  Arguments that are domain elements stay fixed.
+ *   Return FALSE when done.
+ *
+ *************/
+
+static
+LADR_BOOL next_args(int n, int *kids, int *vals)
+{
+  int i;
+  for (i = n-1; i >= 0; i--) {
+    if (kids[i] >= Domain_size) {
+      if (vals[i] < Domain_size - 1) {
+	vals[i]++;
+	return TRUE;
+      }
+      vals[i] = 0;
+    }
+  }
+  return FALSE;
+}  /* next_args */
+
+/*************
+ *
+ *   args_start()
+ *
+ *   Start a clause with the negated literals "argument i has value
+ *   vals[i]", and return the cell ID of sym(vals).  Return -1 if
+ *   some argument cannot have that value.
+ *
+ *************/
+
+static
+int args_start(Msat s, Symbol_data sym, int *kids, int *vals)
+{
+  int i, id = sym->base, mult = 1;
+  cbuf_start(s);
+  for (i = sym->arity-1; i >= 0; i--) {
+    int lit;
+    int r = node_lit(s, kids[i], vals[i], &lit);
+    if (r == SL_FALSE)
+      return -1;
+    cbuf_add(s, r, lit, TRUE);
+    id += vals[i] * mult;
+    mult *= Domain_size;
+  }
+  return id;
+}  /* args_start */
+
+/*************
+ *
+ *   define_term()
+ *
+ *   Clauses for a new nested term:  x_0, ..., x_{n-1} say which value
+ *   it has, and  a_1=v_1 & ... & a_k=v_k & f(v_1,...,v_k)=v -> x_v.
+ *
+ *************/
+
+static
+void define_term(Msat s, Symbol_data sym, int k, int *kids)
+{
+  int vals[MAX_ARITY];
+  int x = new_vars(s, Domain_size);
+  int i, j;
+
+  s->aux_var[k] = x;
+
+  cbuf_start(s);
+  for (i = 0; i < Domain_size; i++)
+    cbuf_add(s, SL_LIT, POS_LIT(x + i), FALSE);
+  cbuf_end(s);
+  for (i = 0; i < Domain_size; i++)
+    for (j = i + 1; j < Domain_size; j++) {
+      cbuf_start(s);
+      cbuf_add(s, SL_LIT, POS_LIT(x + i), TRUE);
+      cbuf_add(s, SL_LIT, POS_LIT(x + j), TRUE);
+      cbuf_end(s);
+    }
+
+  for (i = 0; i < sym->arity; i++)
+    vals[i] = (kids[i] < Domain_size ? kids[i] : 0);
+
+  do {
+    int v;
+    for (v = 0; v < Domain_size; v++) {
+      int lit, r;
+      int id = args_start(s, sym, kids, vals);
+      if (id == -1)
+	break;
+      r = cell_lit(s, id, v, &lit);
+      if (r != SL_FALSE) {
+	cbuf_add(s, r, lit, TRUE);
+	cbuf_add(s, SL_LIT, POS_LIT(x + v), FALSE);
+	cbuf_end(s);
+      }
+    }
+  } while (next_args(sym->arity, kids, vals));
+}  /* define_term */
+
+/*************
+ *
+ *   define_atom()
+ *
+ *   Clauses for a new nested atom:  y <-> P(a_1,...,a_k).
+ *
+ *************/
+
+static
+void define_atom(Msat s, Symbol_data sym, int k, int *kids)
+{
+  int vals[MAX_ARITY];
+  int y = new_vars(s, 1);
+  int i;
+
+  s->aux_var[k] = y;
+
+  for (i = 0; i < sym->arity; i++)
+    vals[i] = (kids[i] < Domain_size ? kids[i] : 0);
+
+  do {
+    int sign;
+    for (sign = 0; sign <= 1; sign++) {
+      int lit, r;
+      int id = args_start(s, sym, kids, vals);
+      if (id == -1)
+	break;
+      r = cell_lit(s, id, 1, &lit);
+      cbuf_add(s, r, lit, sign == 0);
+      cbuf_add(s, SL_LIT, POS_LIT(y), sign == 1);
+      cbuf_end(s);
+    }
+  } while (next_args(sym->arity, kids, vals));
+}  /* define_atom */
+
+/*************
+ *
+ *   define_eq()
+ *
+ *   Clauses for a new equality of nested terms:  y <-> a=b.
+ *
+ *************/
+
+static
+void define_eq(Msat s, int k, int a, int b)
+{
+  int y = new_vars(s, 1);
+  int v;
+
+  s->aux_var[k] = y;
+
+  for (v = 0; v < Domain_size; v++) {
+    int la, lb;
+    int ra = node_lit(s, a, v, &la);
+    int rb = node_lit(s, b, v, &lb);
+    cbuf_start(s);                   /* a=v & b=v -> y */
+    cbuf_add(s, ra, la, TRUE);
+    cbuf_add(s, rb, lb, TRUE);
+    cbuf_add(s, SL_LIT, POS_LIT(y), FALSE);
+    cbuf_end(s);
+    cbuf_start(s);                   /* a=v & y -> b=v */
+    cbuf_add(s, ra, la, TRUE);
+    cbuf_add(s, rb, lb, FALSE);
+    cbuf_add(s, SL_LIT, POS_LIT(y), TRUE);
+    cbuf_end(s);
+  }
+}  /* define_eq */
+
+/*************
+ *
+ *   term_node()
+ *
+ *   Get the node for a ground term (see node_lit()).
+ *
+ *************/
+
+static
+int term_node(Msat s, Term t)
+{
+  if (VARIABLE(t))
+    return VARNUM(t);
+  else {
+    Symbol_data sym = Sn_to_mace_sn[SYMNUM(t)];
+    int kids[MAX_ARITY];
+    LADR_BOOL elements = TRUE;
+    LADR_BOOL new;
+    int i, k;
+
+    for (i = 0; i < ARITY(t); i++) {
+      kids[i] = term_node(s, ARG(t,i));
+      if (kids[i] >= Domain_size)
+	elements = FALSE;
+    }
+
+    if (elements) {
+      int id = sym->base, mult = 1;
+      for (i = ARITY(t)-1; i >= 0; i--) {
+	id += kids[i] * mult;
+	mult *= Domain_size;
+      }
+      if (Cells[id].value != NULL)
+	return VARNUM(Cells[id].value);
+      else
+	return Domain_size + id;
+    }
+
+    k = aux_lookup(s, SYMNUM(t), ARITY(t), kids, &new);
+    if (new)
+      define_term(s, sym, k, kids);
+    return Domain_size + Number_of_cells + k;
+  }
+}  /* term_node */
+
+/*************
+ *
+ *   encode_literal()
+ *
+ *   Return SL_TRUE, SL_FALSE, or SL_LIT (and set *plit).
+ *
+ *************/
+
+static
+int encode_literal(Msat s, Term lit, int *plit)
+{
+  int r, k;
+  LADR_BOOL new;
+
+  if (FALSE_TERM(lit))
+    return SL_FALSE;
+  else if (TRUE_TERM(lit))
+    return SL_TRUE;
+  else if (EQ_TERM(lit)) {
+    int a = term_node(s, ARG(lit,0));
+    int b = term_node(s, ARG(lit,1));
+    if (a < Domain_size && b < Domain_size)
+      r = (a == b ? SL_TRUE : SL_FALSE);
+    else if (b < Domain_size)
+      r = node_lit(s, a, b, plit);
+    else if (a < Domain_size)
+      r = node_lit(s, b, a, plit);
+    else if (a == b)
+      r = SL_TRUE;
+    else {
+      int kids[2];
+      kids[0] = MIN(a, b);
+      kids[1] = MAX(a, b);
+      k = aux_lookup(s, Eq_sn, 2, kids, &new);
+      if (new)
+	define_eq(s, k, kids[0], kids[1]);
+      *plit = POS_LIT(s->aux_var[k]);
+      r = SL_LIT;
+    }
+  }
+  else {
+    Symbol_data sym = Sn_to_mace_sn[SYMNUM(lit)];
+    int kids[MAX_ARITY];
+    LADR_BOOL elements = TRUE;
+    int i;
+    for (i = 0; i < ARITY(lit); i++) {
+      kids[i] = term_node(s, ARG(lit,i));
+      if (kids[i] >= Domain_size)
+	elements = FALSE;
+    }
+    if (elements) {
+      int id = sym->base, mult = 1;
+      for (i = ARITY(lit)-1; i >= 0; i--) {
+	id += kids[i] * mult;
+	mult *= Domain_size;
+      }
+      r = cell_lit(s, id, 1, plit);
+    }
+    else {
+      k = aux_lookup(s, SYMNUM(lit), ARITY(lit), kids, &new);
+      if (new)
+	define_atom(s, sym, k, kids);
+      *plit = POS_LIT(s->aux_var[k]);
+      r = SL_LIT;
+    }
+  }
+
+  if (NEGATED(lit)) {
+    if (r == SL_TRUE)
+      r = SL_FALSE;
+    else if (r == SL_FALSE)
+      r = SL_TRUE;
+    else
+      *plit = NEG_LIT(*plit);
+  }
+  return r;
+}  /* encode_literal */
+
+/*************
+ *
+ *   nested_terms()
+ *
+ *   Count the subterms of a literal that must be eliminated:  terms
+ *   that are arguments of other terms or of non-equality atoms, and
+ *   one side of an equality between terms.
+ *
+ *************/
+
+static
+int nested_terms(Term t, LADR_BOOL top)
+{
+  if (VARIABLE(t))
+    return 0;
+  else {
+    int i, n = (top ? 0 : 1);
+    for (i = 0; i < ARITY(t); i++)
+      n += nested_terms(ARG(t,i), FALSE);
+    return n;
+  }
+}  /* nested_terms */
+
+static
+int nested_in_literal(Term lit)
+{
+  if (VARIABLE(lit))
+    return 0;
+  else if (EQ_TERM(lit)) {
+    Term a = ARG(lit,0);
+    Term b = ARG(lit,1);
+    return (nested_terms(a, TRUE) + nested_terms(b, TRUE) +
+	    (!VARIABLE(a) && !VARIABLE(b) ? 1 : 0));
+  }
+  else
+    return nested_terms(lit, TRUE);
+}  /* nested_in_literal */
+
+/*************
+ *
+ *   expand_value()
+ *
+ *   For expansion:  the value of a ground term, if it is a domain
+ *   element, an assigned cell, or a term already eliminated; else -1.
+ *   If all arguments have values, *pid is set to the cell ID.
+ *
+ *************/
+
+static
+int expand_value(Msat s, Term t, int *pid)
+{
+  *pid = -1;
+  if (VARIABLE(t))
+    return VARNUM(t);
+  else {
+    int i, id = Sn_to_mace_sn[SYMNUM(t)]->base, mult = 1;
+    for (i = ARITY(t)-1; i >= 0; i--) {
+      int sub;
+      int v = expand_value(s, ARG(t,i), &sub);
+      if (v == -1)
+	return -1;
+      id += v * mult;
+      mult *= Domain_size;
+    }
+    *pid = id;
+    if (Cells[id].value != NULL)
+      return VARNUM(Cells[id].value);
+    for (i = 0; i < s->num_elim; i++)
+      if (s->elim_id[i] == id)
+	return s->elim_val[i];
+    return -1;
+  }
+}  /* expand_value */
+
+/*************
+ *
+ *   open_subterm()
+ *
+ *   Find an innermost subterm of t (possibly t itself) whose value
+ *   is unknown, but whose arguments all have values; return its ID.
+ *
+ *************/
+
+static
+int open_subterm(Msat s, Term t)
+{
+  int i, id;
+  if (VARIABLE(t) || expand_value(s, t, &id) != -1)
+    return -1;
+  for (i = 0; i < ARITY(t); i++) {
+    int sub = open_subterm(s, ARG(t,i));
+    if (sub != -1)
+      return sub;
+  }
+  return id;
+}  /* open_subterm */
+
+/*************
+ *
+ *   expand_literal()
+ *
+ *   Return SL_TRUE, SL_FALSE, SL_LIT (*plit is set), or SL_OPEN
+ *   (*popen is set to the ID of a term that must be eliminated first).
+ *
+ *************/
+
+static
+int expand_literal(Msat s, Term lit, int *plit, int *popen)
+{
+  int r, ida, idb;
+
+  if (FALSE_TERM(lit))
+    return SL_FALSE;
+  else if (TRUE_TERM(lit))
+    return SL_TRUE;
+  else if (EQ_TERM(lit)) {
+    int va = expand_value(s, ARG(lit,0), &ida);
+    int vb = expand_value(s, ARG(lit,1), &idb);
+    if (va != -1 && vb != -1)
+      r = (va == vb ? SL_TRUE : SL_FALSE);
+    else if (vb != -1 && ida != -1)
+      r = cell_lit(s, ida, vb, plit);
+    else if (va != -1 && idb != -1)
+      r = cell_lit(s, idb, va, plit);
+    else {
+      *popen = open_subterm(s, ARG(lit,0));
+      if (*popen == -1)
+	*popen = open_subterm(s, ARG(lit,1));
+      return SL_OPEN;
+    }
+  }
+  else {
+    int i;
+    for (i = 0; i < ARITY(lit); i++) {
+      if (expand_value(s, ARG(lit,i), &ida) == -1) {
+	*popen = open_subterm(s, ARG(lit,i));
+	return SL_OPEN;
+      }
+    }
+    expand_value(s, lit, &ida);
+    r = cell_lit(s, ida, 1, plit);
+  }
+
+  if (NEGATED(lit)) {
+    if (r == SL_TRUE)
+      r = SL_FALSE;
+    else if (r == SL_FALSE)
+      r = SL_TRUE;
+    else
+      *plit = NEG_LIT(*plit);
+  }
+  return r;
+}  /* expand_literal */
+
+/*************
+ *
+ *   expand_mclause()
+ *
+ *   Function elimination by expansion:  if the term t=f(1,2) has
+ *   no value, the clause C[t] is replaced with  f(1,2)!=v | C[v]
+ *   for each possible value v.
+ *
+ *************/
+
+static
+void expand_mclause(Msat s, Mclause c)
+{
+  int open = -1;
+  int i;
+
+  cbuf_start(s);
+  for (i = 0; i < s->num_elim; i++) {
+    int lit;
+    int r = cell_lit(s, s->elim_id[i], s->elim_val[i], &lit);
+    cbuf_add(s, r, lit, TRUE);
+  }
+
+  for (i = 0; i < c->numlits; i++) {
+    int lit, id = -1;
+    int r = expand_literal(s, LIT(c,i), &lit, &id);
+    if (r == SL_OPEN) {
+      if (open == -1)
+	open = id;
+    }
+    else
+      cbuf_add(s, r, lit, FALSE);
+  }
+
+  if (open == -1)
+    cbuf_end(s);
+  else if (s->num_elim == MAX_EXPAND)
+    fatal_error("expand_mclause, too many nested terms");
+  else {
+    int v;
+    for (v = 0; v < Domain_size; v++) {
+      if (Cells[open].possible[v] != NULL) {
+	s->elim_id[s->num_elim] = open;
+	s->elim_val[s->num_elim] = v;
+	s->num_elim++;
+	expand_mclause(s, c);
+	s->num_elim--;
+      }
+    }
+  }
+}  /* expand_mclause */
+
+/*************
+ *
+ *   encode_mclause()
+ *
+ *   If the ground clause has only a few nested terms, it is
+ *   expanded.  Otherwise, the nested terms and atoms get variables
+ *   of their own (with defining clauses), so that the ground clause
+ *   gives just one propositional clause.
+ *
+ *************/
+
+static
+void encode_mclause(Msat s, Mclause c)
+{
+  int *lits, *results;
+  int i, nested = 0;
+
+  for (i = 0; i < c->numlits; i++)
+    nested += nested_in_literal(LIT(c,i));
+
+  if (nested <= MAX_EXPAND) {
+    expand_mclause(s, c);
+    return;
+  }
+
+  /* Get the literals first, because defining clauses use the cbuf. */
+
+  lits = malloc(c->numlits * sizeof(int));
+  results = malloc(c->numlits * sizeof(int));
+
+  for (i = 0; i < c->numlits; i++)
+    results[i] = encode_literal(s, LIT(c,i), &(lits[i]));
+
+  cbuf_start(s);
+  for (i = 0; i < c->numlits; i++)
+    cbuf_add(s, results[i], lits[i], FALSE);
+  cbuf_end(s);
+
+  free(lits);
+  free(results);
+}  /* encode_mclause */
+
+/*************
+ *
+ *   encode_cells()
+ *
+ *   Totality and functionality of the (unassigned) function cells.
+ *
+ *************/
+
+static
+void encode_cells(Msat s)
+{
+  int id;
+  for (id = 0; id < Number_of_cells; id++) {
+    if (s->cell_var[id] != -1 && Cells[id].symbol->type == FUNCTION) {
+      int i, j, li, lj, ri, rj;
+      cbuf_start(s);
+      for (i = 0; i < Domain_size; i++) {
+	ri = cell_lit(s, id, i, &li);
+	cbuf_add(s, ri, li, FALSE);
+      }
+      cbuf_end(s);
+      for (i = 0; i < Domain_size; i++) {
+	ri = cell_lit(s, id, i, &li);
+	for (j = i + 1; j < Domain_size && ri == SL_LIT; j++) {
+	  rj = cell_lit(s, id, j, &lj);
+	  cbuf_start(s);
+	  cbuf_add(s, ri, li, TRUE);
+	  cbuf_add(s, rj, lj, TRUE);
+	  cbuf_end(s);
+	}
+      }
+    }
+  }
+}  /* encode_cells */
+
+/*************
+ *
+ *   encode_symmetry()
+ *
+ *   Static symmetry breaking, in the spirit of the least number
+ *   heuristic.  Elements m = max_constrained+1 and greater are
+ *   interchangeable, so we may rename them in order of first
+ *   appearance in a sequence of "generator" cells:  first the
+ *   constants c_0, c_1, ..., then g(0), g(1), ..., where g(x) is
+ *   f(0,...,0,x) for the first nonconstant function symbol f.
+ *   (If element i has not appeared when we get to g(i), we name an
+ *   unused element i.)  In the renamed model, each generator has
+ *   a bounded value, and a new value d must follow d-1:
+ *
+ *       c_i  <= m+i
+ *       g(i) <= i + max(m+k,1)              (k is the number of constants)
+ *       t_p = d  ->  t_q = d-1 for some q < p   (d > m, and d > i+1 for g(i))
+ *
+ *************/
+
+static
+void encode_symmetry(Msat s, int max_constrained)
+{
+  int m = max_constrained + 1;
+  int *gen = malloc((Number_of_cells + Domain_size) * sizeof(int));
+  int *bound = malloc((Number_of_cells + Domain_size) * sizeof(int));
+  int *chain = malloc((Number_of_cells + Domain_size) * sizeof(int));
+  int p, k, n = 0;
+  Symbol_data sym, f = NULL;
+
+  for (sym = Symbols; sym != NULL; sym = sym->next) {
+    if (sym->type == FUNCTION && sym->arity == 0) {
+      gen[n] = sym->base;
+      bound[n] = m + n;
+      chain[n] = m + 1;
+      n++;
+    }
+    else if (sym->type == FUNCTION && f == NULL)
+      f = sym;
+  }
+  k = n;
+
+  if (f != NULL) {
+    int i;
+    for (i = 0; i < Domain_size; i++) {
+      gen[n] = f->base + i;   /* f(0,...,0,i) */
+      bound[n] = i + MAX(m + k, 1);
+      chain[n] = MAX(m + 1, i + 2);
+      n++;
+    }
+  }
+
+  for (p = 0; p < n; p++) {
+    int d;
+    for (d = chain[p]; d < Domain_size; d++) {
+      int lit, q;
+      int r = cell_lit(s, gen[p], d, &lit);
+      cbuf_start(s);
+      cbuf_add(s, r, lit, TRUE);
+      if (d <= bound[p]) {
+	for (q = 0; q < p; q++) {
+	  r = cell_lit(s, gen[q], d - 1, &lit);
+	  cbuf_add(s, r, lit, FALSE);
+	}
+      }
+      cbuf_end(s);
+    }
+  }
+  free(gen);
+  free(bound);
+  free(chain);
+}  /* encode_symmetry */
+
+/*************
+ *
+ *   msat_init()
+ *
+ *   Build the propositional problem from the current cell table
+ *   and ground clauses.
+ *
+ *************/
+
+/* DOCUMENTATION
+*/
+
+/* PUBLIC */
+Msat msat_init(int max_constrained)
+{
+  Msat s = calloc(1, sizeof(struct msat));
+  int id, i;
+  Plist p;
+
+  s->ok = TRUE;
+  s->var_inc = 1;
+  s->cla_inc = 1;
+  s->conflicts_to_restart = 100 * luby(0);
+
+  s->cbuf_size = Domain_size + 16;
+  s->cbuf = malloc(s->cbuf_size * sizeof(int));
+
+  s->aux_size = 1024;
+  s->aux_sn   = malloc(s->aux_size * sizeof(int));
+  s->aux_kids = malloc(s->aux_size * sizeof(int));
+  s->aux_var  = malloc(s->aux_size * sizeof(int));
+  s->aux_next = malloc(s->aux_size * sizeof(int));
+  s->aux_hash_size = 1024;
+  s->aux_hash = malloc(s->aux_hash_size * sizeof(int));
+  for (i = 0; i < s->aux_hash_size; i++)
+    s->aux_hash[i] = -1;
+  s->kids_size = 4096;
+  s->kids = malloc(s->kids_size * sizeof(int));
+
+  /* Variables for the unassigned cells. */
+
+  s->cell_var = malloc(Number_of_cells * sizeof(int));
+  for (id = 0; id < Number_of_cells; id++) {
+    if (Cells[id].value != NULL)
+      s->cell_var[id] = -1;
+    else
+      s->cell_var[id] = new_vars(s, Cells[id].symbol->type == RELATION ?
+				 1 : Domain_size);
+  }
+
+  encode_cells(s);
+
+  for (p = Ground_clauses; p != NULL && s->ok; p = p->next) {
+    Mclause c = p->v;
+    if (!c->subsumed)
+      encode_mclause(s, c);
+  }
+
+  if (flag(Opt->lnh))
+    encode_symmetry(s, max_constrained);
+
+  s->max_learnts = MAX(s->num_clauses / 3.0, 5000);
+  return s;
+}  /* msat_init */
+
+/*************
+ *
+ *   msat_free()
+ *
+ *************/
+
+/* DOCUMENTATION
+*/
+
+/* PUBLIC */
+void msat_free(Msat s)
+{
+  int i;
+  for (i = 0; i < s->num_clauses; i++)
+    free(s->clauses[i]);
+  for (i = 0; i < s->num_learnts; i++)
+    free(s->learnts[i]);
+  for (i = 0; i < 2 * s->nvars; i++)
+    free(s->watches[i].w);
+  free(s->clauses);
+  free(s->learnts);
+  free(s->watches);
+  free(s->value);
+  free(s->phase);
+  free(s->level);
+  free(s->reason);
+  free(s->activity);
+  free(s->seen);
+  free(s->trail);
+  free(s->trail_lim);
+  free(s->heap);
+  free(s->heap_pos);
+  free(s->toclear);
+  free(s->buf);
+  free(s->cell_var);
+  free(s->cbuf);
+  free(s->aux_sn);
+  free(s->aux_kids);
+  free(s->aux_var);
+  free(s->aux_next);
+  free(s->aux_hash);
+  free(s->kids);
+  free(s);
+}  /* msat_free */
+
+/*************
+ *
+ *   msat_cell_value()
+ *
+ *   After msat_solve() returns MSAT_SAT, get the value of a cell.
+ *
+ *************/
+
+/* DOCUMENTATION
+*/
+
+/* PUBLIC */
+int msat_cell_value(Msat s, int id)
+{
+  if (Cells[id].value != NULL)
+    return VARNUM(Cells[id].value);
+  else if (Cells[id].symbol->type == RELATION)
+    return s->value[s->cell_var[id]] == V_TRUE ? 1 : 0;
+  else {
+    int v;
+    for (v = 0; v < Domain_size; v++)
+      if (s->value[s->cell_var[id] + v] == V_TRUE)
+	return v;
+    fatal_error("msat_cell_value, cell has no value");
+    return -1;
+  }
+}  /* msat_cell_value */
+
+/*************
+ *
+ *   msat_block_model()
+ *
+ *   After msat_solve() returns MSAT_SAT, add a clause that excludes
+ *   the current model, so that the next call finds a different one.
+ *   Return FALSE if there can be no more models.
+ *
+ *************/
+
+/* DOCUMENTATION
+*/
+
+/* PUBLIC */
+LADR_BOOL msat_block_model(Msat s)
+{
+  int id, n = 0;
+  int *lits = malloc((Number_of_cells + 1) * sizeof(int));
+  for (id = 0; id < Number_of_cells; id++) {
+    if (s->cell_var[id] != -1) {
+      int v = msat_cell_value(s, id);
+      int lit;
+      if (cell_lit(s, id, v, &lit) == SL_LIT)
+	lits[n++] = NEG_LIT(lit);
+    }
+  }
+  cancel_until(s, 0);
+  add_clause(s, lits, n);
+  free(lits);
+  return s->ok;
+}  /* msat_block_model */
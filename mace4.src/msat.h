@@ -0,0 +1,62 @@
+/*  Copyright (C) 2006, 2007 William McCune
+
+    This file is part of the LADR Deduction Library.
+
+    The LADR Deduction Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU General Public License,
+    version 2.
+
+    The LADR Deduction Library is distributed in the hope that it will be
+    useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with the LADR Deduction Library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifndef MACE4_MSAT_H
+#define MACE4_MSAT_H
+
+/* INTRODUCTION
+A propositional (CDCL) back end for Mace4.  After the ground
+clauses for a domain size have been generated and the initial
+unit propagation is done, msat_init() flattens the current state
+(the cell table and the nonsubsumed ground clauses) into a
+propositional problem: one variable for each relation cell,
+one variable for each (function cell, value) pair, with
+totality and functionality clauses for the function cells.
+Nested terms are removed by the usual function elimination,
+f(g(1))=2  ==>  g(1)!=v | f(v)=2  for each value v.
+If the lnh flag is set, the constants are ordered to break
+symmetry, in the spirit of the least number heuristic.
+<P>
+msat_solve() runs a conflict-driven clause-learning search
+(two watched literals, VSIDS, phase saving, Luby restarts,
+and periodic deletion of inactive learned clauses).
+*/
+
+/* Public definitions */
+
+typedef struct msat * Msat;
+
+/* msat_solve() results */
+
+enum {
+  MSAT_UNKNOWN,  /* conflict budget exhausted */
+  MSAT_SAT,
+  MSAT_UNSAT
+};
+
+/* End of public definitions */
+
+/* Public function prototypes from msat.c */
+
+Msat msat_init(int max_constrained);
+void msat_free(Msat s);
+int msat_solve(Msat s, int max_conflicts);
+int msat_cell_value(Msat s, int id);
+LADR_BOOL msat_block_model(Msat s);
+
+#endif  /* conditional compilation of whole file */
@@ -64,6 +64,12 @@ static int Max_domain_element_in_input;  /* For Least Number Heuristic */
 
 static Plist Models;  /* in case we collect models as terms */
 
+static Hashtab Canon_models;  /* canonical forms, for nonisomorphic */
+static Plist Canon_list;      /* the same canonical forms, for freeing */
+
+static FILE *Binary_fp;          /* models are also written here (-W) */
+static Interp_bin Binary_header; /* after the first model is written */
+
 Clock Mace4_clock;
 
 /* stats for entire run */
@@ -86,9 +92,15 @@ enum {
   SEARCH_MAX_MEGS,            /* stop */
   SEARCH_MAX_TOTAL_SECONDS,   /* stop */
   SEARCH_MAX_DOMAIN_SECONDS,  /* stop */
-  SEARCH_DOMAIN_OUT_OF_RANGE  /* stop */
+  SEARCH_DOMAIN_OUT_OF_RANGE, /* stop */
+  SEARCH_BACKJUMP             /* learn_search(): back up to Backjump_level */
 };
 
+/* for learn_search() */
+
+static int Backjump_level;  /* where the pending nogood becomes unit */
+static int Model_floor;     /* search levels below this have found models */
+
 /* Ground terms.  MACE4 operates on ground clauses, which are
    represented by the structure mclause.  Ground terms (and
    atoms) are represented with ordinary LADR terms.  There are
@@ -142,6 +154,7 @@ void init_mace_options(Mace_options opt)
   opt->selection_measure = init_parm("selection_measure",4,       0, 4);
   opt->increment         = init_parm("increment",        1,       1, INT_MAX);
   opt->max_megs          = init_parm("max_megs",       500,      -1, INT_MAX);
+  opt->max_learned_megs  = init_parm("max_learned_megs",100,      1, INT_MAX);
   opt->report_stderr     = init_parm("report_stderr",   -1,      -1, INT_MAX);
          
   opt->print_models           = init_flag("print_models",           TRUE);
@@ -160,6 +173,9 @@ void init_mace_options(Mace_options opt)
   opt->iterate_primes         = init_flag("iterate_primes",         FALSE);
   opt->iterate_nonprimes      = init_flag("iterate_nonprimes",      FALSE);
   opt->skolems_last           = init_flag("skolems_last",           FALSE);
+  opt->nonisomorphic          = init_flag("nonisomorphic",          FALSE);
+  opt->sat_search             = init_flag("sat_search",             FALSE);
+  opt->learn_nogoods          = init_flag("learn_nogoods",          FALSE);
   opt->return_models          = init_flag("return_models",          FALSE);
 
   opt->iterate = init_stringparm("iterate", 5,
@@ -485,6 +501,122 @@ LADR_BOOL check_that_ground_clauses_are_true(void)
   return ok;
 }  /* check_that_ground_clauses_are_true */
 
+/*************
+ *
+ *   id_interp()
+ *
+ *************/
+
+static
+LADR_BOOL id_interp(void *a, void *b)
+{
+  return ident_interp(a, b);
+}  /* id_interp */
+
+/*************
+ *
+ *   isomorphic_to_previous_model()
+ *
+ *   Compute the canonical form of the current model, and check whether
+ *   we have seen it before (for the current domain size).  If not,
+ *   remember it.
+ *
+ *************/
+
+static
+LADR_BOOL isomorphic_to_previous_model(void)
+{
+  Term modelterm = interp_term();
+  Interp a = compile_interp(modelterm, FALSE);
+  Interp norm = normal3_interp(a, NULL);
+  Interp canon = canon_interp(norm);
+  unsigned h = hash_interp(canon);
+  LADR_BOOL found;
+
+  zap_term(modelterm);
+  zap_interp(a);
+  zap_interp(norm);
+
+  if (Canon_models == NULL)
+    Canon_models = hash_init(100003);
+
+  found = hash_lookup(canon, h, Canon_models, id_interp) != NULL;
+  if (found)
+    zap_interp(canon);
+  else {
+    hash_insert(canon, h, Canon_models);
+    Canon_list = plist_prepend(Canon_list, canon);
+  }
+  return found;
+}  /* isomorphic_to_previous_model */
+
+/*************
+ *
+ *   free_canon_models()
+ *
+ *************/
+
+static
+void free_canon_models(void)
+{
+  Plist p;
+  for (p = Canon_list; p; p = p->next)
+    zap_interp(p->v);
+  zap_plist(Canon_list);
+  Canon_list = NULL;
+  if (Canon_models) {
+    hash_destroy(Canon_models);
+    Canon_models = NULL;
+  }
+}  /* free_canon_models */
+
+/*************
+ *
+ *   set_binary_models_file()
+ *
+ *   Each model will also be written to fp, in the binary form
+ *   of fwrite_interp_bin().
+ *
+ *************/
+
+void set_binary_models_file(FILE *fp)
+{
+  Binary_fp = fp;
+}  /* set_binary_models_file */
+
+/*************
+ *
+ *   write_model_binary()
+ *
+ *************/
+
+static
+void write_model_binary(void)
+{
+  Term modelterm = interp_term();
+  Term eq = get_rigid_term("=", 2);
+  Interp a;
+
+  /* comments [number = n, seconds = s], as in print_model_standard() */
+
+  zap_term(ARG(modelterm,1));
+  ARG(eq,0) = get_rigid_term("seconds", 0);
+  ARG(eq,1) = nat_to_term((int) user_seconds());
+  ARG(modelterm,1) = listterm_cons(eq, get_nil_term());
+  eq = get_rigid_term("=", 2);
+  ARG(eq,0) = get_rigid_term("number", 0);
+  ARG(eq,1) = nat_to_term(Total_models);
+  ARG(modelterm,1) = listterm_cons(eq, ARG(modelterm,1));
+
+  a = compile_interp(modelterm, FALSE);
+  zap_term(modelterm);
+  if (Binary_header == NULL)
+    Binary_header = fwrite_interp_bin_header(Binary_fp, a);
+  fwrite_interp_bin(Binary_fp, Binary_header, a);
+  fflush(Binary_fp);
+  zap_interp(a);
+}  /* write_model_binary */
+
 /*************
  *
  *   possible_model()
@@ -501,6 +633,11 @@ int possible_model(void)
   else if (!check_that_ground_clauses_are_true())
     fatal_error("possible_model, bad model found");
 
+  if (flag(Opt->nonisomorphic) && isomorphic_to_previous_model()) {
+    Mstats.isomorphic_models++;
+    return SEARCH_GO_NO_MODELS;
+  }
+
   {
     static int next_message = 1;
     Total_models++;
@@ -513,6 +650,9 @@ int possible_model(void)
       Models = plist_append(Models, model);
     }
 
+    if (Binary_fp)
+      write_model_binary();
+
     if (flag(Opt->print_models))
       print_model_standard(stdout, TRUE);
     else if (flag(Opt->print_models_tabular))
@@ -714,6 +854,214 @@ int search(int max_constrained, int depth)
   }
 }  /* search */
 
+/*************
+ *
+ *   learn_search()
+ *
+ *   The search with nogood learning (flag learn_nogoods).  It is
+ *   like search(), except that a contradiction is analyzed (see
+ *   learn.c).  The resulting nogood may tell us to back up several
+ *   levels (rc SEARCH_BACKJUMP), to the level (depth) at which it is
+ *   unit; there, it is asserted, and the current value of the cell
+ *   is tried again.  We never back up into a level whose current
+ *   branch has found models (those below Model_floor), because the
+ *   models would be found again.
+ *
+ *   A nogood can also assign the selected cell; in that case we
+ *   stop if that value has already been tried, and otherwise select
+ *   another cell.
+ *
+ *************/
+
+static
+int learn_search(int max_constrained, int depth)
+{
+  Estack asserted = NULL;  /* consequences of nogoods at this level */
+  int id = -1;
+  int i = 0, last = 0, level;
+  int rc = check_time_memory();
+  LADR_BOOL go = (rc == SEARCH_GO_NO_MODELS);
+
+  while (go) {
+    if (learn_pending(&level)) {
+      /* A contradiction at this level or below gave a nogood. */
+      level = MIN(MAX(level, Model_floor), depth);
+      if (level < depth) {
+	Backjump_level = level;
+	rc = SEARCH_BACKJUMP;
+	go = FALSE;
+      }
+      else {
+	Estack stk;
+	int result = learn_assert(depth, &stk);
+	if (result == LEARN_ASSERTED)
+	  asserted = estack_cat(stk, asserted);  /* stk on top */
+	else if (result == LEARN_FALSE ||
+		 (result == LEARN_CONFLICT && !learn_pending(&level))) {
+	  rc = SEARCH_GO_NO_MODELS;  /* nothing more at this level */
+	  go = FALSE;
+	}
+      }
+    }
+    else if (id == -1 || Cells[id].value != NULL) {
+      if (id != -1 && VARNUM(Cells[id].value) < i) {
+	rc = SEARCH_GO_NO_MODELS;  /* that value has been done */
+	go = FALSE;
+      }
+      else {
+	learn_level(-1);  /* in case selection does lookahead */
+	id = select_cell(max_constrained);
+	if (id == -1) {
+	  rc = possible_model();
+	  if (rc == SEARCH_GO_MODELS)
+	    Model_floor = depth;
+	  go = FALSE;
+	}
+	else {
+	  max_constrained = MAX(max_constrained, Cells[id].max_index);
+	  Mstats.selections++;
+	  if (flag(Opt->trace)) {
+	    printf("select: ");
+	    p_model(FALSE);
+	  }
+	  if (Cells[id].symbol->type == RELATION)
+	    last = 1;
+	  else if (flag(Opt->lnh))
+	    last = MIN(max_constrained+1, Domain_size-1);
+	  else
+	    last = Domain_size-1;
+	  i = 0;
+	}
+      }
+    }
+    else if (i > last)
+      go = FALSE;  /* rc is from the last value */
+    else if (Cells[id].possible[i] == NULL)
+      i++;
+    else {
+      Estack stk;
+      Mstats.assignments++;
+      if (flag(Opt->trace)) {
+	printf("assign: ");
+	fwrite_term(stdout, Cells[id].eterm);
+	printf("=%d (%d) depth=%d\n", i, last, depth);
+      }
+      Model_floor = MIN(Model_floor, depth);
+      learn_level(depth+1);
+      stk = assign_and_propagate(id, Domain[i]);
+      if (stk == NULL) {
+	if (!learn_pending(&level))
+	  i++;  /* try the next value */
+      }
+      else {
+	rc = learn_search(MAX(max_constrained, i), depth+1);
+	restore_from_stack(stk);
+	if (rc == SEARCH_BACKJUMP) {
+	  if (Backjump_level < depth)
+	    go = FALSE;
+	  else
+	    rc = SEARCH_GO_NO_MODELS;  /* assert the nogood and redo i */
+	}
+	else if (rc == SEARCH_GO_MODELS) {
+	  go = mace4_skolem_check(id);
+	  i++;
+	}
+	else if (rc == SEARCH_GO_NO_MODELS)
+	  i++;
+	else
+	  go = FALSE;
+      }
+    }
+  }
+  if (rc == SEARCH_BACKJUMP)
+    Mstats.backjumps++;
+  restore_from_stack(asserted);
+  return rc;
+}  /* learn_search */
+
+/*************
+ *
+ *   sat_possible_model()
+ *
+ *   The SAT back end has a total assignment.  Give it to the ordinary
+ *   propagation code (which also checks it), so that possible_model()
+ *   can print and count the model as usual.
+ *
+ *************/
+
+static
+int sat_possible_model(Msat sat)
+{
+  Estack *stacks = malloc(Number_of_cells * sizeof(Estack));
+  int id, n, rc;
+
+  for (id = 0, n = 0; id < Number_of_cells; id++) {
+    Term value = Domain[msat_cell_value(sat, id)];
+    if (Cells[id].value == NULL) {
+      Estack stk = assign_and_propagate(id, value);
+      if (stk == NULL)
+	fatal_error("sat_possible_model, model rejected by propagation");
+      stacks[n++] = stk;
+    }
+    else if (Cells[id].value != value)
+      fatal_error("sat_possible_model, model contradicts propagation");
+  }
+
+  rc = possible_model();
+
+  while (n > 0)
+    restore_from_stack(stacks[--n]);
+  free(stacks);
+  return rc;
+}  /* sat_possible_model */
+
+/*************
+ *
+ *   sat_search()
+ *
+ *   Search with the SAT back end (see msat.c) instead of search().
+ *   The solver gets a conflict budget, so that we can check the
+ *   time and memory limits now and then.
+ *
+ *************/
+
+static
+int sat_search(int max_constrained)
+{
+  Msat sat = msat_init(max_constrained);
+  int rc = SEARCH_GO_NO_MODELS;
+  LADR_BOOL found = FALSE;
+  LADR_BOOL go = TRUE;
+
+  if (flag(Opt->verbose))
+    printf("\nSAT encoding: %u variables, %u clauses.\n",
+	   Mstats.sat_vars, Mstats.sat_clauses);
+
+  while (go) {
+    int result = msat_solve(sat, 100);
+    if (result == MSAT_UNKNOWN) {
+      rc = check_time_memory();
+      go = (rc == SEARCH_GO_NO_MODELS);
+    }
+    else if (result == MSAT_UNSAT) {
+      rc = SEARCH_GO_NO_MODELS;
+      go = FALSE;
+    }
+    else {
+      rc = sat_possible_model(sat);
+      if (rc == SEARCH_GO_MODELS)
+	found = TRUE;
+      go = ((rc == SEARCH_GO_MODELS || rc == SEARCH_GO_NO_MODELS) &&
+	    msat_block_model(sat));
+    }
+  }
+
+  msat_free(sat);
+  if (rc == SEARCH_GO_NO_MODELS && found)
+    rc = SEARCH_GO_MODELS;
+  return rc;
+}  /* sat_search */
+
 /*************
  *
  *   mace4n() -- look for a model of a specific size
@@ -747,6 +1095,10 @@ int mace4n(Plist clauses, int order)
 
   special_assignments();  /* assignments determined by options */
 
+  init_selection();  /* open cells, for select_cell() */
+
+  init_learning();  /* reasons and nogoods, if learn_nogoods is set */
+
   /* Instantiate clauses over the domain.  This also 
      (1) makes any domain element constants into real domain elements,
      (2) applies OR, NOT, and EQ simplification, and
@@ -778,7 +1130,13 @@ int mace4n(Plist clauses, int order)
 
   /* Here we go! */
 
-  if (initial_state->ok)
+  if (initial_state->ok && flag(Opt->sat_search) && !flag(Opt->arithmetic))
+    rc = sat_search(Max_domain_element_in_input);
+  else if (initial_state->ok && learning()) {
+    Model_floor = INT_MAX;
+    rc = learn_search(Max_domain_element_in_input, 0);
+  }
+  else if (initial_state->ok)
     rc = search(Max_domain_element_in_input, 0);
   else
     rc = SEARCH_GO_NO_MODELS;  /* contradiction in initial state */
@@ -791,6 +1149,10 @@ int mace4n(Plist clauses, int order)
   if (flag(Opt->negprop))
     free_negprop_index();
 
+  free_selection();
+  free_canon_models();
+  free_learning();
+
   free(Ordered_cells);
   Ordered_cells = NULL;
 
@@ -810,6 +1172,7 @@ int mace4n(Plist clauses, int order)
     zap_mclause(g->v);
   zap_plist(Ground_clauses);
   Ground_clauses = NULL;
+  zap_ground_templates();
 
   set_variable_style(save_style);
   return rc;
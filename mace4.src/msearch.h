@@ -36,6 +36,8 @@
 #include "syms.h"
 #include "ground.h"
 #include "propagate.h"
+#include "msat.h"
+#include "learn.h"
 
 /*********************************************** macro definitions */
 
@@ -66,6 +68,9 @@ struct mace_options {
     iterate_primes,
     iterate_nonprimes,
     skolems_last,
+    nonisomorphic,
+    sat_search,
+    learn_nogoods,
 
     return_models;  /* special case */
 
@@ -82,6 +87,7 @@ struct mace_options {
     max_seconds,
     max_seconds_per,
     max_megs,
+    max_learned_megs,
     report_stderr;
 
   /* stringparms */
@@ -93,6 +99,7 @@ struct mace_stats {
   /* stats for the current domain size */
   unsigned
     current_models,
+    isomorphic_models,
     selections,
     assignments,
     propagations,
@@ -118,7 +125,20 @@ struct mace_stats {
 
     neg_near_elim_attempts,
     neg_near_elim_agone,
-    neg_near_elim_egone;
+    neg_near_elim_egone,
+
+    sat_vars,
+    sat_clauses,
+    sat_decisions,
+    sat_propagations,
+    sat_conflicts,
+    sat_restarts,
+
+    nogoods,
+    nogood_facts,
+    nogood_propagations,
+    nogoods_deleted,
+    backjumps;
 };
 
 /* Mace results */
@@ -191,6 +211,7 @@ struct cell {
 /* from msearch.c */
 
 void init_mace_options(Mace_options opt);
+void set_binary_models_file(FILE *fp);
 Mace_results mace4(Plist clauses, Mace_options opt);
 void mace4_exit(int exit_code);
 
@@ -214,6 +235,10 @@ Term interp_term(void);
 
 /* from select.c */
 
+void init_selection(void);
+void free_selection(void);
+Estack select_assign_update(int id, Estack stk);
+Estack select_elim_update(int id, Estack stk);
 int select_cell(int max_constrained);
 
 /* from negpropindex.c */
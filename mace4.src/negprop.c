@@ -73,7 +73,9 @@ void negprop_elim(int id, Term beta, Mstate state)
   int arity      = c->symbol->arity;
   int sym        = c->symbol->mace_sn;
   Term alpha     = c->eterm;
+  struct mreason r = {R_NEGPROP, NULL, -1, -1};
   int i;
+  r.fact = FACT(id, VARNUM(beta), TRUE);
   for (i = 0; i < arity; i++) {
     Term results = negprop_find_near(1, sym, VARNUM(beta), alpha, i);
     while (results) {
@@ -94,7 +96,9 @@ void negprop_elim(int id, Term beta, Mstate state)
 	  Mstats.neg_elim_egone++;
 	else {
 	  Mstats.neg_elim_attempts++;
-	  new_elimination(subterm_id, ARG(alpha,i), state);
+	  r.p = containing_mclause(results);
+	  r.x = subterm_id;
+	  new_elimination(subterm_id, ARG(alpha,i), &r, state);
 	  if (!state->ok)
 	    return;  /* contradiction */
 	}
@@ -121,8 +125,11 @@ void negprop_assign(int id, Mstate state)
   int sym        = c->symbol->mace_sn;
   Term alpha     = c->eterm;
   Term beta      = c->value;
+  struct mreason r = {R_NEGPROP, NULL, -1, -1};
   int i;
 
+  r.fact = FACT(id, VARNUM(beta), FALSE);
+
   if (c->symbol->type == FUNCTION) {
     for (i = 0; i < arity; i++) {
       Term results = negprop_find_near(0, sym, VARNUM(beta), alpha, i);
@@ -144,7 +151,9 @@ void negprop_assign(int id, Mstate state)
 	    Mstats.neg_assign_egone++;
 	  else {
 	    Mstats.neg_assign_attempts++;
-	    new_elimination(subterm_id, ARG(alpha,i), state);
+	    r.p = containing_mclause(results);
+	    r.x = subterm_id;
+	    new_elimination(subterm_id, ARG(alpha,i), &r, state);
 	    if (!state->ok)
 	      return;  /* contradiction */
 	  }
@@ -187,7 +196,9 @@ void negprop_assign(int id, Mstate state)
 	      Mstats.neg_assign_egone++;
 	    else {
 	      Mstats.neg_assign_attempts++;
-	      new_elimination(subterm_id, ARG(alpha,i), state);
+	      r.p = containing_mclause(results);
+	      r.x = subterm_id;
+	      new_elimination(subterm_id, ARG(alpha,i), &r, state);
 	      if (!state->ok)
 		return;  /* contradiction */
 	    }
@@ -220,10 +231,14 @@ void negprop_near_elim(int subterm_id, Term alpha, Term beta, int pos,
     int i;
     int id = nterm_id(alpha);
     int increment = int_power(Domain_size, (ARITY(alpha) - 1) - pos);
+    struct mreason r = {R_NEGPROP, NULL, -1, -1};
+    r.p = containing_mclause(alpha);
+    r.x = subterm_id;
     for (i = 0; i < Domain_size; i++) {
       if (Cells[id].value == beta) {
 	Mstats.neg_near_elim_attempts++;
-	new_elimination(subterm_id, Domain[i], state);
+	r.fact = FACT(id, VARNUM(beta), FALSE);
+	new_elimination(subterm_id, Domain[i], &r, state);
 	if (!state->ok)
 	  return;
       }
@@ -254,12 +269,16 @@ void negprop_near_assign(int subterm_id, Term alpha, Term beta, int pos,
     int base_id = nterm_id(alpha);
     int increment = int_power(Domain_size, (ARITY(alpha) - 1) - pos);
     int id = base_id;
+    struct mreason r = {R_NEGPROP, NULL, -1, -1};
+    r.p = containing_mclause(alpha);
+    r.x = subterm_id;
 
     if (!LITERAL(alpha)) {
       for (i = 0; i < Domain_size; i++) {
 	if (Cells[id].possible[VARNUM(beta)] == NULL) {
 	  Mstats.neg_near_assign_attempts++;
-	  new_elimination(subterm_id, Domain[i], state);
+	  r.fact = FACT(id, VARNUM(beta), TRUE);
+	  new_elimination(subterm_id, Domain[i], &r, state);
 	  if (!state->ok)
 	    return;
 	}
@@ -281,7 +300,8 @@ void negprop_near_assign(int subterm_id, Term alpha, Term beta, int pos,
 	  for (i = 0; i < Domain_size; i++) {
 	    if (Cells[id].value == Domain[j]) {
 	      Mstats.neg_near_assign_attempts++;
-	      new_elimination(subterm_id, Domain[i], state);
+	      r.fact = FACT(id, j, FALSE);
+	      new_elimination(subterm_id, Domain[i], &r, state);
 	      if (!state->ok)
 		return;
 	    }
@@ -20,6 +20,7 @@
 
 #include "../ladr/banner.h"
 
+extern Mace_options Opt;
 extern Symbol_data Symbols;
 
 extern int Number_of_cells;
@@ -235,7 +236,7 @@ void print_model_standard(FILE *fp, LADR_BOOL print_head)
  *
  *   Construct a term representing the current interpretation, e.g.
  *
- *   interpretation( 3, [
+ *   interpretation( 3, [], [
  *         function(B, [2]),
  *         function(g(_), [1,0,1])]).
  *
@@ -269,9 +270,13 @@ Term interp_term(void)
       symlist = listterm_cons(entry, symlist);
     }
   }
-  return build_binary_term(str_to_sn("interpretation", 2),
-			   nat_to_term(Domain_size),
-			   symlist);
+  {
+    Term t = get_rigid_term("interpretation", 3);
+    ARG(t,0) = nat_to_term(Domain_size);
+    ARG(t,1) = get_nil_term();  /* no comments */
+    ARG(t,2) = symlist;
+    return t;
+  }
 }  /* interp_term */
 
 /*************
@@ -385,6 +390,18 @@ void p_stats(void)
 	 Mstats.rewrite_terms, Mstats.rewrite_bools, Mstats.indexes);
   printf("Rules_from_neg_clauses=%u, cross_offs=%d.\n",
 	 Mstats.rules_from_neg, Mstats.cross_offs);
+  if (flag(Opt->sat_search))
+    printf("Sat_vars=%u, sat_clauses=%u, sat_decisions=%u, sat_propagations=%u,\n"
+	   "sat_conflicts=%u, sat_restarts=%u.\n",
+	   Mstats.sat_vars, Mstats.sat_clauses, Mstats.sat_decisions,
+	   Mstats.sat_propagations, Mstats.sat_conflicts, Mstats.sat_restarts);
+  if (flag(Opt->learn_nogoods))
+    printf("Nogoods=%u, nogood_facts=%u, nogood_propagations=%u,\n"
+	   "nogoods_deleted=%u, backjumps=%u.\n",
+	   Mstats.nogoods, Mstats.nogood_facts, Mstats.nogood_propagations,
+	   Mstats.nogoods_deleted, Mstats.backjumps);
+  if (flag(Opt->nonisomorphic))
+    printf("Isomorphic_models=%u (not counted).\n", Mstats.isomorphic_models);
 #if 0
   printf("Negative propagation:\n");
   printf("                 attempts      agone      egone\n");
@@ -433,6 +450,7 @@ void p_mem(void)
 void reset_current_stats(void)
 {
   Mstats.current_models = 0;
+  Mstats.isomorphic_models = 0;
   Mstats.selections = 0;
   Mstats.assignments = 0;
   Mstats.propagations = 0;
@@ -459,5 +477,18 @@ void reset_current_stats(void)
   Mstats.neg_near_elim_attempts = 0;
   Mstats.neg_near_elim_agone = 0;
   Mstats.neg_near_elim_egone = 0;
+
+  Mstats.sat_vars = 0;
+  Mstats.sat_clauses = 0;
+  Mstats.sat_decisions = 0;
+  Mstats.sat_propagations = 0;
+  Mstats.sat_conflicts = 0;
+  Mstats.sat_restarts = 0;
+
+  Mstats.nogoods = 0;
+  Mstats.nogood_facts = 0;
+  Mstats.nogood_propagations = 0;
+  Mstats.nogoods_deleted = 0;
+  Mstats.backjumps = 0;
 }  /* reset_current_stats */
 
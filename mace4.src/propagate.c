@@ -169,18 +169,32 @@ void nterm_check_and_process(Term lit, Mstate state)
  *
  *   new_assignment()
  *
+ *   The reason is recorded for conflict analysis (see learn.c).
  *   If a contradiction is found, set state->ok to FALSE.
  *
  *************/
 
-static
-void new_assignment(int id, Term value, Mstate state)
+void new_assignment(int id, Term value, Mreason r, Mstate state)
 {
-  if (Cells[id].value == NULL) {
+  if (Cells[id].value == NULL && learning() &&
+      Cells[id].possible[VARNUM(value)] == NULL) {
+    /* contradiction: the value has been crossed off */
+    if (flag(Opt->trace)) {
+      printf("\t\t\t\t\t");
+      fwrite_term(stdout, Cells[id].eterm);
+      printf(" = %d BACKUP!\n", VARNUM(value));
+    }
+    learn_conflict(r, FACT(id, VARNUM(value), TRUE));
+    state->ok = FALSE;
+    return;
+  }
+  else if (Cells[id].value == NULL) {
     /* Note that alpha of the new rule is indexed, so the
        rule will rewrite itself.  That IS what we want. */
     state->stack = update_and_push((void **) &(Cells[id].value),
 				   value, state->stack);
+    state->stack = select_assign_update(id, state->stack);
+    learn_record(id, VARNUM(value), FALSE, r);
     if (flag(Opt->trace)) {
       printf("\t\t\t\t\t");
       fwrite_term(stdout, Cells[id].eterm);
@@ -199,6 +213,7 @@ void new_assignment(int id, Term value, Mstate state)
       fwrite_term(stdout, Cells[id].eterm);
       printf(" = %d BACKUP!\n", VARNUM(value));
     }
+    learn_conflict(r, FACT(id, VARNUM(Cells[id].value), FALSE));
     state->ok = FALSE;
     return;
   }
@@ -208,11 +223,12 @@ void new_assignment(int id, Term value, Mstate state)
  *
  *   new_elimination()
  *
+ *   The reason is recorded for conflict analysis (see learn.c).
  *   If a contradiction is found, set state->ok to FALSE.
  *
  *************/
 
-void new_elimination(int id, Term beta, Mstate state)
+void new_elimination(int id, Term beta, Mreason r, Mstate state)
 {
   if (Cells[id].value == beta) {
     if (flag(Opt->trace)) {
@@ -220,6 +236,7 @@ void new_elimination(int id, Term beta, Mstate state)
       fwrite_term(stdout, Cells[id].eterm);
       printf(" != %d BACKUP!\n", VARNUM(beta));
     }
+    learn_conflict(r, FACT(id, VARNUM(beta), FALSE));
     state->ok = FALSE;   /* contradiction: cell already has that value! */
     return;
   }
@@ -233,20 +250,24 @@ void new_elimination(int id, Term beta, Mstate state)
     Mstats.cross_offs++;
     state->stack=update_and_push((void **) &(Cells[id].possible[VARNUM(beta)]),
 				 NULL, state->stack);
+    state->stack = select_elim_update(id, state->stack);
+    learn_record(id, VARNUM(beta), TRUE, r);
     if (flag(Opt->trace)) {
       printf("\t\t\t\t\t");
       fwrite_term(stdout, Cells[id].eterm);
       printf(" != %d\n", VARNUM(beta));
     }
-    if (flag(Opt->negprop))
+    if (flag(Opt->negprop) || learning())
       job_prepend(state, ELIMINATION, id, NULL, beta, -1);
 
     value = pvalues_check(Cells[id].possible, Domain_size);
     if (value == NULL)
       return;  /* ok: nothing more to do */
     else {
+      struct mreason elims = {R_ELIMS, NULL, -1, -1};
+      elims.x = id;
       Mstats.rules_from_neg++;
-      new_assignment(id, value, state);
+      new_assignment(id, value, &elims, state);
     }
   }
 }  /* new_elimination */
@@ -273,8 +294,11 @@ void process_clause(Mclause c, Mstate state)
   if (c->subsumed)
     return;
   else if (c->u.active == 0) {
+    struct mreason r = {R_CLAUSE, NULL, -1, -1};
     if (flag(Opt->trace))
       printf("\t\t\t\t\t** BACKUP **\n");
+    r.p = c;
+    learn_conflict(&r, -1);
     state->ok = FALSE;
     return;
   }
@@ -286,6 +310,7 @@ void process_clause(Mclause c, Mstate state)
     LADR_BOOL negated, eq;
     int id;
     int i = 0;
+    struct mreason r = {R_CLAUSE, NULL, -1, -1};
     while (FALSE_TERM(LIT(c,i)))
       i++;
     
@@ -311,10 +336,12 @@ void process_clause(Mclause c, Mstate state)
       return;  /* We cannot do anything else with the unit. */
     }
 
+    r.p = c;
+    r.x = id;
     if (eq && negated)
-      new_elimination(id, beta, state);  /* f(1,2) != 3 */
+      new_elimination(id, beta, &r, state);  /* f(1,2) != 3 */
     else
-      new_assignment(id, beta, state);   /* f(1,2) = 3, P(0), ~P(0) */
+      new_assignment(id, beta, &r, state);   /* f(1,2) = 3, P(0), ~P(0) */
   }
 }  /* process_clause */
 
@@ -499,6 +526,9 @@ void propagate(Mstate state)
     if (type == ASSIGNMENT)
       propagate_positive(id, state);
 
+    if (state->ok && learning() && (type == ASSIGNMENT || type == ELIMINATION))
+      propagate_nogoods(type, id, beta, state);
+
     if (state->ok && flag(Opt->negprop))
       propagate_negative(type, id, alpha, beta, pos, state);
   }
@@ -524,6 +554,7 @@ Estack assign_and_propagate(int id, Term value)
 {
   Estack tmp_stack;
   Mstate state = get_mstate();
+  struct mreason decision = {R_DECISION, NULL, -1, -1};
 
   if (Cells[id].value == value)
     fatal_error("assign_and_propagate: repeated assignment");
@@ -533,6 +564,8 @@ Estack assign_and_propagate(int id, Term value)
   /* First make the assignment and initialize the job list. */
 
   state->stack = update_and_push((void **) &(Cells[id].value), value, NULL);
+  state->stack = select_assign_update(id, state->stack);
+  learn_record(id, VARNUM(value), FALSE, &decision);
   job_prepend(state, ASSIGNMENT, id, NULL, NULL, -1);
 
   /* Process the job list (which can grow during propagation). */
@@ -546,6 +579,33 @@ Estack assign_and_propagate(int id, Term value)
   return tmp_stack;
 }  /* assign_and_propagate */
 
+/*************
+ *
+ *   propagate_fact()
+ *
+ *   Like assign_and_propagate(), but for an assignment or
+ *   elimination with a reason (a learned nogood, see learn.c).
+ *   Return NULL if the propagation gives a contradiction.
+ *
+ *************/
+
+Estack propagate_fact(int id, Term value, LADR_BOOL elim, Mreason r)
+{
+  Estack tmp_stack;
+  Mstate state = get_mstate();
+
+  if (elim)
+    new_elimination(id, value, r, state);
+  else
+    new_assignment(id, value, r, state);
+
+  propagate(state);
+
+  tmp_stack = state->stack;
+  free_mstate(state);
+  return tmp_stack;
+}  /* propagate_fact */
+
 /*************
  *
  *   process_initial_clause()
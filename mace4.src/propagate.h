@@ -26,6 +26,23 @@
 #define ELIMINATION       2  /* f(1,2) != 3 */
 #define NEAR_ELIMINATION  3  /* f(1,g(2)) != 3 */
 
+/* Reasons for assignments and eliminations (for conflict analysis) */
+
+#define R_DECISION  0  /* made by the search */
+#define R_CLAUSE    1  /* unit ground clause p, whose literal is on cell x */
+#define R_ELIMS     2  /* all other values of the cell are eliminated */
+#define R_NEGPROP   3  /* unit ground clause p (near cell x), and fact */
+#define R_NOGOOD    4  /* learned nogood p, all but fact x */
+
+typedef struct mreason * Mreason;
+
+struct mreason {
+  int type;
+  void *p;    /* Mclause or Nogood */
+  int x;      /* cell or fact to leave out of the explanation, or -1 */
+  int fact;   /* R_NEGPROP: the assignment or elimination used */
+};
+
 /* Public function prototypes from propagate.c */
 
 LADR_BOOL eterm(Term t, int *id);
@@ -38,6 +55,10 @@ Estack assign_and_propagate(int id, Term value);
 
 Estack reset_estack(void);
 
-void new_elimination(int id, Term beta, Mstate state);
+void new_assignment(int id, Term value, Mreason r, Mstate state);
+
+void new_elimination(int id, Term beta, Mreason r, Mstate state);
+
+Estack propagate_fact(int id, Term value, LADR_BOOL elim, Mreason r);
 
 #endif  /* conditional compilation of whole file */
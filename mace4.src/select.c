@@ -165,32 +165,290 @@ void selection_measure(int id, int *max, int *max_id)
   }
 }  /* selection_measure */
 
+/*
+ * Open cells.
+ *
+ * The open (unassigned) cells are kept in bitsets indexed by position
+ * in the selection order: the ID for linear selection, and the index
+ * into Ordered_cells for concentric selection.  For the most_crossed
+ * measure, there is also one bitset for each possible number of
+ * crossed-off values, so the best open cell is found by looking
+ * for the first bit in the highest nonempty bucket.
+ *
+ * The bitsets are updated by propagation (select_assign_update() and
+ * select_elim_update()), and every change goes onto the Estack along
+ * with the change to the cell, so backtracking restores them for free.
+ */
+
+#define WORD_BITS  ((int) (sizeof(size_t) * CHAR_BIT))
+
+static int Sel_words;         /* words in each bitset */
+static size_t *Sel_open;      /* open cells */
+static size_t **Sel_bucket;   /* Sel_bucket[k]: open, with k crossed off */
+static size_t *Sel_crossed;   /* number of values crossed off, by ID */
+static int *Sel_pos;          /* position of each cell, by ID */
+static int Sel_last;          /* last position of a non-equality cell */
+
 /*************
  *
- *   select_linear()
+ *   bit_index()
  *
  *************/
 
-int select_linear(int min_id, int max_id)
+static
+int bit_index(size_t w)
 {
-  if (parm(Opt->selection_measure) == NO_MEASURE) {
-    /* Return the first open cell. */
-    int i = min_id;
-    while (i <= max_id && Cells[i].value != NULL)
-      i++;
-    return (i > max_id ? -1 : i);
+#if defined(__GNUC__)
+  return (sizeof(size_t) == sizeof(unsigned long long) ?
+	  __builtin_ctzll((unsigned long long) w) :
+	  __builtin_ctzl((unsigned long) w));
+#else
+  int i = 0;
+  while ((w & 1) == 0) {
+    w >>= 1;
+    i++;
   }
+  return i;
+#endif
+}  /* bit_index */
+
+/*************
+ *
+ *   first_bit()
+ *
+ *   Return the first position in [lo..hi] that is set, or -1.
+ *
+ *************/
+
+static
+int first_bit(size_t *a, int lo, int hi)
+{
+  int w, last;
+  size_t x;
+  if (lo > hi)
+    return -1;
+  w = lo / WORD_BITS;
+  last = hi / WORD_BITS;
+  x = a[w] & (~(size_t) 0 << (lo % WORD_BITS));
+  while (x == 0 && w < last)
+    x = a[++w];
+  if (x == 0)
+    return -1;
   else {
+    int p = w * WORD_BITS + bit_index(x);
+    return (p > hi ? -1 : p);
+  }
+}  /* first_bit */
+
+/*************
+ *
+ *   trail_bit()
+ *
+ *   Set or clear a bit, pushing the change onto the stack.
+ *
+ *************/
+
+static
+Estack trail_bit(size_t *a, int pos, LADR_BOOL on, Estack stk)
+{
+  size_t *w = a + pos / WORD_BITS;
+  size_t bit = (size_t) 1 << (pos % WORD_BITS);
+  size_t x = (on ? *w | bit : *w & ~bit);
+  return update_and_push((void **) w, (void *) x, stk);
+}  /* trail_bit */
+
+/*************
+ *
+ *   pos_to_id()
+ *
+ *************/
+
+static
+int pos_to_id(int pos)
+{
+  if (parm(Opt->selection_order) == SELECT_LINEAR)
+    return pos;
+  else
+    return Ordered_cells[pos]->id;
+}  /* pos_to_id */
+
+/*************
+ *
+ *   init_selection()
+ *
+ *   Call this after the built-in and special assignments, and before
+ *   any propagation, for each domain size.
+ *
+ *************/
+
+void init_selection(void)
+{
+  int i, k, nbuckets = Domain_size + 1;
+  LADR_BOOL buckets = parm(Opt->selection_measure) == MOST_CROSSED;
+
+  Sel_words = (Number_of_cells + WORD_BITS - 1) / WORD_BITS;
+  Sel_open = calloc(Sel_words, sizeof(size_t));
+  Sel_pos = malloc(Number_of_cells * sizeof(int));
+  Sel_bucket = NULL;
+  Sel_crossed = NULL;
+  if (buckets) {
+    Sel_crossed = calloc(Number_of_cells, sizeof(size_t));
+    Sel_bucket = malloc(nbuckets * sizeof(size_t *));
+    for (k = 0; k < nbuckets; k++)
+      Sel_bucket[k] = calloc(Sel_words, sizeof(size_t));
+  }
+
+  Sel_last = Number_of_cells - 1;
+  for (i = 0; i < Number_of_cells; i++) {
+    int id = pos_to_id(i);
+    Sel_pos[id] = i;
+    if (Cells[id].symbol->attribute == EQUALITY_SYMBOL && Sel_last > i - 1)
+      Sel_last = i - 1;  /* equality cells are last in Ordered_cells */
+  }
+
+  for (i = 0; i < Number_of_cells; i++) {
+    if (Cells[i].value == NULL) {
+      int p = Sel_pos[i];
+      Sel_open[p / WORD_BITS] |= (size_t) 1 << (p % WORD_BITS);
+      if (buckets) {
+	Sel_crossed[i] = num_crossed(i);
+	Sel_bucket[Sel_crossed[i]][p / WORD_BITS] |=
+	  (size_t) 1 << (p % WORD_BITS);
+      }
+    }
+  }
+}  /* init_selection */
+
+/*************
+ *
+ *   free_selection()
+ *
+ *************/
+
+void free_selection(void)
+{
+  if (Sel_bucket) {
+    int k;
+    for (k = 0; k < Domain_size + 1; k++)
+      free(Sel_bucket[k]);
+    free(Sel_bucket);
+    free(Sel_crossed);
+    Sel_bucket = NULL;
+    Sel_crossed = NULL;
+  }
+  free(Sel_open);
+  free(Sel_pos);
+  Sel_open = NULL;
+  Sel_pos = NULL;
+}  /* free_selection */
+
+/*************
+ *
+ *   select_assign_update()
+ *
+ *   Cell ID has just been assigned.
+ *
+ *************/
+
+Estack select_assign_update(int id, Estack stk)
+{
+  int p = Sel_pos[id];
+  stk = trail_bit(Sel_open, p, FALSE, stk);
+  if (Sel_bucket)
+    stk = trail_bit(Sel_bucket[Sel_crossed[id]], p, FALSE, stk);
+  return stk;
+}  /* select_assign_update */
+
+/*************
+ *
+ *   select_elim_update()
+ *
+ *   A value has just been crossed off of the open cell ID.
+ *
+ *************/
+
+Estack select_elim_update(int id, Estack stk)
+{
+  if (Sel_bucket) {
+    int p = Sel_pos[id];
+    size_t k = Sel_crossed[id];
+    stk = trail_bit(Sel_bucket[k], p, FALSE, stk);
+    stk = trail_bit(Sel_bucket[k+1], p, TRUE, stk);
+    stk = update_and_push((void **) &(Sel_crossed[id]), (void *) (k+1), stk);
+  }
+  return stk;
+}  /* select_elim_update */
+
+/*************
+ *
+ *   best_open()
+ *
+ *   Return the ID of the best open cell at positions lo..hi, or -1.
+ *   Ties go to the earliest position.
+ *
+ *************/
+
+static
+int best_open(int lo, int hi)
+{
+  if (Sel_bucket) {
+    int k;
+    for (k = Domain_size; k >= 0; k--) {
+      int p = first_bit(Sel_bucket[k], lo, hi);
+      if (p >= 0)
+	return pos_to_id(p);
+    }
+    return -1;
+  }
+  else {
+    /* The measure has to be computed for each open cell. */
     int id_of_max = -1;
     int max = -1;
-    int i;
-    for (i = min_id; i <= max_id; i++) {
-      if (Cells[i].value == NULL) {
-	selection_measure(i, &max, &id_of_max);
-      }
+    int p = first_bit(Sel_open, lo, hi);
+    while (p >= 0) {
+      selection_measure(pos_to_id(p), &max, &id_of_max);
+      p = first_bit(Sel_open, p+1, hi);
     }
-    return id_of_max;    
+    return id_of_max;
+  }
+}  /* best_open */
+
+/*************
+ *
+ *   last_with_max_index()
+ *
+ *   Return the last position in lo..hi (Ordered_cells) whose cell has
+ *   max_index <= n, or lo-1 if there is none.  This assumes that the
+ *   cells in lo..hi are ordered by max_index.
+ *
+ *************/
+
+static
+int last_with_max_index(int lo, int hi, int n)
+{
+  while (lo <= hi) {
+    int mid = lo + (hi - lo) / 2;
+    if (Ordered_cells[mid]->max_index <= n)
+      lo = mid + 1;
+    else
+      hi = mid - 1;
   }
+  return lo - 1;
+}  /* last_with_max_index */
+
+/*************
+ *
+ *   select_linear()
+ *
+ *************/
+
+int select_linear(int min_id, int max_id)
+{
+  if (parm(Opt->selection_measure) == NO_MEASURE)
+    /* Return the first open cell. */
+    return first_bit(Sel_open, min_id, max_id);
+  else
+    return best_open(min_id, max_id);
 }  /* select_linear */
 
 /*************
@@ -207,23 +465,13 @@ int select_linear(int min_id, int max_id)
 int select_concentric(int min_id, int max_id)
 {
   /* Find the first open cell. */
-  int i = min_id;
-  while (i <= max_id && Ordered_cells[i]->value != NULL)
-    i++;
-  if (i > max_id)
+  int i = first_bit(Sel_open, min_id, max_id);
+  if (i < 0)
     return -1;
   else {
     /* Find the best cell with the same max_index as the first open cell. */
     int n = Ordered_cells[i]->max_index;
-    int max_val = -1;
-    int id_of_max = -1;
-
-    while (i <= max_id && Ordered_cells[i]->max_index <= n) {
-      if (Ordered_cells[i]->value == NULL)
-	selection_measure(Ordered_cells[i]->id, &max_val, &id_of_max);
-      i++;
-    }
-    return id_of_max;
+    return best_open(i, last_with_max_index(i, IMIN(max_id, Sel_last), n));
   }
 }  /* select_concentric */
 
@@ -235,22 +483,12 @@ int select_concentric(int min_id, int max_id)
 
 int select_concentric_band(int min_id, int max_id, int max_constrained)
 {
-  int max = -1;
-  int id_of_max = -1;
-  int i = min_id;
-  
-  while (i <= max_id &&
-	 Ordered_cells[i]->max_index <= max_constrained) {
-    if (Ordered_cells[i]->value == NULL)
-      selection_measure(Ordered_cells[i]->id, &max, &id_of_max);
-    i++;
-  }
+  int hi = last_with_max_index(min_id, IMIN(max_id, Sel_last), max_constrained);
+  int id_of_max = best_open(min_id, hi);
   if (id_of_max >= 0)
     return id_of_max;
   else
-    /* There is nothing in the band, so revert to select_concentric.
-       This is a bit redundant, because it will scan (again) the full cells.
-    */
+    /* There is nothing in the band, so revert to select_concentric. */
     return select_concentric(min_id, max_id);
 }  /* select_concentric_band */
 
@@ -192,16 +192,18 @@ Plist back_demodulatable(Topform demod, int type, LADR_BOOL lex_order_vars)
 
 /*************
  *
- *   back_demod_idx_report()
+ *   fprint_demod_idx_stats()
  *
  *************/
 
 /* DOCUMENTATION
+Print the statistics of the demodulator and back demodulation
+indexes (see fprint_mindex_stats()).
 */
 
 /* PUBLIC */
-void back_demod_idx_report(void)
+void fprint_demod_idx_stats(FILE *fp)
 {
-  printf("Back demod index: ");
-  p_fpa_density(Back_demod_idx->fpa);
-}  /* back_demod_idx_report */
+  fprint_mindex_stats(fp, "Demod", Demod_idx);
+  fprint_mindex_stats(fp, "Back_demod", Back_demod_idx);
+}  /* fprint_demod_idx_stats */
@@ -47,6 +47,6 @@ void demodulate_clause(Topform c, int step_limit, int increase_limit,
 
 Plist back_demodulatable(Topform demod, int type, LADR_BOOL lex_order_vars);
 
-void back_demod_idx_report(void);
+void fprint_demod_idx_stats(FILE *fp);
 
 #endif  /* conditional compilation of whole file */
@@ -33,16 +33,19 @@ static Di_tree Nonunit_features_idx;  /* nonunit fsub, nonunit bsub */
  *************/
 
 /* DOCUMENTATION
+The Mindextype (FPA or SUBST_TREE) is for the indexes used for
+unification and instance retrieval (unit conflict, back subsumption,
+and back unit deletion).
 */
 
 /* PUBLIC */
-void init_literals_index(void)
+void init_literals_index(Mindextype mtype)
 {
-  Unit_fpa_idx     = lindex_init(FPA, ORDINARY_UNIF, 10,
-				 FPA, ORDINARY_UNIF, 10);
+  Unit_fpa_idx     = lindex_init(mtype, ORDINARY_UNIF, 10,
+				 mtype, ORDINARY_UNIF, 10);
 
-  Nonunit_fpa_idx  = lindex_init(FPA, ORDINARY_UNIF, 10,
-				 FPA, ORDINARY_UNIF, 10);
+  Nonunit_fpa_idx  = lindex_init(mtype, ORDINARY_UNIF, 10,
+				 mtype, ORDINARY_UNIF, 10);
 
   Unit_discrim_idx = lindex_init(DISCRIM_BIND, ORDINARY_UNIF, 10,
 				 DISCRIM_BIND, ORDINARY_UNIF, 10);
@@ -209,22 +212,18 @@ Plist back_subsumption(Topform c)
 
 /*************
  *
- *   lits_idx_report()
+ *   fprint_lits_idx_stats()
  *
  *************/
 
 /* DOCUMENTATION
+Print the statistics of the literal indexes (see fprint_mindex_stats()).
 */
 
 /* PUBLIC */
-void lits_idx_report(void)
+void fprint_lits_idx_stats(FILE *fp)
 {
-  printf("Pos unit lits index: ");
-  p_fpa_density(Unit_fpa_idx->pos->fpa);
-  printf("Neg unit lits index: ");
-  p_fpa_density(Unit_fpa_idx->neg->fpa);
-  printf("Pos nonunit lits index: ");
-  p_fpa_density(Nonunit_fpa_idx->pos->fpa);
-  printf("Neg nonunit lits index: ");
-  p_fpa_density(Nonunit_fpa_idx->neg->fpa);
-}  /* lits_idx_report */
+  fprint_lindex_stats(fp, "Unit_lits", Unit_fpa_idx);
+  fprint_lindex_stats(fp, "Nonunit_lits", Nonunit_fpa_idx);
+  fprint_lindex_stats(fp, "Unit_discrim", Unit_discrim_idx);
+}  /* fprint_lits_idx_stats */
@@ -32,7 +32,7 @@
 
 /* Public function prototypes from index_lits.c */
 
-void init_literals_index(void);
+void init_literals_index(Mindextype mtype);
 
 void destroy_literals_index(void);
 
@@ -50,6 +50,6 @@ Topform forward_subsumption(Topform d);
 
 Plist back_subsumption(Topform c);
 
-void lits_idx_report(void);
+void fprint_lits_idx_stats(FILE *fp);
 
 #endif  /* conditional compilation of whole file */
@@ -0,0 +1,147 @@
+/*  Copyright (C) 2006, 2007 William McCune
+
+    This file is part of the LADR Deduction Library.
+
+    The LADR Deduction Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU General Public License,
+    version 2.
+
+    The LADR Deduction Library is distributed in the hope that it will be
+    useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with the LADR Deduction Library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#define PROVER_NAME     "Multigoal-Prover9"
+#include "../VERSION_DATE.h"
+
+#include "provers.h"
+
+/*************
+ *
+ *    next_goal() -- take the denials of the first goal from sos
+ *
+ *************/
+
+static
+Plist next_goal(Plist *sos)
+{
+  Plist denials = NULL;
+  Plist p = *sos;
+  Plist rest = NULL;
+  int goal_id = 0;
+
+  for (p = *sos; p; p = p->next) {
+    Topform c = p->v;
+    Just j = c->justification;
+    if (j && j->type == DENY_JUST && (goal_id == 0 || j->u.id == goal_id)) {
+      goal_id = j->u.id;
+      denials = plist_prepend(denials, c);
+    }
+    else
+      rest = plist_prepend(rest, c);
+  }
+  zap_plist(*sos);
+  *sos = reverse_plist(rest);
+  return reverse_plist(denials);
+}  // next_goal
+
+/*************
+ *
+ *    main -- basic prover, each goal separately, same axioms
+ *
+ *************/
+
+int main(int argc, char **argv)
+{
+  Prover_input input;
+  Prover_session session;
+  Plist goals = NULL;
+  Plist denials, p;
+  int saturate_given, n, i, proved, return_code;
+
+  print_banner(argc, argv, PROVER_NAME, PROGRAM_VERSION, PROGRAM_DATE, FALSE);
+
+  saturate_given = init_parm("saturate_given", 0, 0, INT_MAX);
+
+  /***************** Initialize and read the input ***************************/
+
+  input = std_prover_init_and_input(argc, argv,
+			    TRUE,           // clausify
+			    TRUE,           // echo input to stdout
+			    KILL_UNKNOWN);  // unknown flags/parms are fatal
+
+  // Separate the denials (at the end of sos) by goal.
+
+  while ((denials = next_goal(&(input->sos))) != NULL)
+    goals = plist_append(goals, denials);
+  n = plist_count(goals);
+
+  if (n == 0)
+    fatal_error(PROVER_NAME ": no goals");
+
+  /***************** Process and saturate the axioms *************************/
+
+  print_separator(stdout, "AXIOMS", TRUE);
+
+  session = init_prover_session(input, parm(saturate_given));
+
+  if (session->saturation_code == MAX_PROOFS_EXIT) {
+    printf("\nThe axioms are inconsistent, so all goals are proved.\n");
+    printf("\nTHEOREM PROVED\n");
+    exit_with_message(stdout, MAX_PROOFS_EXIT);
+  }
+
+  printf("\n%% The checkpoint has %d usable, %d sos, and %d demodulators.\n",
+	 session->usable->length, session->sos->length,
+	 session->demods->length);
+
+  /***************** Search for a proof of each goal *************************/
+
+  proved = 0;
+  return_code = MAX_PROOFS_EXIT;
+
+  for (p = goals, i = 1; p; p = p->next, i++) {
+    Prover_results results;
+
+    print_separator(stdout, "GOAL", TRUE);
+    printf("\nStarting goal %d of %d.\n", i, n);
+    fflush(stdout);
+
+    results = session_search(session, p->v);
+
+    printf("\n%% Goal %d of %d: %s (%s).\n", i, n,
+	   results->proofs ? "proved" : "failed",
+	   exit_string(results->return_code));
+    if (results->proofs)
+      proved++;
+    else
+      return_code = results->return_code;
+    zap_prover_results(results);
+  }
+
+  zap_plist(goals);  // the denials were used up
+  zap_prover_session(session);
+
+  /***************** Print result message and exit ***************************/
+
+  printf("\n%d of %d goals proved.\n", proved, n);
+
+  if (proved == n) {
+    printf("\nTHEOREM PROVED\n");
+    if (!flag(input->options->quiet))
+      fprintf(stderr, "\nTHEOREM PROVED\n");
+  }
+  else {
+    printf("\nSEARCH FAILED\n");
+    if (!flag(input->options->quiet))
+      fprintf(stderr, "\nSEARCH FAILED\n");
+  }
+
+  exit_with_message(stdout, return_code);
+  exit(1);  // to satisfy the compiler (won't be called)
+}  // main
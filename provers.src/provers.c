@@ -29,12 +29,14 @@
 /* Private definitions and types */
 
 static char Help_string[] = 
-"\nUsage: prover9 [-h] [-x] [-p] [-t <n>] [-f <files>]\n"
+"\nUsage: prover9 [-h] [-x] [-p] [-t <n>] [-s <file>] [-w <file>] [-f <files>]\n"
 "\n"
 "  -h         Help.  Also see http://www.cs.unm.edu/~mccune/prover9/\n"
 "  -x         set(auto2).  (enhanced auto mode)\n"
 "  -p         Fully parenthesize output.\n"
 "  -t n       assign(max_seconds, n).  (overrides ordinary input)\n"
+"  -s file    Write a snapshot of the processed initial clauses, then exit.\n"
+"  -w file    Warm start: take processed initial clauses from a snapshot.\n"
 "  -f files   Take input from files instead of from standard input.\n"
 "\n";
 
@@ -43,6 +45,8 @@ struct arg_options {
   LADR_BOOL auto2;
   int  max_seconds;
   LADR_BOOL files;
+  char *snapshot;
+  char *warm_start;
 };
 
 /*************
@@ -59,7 +63,7 @@ static
 struct arg_options get_command_line_args(int argc, char **argv)
 {
   int c;
-  struct arg_options opts = {FALSE, FALSE, INT_MAX, FALSE};
+  struct arg_options opts = {FALSE, FALSE, INT_MAX, FALSE, NULL, NULL};
 
   /* getopt() option string
 
@@ -70,7 +74,7 @@ struct arg_options get_command_line_args(int argc, char **argv)
      Two colon after options: argument optional. (GNU extension! Don't use it!)
   */
   
-  while ((c = getopt(argc, argv,":hapxt:f")) != EOF) {
+  while ((c = getopt(argc, argv,":hapxt:fs:w:")) != EOF) {
     switch (c) {
     case 'x':
       opts.auto2 = TRUE;
@@ -84,6 +88,12 @@ struct arg_options get_command_line_args(int argc, char **argv)
     case 'f':  /* input files */
       opts.files = TRUE;
       break;
+    case 's':
+      opts.snapshot = optarg;
+      break;
+    case 'w':
+      opts.warm_start = optarg;
+      break;
     case 'h':
     default:
       printf("%s", Help_string);
@@ -264,6 +274,21 @@ Prover_input std_prover_init_and_input(int argc, char **argv,
 
   process_command_line_args_1(opts, pi->options);  // high-level, e.g., auto2
 
+  // Read the snapshot first, so that new Skolem symbols are different.
+
+  if (opts.warm_start) {
+    Plist lists[3];
+    read_snapshot(opts.warm_start, lists, 3);
+    pi->warm_usable = lists[0];
+    pi->warm_sos    = lists[1];
+    pi->warm_demods = lists[2];
+    printf("\n%% From the command line: warm start from %s "
+	   "(%d usable, %d sos, %d demodulators).\n", opts.warm_start,
+	   plist_count(pi->warm_usable), plist_count(pi->warm_sos),
+	   plist_count(pi->warm_demods));
+  }
+  pi->snapshot = opts.snapshot;
+
   // Read commands such as set, clear, op, lex.
   // Read lists, filling in variables given to the accept_list calls.
 
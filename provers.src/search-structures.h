@@ -186,7 +186,10 @@ struct prover_options {
     eq_defs,             // fold, unfold, pass
     literal_selection,   // maximal, etc.
     stats,               // none, some, lots, all
-    multiple_interps;    // false_in_all, false_in_some
+    multiple_interps,    // false_in_all, false_in_some
+    literals_index,      // fpa, subst_tree
+    back_demod_index,    // fpa, subst_tree
+    clash_index;         // fpa, subst_tree
 };
 
 // Clocks
@@ -262,6 +265,20 @@ struct prover_input {
   Prover_options options;
   // extra options
   LADR_BOOL xproofs;  // tell search() to return xproofs as well as ordinary proofs
+  // snapshots (see snapshot.h)
+  Plist warm_usable, warm_sos, warm_demods;  // processed clauses from a snapshot
+  char *snapshot;     // write the processed initial clauses here, then exit
+};
+
+// Sessions: searches for several goals with the same axioms
+
+typedef struct prover_session * Prover_session;
+
+struct prover_session {
+  struct prover_input input;  // options, hints, etc. (no clauses)
+  Clist usable, sos, demods;  // checkpoint: the axioms after saturation
+  Clist archive;              // other clauses from the saturation (ancestors)
+  int saturation_code;        // return code of the saturation search
 };
 
 // Search results
@@ -287,6 +304,7 @@ enum {
   MAX_GIVEN_EXIT    = 5,
   MAX_KEPT_EXIT     = 6,
   ACTION_EXIT       = 7,
+  SNAPSHOT_EXIT     = 8,
 
   SIGINT_EXIT       = 101,
   SIGSEGV_EXIT      = 102
@@ -73,6 +73,11 @@ static struct {
   Clist disabled;
   Plist empties;
 
+  // clauses from a snapshot (warm start), already processed
+
+  Clist warm_sos;
+  Plist warm_demods;
+
   // indexing
 
   Lindex clashable_idx;  // literal index for resolution rules
@@ -90,6 +95,7 @@ static struct {
   LADR_BOOL searching;      // set to TRUE when first given is selected
   LADR_BOOL initialized;    // has this structure been initialized?
   double start_time;   // when was it initialized? 
+  double base_seconds; // max_seconds counts from here (session searches)
   int start_ticks;     // quasi-clock that times the same for all machines
 
   int return_code;     // result of search
@@ -284,6 +290,18 @@ Prover_options init_prover_options(void)
 					"false_in_all",
 					"false_in_some");
 
+  p->literals_index = init_stringparm("literals_index", 2,
+				      "fpa",
+				      "subst_tree");
+
+  p->back_demod_index = init_stringparm("back_demod_index", 2,
+					"fpa",
+					"subst_tree");
+
+  p->clash_index = init_stringparm("clash_index", 2,
+				   "fpa",
+				   "subst_tree");
+
   // Flag and parm Dependencies.  These cause other flags and parms
   // to be changed.  The changes happen immediately and can be undone
   // by later settings in the input.
@@ -632,6 +650,24 @@ void fprint_prover_clocks(FILE *fp, struct prover_clocks clks)
   }
 }  /* fprint_prover_clocks */
 
+/*************
+ *
+ *   fprint_index_stats()
+ *
+ *************/
+
+static
+void fprint_index_stats(FILE *fp)
+{
+  if (Glob.clashable_idx != NULL) {
+    fprintf(fp, "\nIndex statistics, queries "
+	    "(unify/instance/generalization/variant/identical):\n");
+    fprint_lits_idx_stats(fp);
+    fprint_demod_idx_stats(fp);
+    fprint_lindex_stats(fp, "Clashable", Glob.clashable_idx);
+  }
+}  /* fprint_index_stats */
+
 /*************
  *
  *   fprint_all_stats()
@@ -654,6 +690,7 @@ void fprint_all_stats(FILE *fp, char *stats_level)
 
   if (str_ident(stats_level, "all")) {
     print_memory_stats(fp);
+    fprint_index_stats(fp);
     selector_report();
     /* p_sos_dist(); */
   }
@@ -667,7 +704,11 @@ void fprint_all_stats(FILE *fp, char *stats_level)
  *
  *************/
 
-static
+/* DOCUMENTATION
+The name of an exit code, for messages.
+*/
+
+/* PUBLIC */
 char *exit_string(int code)
 {
   char *message;
@@ -680,6 +721,7 @@ char *exit_string(int code)
   case MAX_GIVEN_EXIT:   message = "max_given";   break;
   case MAX_KEPT_EXIT:    message = "max_kept";    break;
   case ACTION_EXIT:      message = "action";      break;
+  case SNAPSHOT_EXIT:    message = "snapshot";    break;
   case SIGSEGV_EXIT:     message = "SIGSEGV";     break;
   case SIGINT_EXIT:      message = "SIGINT";      break;
   default: message = "???";
@@ -822,7 +864,8 @@ void exit_if_over_limit(void)
     done_with_search(MAX_KEPT_EXIT);
   else if (over_parm_limit(Stats.given, Opt->max_given))
     done_with_search(MAX_GIVEN_EXIT);
-  else if (at_parm_limit(user_seconds(), Opt->max_seconds))
+  else if (at_parm_limit(user_seconds() - Glob.base_seconds,
+			 Opt->max_seconds))
     done_with_search(MAX_SECONDS_EXIT);
 }  // exit_if_over_limit
 
@@ -997,6 +1040,85 @@ void free_search_memory(void)
 
 }  // free_search_memory
 
+/*************
+ *
+ *   rollback_search()
+ *
+ *   This takes back a search, for sessions: the clauses are
+ *   unindexed and removed from the lists, and the indexes are freed.
+ *   Clauses that are in other lists (a session's checkpoint) are kept.
+ *   The others are deleted, or, if archive is not NULL, put there.
+ *   The hints belong to the caller, so they are not deleted.
+ *
+ *************/
+
+static
+void rollback_search(Clist archive)
+{
+  Clist_pos p;
+
+  while (Glob.demods->first) {
+    Topform c = Glob.demods->first->c;
+    if (!flag(Opt->eval_rewrite))
+      index_demodulator(c, demodulator_type(c,
+					    parm(Opt->lex_dep_demod_lim),
+					    flag(Opt->lex_dep_demod_sane)),
+			DELETE, Clocks.index);
+    clist_remove(c, Glob.demods);
+    if (c->containers == NULL)
+      clist_append(c, Glob.disabled);
+  }
+  clist_free(Glob.demods);
+  destroy_demodulation_index();
+
+  while (Glob.usable->first)
+    disable_clause(Glob.usable->first->c);
+  clist_free(Glob.usable);
+
+  while (Glob.sos->first)
+    disable_clause(Glob.sos->first->c);
+  clist_free(Glob.sos);
+
+  while (Glob.limbo->first)
+    disable_clause(Glob.limbo->first->c);
+  clist_free(Glob.limbo);
+
+  destroy_literals_index();
+  destroy_back_demod_index();
+  lindex_destroy(Glob.clashable_idx);
+
+  if (Glob.hints->first) {
+    for (p = Glob.hints->first; p; p = p->next)
+      unindex_hint(p->c);
+    done_with_hints();
+  }
+  while (Glob.hints->first)
+    clist_remove(Glob.hints->first->c, Glob.hints);
+  clist_free(Glob.hints);
+
+  if (archive == NULL)
+    delete_clist(Glob.disabled);
+  else {
+    while (Glob.disabled->first) {
+      Topform c = Glob.disabled->first->c;
+      clist_remove(c, Glob.disabled);
+      clist_append(c, archive);
+    }
+    clist_free(Glob.disabled);
+  }
+
+  Glob.usable = Glob.sos = Glob.limbo = Glob.demods = NULL;
+  Glob.hints = Glob.disabled = NULL;
+  Glob.clashable_idx = NULL;
+
+  zap_plist(Glob.empties);
+  zap_plist(Glob.desc_to_be_disabled);
+  zap_plist(Glob.cac_clauses);
+  Glob.empties = Glob.desc_to_be_disabled = Glob.cac_clauses = NULL;
+  Glob.searching = FALSE;
+  memset(&Stats, 0, sizeof(Stats));
+}  // rollback_search
+
 /*************
  *
  *   handle_proof_and_maybe_exit()
@@ -1143,6 +1265,19 @@ void clause_wt_with_adjustments(Topform c)
 
 /* First, some helper routines. */
 
+static
+void cl_process_cac(Topform c)
+{
+  if (flag(Opt->cac_redundancy)) {
+    clock_start(Clocks.redundancy);
+    // If comm or assoc, make a note of it.
+    // Also simplify C or AC redundant literals to $T.
+    if (cac_redundancy(c, !flag(Opt->quiet)))
+      Glob.cac_clauses = plist_prepend(Glob.cac_clauses, c);
+    clock_stop(Clocks.redundancy);
+  }
+}  // cl_process_cac
+
 static
 void cl_process_simplify(Topform c)
 {
@@ -1184,14 +1319,7 @@ void cl_process_simplify(Topform c)
     clock_stop(Clocks.unit_del);
   }
 
-  if (flag(Opt->cac_redundancy)) {
-    clock_start(Clocks.redundancy);
-    // If comm or assoc, make a note of it.
-    // Also simplify C or AC redundant literals to $T.
-    if (cac_redundancy(c, !flag(Opt->quiet)))
-      Glob.cac_clauses = plist_prepend(Glob.cac_clauses, c);
-    clock_stop(Clocks.redundancy);
-  }
+  cl_process_cac(c);
 }  // cl_process_simplify
 
 static
@@ -1855,8 +1983,10 @@ void make_inferences(void)
 
     // Maybe disable back subsumption.
 
-    if (over_parm_limit(Stats.given, Opt->max_given))
+    if (over_parm_limit(Stats.given, Opt->max_given)) {
+      insert_into_sos2(given_clause, Glob.sos);  // not given after all
       done_with_search(MAX_GIVEN_EXIT);
+    }
 
     if (Stats.given == parm(Opt->backsub_check)) {
       int ratio = (Stats.back_subsumed == 0 ?
@@ -2263,6 +2393,150 @@ void init_search(void)
 
 }  /* init_search */
 
+/*************
+ *
+ *   index_type()
+ *
+ *   For the stringparms that choose an index for unification
+ *   and instance retrieval.
+ *
+ *************/
+
+static
+Mindextype index_type(int id)
+{
+  if (stringparm(id, "subst_tree"))
+    return SUBST_TREE;
+  else
+    return FPA;
+}  /* index_type */
+
+/*************
+ *
+ *   bulk_sort_thread()
+ *
+ *************/
+
+static
+int bulk_sort_thread(void *arg)
+{
+  mindex_bulk_sort((Mindex) arg);
+  return 0;
+}  /* bulk_sort_thread */
+
+/*************
+ *
+ *   build_bulk_indexes()
+ *
+ *************/
+
+static
+void build_bulk_indexes(void)
+{
+  // Finish the bulk loading started by mindex_bulk_begin().  The sorting
+  // is done in parallel, one thread per index; the building (get_mem)
+  // is sequential.
+
+  Plist indexes = mindex_bulk_end();
+  int n = plist_count(indexes);
+  Plist p;
+
+  clock_start(Clocks.index);
+  if (n > 1) {
+    thrd_t *threads = malloc(n * sizeof(thrd_t));
+    int i = 0;
+    for (p = indexes; p; p = p->next) {
+      if (thrd_create(&threads[i], bulk_sort_thread, p->v) != thrd_success)
+	fatal_error("build_bulk_indexes: thread creation failed");
+      i++;
+    }
+    for (i = 0; i < n; i++)
+      thrd_join(threads[i], NULL);
+    free(threads);
+  }
+  for (p = indexes; p; p = p->next)
+    mindex_bulk_build(p->v);
+  clock_stop(Clocks.index);
+  zap_plist(indexes);
+}  /* build_bulk_indexes */
+
+/*************
+ *
+ *   clear_warm_marks()
+ *
+ *************/
+
+static
+void clear_warm_marks(Plist clauses)
+{
+  Plist p;
+  for (p = clauses; p; p = p->next)
+    clear_atom_flags(p->v);
+}  /* clear_warm_marks */
+
+/*************
+ *
+ *   index_warm_clauses()
+ *
+ *   The Sos clauses and demodulators from a snapshot (-w) or a
+ *   session checkpoint were processed before, so they are not
+ *   simplified again.  They are oriented for this job's term
+ *   ordering (which can be different, so equalities can be flipped),
+ *   checked for C and AC laws, weighed, kept (as in cl_process()),
+ *   and indexed.  The warm Sos clauses are removed from temp_sos.
+ *
+ *************/
+
+static
+void index_warm_clauses(Clist temp_sos)
+{
+  Clist_pos p;
+  Plist q;
+
+  mindex_bulk_begin();
+  for (p = Glob.warm_sos->first; p != NULL; p = p->next) {
+    Topform c = p->c;
+    if (clist_member(c, temp_sos)) {  // not removed by predicate_elim
+      clist_remove(c, temp_sos);
+      if (number_of_literals(c->literals) == 0)
+	handle_proof_and_maybe_exit(c);
+      else {
+	orient_equalities(c, TRUE);  // the term order can be different
+	cl_process_cac(c);           // note C and AC symbols
+	clause_wt_with_adjustments(c);
+	cl_process_keep(c);
+	c->initial = TRUE;
+	insert_into_sos2(c, Glob.sos);
+	index_literals(c, INSERT, Clocks.index, FALSE);
+	index_back_demod(c, INSERT, Clocks.index, flag(Opt->back_demod));
+      }
+    }
+  }
+  build_bulk_indexes();
+
+  mindex_bulk_begin();
+  for (q = Glob.warm_demods; q; q = q->next) {
+    Topform c = q->v;
+    int type;
+    if (c->id == 0)
+      assign_clause_id(c);
+    orient_equalities(c, TRUE);  // flips go into the justification
+    type = demodulator_type(c,
+			    parm(Opt->lex_dep_demod_lim),
+			    flag(Opt->lex_dep_demod_sane));
+    if (type != NOT_DEMODULATOR) {
+      clist_append(c, Glob.demods);
+      index_demodulator(c, type, INSERT, Clocks.index);
+    }
+  }
+  build_bulk_indexes();
+
+  clist_zap(Glob.warm_sos);
+  zap_plist(Glob.warm_demods);
+  Glob.warm_sos = NULL;
+  Glob.warm_demods = NULL;
+}  /* index_warm_clauses */
+
 /*************
  *
  *   index_and_process_initial_clauses()
@@ -2286,14 +2560,18 @@ void index_and_process_initial_clauses(void)
 
   // Allocate and initialize indexes (even if they won't be used).
 
-  init_literals_index();  // fsub, bsub, fudel, budel, ucon
+  mindex_query_depth_stats(stringparm(Opt->stats, "all"));  // for the index stats
+
+  init_literals_index(index_type(Opt->literals_index));  // fsub, bsub, fudel, budel, ucon
 
   init_demodulator_index(DISCRIM_BIND, ORDINARY_UNIF, 0);
 
-  init_back_demod_index(FPA, ORDINARY_UNIF, 10);
+  init_back_demod_index(index_type(Opt->back_demod_index), ORDINARY_UNIF, 10);
 
-  Glob.clashable_idx = lindex_init(FPA, ORDINARY_UNIF, 10,
-				   FPA, ORDINARY_UNIF, 10);
+  Glob.clashable_idx = lindex_init(index_type(Opt->clash_index),
+				   ORDINARY_UNIF, 10,
+				   index_type(Opt->clash_index),
+				   ORDINARY_UNIF, 10);
 
   init_hints(ORDINARY_UNIF, Att.bsub_hint_wt,
 	     flag(Opt->collect_hint_labels),
@@ -2309,9 +2587,11 @@ void index_and_process_initial_clauses(void)
   ////////////////////////////////////////////////////////////////////////////
   // Usable
 
+  mindex_bulk_begin();
   for (p = Glob.usable->first; p != NULL; p = p->next) {
     Topform c = p->c;
-    assign_clause_id(c);
+    if (c->id == 0)  // session checkpoint clauses have IDs
+      assign_clause_id(c);
     mark_maximal_literals(c->literals);
     mark_selected_literals(c->literals, stringparm1(Opt->literal_selection));
     if (flag(Opt->dont_flip_input))
@@ -2322,6 +2602,7 @@ void index_and_process_initial_clauses(void)
     index_back_demod(c, INSERT, Clocks.index, flag(Opt->back_demod));
     index_clashable(c, INSERT);
   }
+  build_bulk_indexes();
 
   ////////////////////////////////////////////////////////////////////////////
   // Demodulators
@@ -2336,6 +2617,7 @@ void index_and_process_initial_clauses(void)
     fflush(stderr);
   }
 
+  mindex_bulk_begin();
   for (p = Glob.demods->first; p != NULL; p = p->next) {
     Topform c = p->c;
     assign_clause_id(c);
@@ -2399,6 +2681,7 @@ void index_and_process_initial_clauses(void)
       }
     }
   }
+  build_bulk_indexes();
 
   if (flag(Opt->eval_rewrite))
     init_dollar_eval(Glob.demods);
@@ -2427,6 +2710,8 @@ void index_and_process_initial_clauses(void)
   name_clist(temp_sos, "temp_sos");       // not really necessary
   Glob.sos = clist_init("sos");           // get a new (empty) Sos list
 
+  index_warm_clauses(temp_sos);
+
   if (flag(Opt->process_initial_sos)) {
 
     if (flag(Opt->print_initial_clauses))
@@ -2473,6 +2758,7 @@ void index_and_process_initial_clauses(void)
     fflush(stderr);
     
     /* not applying full processing to initial sos */
+    mindex_bulk_begin();
     while (temp_sos->first) {
       Topform c = temp_sos->first->c;
       clist_remove(c, temp_sos);
@@ -2504,6 +2790,7 @@ void index_and_process_initial_clauses(void)
 	index_back_demod(c, INSERT, Clocks.index, flag(Opt->back_demod));
       }
     }
+    build_bulk_indexes();
   }
 
   clist_zap(temp_sos);  // free the temporary list
@@ -2672,11 +2959,26 @@ Prover_results search(Prover_input p)
 
     // Move clauses and term lists into Glob; do not assign IDs to clauses.
 
-    Glob.usable  = move_clauses_to_clist(p->usable, "usable", FALSE);
-    Glob.sos     = move_clauses_to_clist(p->sos, "sos", FALSE);
+    // Clauses from a snapshot (-w) go first.  They take part in the
+    // auto analysis, but they are not processed again (see
+    // index_and_process_initial_clauses()).  Their marks (oriented,
+    // maximal, selected) are for the term ordering of the job that
+    // processed them, so they are cleared, to be set again.
+
+    clear_warm_marks(p->warm_usable);
+    clear_warm_marks(p->warm_sos);
+    clear_warm_marks(p->warm_demods);
+
+    Glob.usable  = move_clauses_to_clist(p->warm_usable, "usable", FALSE);
+    clist_append_plist(Glob.usable, p->usable);
+    Glob.sos     = move_clauses_to_clist(p->warm_sos, "sos", FALSE);
+    clist_append_plist(Glob.sos, p->sos);
     Glob.demods  = move_clauses_to_clist(p->demods,"demodulators",FALSE);
     Glob.hints   = move_clauses_to_clist(p->hints, "hints", FALSE);
 
+    Glob.warm_sos    = move_clauses_to_clist(p->warm_sos, "warm_sos", FALSE);
+    Glob.warm_demods = p->warm_demods;
+
     Glob.weights          = tlist_copy(p->weights);
     Glob.kbo_weights      = tlist_copy(p->kbo_weights);
     Glob.actions          = tlist_copy(p->actions);
@@ -2719,6 +3021,17 @@ Prover_results search(Prover_input p)
     
     index_and_process_initial_clauses();
 
+    if (p->snapshot) {
+      Clist lists[3];
+      lists[0] = Glob.usable;
+      lists[1] = Glob.sos;
+      lists[2] = Glob.demods;
+      write_snapshot(p->snapshot, lists, 3);
+      printf("\n%% Snapshot of the initial clauses written to %s.\n",
+	     p->snapshot);
+      exit_with_message(stdout, SNAPSHOT_EXIT);
+    }
+
     print_separator(stdout, "SEARCH", TRUE);
 
     printf("\n%% Starting search at %.2f seconds.\n", user_seconds());
@@ -2907,3 +3220,150 @@ Prover_results forking_search(Prover_input input)
 
     return results;
 }
+
+/*************
+ *
+ *   init_prover_session()
+ *
+ *************/
+
+/* DOCUMENTATION
+This starts a session, for proving several goals, one at a time,
+with the same axioms: the clauses in p, which should not include
+any denials.
+<P>
+The axioms are processed, and then saturated by a search
+with at most max_given given clauses.  The resulting lists
+(usable, sos, and demodulators) are kept as a checkpoint,
+and each session_search() starts from it, so the work
+on the axioms is done once for the whole session.
+<P>
+The saturation does not see the goals, so the things that depend
+on them (predicate_elim and auto_denials) are off for it.
+<P>
+The clauses in p are used up.  The options, hints, and other
+lists in p are used for all of the searches in the session.
+*/
+
+/* PUBLIC */
+Prover_session init_prover_session(Prover_input p, int max_given)
+{
+  Prover_session s = calloc(1, sizeof(struct prover_session));
+  int given_limit = parm(p->options->max_given);
+  LADR_BOOL pred_elim_flag = flag(p->options->predicate_elim);
+  LADR_BOOL denials_flag = flag(p->options->auto_denials);
+  Prover_results results;
+  Clist_pos q;
+  Plist a;
+
+  // Without the goals, predicate_elim would remove the goal predicates.
+
+  assign_parm(p->options->max_given, max_given, FALSE);
+  clear_flag(p->options->predicate_elim, FALSE);
+  clear_flag(p->options->auto_denials, FALSE);
+  results = search(p);
+  assign_parm(p->options->max_given, given_limit, FALSE);
+  update_flag(stdout, p->options->predicate_elim, pred_elim_flag, FALSE);
+  update_flag(stdout, p->options->auto_denials, denials_flag, FALSE);
+  s->saturation_code = results->return_code;
+
+  s->usable = clist_init("session_usable");
+  s->sos    = clist_init("session_sos");
+  s->demods = clist_init("session_demods");
+  s->archive = clist_init("session_archive");
+  for (q = Glob.usable->first; q; q = q->next)
+    clist_append(q->c, s->usable);
+  for (q = Glob.sos->first; q; q = q->next)
+    clist_append(q->c, s->sos);
+  for (q = Glob.demods->first; q; q = q->next)
+    clist_append(q->c, s->demods);
+
+  rollback_search(s->archive);
+
+  // The proofs (if the axioms are inconsistent) are in the archive.
+
+  for (a = results->proofs; a; a = a->next)
+    zap_plist(a->v);
+  zap_plist(results->proofs);
+  free(results);
+
+  s->input = *p;  // structure copy
+  s->input.usable = s->input.sos = s->input.demods = NULL;
+  s->input.snapshot = NULL;
+  return s;
+}  /* init_prover_session */
+
+/*************
+ *
+ *   session_search()
+ *
+ *************/
+
+/* DOCUMENTATION
+This searches for a proof from the checkpoint of a session
+(see init_prover_session()) and a list of denials,
+which are used up.
+The search is limited by the session's options, with max_seconds
+counted from the start of this search, and it stops at the first
+proof (so auto_denials is off, as it can raise max_proofs).
+<P>
+Afterward, the state is rolled back to the checkpoint, so the
+clauses in the proofs of the results are copies, and the results
+should be freed with zap_prover_results().
+*/
+
+/* PUBLIC */
+Prover_results session_search(Prover_session s, Plist denials)
+{
+  struct prover_input in = s->input;  // structure copy
+  int proof_limit = parm(in.options->max_proofs);
+  LADR_BOOL denials_flag = flag(in.options->auto_denials);
+  Prover_results results;
+  Plist a;
+
+  in.warm_usable = copy_clist_to_plist_shallow(s->usable);
+  in.warm_sos    = copy_clist_to_plist_shallow(s->sos);
+  in.warm_demods = copy_clist_to_plist_shallow(s->demods);  // used up
+  in.sos         = denials;
+
+  assign_parm(in.options->max_proofs, 1, FALSE);
+  clear_flag(in.options->auto_denials, FALSE);
+  Glob.base_seconds = user_seconds();
+  results = search(&in);
+  Glob.base_seconds = 0;
+  assign_parm(in.options->max_proofs, proof_limit, FALSE);
+  update_flag(stdout, in.options->auto_denials, denials_flag, FALSE);
+
+  for (a = results->proofs; a; a = a->next) {
+    Plist proof = a->v;
+    a->v = copy_clauses_ija(proof);
+    zap_plist(proof);
+  }
+
+  rollback_search(NULL);
+  zap_plist(in.warm_usable);
+  zap_plist(in.warm_sos);
+  zap_plist(in.sos);
+  return results;
+}  /* session_search */
+
+/*************
+ *
+ *   zap_prover_session()
+ *
+ *************/
+
+/* DOCUMENTATION
+Free a session and its clauses.  The other parts of the
+Prover_input given to init_prover_session() are not freed.
+*/
+
+/* PUBLIC */
+void zap_prover_session(Prover_session s)
+{
+  delete_clist(s->usable);
+  delete_clist(s->sos);
+  delete_clist(s->demods);
+  delete_clist(s->archive);
+  free(s);
+}  /* zap_prover_session */
@@ -54,6 +54,8 @@ void fprint_prover_clocks(FILE *fp, struct prover_clocks clks);
 
 void fprint_all_stats(FILE *fp, char *stats_level);
 
+char *exit_string(int code);
+
 void exit_with_message(FILE *fp, int code);
 
 void report(FILE *fp, char *level);
@@ -66,4 +68,10 @@ Prover_results search(Prover_input p);
 
 Prover_results forking_search(Prover_input input);
 
+Prover_session init_prover_session(Prover_input p, int max_given);
+
+Prover_results session_search(Prover_session s, Plist denials);
+
+void zap_prover_session(Prover_session s);
+
 #endif  /* conditional compilation of whole file */
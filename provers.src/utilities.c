@@ -55,6 +55,7 @@ void print_memory_stats(FILE *fp)
   fprint_discrim_mem(fp, FALSE);
   fprint_discrimb_mem(fp, FALSE);
   fprint_discrimw_mem(fp, FALSE);
+  fprint_substree_mem(fp, FALSE);
   fprint_flatterm_mem(fp, FALSE);
   fprint_mindex_mem(fp, FALSE);
   fprint_lindex_mem(fp, FALSE);